@@ -24,34 +24,115 @@
 
 #include <libvirt-sandbox/libvirt-sandbox.h>
 #include <glib/gi18n.h>
+#include <glib-unix.h>
 #include <sys/types.h>
+#include <sys/ioctl.h>
+#include <signal.h>
+#include <unistd.h>
 #include <pwd.h>
 
+/* Upper bound on how long to wait for the domain to stop, once
+ * the app console has closed, if no lifecycle event arrives */
+#define CLOSE_TIMEOUT 2000
+
+struct SandboxClose {
+    GMainLoop *loop;
+    gboolean appClosed;
+    gboolean domainStopped;
+    guint timer;
+};
+
 static gboolean do_close(GVirSandboxConsole *con G_GNUC_UNUSED,
                          gboolean error G_GNUC_UNUSED,
                          gpointer opaque)
 {
-    GMainLoop *loop = opaque;
-    g_main_loop_quit(loop);
+    struct SandboxClose *closing = opaque;
+    g_main_loop_quit(closing->loop);
     return FALSE;
 }
 
 static gboolean do_delayed_close(gpointer opaque)
 {
-    GMainLoop *loop = opaque;
-    g_main_loop_quit(loop);
+    struct SandboxClose *closing = opaque;
+    closing->timer = 0;
+    g_main_loop_quit(closing->loop);
     return FALSE;
 }
 
+static void do_check_close(struct SandboxClose *closing)
+{
+    if (closing->appClosed && closing->domainStopped) {
+        g_main_loop_quit(closing->loop);
+        return;
+    }
+
+    if (!closing->timer)
+        closing->timer = g_timeout_add(CLOSE_TIMEOUT, do_delayed_close, closing);
+}
+
 static gboolean do_pending_close(GVirSandboxConsole *con G_GNUC_UNUSED,
                                  gboolean error G_GNUC_UNUSED,
                                  gpointer opaque)
 {
-    GMainLoop *loop = opaque;
-    g_timeout_add(2000, do_delayed_close, loop);
+    struct SandboxClose *closing = opaque;
+    closing->appClosed = TRUE;
+    do_check_close(closing);
     return FALSE;
 }
 
+static void do_stopped(GVirDomain *dom G_GNUC_UNUSED,
+                       gpointer opaque)
+{
+    struct SandboxClose *closing = opaque;
+    closing->domainStopped = TRUE;
+    do_check_close(closing);
+}
+
+/* Signals to virt-sandbox itself that are passed on to the app */
+struct SandboxForward {
+    int signum;
+    guint id;
+    GVirSandboxConsole *con;
+    GMainLoop *loop;
+};
+
+static struct SandboxForward forwards[] = {
+    { SIGINT, 0, NULL, NULL },
+    { SIGTERM, 0, NULL, NULL },
+    { SIGHUP, 0, NULL, NULL },
+#if GLIB_CHECK_VERSION(2, 54, 0)
+    { SIGWINCH, 0, NULL, NULL },
+#endif
+};
+
+/* Set once a signal to stop has been passed on to the app */
+static gboolean forwardedStop = FALSE;
+
+static gboolean do_forward_signal(gpointer opaque)
+{
+    struct SandboxForward *fwd = opaque;
+
+#if GLIB_CHECK_VERSION(2, 54, 0)
+    if (fwd->signum == SIGWINCH) {
+        struct winsize ws;
+        if (ioctl(STDIN_FILENO, TIOCGWINSZ, &ws) == 0)
+            gvir_sandbox_console_set_window_size(fwd->con, ws.ws_row, ws.ws_col, NULL);
+        return TRUE;
+    }
+#endif
+
+    /* An app may well ignore the signal, so a second one tears
+     * the sandbox down instead, as does failing to tell the app */
+    if ((fwd->signum != SIGHUP && forwardedStop) ||
+        !gvir_sandbox_console_send_signal(fwd->con, fwd->signum, NULL)) {
+        g_main_loop_quit(fwd->loop);
+        return TRUE;
+    }
+    if (fwd->signum != SIGHUP)
+        forwardedStop = TRUE;
+    return TRUE;
+}
+
 static gboolean do_exited(GVirSandboxConsole *con G_GNUC_UNUSED,
                           int status,
                           gpointer opaque)
@@ -61,6 +142,21 @@ static gboolean do_exited(GVirSandboxConsole *con G_GNUC_UNUSED,
     return FALSE;
 }
 
+static void do_telemetry(GVirSandboxConsole *con G_GNUC_UNUSED,
+                         GVirSandboxTelemetry *telemetry,
+                         gpointer opaque G_GNUC_UNUSED)
+{
+    g_printerr("telemetry: cpu=%.2f mem=%.2f/%.2f io=%.2f/%.2f "
+               "avail=%" G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT "KiB\n",
+               gvir_sandbox_telemetry_get_cpu_some_pressure(telemetry),
+               gvir_sandbox_telemetry_get_memory_some_pressure(telemetry),
+               gvir_sandbox_telemetry_get_memory_full_pressure(telemetry),
+               gvir_sandbox_telemetry_get_io_some_pressure(telemetry),
+               gvir_sandbox_telemetry_get_io_full_pressure(telemetry),
+               gvir_sandbox_telemetry_get_memory_available(telemetry),
+               gvir_sandbox_telemetry_get_memory_total(telemetry));
+}
+
 static void libvirt_sandbox_version(void)
 {
     g_print(_("%s version %s\n"), PACKAGE, VERSION);
@@ -79,9 +175,13 @@ int main(int argc, char **argv) {
     GVirSandboxConsole *log = NULL;
     GVirSandboxConsole *con = NULL;
     GMainLoop *loop = NULL;
+    GVirDomain *dom = NULL;
+    struct SandboxClose closing = { NULL, FALSE, FALSE, 0 };
+    gsize i;
     GError *error = NULL;
     gchar *name = NULL;
     gchar **disks = NULL;
+    gchar **volumes = NULL;
     gchar **envs = NULL;
     gchar **mounts = NULL;
     gchar **includes = NULL;
@@ -95,10 +195,22 @@ int main(int argc, char **argv) {
     gchar *kernpath = NULL;
     gchar *kmodpath = NULL;
     gchar *switchto = NULL;
+    gchar *tuning = NULL;
+    gchar *zram = NULL;
+    gchar *initrdcomp = NULL;
+    gint telemetry = 0;
     gboolean verbose = FALSE;
     gboolean debug = FALSE;
     gboolean shell = FALSE;
     gboolean privileged = FALSE;
+    gboolean readahead = FALSE;
+    gboolean fastboot = FALSE;
+    gint rngrate = 0;
+    gchar *vcpus = NULL;
+    gchar *memory = NULL;
+    gchar *membacking = NULL;
+    gboolean balloon = FALSE;
+    gchar *disktuning = NULL;
     GOptionContext *context;
     GOptionEntry options[] = {
         { "version", 'V', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK,
@@ -114,7 +226,11 @@ int main(int argc, char **argv) {
         { "root", 'r', 0, G_OPTION_ARG_STRING, &root,
           N_("root directory of the sandbox"), "DIR" },
         { "disk", ' ', 0, G_OPTION_ARG_STRING_ARRAY, &disks,
-          N_("add a disk in the guest"), "TYPE:TAGNAME=SOURCE,format=FORMAT" },
+          N_("add a disk in the guest"), "TYPE:TAGNAME=SOURCE,format=FORMAT[,TUNING...]" },
+        { "disk-tuning", 0, 0, G_OPTION_ARG_STRING, &disktuning,
+          N_("tuning of all guest disks"), "TUNING[,TUNING...]" },
+        { "volume", ' ', 0, G_OPTION_ARG_STRING_ARRAY, &volumes,
+          N_("add a data volume in the guest"), "in|out:TAGNAME=PATH[,target=DIR][,size=SIZE]" },
         { "env", 'e', 0, G_OPTION_ARG_STRING_ARRAY, &envs,
           N_("add a environment variable for the sandbox"), "KEY=VALUE" },
         { "mount", 'm', 0, G_OPTION_ARG_STRING_ARRAY, &mounts,
@@ -139,6 +255,28 @@ int main(int argc, char **argv) {
           N_("kernel binary path"), NULL, },
         { "kmodpath", 0, 0, G_OPTION_ARG_STRING, &kmodpath,
           N_("kernel module directory"), NULL, },
+        { "telemetry", 0, 0, G_OPTION_ARG_INT, &telemetry,
+          N_("report guest resource pressure periodically"), "MSEC", },
+        { "readahead", 0, 0, G_OPTION_ARG_NONE, &readahead,
+          N_("read ahead files recorded at previous startups"), NULL, },
+        { "fastboot", 0, 0, G_OPTION_ARG_NONE, &fastboot,
+          N_("skip probing hardware the guest never has"), NULL, },
+        { "rng-rate", 0, 0, G_OPTION_ARG_INT, &rngrate,
+          N_("limit the guest entropy rate"), "BYTES", },
+        { "vcpus", 0, 0, G_OPTION_ARG_STRING, &vcpus,
+          N_("number of virtual CPUs"), "VCPUS[,sockets=S,cores=C,threads=T]", },
+        { "memory", 0, 0, G_OPTION_ARG_STRING, &memory,
+          N_("amount of guest memory"), "SIZE[,max=SIZE]", },
+        { "memory-backing", 0, 0, G_OPTION_ARG_STRING, &membacking,
+          N_("guest memory backing"), "[hugepages[=SIZE]][,memfd][,prealloc][,locked][,nosharepages]", },
+        { "balloon", 0, 0, G_OPTION_ARG_NONE, &balloon,
+          N_("add a memory balloon returning free guest memory"), NULL, },
+        { "tuning", 0, 0, G_OPTION_ARG_STRING, &tuning,
+          N_("guest kernel tuning profile"), "PROFILE[,KEY=VALUE...]", },
+        { "zram", 0, 0, G_OPTION_ARG_STRING, &zram,
+          N_("add a compressed RAM swap device"), "SIZE[,algorithm=ALGORITHM]", },
+        { "initrd-compression", 0, 0, G_OPTION_ARG_STRING, &initrdcomp,
+          N_("initrd compression codec"), "CODEC[,level=LEVEL]", },
         { G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_STRING_ARRAY, &cmdargs,
           NULL, "COMMAND-PATH [ARGS...]" },
         { NULL, 0, 0, G_OPTION_ARG_NONE, NULL, NULL, NULL }
@@ -182,6 +320,7 @@ int main(int argc, char **argv) {
     }
 
     loop = g_main_loop_new(g_main_context_default(), FALSE);
+    closing.loop = loop;
 
     hv = gvir_connection_new(uri);
     if (!gvir_connection_open(hv, NULL, &error)) {
@@ -239,6 +378,13 @@ int main(int argc, char **argv) {
         goto cleanup;
     }
 
+    if (volumes &&
+        !gvir_sandbox_config_add_volume_strv(cfg, volumes, &error)) {
+        g_printerr(_("Unable to parse volumes: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
     if (mounts &&
         !gvir_sandbox_config_add_mount_strv(cfg, mounts, &error)) {
         g_printerr(_("Unable to parse mounts: %s\n"),
@@ -273,6 +419,70 @@ int main(int argc, char **argv) {
     if (shell)
         gvir_sandbox_config_set_shell(cfg, TRUE);
 
+    if (tuning &&
+        !gvir_sandbox_config_set_tuning_opts(cfg, tuning, &error)) {
+        g_printerr(_("Unable to parse tuning: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
+    if (zram &&
+        !gvir_sandbox_config_set_zram_opts(cfg, zram, &error)) {
+        g_printerr(_("Unable to parse zram: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
+    if (initrdcomp &&
+        !gvir_sandbox_config_set_initrd_compression_opts(cfg, initrdcomp, &error)) {
+        g_printerr(_("Unable to parse initrd compression: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
+    if (telemetry < 0) {
+        g_printerr(_("Telemetry interval must not be negative\n"));
+        goto cleanup;
+    }
+    gvir_sandbox_config_set_telemetry_interval(cfg, telemetry);
+    gvir_sandbox_config_set_readahead(cfg, readahead);
+    gvir_sandbox_config_set_fastboot(cfg, fastboot);
+
+    if (rngrate < 0) {
+        g_printerr(_("Entropy rate must not be negative\n"));
+        goto cleanup;
+    }
+    gvir_sandbox_config_set_rng_rate(cfg, rngrate);
+
+    if (vcpus &&
+        !gvir_sandbox_config_set_vcpus_opts(cfg, vcpus, &error)) {
+        g_printerr(_("Unable to parse vcpus: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
+    if (memory &&
+        !gvir_sandbox_config_set_memory_opts(cfg, memory, &error)) {
+        g_printerr(_("Unable to parse memory: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
+    if (membacking &&
+        !gvir_sandbox_config_set_memory_backing_opts(cfg, membacking, &error)) {
+        g_printerr(_("Unable to parse memory backing: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+    gvir_sandbox_config_set_balloon(cfg, balloon);
+
+    if (disktuning &&
+        !gvir_sandbox_config_set_disk_tuning_opts(cfg, disktuning, &error)) {
+        g_printerr(_("Unable to parse disk tuning: %s\n"),
+                   error && error->message ? error->message : _("Unknown failure"));
+        goto cleanup;
+    }
+
     gvir_sandbox_config_set_debug(cfg, debug);
     gvir_sandbox_config_set_verbose(cfg, verbose);
 
@@ -293,7 +503,7 @@ int main(int argc, char **argv) {
                    error && error->message ? error->message : _("Unknown failure"));
         goto cleanup;
     }
-    g_signal_connect(log, "closed", (GCallback)do_close, loop);
+    g_signal_connect(log, "closed", (GCallback)do_close, &closing);
 
     if (!(gvir_sandbox_console_attach_stderr(log, &error))) {
         g_printerr(_("Unable to attach sandbox console: %s\n"),
@@ -308,11 +518,14 @@ int main(int argc, char **argv) {
     }
     /* We don't close right away - we want to ensure we read any
      * final debug info from the log console. We should get an
-     * EOF on that console which will trigger the real close,
-     * but we schedule a timer just in case.
+     * EOF on that console, or the domain stopped event, either
+     * of which will trigger the real close, but we schedule a
+     * timer just in case.
      */
-    g_signal_connect(con, "closed", (GCallback)do_pending_close, loop);
+    g_signal_connect(con, "closed", (GCallback)do_pending_close, &closing);
     g_signal_connect(con, "exited", (GCallback)do_exited, &ret);
+    if (telemetry)
+        g_signal_connect(con, "telemetry", (GCallback)do_telemetry, NULL);
 
     if (!(gvir_sandbox_console_attach_stdio(con, &error))) {
         g_printerr(_("Unable to attach sandbox console: %s\n"),
@@ -320,17 +533,38 @@ int main(int argc, char **argv) {
         goto cleanup;
     }
 
+    if ((dom = gvir_sandbox_context_get_domain(ctx, NULL)))
+        g_signal_connect(dom, "stopped", (GCallback)do_stopped, &closing);
+
+    for (i = 0 ; i < G_N_ELEMENTS(forwards) ; i++) {
+        forwards[i].con = con;
+        forwards[i].loop = loop;
+        forwards[i].id = g_unix_signal_add(forwards[i].signum,
+                                           do_forward_signal,
+                                           &forwards[i]);
+    }
+
     g_main_loop_run(loop);
 
 cleanup:
+    for (i = 0 ; i < G_N_ELEMENTS(forwards) ; i++) {
+        if (forwards[i].id)
+            g_source_remove(forwards[i].id);
+    }
     if (error)
         g_error_free(error);
     if (con)
         gvir_sandbox_console_detach(con, NULL);
+    if (dom) {
+        g_signal_handlers_disconnect_by_data(dom, &closing);
+        g_object_unref(dom);
+    }
     if (ctx) {
         gvir_sandbox_context_stop(ctx, NULL);
         g_object_unref(ctx);
     }
+    if (closing.timer)
+        g_source_remove(closing.timer);
     if (cfg)
         g_object_unref(cfg);
     if (loop)
@@ -359,6 +593,12 @@ default sandbox domain only allows applications the ability to read and
 write stdin, stdout and any other file descriptors handed to it. It is
 not allowed to open any other files.
 
+The signals SIGINT, SIGTERM and SIGHUP received by C<virt-sandbox> are
+passed on to the application, and terminal size changes are reflected
+in the sandbox, ahead of any input still queued for the application.
+Should the application not exit, a second SIGINT or SIGTERM stops the
+sandbox altogether.
+
 =head1 OPTIONS
 
 =over 8
@@ -390,7 +630,7 @@ package. This restriction may be lifted in a future version.
 
 Sets up a custom environment variable on a running sandbox.
 
-=item B<--disk TYPE:TAGNAME=SOURCE,format=FORMAT>
+=item B<--disk TYPE:TAGNAME=SOURCE,format=FORMAT[,TUNING...]>
 
 Sets up a disk inside the sandbox by using B<SOURCE> with a symlink named as B<TAGNAME>
 and type B<TYPE> and format B<FORMAT>. Example: file:cache=/var/lib/sandbox/demo/tmp.qcow2,format=qcow2
@@ -415,6 +655,85 @@ Source parameter needs to point a file which must be a one of the valid domain d
 Format parameter must be set to the same disk format as the file passed on source parameter.
 This parameter is optional and the format can be guessed from the image extension
 
+=item B<TUNING>
+
+Any of the options accepted by B<--disk-tuning>, which override them
+for this disk.
+
+=back
+
+=item B<--disk-tuning=TUNING[,TUNING...]>
+
+Tune how the host handles I/O for the disks of the sandbox, which only
+applies to the QEMU driver. The options are
+
+=over 4
+
+=item B<cache=CACHE>
+
+The host page cache mode, one of C<none>, C<writethrough>,
+C<writeback>, C<directsync> or C<unsafe>. Scratch images for
+B<--volume> use C<unsafe> unless a mode is given here, since they are
+discarded anyway should the host crash.
+
+=item B<io=IO>
+
+The host I/O mode, one of C<native>, C<threads> or C<io_uring>.
+C<native> bypasses the host page cache, so it requires B<cache=none> or
+B<cache=directsync>, and makes disks without a cache mode, scratch
+images included, use C<none>.
+
+=item B<discard=DISCARD>
+
+Whether discard requests from the guest are passed on to the host
+file, either C<unmap> or C<ignore>.
+
+=item B<detect-zeroes=MODE>
+
+Whether writes of zeroes are turned into cheaper operations, one of
+C<off>, C<on> or C<unmap>. C<unmap> requires B<discard=unmap>.
+
+=item B<iothread>
+
+Give each disk its own I/O thread, rather than serving it from the
+main QEMU thread.
+
+=item B<queues=N>
+
+The number of virtqueues of each disk, which lets a guest with several
+CPUs submit I/O from all of them in parallel.
+
+=back
+
+For example
+
+  --disk-tuning cache=none,io=io_uring,iothread,queues=4
+
+=item B<--volume in|out:TAGNAME=PATH[,target=DIR][,size=SIZE]>
+
+Sets up a block device for moving bulk data in or out of the sandbox,
+which avoids the per-file overhead of a filesystem passthrough. As
+with B<--disk>, the device is linked from /dev/disk/by-tag/TAGNAME.
+TAGNAME may not be empty, nor contain '/' or '..'.
+
+=over 4
+
+=item B<in>
+
+B<PATH> is handed to the sandbox read-only. If it is a file and no
+B<target> is given it is attached as-is, without being copied. If
+B<target> is given, B<PATH> may be a file or a directory: a copy of
+it is placed in a scratch ext4 image that is mounted at B<target>.
+The image is sized to fit unless B<size> is given.
+
+=item B<out>
+
+A sparse scratch device of B<size> bytes is created and, once the
+sandbox stops, moved to B<PATH> on the host. If B<target> is given it
+is formatted as ext4 and mounted there, otherwise the application
+writes to the raw device. The suffixes accepted for B<size> are the
+same as for B<--zram>.
+
 =back
 
 =item B<-m TYPE:DST=SRC>, B<--mount TYPE:DST=SRC>
@@ -494,6 +813,34 @@ is the name of any libvirt virtual network. See also B<virsh net-list>
 Set the MAC address of the network interface, where each NN is a pair
 of hex digits.
 
+=item backend=slirp|passt
+
+Set how an interface without a C<source> network reaches the outside
+world. The default, C<slirp>, is the TCP/IP stack built into QEMU.
+C<passt> instead connects the interface to a passt process, which
+forwards the traffic with ordinary host sockets and is much faster,
+without needing any privileges. passt must be installed on the host.
+Containers have no user mode networking, so they reject this key.
+
+=item vhost
+
+Handle the packets of the network interface in the host kernel instead
+of the QEMU process. This requires a C<source> network, and is ignored
+for containers. This key takes no value.
+
+=item queues=N
+
+Give a vhost network interface N transmit/receive queue pairs. The
+default is one queue pair per vCPU, so that network throughput scales
+with B<--vcpus>. The guest enables all of the queue pairs at startup.
+
+=item rx_queue_size=N, tx_queue_size=N
+
+Set the number of entries of each receive or transmit ring of the
+network interface. N must be a power of two between 256 and 1024.
+QEMU only honours transmit ring sizes above 256 for vhost-user
+backends.
+
 =item address=IP-ADDRESS/PREFIX%BROADCAST
 
 Configure the network interface with the static IPv4 or IPv6 address
@@ -554,7 +901,11 @@ omitted, defaults to match the current running host version.
 =item B<--kernpath=FILE-PATH>
 
 Specify the path to the kernel binary. If omitted, defaults
-to C</boot/vmlinuz-$KERNEL-VERSION>.
+to C</boot/vmlinuz-$KERNEL-VERSION>. On x86 hosts, if an uncompressed
+C<vmlinux> with a PVH entry point is given, or is found as
+C<vmlinux-$KERNEL-VERSION> next to the kernel binary or as C<vmlinux>
+in the kernel module directory, it is booted directly instead, which
+skips decompressing the kernel at startup.
 
 =item B<--kmodpath=DIR-PATH>
 
@@ -562,6 +913,129 @@ Specify the path to the kernel module base directory. If omitted, defaults
 to C</lib/modules>. The suffix C<$KERNEL-VERSION/kernel> will be appended
 to this path to locate the modules.
 
+=item B<--telemetry=MSEC>
+
+Sample the guest's CPU, memory and I/O pressure stall information,
+along with its memory and CPU usage, every B<MSEC> milliseconds and
+print a summary of each sample on stderr. Samples are dropped,
+rather than queued, while the sandbox's output is busy. Telemetry is
+disabled by default.
+
+=item B<--readahead>
+
+Record the files read from the root filesystem while the sandbox starts
+up, and on later launches of the same command under the same sandbox
+name, read them ahead into the host page cache in parallel while the
+guest boots. The trace is kept in the sandbox state directory. This only
+applies to the QEMU driver, whose root filesystem is shared over 9p.
+
+=item B<--fastboot>
+
+Boot the guest kernel with a command line that skips probing for legacy
+hardware, PCI buses and serial ports the sandbox does not have, along
+with boot time self tests and clock stability checks. The hardware and
+clock options are specific to x86 guests, and PCI bridges are still
+scanned for when the sandbox has too many devices for the root bus.
+This shortens kernel initialization, and only applies to the QEMU
+driver.
+
+=item B<--rng-rate=BYTES>
+
+Limit the entropy the guest may draw from the host's C</dev/urandom>
+through its virtio RNG device to B<BYTES> per second. The device is
+always present for the QEMU driver, so that the guest never stalls
+waiting for entropy at startup, and is not limited by default.
+
+=item B<--vcpus=VCPUS[,sockets=S,cores=C,threads=T]>
+
+Give the sandbox B<VCPUS> virtual CPUs. With the QEMU driver this is the
+number of CPUs the guest boots with, one by default, and the CPU
+topology may be set too, as long as the product of B<S>, B<C> and B<T>
+equals B<VCPUS>. With the LXC driver, which does not limit containers by
+default, the CPU time of the sandbox is capped to that of B<VCPUS> host
+CPUs. For example
+
+  --vcpus 4,sockets=1,cores=2,threads=2
+
+=item B<--memory=SIZE[,max=SIZE]>
+
+Give the sandbox B<SIZE> bytes of memory, 512 MiB by default. The sizes
+may have a C<K>, C<M> or C<G> suffix. With the QEMU driver and
+B<--balloon>, a larger B<max> size is reserved for the guest, which
+starts with B<SIZE> and can be given more memory while it runs, up to
+B<max>. Without B<--balloon>, B<max> is ignored. With the LXC driver
+the size is the memory limit of the container, and B<max> is ignored.
+
+=item B<--memory-backing=[hugepages[=SIZE]][,memfd][,prealloc][,locked][,nosharepages]>
+
+Change how the guest memory is backed on the host, which only applies
+to the QEMU driver. B<hugepages> backs it with huge pages of B<SIZE>
+bytes, 2M by default, which must have been reserved on the host
+beforehand. B<SIZE> must be a power of two, and the guest memory a
+multiple of it. B<memfd> backs it with a memfd mapped with shared access.
+B<prealloc> allocates all of it when the sandbox starts, rather than as
+the guest first touches it, and B<locked> keeps it from being swapped
+out, which needs the memory lock limit of the user running the sandbox
+to be large enough. Together these avoid most of the page faults a
+guest otherwise takes while it boots and warms up. For example
+
+  --memory-backing hugepages=1G,prealloc,locked
+
+As for any other guest, the host's kernel samepage merging (KSM), when
+it runs, may share identical pages between sandboxes, which lets many
+near identical sandboxes fit on one host. B<nosharepages> stops that,
+since shared pages leak timing information from one sandbox to another.
+B<mergeable> is accepted for the default behaviour.
+
+=item B<--balloon>
+
+Add a virtio memory balloon to the guest, which is left out by default.
+The guest reports the memory it frees back to the host, the balloon
+deflates rather than letting the guest run out of memory, and the
+memory of the running sandbox can be adjusted up to its B<--memory> max
+size. This only applies to the QEMU driver.
+
+=item B<--tuning=PROFILE[,KEY=VALUE...]>
+
+Tune the guest kernel before the command is started. B<PROFILE> is one
+of C<throughput>, C<latency> or C<minimal-memory>, which set
+swappiness, dirty page ratios, memory overcommit, transparent huge
+pages and the I/O scheduler of virtio disks to suit that workload.
+Individual parameters can be overridden, or set without any profile,
+with B<KEY=VALUE> pairs. Keys of the form C<block.NAME> are written to
+C</sys/block/vdX/queue/NAME>, keys of the form C<thp.NAME> to
+C</sys/kernel/mm/transparent_hugepage/NAME>, and any other key is a
+sysctl name. As with L<sysctl(8)>, a sysctl name may use slashes as its
+separator, when one of its components contains a dot, as in
+C<net/ipv4/conf/eth0.100/forwarding>. For example
+
+  --tuning throughput,vm.swappiness=0,block.nr_requests=256
+
+Parameters the guest kernel does not support are ignored.
+
+=item B<--zram=SIZE[,algorithm=ALGORITHM]>
+
+Add a compressed RAM swap device able to hold B<SIZE> bytes of swapped
+out memory. The size may have a C<K>, C<M> or C<G> suffix, and must be
+between 1M and 16T. The compression B<ALGORITHM> is one of C<lzo>,
+C<lzo-rle>, C<lz4>, C<lz4hc> or C<zstd>, defaulting to the kernel's
+choice. This only applies to the
+QEMU driver. For example
+
+  --zram 1G,algorithm=zstd
+
+=item B<--initrd-compression=CODEC[,level=LEVEL]>
+
+Compress the initrd with B<CODEC>, one of C<gzip>, C<lz4>, C<zstd> or
+C<none>, instead of the default of C<gzip>. The B<LEVEL> is passed to
+the codec, and ranges from 1 to 9 for C<gzip>, 1 to 12 for C<lz4> and
+1 to 19 for C<zstd>. Faster codecs and lower levels make the initrd
+quicker to build and to unpack while booting, at the cost of size. The
+kernel must have been built to support the codec. This only applies to
+the QEMU driver. For example
+
+  --initrd-compression lz4
+
 =item B<-p>, B<--privileged>
 
 Retain root privileges inside the sandbox, rather than dropping privileges
@@ -159,6 +159,18 @@ static gboolean gvir_sandbox_builder_container_construct_basic(GVirSandboxBuilde
     gvir_config_domain_set_features(domain, features);
     g_strfreev(features);
 
+    /* The LXC driver does not restrict a container to its vCPU
+     * count, so cap its CPU time to the same number of CPUs */
+    if (gvir_sandbox_config_get_vcpus(config)) {
+        gchar *cputune = g_strdup_printf("<cputune>"
+                                         "<period>100000</period>"
+                                         "<quota>%llu</quota>"
+                                         "</cputune>",
+                                         (unsigned long long)gvir_sandbox_config_get_vcpus(config) * 100000);
+        gvir_sandbox_builder_add_xml(builder, "domain", cputune);
+        g_free(cputune);
+    }
+
     return TRUE;
 }
 
@@ -220,7 +232,9 @@ static gboolean gvir_sandbox_builder_container_construct_devices(GVirSandboxBuil
     GVirConfigDomainDisk *disk;
     GVirConfigDomainDiskDriver *diskDriver;
     GList *tmp = NULL, *mounts = NULL, *networks = NULL, *disks = NULL;
+    GList *volumes = NULL;
     gchar *configdir = g_strdup_printf("%s/config", statedir);
+    const gchar *libsdir;
     gboolean ret = FALSE;
     size_t nVirtioDev = 0;
 
@@ -255,6 +269,49 @@ static gboolean gvir_sandbox_builder_container_construct_devices(GVirSandboxBuil
     g_list_foreach(disks, (GFunc)g_object_unref, NULL);
     g_list_free(disks);
 
+    volumes = gvir_sandbox_config_get_volumes(config);
+    for (tmp = volumes ; tmp ; tmp = tmp->next) {
+        GVirSandboxConfigVolume *vconfig = GVIR_SANDBOX_CONFIG_VOLUME(tmp->data);
+        const gchar *target = gvir_sandbox_config_volume_get_target(vconfig);
+        gchar *source = gvir_sandbox_builder_get_volume_path(vconfig, statedir);
+
+        if (target) {
+            fs = gvir_config_domain_filesys_new();
+            gvir_config_domain_filesys_set_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_FILE);
+            gvir_config_domain_filesys_set_access_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_ACCESS_PASSTHROUGH);
+            gvir_config_domain_filesys_set_source(fs, source);
+            gvir_config_domain_filesys_set_target(fs, target);
+            gvir_config_domain_filesys_set_driver_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_DRIVER_LOOP);
+            gvir_config_domain_filesys_set_driver_format(fs, GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW);
+            if (!gvir_sandbox_config_volume_get_output(vconfig))
+                gvir_config_domain_filesys_set_readonly(fs, TRUE);
+
+            gvir_config_domain_add_device(domain,
+                                          GVIR_CONFIG_DOMAIN_DEVICE(fs));
+            g_object_unref(fs);
+        } else {
+            gchar *device = g_strdup_printf("sd%c", (char)('a' + nVirtioDev++));
+            disk = gvir_config_domain_disk_new();
+            diskDriver = gvir_config_domain_disk_driver_new();
+            gvir_config_domain_disk_set_type(disk, GVIR_CONFIG_DOMAIN_DISK_FILE);
+            gvir_config_domain_disk_driver_set_format(diskDriver,
+                                                      GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW);
+            gvir_config_domain_disk_set_source(disk, source);
+            gvir_config_domain_disk_set_target_dev(disk, device);
+            gvir_config_domain_disk_set_driver(disk, diskDriver);
+            if (!gvir_sandbox_config_volume_get_output(vconfig))
+                gvir_config_domain_disk_set_readonly(disk, TRUE);
+            gvir_config_domain_add_device(domain,
+                                          GVIR_CONFIG_DOMAIN_DEVICE(disk));
+            g_object_unref(diskDriver);
+            g_object_unref(disk);
+            g_free(device);
+        }
+        g_free(source);
+    }
+    g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(volumes);
+
 
     if (!gvir_sandbox_config_has_root_mount(config)) {
         fs = gvir_config_domain_filesys_new();
@@ -283,6 +340,19 @@ static gboolean gvir_sandbox_builder_container_construct_devices(GVirSandboxBuil
                                   GVIR_CONFIG_DOMAIN_DEVICE(fs));
     g_object_unref(fs);
 
+    if ((libsdir = gvir_sandbox_builder_get_libsdir(builder))) {
+        fs = gvir_config_domain_filesys_new();
+        gvir_config_domain_filesys_set_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_MOUNT);
+        gvir_config_domain_filesys_set_access_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_ACCESS_PASSTHROUGH);
+        gvir_config_domain_filesys_set_source(fs, libsdir);
+        gvir_config_domain_filesys_set_target(fs, SANDBOXCONFIGDIR "/.libs");
+        gvir_config_domain_filesys_set_readonly(fs, TRUE);
+
+        gvir_config_domain_add_device(domain,
+                                      GVIR_CONFIG_DOMAIN_DEVICE(fs));
+        g_object_unref(fs);
+    }
+
 
 
     tmp = mounts = gvir_sandbox_config_get_mounts(config);
@@ -369,6 +439,17 @@ static gboolean gvir_sandbox_builder_container_construct_devices(GVirSandboxBuil
         GVirSandboxConfigNetwork *network = GVIR_SANDBOX_CONFIG_NETWORK(tmp->data);
         GVirSandboxConfigNetworkFilterref *filterref;
 
+        /* The LXC driver has no user mode networking, so there is
+         * no way to put a pasta process in front of the container */
+        if (g_strcmp0(gvir_sandbox_config_network_get_backend(network), "passt") == 0) {
+            g_set_error(error, GVIR_SANDBOX_BUILDER_CONTAINER_ERROR, 0,
+                        _("Network backend %s is not supported for containers"),
+                        gvir_sandbox_config_network_get_backend(network));
+            g_list_foreach(networks, (GFunc)g_object_unref, NULL);
+            g_list_free(networks);
+            goto cleanup;
+        }
+
         iface = gvir_config_domain_interface_network_new();
         source = gvir_sandbox_config_network_get_source(network);
         if (source)
@@ -0,0 +1,844 @@
+/*
+ * libvirt-sandbox-builder-elf.c: ELF shared library dependency resolution
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <elf.h>
+#include <sys/stat.h>
+#include <glib/gi18n.h>
+
+#include "libvirt-sandbox/libvirt-sandbox.h"
+#include "libvirt-sandbox/libvirt-sandbox-builder-private.h"
+
+/*
+ * Works out the shared libraries a program needs by reading its
+ * ELF headers, following DT_NEEDED through DT_RPATH, DT_RUNPATH,
+ * the ld.so.cache and the default directories much as the dynamic
+ * loader itself would. This avoids running ldd, which forks and
+ * may even end up executing the program under the loader.
+ *
+ * Parsed objects are remembered by device, inode and mtime until
+ * the build that needed them is done, so that the programs of one
+ * sandbox only parse their shared libraries once. The ld.so.cache
+ * is remembered across builds, and only reloaded when it changes.
+ */
+
+#define GVIR_SANDBOX_BUILDER_ELF_ERROR gvir_sandbox_builder_elf_error_quark()
+
+#define LDSO_CACHE_PATH "/etc/ld.so.cache"
+#define LDSO_CACHE_MAGIC_NEW "glibc-ld.so.cache1.1"
+#define LDSO_CACHE_MAGIC_OLD "ld.so-1.7.0"
+#define LDSO_CACHE_FLAG_TYPE_MASK 0x00ff
+#define LDSO_CACHE_FLAG_ELF_LIBC6 0x0003
+
+typedef struct _GVirSandboxBuilderElf GVirSandboxBuilderElf;
+struct _GVirSandboxBuilderElf
+{
+    guint8 klass;
+    guint16 machine;
+    gchar *interp;
+    gchar **needed;
+    gchar **rpath;
+    gchar **runpath;
+};
+
+G_LOCK_DEFINE_STATIC(elf);
+static GHashTable *objects;
+static GHashTable *ldcache;
+static gchar *ldcachekey;
+
+
+static GQuark
+gvir_sandbox_builder_elf_error_quark(void)
+{
+    return g_quark_from_static_string("gvir-sandbox-builder-elf");
+}
+
+
+static void gvir_sandbox_builder_elf_free(gpointer opaque)
+{
+    GVirSandboxBuilderElf *elf = opaque;
+
+    g_free(elf->interp);
+    g_strfreev(elf->needed);
+    g_strfreev(elf->rpath);
+    g_strfreev(elf->runpath);
+    g_free(elf);
+}
+
+
+static gchar *gvir_sandbox_builder_elf_stat_key(const gchar *path,
+                                                GError **error)
+{
+    struct stat sb;
+
+    if (stat(path, &sb) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ELF_ERROR, 0,
+                    _("Unable to access %s: %s"), path, strerror(errno));
+        return NULL;
+    }
+
+    return g_strdup_printf("%llx:%llx:%llx",
+                           (unsigned long long)sb.st_dev,
+                           (unsigned long long)sb.st_ino,
+                           (unsigned long long)sb.st_mtime);
+}
+
+
+/* Maps a virtual address onto its offset in the file */
+static gboolean gvir_sandbox_builder_elf_vaddr(const guint8 *data,
+                                               gsize len,
+                                               guint8 klass,
+                                               guint64 vaddr,
+                                               guint64 *offset)
+{
+    guint64 phoff;
+    guint16 phnum, phentsize;
+    gsize i;
+
+    if (klass == ELFCLASS64) {
+        const Elf64_Ehdr *ehdr = (const Elf64_Ehdr *)data;
+        phoff = ehdr->e_phoff;
+        phnum = ehdr->e_phnum;
+        phentsize = ehdr->e_phentsize;
+    } else {
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)data;
+        phoff = ehdr->e_phoff;
+        phnum = ehdr->e_phnum;
+        phentsize = ehdr->e_phentsize;
+    }
+
+    if (phentsize < (klass == ELFCLASS64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr)))
+        return FALSE;
+
+    for (i = 0; i < phnum; i++) {
+        guint64 type, off, addr, filesz;
+
+        if (phoff + ((i + 1) * phentsize) > len)
+            return FALSE;
+
+        if (klass == ELFCLASS64) {
+            const Elf64_Phdr *phdr = (const Elf64_Phdr *)(data + phoff + (i * phentsize));
+            type = phdr->p_type;
+            off = phdr->p_offset;
+            addr = phdr->p_vaddr;
+            filesz = phdr->p_filesz;
+        } else {
+            const Elf32_Phdr *phdr = (const Elf32_Phdr *)(data + phoff + (i * phentsize));
+            type = phdr->p_type;
+            off = phdr->p_offset;
+            addr = phdr->p_vaddr;
+            filesz = phdr->p_filesz;
+        }
+
+        if (type == PT_LOAD &&
+            vaddr >= addr && vaddr < addr + filesz) {
+            *offset = off + (vaddr - addr);
+            return *offset < len;
+        }
+    }
+
+    return FALSE;
+}
+
+
+static GVirSandboxBuilderElf *gvir_sandbox_builder_elf_parse(const gchar *path,
+                                                             GError **error)
+{
+    GMappedFile *file;
+    const guint8 *data;
+    gsize len;
+    GVirSandboxBuilderElf *elf = NULL;
+    guint64 phoff;
+    guint16 phnum, phentsize;
+    guint64 dynoff = 0, dynsz = 0;
+    guint64 strtab = 0, strsz = 0, stroff;
+    GArray *needed = g_array_new(FALSE, FALSE, sizeof(guint64));
+    gint64 rpath = -1, runpath = -1;
+    GPtrArray *names = NULL;
+    gsize i;
+
+    if (!(file = g_mapped_file_new(path, FALSE, error)))
+        goto cleanup;
+
+    data = (const guint8 *)g_mapped_file_get_contents(file);
+    len = g_mapped_file_get_length(file);
+
+    if (len < EI_NIDENT ||
+        memcmp(data, ELFMAG, SELFMAG) != 0 ||
+        (data[EI_CLASS] == ELFCLASS64 && len < sizeof(Elf64_Ehdr)) ||
+        (data[EI_CLASS] == ELFCLASS32 && len < sizeof(Elf32_Ehdr))) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ELF_ERROR, 0,
+                    _("%s is not an ELF object"), path);
+        goto cleanup;
+    }
+
+    /* Only objects the host could load are of any interest */
+    if ((data[EI_CLASS] != ELFCLASS32 && data[EI_CLASS] != ELFCLASS64) ||
+        data[EI_DATA] != (G_BYTE_ORDER == G_LITTLE_ENDIAN ?
+                          ELFDATA2LSB : ELFDATA2MSB)) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ELF_ERROR, 0,
+                    _("%s is not a native ELF object"), path);
+        goto cleanup;
+    }
+
+    elf = g_new0(GVirSandboxBuilderElf, 1);
+    elf->klass = data[EI_CLASS];
+    if (elf->klass == ELFCLASS64) {
+        const Elf64_Ehdr *ehdr = (const Elf64_Ehdr *)data;
+        elf->machine = ehdr->e_machine;
+        phoff = ehdr->e_phoff;
+        phnum = ehdr->e_phnum;
+        phentsize = ehdr->e_phentsize;
+    } else {
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)data;
+        elf->machine = ehdr->e_machine;
+        phoff = ehdr->e_phoff;
+        phnum = ehdr->e_phnum;
+        phentsize = ehdr->e_phentsize;
+    }
+
+    if (phnum &&
+        phentsize < (elf->klass == ELFCLASS64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr)))
+        goto malformed;
+
+    for (i = 0; i < phnum; i++) {
+        guint64 type, off, filesz;
+
+        if (phoff + ((i + 1) * phentsize) > len)
+            goto malformed;
+
+        if (elf->klass == ELFCLASS64) {
+            const Elf64_Phdr *phdr = (const Elf64_Phdr *)(data + phoff + (i * phentsize));
+            type = phdr->p_type;
+            off = phdr->p_offset;
+            filesz = phdr->p_filesz;
+        } else {
+            const Elf32_Phdr *phdr = (const Elf32_Phdr *)(data + phoff + (i * phentsize));
+            type = phdr->p_type;
+            off = phdr->p_offset;
+            filesz = phdr->p_filesz;
+        }
+
+        if (off > len || filesz > len - off)
+            goto malformed;
+
+        if (type == PT_INTERP) {
+            g_free(elf->interp);
+            elf->interp = g_strndup((const gchar *)data + off, filesz);
+        } else if (type == PT_DYNAMIC) {
+            dynoff = off;
+            dynsz = filesz;
+        }
+    }
+
+    /* Statically linked */
+    if (!dynsz)
+        goto done;
+
+    for (i = 0; ; i++) {
+        guint64 tag, val;
+
+        if (elf->klass == ELFCLASS64) {
+            const Elf64_Dyn *dyn = (const Elf64_Dyn *)(data + dynoff) + i;
+            if ((i + 1) * sizeof(*dyn) > dynsz)
+                break;
+            tag = dyn->d_tag;
+            val = dyn->d_un.d_val;
+        } else {
+            const Elf32_Dyn *dyn = (const Elf32_Dyn *)(data + dynoff) + i;
+            if ((i + 1) * sizeof(*dyn) > dynsz)
+                break;
+            tag = dyn->d_tag;
+            val = dyn->d_un.d_val;
+        }
+
+        if (tag == DT_NULL)
+            break;
+        else if (tag == DT_NEEDED)
+            g_array_append_val(needed, val);
+        else if (tag == DT_STRTAB)
+            strtab = val;
+        else if (tag == DT_STRSZ)
+            strsz = val;
+        else if (tag == DT_RPATH)
+            rpath = val;
+        else if (tag == DT_RUNPATH)
+            runpath = val;
+    }
+
+    if (!gvir_sandbox_builder_elf_vaddr(data, len, elf->klass, strtab, &stroff))
+        goto malformed;
+    if (strsz > len - stroff)
+        strsz = len - stroff;
+
+#define GVIR_SANDBOX_BUILDER_ELF_STR(off)                               \
+    ((off) < strsz && memchr(data + stroff + (off), '\0', strsz - (off)) ? \
+     (const gchar *)data + stroff + (off) : NULL)
+
+    names = g_ptr_array_new();
+    for (i = 0; i < needed->len; i++) {
+        const gchar *name = GVIR_SANDBOX_BUILDER_ELF_STR(g_array_index(needed, guint64, i));
+        if (!name)
+            goto malformed;
+        g_ptr_array_add(names, g_strdup(name));
+    }
+    g_ptr_array_add(names, NULL);
+    elf->needed = (gchar **)g_ptr_array_free(names, FALSE);
+    names = NULL;
+
+    if (rpath >= 0) {
+        const gchar *str = GVIR_SANDBOX_BUILDER_ELF_STR((guint64)rpath);
+        if (!str)
+            goto malformed;
+        elf->rpath = g_strsplit(str, ":", 0);
+    }
+    if (runpath >= 0) {
+        const gchar *str = GVIR_SANDBOX_BUILDER_ELF_STR((guint64)runpath);
+        if (!str)
+            goto malformed;
+        elf->runpath = g_strsplit(str, ":", 0);
+    }
+
+#undef GVIR_SANDBOX_BUILDER_ELF_STR
+
+ done:
+    if (!elf->needed)
+        elf->needed = g_new0(gchar *, 1);
+
+ cleanup:
+    if (names)
+        g_ptr_array_free(names, TRUE);
+    g_array_unref(needed);
+    if (file)
+        g_mapped_file_unref(file);
+    return elf;
+
+ malformed:
+    g_set_error(error, GVIR_SANDBOX_BUILDER_ELF_ERROR, 0,
+                _("%s is a malformed ELF object"), path);
+    gvir_sandbox_builder_elf_free(elf);
+    elf = NULL;
+    goto cleanup;
+}
+
+
+static GVirSandboxBuilderElf *gvir_sandbox_builder_elf_lookup(const gchar *path,
+                                                              GError **error)
+{
+    GVirSandboxBuilderElf *elf;
+    gchar *key;
+
+    if (!(key = gvir_sandbox_builder_elf_stat_key(path, error)))
+        return NULL;
+
+    if (!objects)
+        objects = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                        g_free, gvir_sandbox_builder_elf_free);
+
+    if ((elf = g_hash_table_lookup(objects, key))) {
+        g_free(key);
+        return elf;
+    }
+
+    if (!(elf = gvir_sandbox_builder_elf_parse(path, error))) {
+        g_free(key);
+        return NULL;
+    }
+
+    g_hash_table_insert(objects, key, elf);
+    return elf;
+}
+
+
+/*
+ * Loads the soname to paths mapping from the ld.so.cache. Only
+ * the "new" format is understood, which glibc has written since
+ * 2.2, either on its own or following the old format entries.
+ */
+static void gvir_sandbox_builder_elf_load_ldcache(void)
+{
+    GMappedFile *file;
+    const guint8 *data, *hdr;
+    gsize len, avail;
+    guint32 nlibs, i;
+    gchar *key;
+
+    if (!(key = gvir_sandbox_builder_elf_stat_key(LDSO_CACHE_PATH, NULL)))
+        goto reset;
+    if (ldcache && g_str_equal(key, ldcachekey)) {
+        g_free(key);
+        return;
+    }
+
+    if (!(file = g_mapped_file_new(LDSO_CACHE_PATH, FALSE, NULL)))
+        goto reset;
+
+    data = (const guint8 *)g_mapped_file_get_contents(file);
+    len = g_mapped_file_get_length(file);
+    hdr = data;
+
+    if (len >= 16 &&
+        memcmp(data, LDSO_CACHE_MAGIC_OLD, strlen(LDSO_CACHE_MAGIC_OLD)) == 0) {
+        gsize off;
+        memcpy(&nlibs, data + 12, sizeof(nlibs));
+        off = 16 + ((gsize)nlibs * 12);
+        off = (off + 7) & ~(gsize)7;
+        hdr = off < len ? data + off : data + len;
+    }
+
+    avail = len - (hdr - data);
+    g_free(ldcachekey);
+    ldcachekey = key;
+    if (ldcache)
+        g_hash_table_unref(ldcache);
+    ldcache = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                    g_free, (GDestroyNotify)g_ptr_array_unref);
+
+    if (avail < 48 ||
+        memcmp(hdr, LDSO_CACHE_MAGIC_NEW, strlen(LDSO_CACHE_MAGIC_NEW)) != 0)
+        goto done;
+
+    memcpy(&nlibs, hdr + 20, sizeof(nlibs));
+    for (i = 0; i < nlibs && 48 + (((gsize)i + 1) * 24) <= avail; i++) {
+        const guint8 *ent = hdr + 48 + ((gsize)i * 24);
+        gint32 flags;
+        guint32 kidx, vidx;
+        guint64 hwcap;
+        GPtrArray *paths;
+
+        memcpy(&flags, ent, sizeof(flags));
+        memcpy(&kidx, ent + 4, sizeof(kidx));
+        memcpy(&vidx, ent + 8, sizeof(vidx));
+        memcpy(&hwcap, ent + 16, sizeof(hwcap));
+
+        /* Skip the hwcaps optimized builds, since the guest may
+         * not run on the same CPU, and the baseline is always there */
+        if ((flags & LDSO_CACHE_FLAG_TYPE_MASK) != LDSO_CACHE_FLAG_ELF_LIBC6 ||
+            hwcap != 0 ||
+            kidx >= avail || vidx >= avail ||
+            !memchr(hdr + kidx, '\0', avail - kidx) ||
+            !memchr(hdr + vidx, '\0', avail - vidx))
+            continue;
+
+        if (!(paths = g_hash_table_lookup(ldcache, hdr + kidx))) {
+            paths = g_ptr_array_new_with_free_func(g_free);
+            g_hash_table_insert(ldcache, g_strdup((const gchar *)hdr + kidx), paths);
+        }
+        g_ptr_array_add(paths, g_strdup((const gchar *)hdr + vidx));
+    }
+
+ done:
+    g_mapped_file_unref(file);
+    return;
+
+ reset:
+    g_free(key);
+    g_free(ldcachekey);
+    ldcachekey = NULL;
+    if (ldcache)
+        g_hash_table_unref(ldcache);
+    ldcache = NULL;
+}
+
+
+/*
+ * Works out what $LIB expands to, which is the directory the loader
+ * of @root really lives in, such as lib64, or lib/x86_64-linux-gnu
+ * with Debian's multiarch layout, where PT_INTERP is a symlink.
+ */
+static gchar *gvir_sandbox_builder_elf_libdir(GVirSandboxBuilderElf *root)
+{
+    gchar *real, *dir, *ret = NULL;
+    const gchar *tmp;
+
+    if (root->interp && (real = realpath(root->interp, NULL))) {
+        dir = g_path_get_dirname(real);
+        free(real);
+
+        tmp = dir;
+        if (g_str_has_prefix(tmp, "/usr/"))
+            tmp += strlen("/usr");
+        if (tmp[0] == '/' && tmp[1])
+            ret = g_strdup(tmp + 1);
+        g_free(dir);
+    }
+
+    if (!ret)
+        ret = g_strdup(root->klass == ELFCLASS64 ? "lib64" : "lib");
+    return ret;
+}
+
+
+static gchar *gvir_sandbox_builder_elf_expand(const gchar *dir,
+                                              const gchar *origin,
+                                              const gchar *lib)
+{
+    gchar *tmp, *ret;
+    gchar **parts;
+
+    parts = g_strsplit(dir, "${ORIGIN}", -1);
+    tmp = g_strjoinv("$ORIGIN", parts);
+    g_strfreev(parts);
+
+    parts = g_strsplit(tmp, "$ORIGIN", -1);
+    g_free(tmp);
+    tmp = g_strjoinv(origin, parts);
+    g_strfreev(parts);
+
+    parts = g_strsplit(tmp, "${LIB}", -1);
+    g_free(tmp);
+    tmp = g_strjoinv("$LIB", parts);
+    g_strfreev(parts);
+
+    parts = g_strsplit(tmp, "$LIB", -1);
+    ret = g_strjoinv(lib, parts);
+    g_strfreev(parts);
+    g_free(tmp);
+
+    return ret;
+}
+
+
+/* Checks @path is a library that could be loaded alongside @root */
+static gboolean gvir_sandbox_builder_elf_usable(const gchar *path,
+                                                GVirSandboxBuilderElf *root)
+{
+    GVirSandboxBuilderElf *elf;
+
+    if (!g_file_test(path, G_FILE_TEST_IS_REGULAR))
+        return FALSE;
+
+    if (!(elf = gvir_sandbox_builder_elf_lookup(path, NULL)))
+        return FALSE;
+
+    return elf->klass == root->klass && elf->machine == root->machine;
+}
+
+
+static gchar *gvir_sandbox_builder_elf_search_dirs(gchar **dirs,
+                                                   const gchar *name,
+                                                   const gchar *origin,
+                                                   const gchar *lib,
+                                                   GVirSandboxBuilderElf *root)
+{
+    gsize i;
+
+    for (i = 0; dirs && dirs[i]; i++) {
+        gchar *dir, *path;
+
+        if (!dirs[i][0])
+            continue;
+
+        dir = gvir_sandbox_builder_elf_expand(dirs[i], origin, lib);
+        path = g_build_filename(dir, name, NULL);
+        g_free(dir);
+
+        if (gvir_sandbox_builder_elf_usable(path, root))
+            return path;
+        g_free(path);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Follows the dynamic loader's search order for @name, needed by
+ * @elf at @path, within a program whose main object is @root and
+ * whose $LIB is @lib.
+ */
+static gchar *gvir_sandbox_builder_elf_find(const gchar *name,
+                                            GVirSandboxBuilderElf *elf,
+                                            const gchar *path,
+                                            GVirSandboxBuilderElf *root,
+                                            const gchar *rootpath,
+                                            const gchar *lib)
+{
+    const gchar *const defdirs64[] = { "/$LIB", "/usr/$LIB",
+                                       "/lib64", "/usr/lib64", "/lib", "/usr/lib", NULL };
+    const gchar *const defdirs32[] = { "/$LIB", "/usr/$LIB", "/lib", "/usr/lib", NULL };
+    gchar *origin = g_path_get_dirname(path);
+    gchar *rootorigin = g_path_get_dirname(rootpath);
+    gchar *ret = NULL;
+    GPtrArray *paths;
+    gsize i;
+
+    if (strchr(name, '/')) {
+        if (gvir_sandbox_builder_elf_usable(name, root))
+            ret = g_strdup(name);
+        goto cleanup;
+    }
+
+    /* DT_RPATH is ignored by any object that has DT_RUNPATH */
+    if (!elf->runpath &&
+        (ret = gvir_sandbox_builder_elf_search_dirs(elf->rpath, name, origin, lib, root)))
+        goto cleanup;
+    if (elf != root && !root->runpath &&
+        (ret = gvir_sandbox_builder_elf_search_dirs(root->rpath, name, rootorigin, lib, root)))
+        goto cleanup;
+
+    if (g_getenv("LD_LIBRARY_PATH")) {
+        gchar **dirs = g_strsplit(g_getenv("LD_LIBRARY_PATH"), ":", 0);
+        ret = gvir_sandbox_builder_elf_search_dirs(dirs, name, origin, lib, root);
+        g_strfreev(dirs);
+        if (ret)
+            goto cleanup;
+    }
+
+    if ((ret = gvir_sandbox_builder_elf_search_dirs(elf->runpath, name, origin, lib, root)))
+        goto cleanup;
+
+    gvir_sandbox_builder_elf_load_ldcache();
+    if (ldcache && (paths = g_hash_table_lookup(ldcache, name))) {
+        for (i = 0; i < paths->len; i++) {
+            if (gvir_sandbox_builder_elf_usable(paths->pdata[i], root)) {
+                ret = g_strdup(paths->pdata[i]);
+                goto cleanup;
+            }
+        }
+    }
+
+    ret = gvir_sandbox_builder_elf_search_dirs(root->klass == ELFCLASS64 ?
+                                               (gchar **)defdirs64 :
+                                               (gchar **)defdirs32,
+                                               name, origin, lib, root);
+
+ cleanup:
+    g_free(rootorigin);
+    g_free(origin);
+    return ret;
+}
+
+
+/**
+ * gvir_sandbox_builder_elf_resolve: (skip)
+ * @program: the program to inspect
+ * @interp: (out): filled with the dynamic loader, if any
+ * @libs: (out): filled with the libraries, in load order
+ * @error: (out): the error location
+ *
+ * Resolves the full set of shared libraries @program needs
+ * without running it, nor ldd.
+ *
+ * Returns: TRUE on success, FALSE if it could not be resolved
+ */
+gboolean gvir_sandbox_builder_elf_resolve(const gchar *program,
+                                          gchar **interp,
+                                          GList **libs,
+                                          GError **error)
+{
+    GVirSandboxBuilderElf *root;
+    GHashTable *seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GQueue queue = G_QUEUE_INIT;
+    gchar *loader = NULL;
+    gchar *lib = NULL;
+    gboolean ret = FALSE;
+
+    *interp = NULL;
+    *libs = NULL;
+
+    G_LOCK(elf);
+
+    if (!(root = gvir_sandbox_builder_elf_lookup(program, error)))
+        goto cleanup;
+
+    /* The loader is staged separately, under a fixed name */
+    if (root->interp)
+        loader = g_path_get_basename(root->interp);
+    lib = gvir_sandbox_builder_elf_libdir(root);
+
+    g_queue_push_tail(&queue, g_strdup(program));
+    while (!g_queue_is_empty(&queue)) {
+        gchar *path = g_queue_pop_head(&queue);
+        GVirSandboxBuilderElf *elf;
+        gsize i;
+
+        if (!(elf = gvir_sandbox_builder_elf_lookup(path, error))) {
+            g_free(path);
+            goto cleanup;
+        }
+
+        for (i = 0; elf->needed[i]; i++) {
+            const gchar *name = elf->needed[i];
+            gchar *found;
+
+            if ((loader && g_str_equal(name, loader)) ||
+                g_hash_table_contains(seen, name))
+                continue;
+            g_hash_table_add(seen, g_strdup(name));
+
+            if (!(found = gvir_sandbox_builder_elf_find(name, elf, path,
+                                                        root, program, lib))) {
+                g_set_error(error, GVIR_SANDBOX_BUILDER_ELF_ERROR, 0,
+                            _("Unable to find library %s needed by %s"),
+                            name, path);
+                g_free(path);
+                goto cleanup;
+            }
+
+            *libs = g_list_append(*libs, found);
+            g_queue_push_tail(&queue, g_strdup(found));
+        }
+        g_free(path);
+    }
+
+    *interp = g_strdup(root->interp);
+    ret = TRUE;
+
+ cleanup:
+    G_UNLOCK(elf);
+    if (!ret) {
+        g_list_free_full(*libs, g_free);
+        *libs = NULL;
+    }
+    g_queue_foreach(&queue, (GFunc)g_free, NULL);
+    g_queue_clear(&queue);
+    g_hash_table_unref(seen);
+    g_free(loader);
+    g_free(lib);
+    return ret;
+}
+
+
+/**
+ * gvir_sandbox_builder_elf_clear: (skip)
+ *
+ * Forgets the objects parsed while resolving the programs of a
+ * build, which a later build has to stat and parse anew anyway
+ * if they changed in the meantime.
+ */
+void gvir_sandbox_builder_elf_clear(void)
+{
+    G_LOCK(elf);
+    if (objects)
+        g_hash_table_unref(objects);
+    objects = NULL;
+    G_UNLOCK(elf);
+}
+
+
+/**
+ * gvir_sandbox_builder_elf_has_note: (skip)
+ * @path: the ELF object to inspect
+ * @owner: the name of the note's owner
+ * @type: the type of note
+ *
+ * Looks for a note of @type from @owner in the program headers
+ * of @path, such as the PVH entry point of a Linux vmlinux.
+ *
+ * Returns: TRUE if @path is a native ELF object with such a note
+ */
+gboolean gvir_sandbox_builder_elf_has_note(const gchar *path,
+                                           const gchar *owner,
+                                           guint32 type)
+{
+    GMappedFile *file;
+    const guint8 *data;
+    gsize len;
+    guint8 klass;
+    guint64 phoff;
+    guint16 phnum, phentsize;
+    gsize ownerlen = strlen(owner) + 1;
+    gboolean ret = FALSE;
+    gsize i;
+
+    if (!(file = g_mapped_file_new(path, FALSE, NULL)))
+        return FALSE;
+
+    data = (const guint8 *)g_mapped_file_get_contents(file);
+    len = g_mapped_file_get_length(file);
+
+    if (len < sizeof(Elf64_Ehdr) ||
+        memcmp(data, ELFMAG, SELFMAG) != 0 ||
+        data[EI_DATA] != (G_BYTE_ORDER == G_LITTLE_ENDIAN ?
+                          ELFDATA2LSB : ELFDATA2MSB))
+        goto cleanup;
+
+    klass = data[EI_CLASS];
+    if (klass == ELFCLASS64) {
+        const Elf64_Ehdr *ehdr = (const Elf64_Ehdr *)data;
+        phoff = ehdr->e_phoff;
+        phnum = ehdr->e_phnum;
+        phentsize = ehdr->e_phentsize;
+        if (phentsize < sizeof(Elf64_Phdr))
+            goto cleanup;
+    } else if (klass == ELFCLASS32) {
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)data;
+        phoff = ehdr->e_phoff;
+        phnum = ehdr->e_phnum;
+        phentsize = ehdr->e_phentsize;
+        if (phentsize < sizeof(Elf32_Phdr))
+            goto cleanup;
+    } else {
+        goto cleanup;
+    }
+
+    for (i = 0; i < phnum && !ret; i++) {
+        guint64 off, filesz, pos;
+
+        if (phoff + ((i + 1) * phentsize) > len)
+            break;
+
+        if (klass == ELFCLASS64) {
+            const Elf64_Phdr *phdr = (const Elf64_Phdr *)(data + phoff + (i * phentsize));
+            if (phdr->p_type != PT_NOTE)
+                continue;
+            off = phdr->p_offset;
+            filesz = phdr->p_filesz;
+        } else {
+            const Elf32_Phdr *phdr = (const Elf32_Phdr *)(data + phoff + (i * phentsize));
+            if (phdr->p_type != PT_NOTE)
+                continue;
+            off = phdr->p_offset;
+            filesz = phdr->p_filesz;
+        }
+
+        if (off > len || filesz > len - off)
+            break;
+
+        /* The note header is the same for both classes */
+        pos = 0;
+        while (pos + sizeof(Elf32_Nhdr) <= filesz) {
+            const Elf32_Nhdr *nhdr = (const Elf32_Nhdr *)(data + off + pos);
+            guint64 namesz = ((guint64)nhdr->n_namesz + 3) & ~3ULL;
+            guint64 descsz = ((guint64)nhdr->n_descsz + 3) & ~3ULL;
+            const gchar *name = (const gchar *)nhdr + sizeof(*nhdr);
+
+            if (pos + sizeof(*nhdr) + namesz + descsz > filesz)
+                break;
+
+            if (nhdr->n_type == type &&
+                nhdr->n_namesz == ownerlen &&
+                memcmp(name, owner, ownerlen) == 0) {
+                ret = TRUE;
+                break;
+            }
+
+            pos += sizeof(*nhdr) + namesz + descsz;
+        }
+    }
+
+ cleanup:
+    g_mapped_file_unref(file);
+    return ret;
+}
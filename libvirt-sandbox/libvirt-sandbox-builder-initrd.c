@@ -25,6 +25,16 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#if WITH_LZMA
+# include <lzma.h>
+#endif /* WITH_LZMA */
 
 #include <glib/gi18n.h>
 
@@ -41,6 +51,11 @@
  * The GVirSandboxBuilderInitrd object provides the support
  * required to dynically creat minimal footprint kernel
  * ramdisks for booting virtual machine based sandboxes.
+ *
+ * If a cache directory is set, each ramdisk is stored there
+ * under a hash of everything that went into it, and later
+ * requests for an identical ramdisk are satisfied with a
+ * hard link to the stored copy instead of building it again.
  */
 
 #define GVIR_SANDBOX_BUILDER_INITRD_GET_PRIVATE(obj)                    \
@@ -48,7 +63,7 @@
 
 struct _GVirSandboxBuilderInitrdPrivate
 {
-    gboolean unused;
+    gchar *cachedir;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxBuilderInitrd, gvir_sandbox_builder_initrd, G_TYPE_OBJECT);
@@ -56,6 +71,7 @@ G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxBuilderInitrd, gvir_sandbox_builder_initrd
 
 enum {
     PROP_0,
+    PROP_CACHEDIR,
 };
 
 enum {
@@ -75,15 +91,16 @@ gvir_sandbox_builder_initrd_error_quark(void)
 
 static void gvir_sandbox_builder_initrd_get_property(GObject *object,
                                                      guint prop_id,
-                                                     GValue *value G_GNUC_UNUSED,
+                                                     GValue *value,
                                                      GParamSpec *pspec)
 {
-#if 0
     GVirSandboxBuilderInitrd *builder = GVIR_SANDBOX_BUILDER_INITRD(object);
     GVirSandboxBuilderInitrdPrivate *priv = builder->priv;
-#endif
 
     switch (prop_id) {
+    case PROP_CACHEDIR:
+        g_value_set_string(value, priv->cachedir);
+        break;
 
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -93,15 +110,17 @@ static void gvir_sandbox_builder_initrd_get_property(GObject *object,
 
 static void gvir_sandbox_builder_initrd_set_property(GObject *object,
                                                      guint prop_id,
-                                                     const GValue *value G_GNUC_UNUSED,
+                                                     const GValue *value,
                                                      GParamSpec *pspec)
 {
-#if 0
     GVirSandboxBuilderInitrd *builder = GVIR_SANDBOX_BUILDER_INITRD(object);
     GVirSandboxBuilderInitrdPrivate *priv = builder->priv;
-#endif
 
     switch (prop_id) {
+    case PROP_CACHEDIR:
+        g_free(priv->cachedir);
+        priv->cachedir = g_value_dup_string(value);
+        break;
 
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -111,10 +130,10 @@ static void gvir_sandbox_builder_initrd_set_property(GObject *object,
 
 static void gvir_sandbox_builder_initrd_finalize(GObject *object)
 {
-#if 0
     GVirSandboxBuilderInitrd *builder = GVIR_SANDBOX_BUILDER_INITRD(object);
     GVirSandboxBuilderInitrdPrivate *priv = builder->priv;
-#endif
+
+    g_free(priv->cachedir);
 
     G_OBJECT_CLASS(gvir_sandbox_builder_initrd_parent_class)->finalize(object);
 }
@@ -127,6 +146,18 @@ static void gvir_sandbox_builder_initrd_class_init(GVirSandboxBuilderInitrdClass
     object_class->finalize = gvir_sandbox_builder_initrd_finalize;
     object_class->get_property = gvir_sandbox_builder_initrd_get_property;
     object_class->set_property = gvir_sandbox_builder_initrd_set_property;
+
+    g_object_class_install_property(object_class,
+                                    PROP_CACHEDIR,
+                                    g_param_spec_string("cachedir",
+                                                        "Cache dir",
+                                                        "Directory for caching built ramdisks",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
 }
 
 
@@ -150,55 +181,40 @@ GVirSandboxBuilderInitrd *gvir_sandbox_builder_initrd_new(void)
 }
 
 
-static gchar *gvir_sandbox_builder_initrd_create_tempdir(GError **error)
+/**
+ * gvir_sandbox_builder_initrd_set_cachedir:
+ * @builder: (transfer none): the initrd builder
+ * @cachedir: (transfer none)(allow-none): the cache directory path
+ *
+ * Sets the directory in which built ramdisks are kept for
+ * reuse, or NULL to always build them from scratch. The
+ * directory may be shared by any number of builders, in
+ * this process or others.
+ */
+void gvir_sandbox_builder_initrd_set_cachedir(GVirSandboxBuilderInitrd *builder,
+                                              const gchar *cachedir)
 {
-    gchar *tmpl = NULL;
-    gchar *dir = NULL;
-    const gchar *tmpdir = getenv("TEMPDIR");
-
-    if (!tmpdir)
-        tmpdir = "/tmp";
-
-    if (!(tmpl = g_strdup_printf("%s/libvirt-sandbox-XXXXXX", tmpdir)))
-        goto cleanup;
-
-    dir = mkdtemp(tmpl);
-
-    if (!dir) {
-        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
-                    _("Unable to create temporary directory %s: %s"),
-                    tmpl, strerror(errno));
-        goto cleanup;
-    }
-
- cleanup:
-    return dir;
+    GVirSandboxBuilderInitrdPrivate *priv = builder->priv;
+    g_free(priv->cachedir);
+    priv->cachedir = g_strdup(cachedir);
 }
 
 
-static gboolean gvir_sandbox_builder_initrd_copy_file(const gchar *srcpath,
-                                                      const gchar *tgtdir,
-                                                      const gchar *tgtname,
-                                                      GError **error)
+/**
+ * gvir_sandbox_builder_initrd_get_cachedir:
+ * @builder: (transfer none): the initrd builder
+ *
+ * Retrieves the directory in which built ramdisks are cached
+ *
+ * Returns: (transfer none): the cache directory path, or NULL
+ */
+const gchar *gvir_sandbox_builder_initrd_get_cachedir(GVirSandboxBuilderInitrd *builder)
 {
-    gchar *tgtpath = g_strdup_printf("%s/%s", tgtdir, tgtname);
-    GFile *tgt = g_file_new_for_path(tgtpath);
-    GFile *src = g_file_new_for_path(srcpath);
-    gboolean ret = FALSE;
-
-    g_free(tgtpath);
-
-    if (!g_file_copy(src, tgt, 0, NULL, NULL, NULL, error))
-        goto cleanup;
-
-    ret = TRUE;
-
- cleanup:
-    g_object_unref(tgt);
-    g_object_unref(src);
-    return ret;
+    GVirSandboxBuilderInitrdPrivate *priv = builder->priv;
+    return priv->cachedir;
 }
 
+
 #define FIND_USING_GIO
 
 #ifdef FIND_USING_GIO
@@ -335,90 +351,676 @@ static GList *gvir_sandbox_builder_initrd_find_files(GList *modnames,
 #endif
 
 
+/*
+ * Modules are named without their ".ko" and compression suffixes,
+ * and the kernel treats '-' and '_' in names as the same
+ */
+static gchar *gvir_sandbox_builder_initrd_module_name(const gchar *path)
+{
+    const gchar *base = strrchr(path, '/');
+    gchar *name;
+    gchar *tmp;
+
+    name = g_strdup(base ? base + 1 : path);
+    if ((tmp = strstr(name, ".ko")))
+        *tmp = '\0';
+    for (tmp = name ; *tmp ; tmp++) {
+        if (*tmp == '-')
+            *tmp = '_';
+    }
+    return name;
+}
+
+
+typedef struct _GVirSandboxBuilderInitrdModules GVirSandboxBuilderInitrdModules;
+struct _GVirSandboxBuilderInitrdModules {
+    gchar *basedir;
+    GHashTable *deps;
+    GHashTable *builtin;
+    GHashTable *aliases;
+    GHashTable *visited;
+    GList *files;
+};
+
+
+static gchar **gvir_sandbox_builder_initrd_read_lines(const gchar *basedir,
+                                                      const gchar *name,
+                                                      GError **error)
+{
+    gchar *path = g_build_filename(basedir, name, NULL);
+    gchar *data = NULL;
+    gchar **lines = NULL;
+
+    if (g_file_get_contents(path, &data, NULL, error))
+        lines = g_strsplit(data, "\n", 0);
+
+    g_free(data);
+    g_free(path);
+    return lines;
+}
+
+
+/* Each entry maps a module name to its path followed by the
+ * paths of everything it depends on, directly or not */
+static gboolean gvir_sandbox_builder_initrd_load_moddep(GVirSandboxBuilderInitrdModules *mods,
+                                                        GError **error)
+{
+    gchar **lines;
+    gsize i;
+
+    if (!(lines = gvir_sandbox_builder_initrd_read_lines(mods->basedir,
+                                                         "modules.dep", error)))
+        return FALSE;
+
+    for (i = 0 ; lines[i] ; i++) {
+        gchar *colon = strchr(lines[i], ':');
+        gchar **entry;
+
+        if (!colon)
+            continue;
+        *colon = ' ';
+
+        entry = g_strsplit(g_strstrip(lines[i]), " ", 0);
+        g_hash_table_insert(mods->deps,
+                            gvir_sandbox_builder_initrd_module_name(entry[0]),
+                            entry);
+    }
+
+    g_strfreev(lines);
+    return TRUE;
+}
+
+
+static void gvir_sandbox_builder_initrd_load_builtin(GVirSandboxBuilderInitrdModules *mods)
+{
+    gchar **lines;
+    gsize i;
+
+    /* Kernels built with no modules at all may not have one */
+    if (!(lines = gvir_sandbox_builder_initrd_read_lines(mods->basedir,
+                                                         "modules.builtin", NULL)))
+        return;
+
+    for (i = 0 ; lines[i] ; i++) {
+        if (lines[i][0])
+            g_hash_table_add(mods->builtin,
+                             gvir_sandbox_builder_initrd_module_name(lines[i]));
+    }
+
+    g_strfreev(lines);
+}
+
+
+/* Only plain names matter here, not the wildcard device aliases */
+static void gvir_sandbox_builder_initrd_load_aliases(GVirSandboxBuilderInitrdModules *mods)
+{
+    gchar **lines;
+    gsize i;
+
+    mods->aliases = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+    if (!(lines = gvir_sandbox_builder_initrd_read_lines(mods->basedir,
+                                                         "modules.alias", NULL)))
+        return;
+
+    for (i = 0 ; lines[i] ; i++) {
+        gchar **fields;
+
+        if (!g_str_has_prefix(lines[i], "alias ") ||
+            strpbrk(lines[i], "*?["))
+            continue;
+
+        fields = g_strsplit(lines[i], " ", 3);
+        if (fields[1] && fields[2])
+            g_hash_table_insert(mods->aliases,
+                                gvir_sandbox_builder_initrd_module_name(fields[1]),
+                                gvir_sandbox_builder_initrd_module_name(fields[2]));
+        g_strfreev(fields);
+    }
+
+    g_strfreev(lines);
+}
+
+
+/* Adds @name after everything it depends on, so the list
+ * comes out in an order the modules can be loaded in */
+static void gvir_sandbox_builder_initrd_visit_module(GVirSandboxBuilderInitrdModules *mods,
+                                                     const gchar *name)
+{
+    gchar **entry;
+    gchar *path;
+    gsize n;
+
+    if (g_hash_table_contains(mods->visited, name))
+        return;
+    g_hash_table_add(mods->visited, g_strdup(name));
+
+    if (!(entry = g_hash_table_lookup(mods->deps, name)))
+        return;
+
+    for (n = g_strv_length(entry) ; n > 1 ; n--) {
+        gchar *depname;
+
+        if (!entry[n - 1][0])
+            continue;
+
+        depname = gvir_sandbox_builder_initrd_module_name(entry[n - 1]);
+        gvir_sandbox_builder_initrd_visit_module(mods, depname);
+        g_free(depname);
+    }
+
+    path = g_build_filename(mods->basedir, entry[0], NULL);
+    mods->files = g_list_append(mods->files, g_file_new_for_path(path));
+    g_free(path);
+}
+
+
+static GList *gvir_sandbox_builder_initrd_resolve_modules(GList *modnames,
+                                                          const gchar *basedir,
+                                                          GError **error)
+{
+    GVirSandboxBuilderInitrdModules mods;
+    GList *tmp;
+
+    mods.basedir = (gchar *)basedir;
+    mods.deps = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                      g_free, (GDestroyNotify)g_strfreev);
+    mods.builtin = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    mods.visited = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    mods.aliases = NULL;
+    mods.files = NULL;
+
+    if (!gvir_sandbox_builder_initrd_load_moddep(&mods, error))
+        goto cleanup;
+    gvir_sandbox_builder_initrd_load_builtin(&mods);
+
+    for (tmp = modnames ; tmp ; tmp = tmp->next) {
+        gchar *name = gvir_sandbox_builder_initrd_module_name(tmp->data);
+
+        if (!g_hash_table_contains(mods.deps, name) &&
+            !g_hash_table_contains(mods.builtin, name)) {
+            const gchar *real;
+            /* The aliases are big, so only read them when needed */
+            if (!mods.aliases)
+                gvir_sandbox_builder_initrd_load_aliases(&mods);
+            if ((real = g_hash_table_lookup(mods.aliases, name))) {
+                g_free(name);
+                name = g_strdup(real);
+            }
+        }
+
+        /* Anything built in, or not built at all, is skipped */
+        if (!g_hash_table_contains(mods.builtin, name))
+            gvir_sandbox_builder_initrd_visit_module(&mods, name);
+        g_free(name);
+    }
+
+ cleanup:
+    g_hash_table_unref(mods.deps);
+    g_hash_table_unref(mods.builtin);
+    g_hash_table_unref(mods.visited);
+    if (mods.aliases)
+        g_hash_table_unref(mods.aliases);
+    return mods.files;
+}
+
+
+/*
+ * Finds the files for the requested modules and all their
+ * dependencies, in the order they need to be loaded in
+ */
 static GList *gvir_sandbox_builder_initrd_find_modules(GList *modnames,
                                                        GVirSandboxConfigInitrd *config,
                                                        GError **error)
 {
-    gchar *moddirpath = g_strdup_printf("%s",
-                                        gvir_sandbox_config_initrd_get_kmoddir(config));
-    GFile *moddir = g_file_new_for_path(moddirpath);
+    const gchar *kmoddir = gvir_sandbox_config_initrd_get_kmoddir(config);
+    gchar *basedir = g_path_get_dirname(kmoddir);
+    gchar *moddep = g_build_filename(basedir, "modules.dep", NULL);
+    GFile *moddir;
+    GList *found, *modfiles = NULL;
+    GList *tmp;
 
-    GList *modfiles = gvir_sandbox_builder_initrd_find_files(modnames,
-                                                             moddir,
-                                                             error);
+    if (g_file_test(moddep, G_FILE_TEST_EXISTS)) {
+        modfiles = gvir_sandbox_builder_initrd_resolve_modules(modnames, basedir, error);
+        goto cleanup;
+    }
 
-    g_free(moddirpath);
+    /* Without depmod's indexes, search the tree by name. This
+     * can't know about dependencies, so all must be requested */
+    moddir = g_file_new_for_path(kmoddir);
+    found = gvir_sandbox_builder_initrd_find_files(modnames, moddir, error);
     g_object_unref(moddir);
+
+    for (tmp = modnames ; tmp ; tmp = tmp->next) {
+        GList *files;
+        for (files = found ; files ; files = files->next) {
+            gchar *basename = g_file_get_basename(files->data);
+            gboolean match = g_str_has_prefix(basename, tmp->data);
+            g_free(basename);
+            if (match) {
+                modfiles = g_list_append(modfiles, g_object_ref(files->data));
+                break;
+            }
+        }
+    }
+    g_list_foreach(found, (GFunc)g_object_unref, NULL);
+    g_list_free(found);
+
+ cleanup:
+    g_free(moddep);
+    g_free(basedir);
     return modfiles;
 }
 
 
-static gboolean gvir_sandbox_builder_initrd_populate_tmpdir(const gchar *tmpdir,
-                                                            GVirSandboxConfigInitrd *config,
-                                                            GError **error)
+/*
+ * The kernel unpacks ramdisks in the "newc" cpio format, which
+ * is simple enough to write directly. Each member is a fixed
+ * size ASCII header, then the name and the data, both padded
+ * out to a multiple of 4 bytes.
+ */
+#define GVIR_SANDBOX_BUILDER_INITRD_NEWC_MAGIC "070701"
+#define GVIR_SANDBOX_BUILDER_INITRD_NEWC_TRAILER "TRAILER!!!"
+
+typedef struct _GVirSandboxBuilderInitrdArchive GVirSandboxBuilderInitrdArchive;
+struct _GVirSandboxBuilderInitrdArchive {
+    GOutputStream *os;
+    guint32 ino;
+    guint64 offset;
+};
+
+
+static gboolean gvir_sandbox_builder_initrd_archive_write(GVirSandboxBuilderInitrdArchive *archive,
+                                                          const void *data,
+                                                          gsize len,
+                                                          GError **error)
+{
+    if (!g_output_stream_write_all(archive->os, data, len, NULL, NULL, error))
+        return FALSE;
+    archive->offset += len;
+    return TRUE;
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_archive_pad(GVirSandboxBuilderInitrdArchive *archive,
+                                                        GError **error)
+{
+    static const gchar zeros[4] = { 0 };
+    gsize pad = (4 - (archive->offset % 4)) % 4;
+
+    return gvir_sandbox_builder_initrd_archive_write(archive, zeros, pad, error);
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_archive_header(GVirSandboxBuilderInitrdArchive *archive,
+                                                           const gchar *name,
+                                                           guint32 mode,
+                                                           guint64 size,
+                                                           GError **error)
+{
+    gchar *header;
+    gsize namelen = strlen(name) + 1;
+    gboolean ret;
+
+    if (size > G_MAXUINT32) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, 0,
+                    _("File %s is too large for the ramdisk"), name);
+        return FALSE;
+    }
+
+    /* Timestamps and ownership are fixed, so that identical
+     * inputs always give an identical ramdisk */
+    header = g_strdup_printf(GVIR_SANDBOX_BUILDER_INITRD_NEWC_MAGIC
+                             "%08X%08X%08X%08X%08X%08X%08X"
+                             "%08X%08X%08X%08X%08X%08X",
+                             archive->ino++, mode, 0, 0, 1, 0,
+                             (guint32)size, 0, 0, 0, 0,
+                             (guint32)namelen, 0);
+
+    ret = gvir_sandbox_builder_initrd_archive_write(archive, header,
+                                                    strlen(header), error) &&
+        gvir_sandbox_builder_initrd_archive_write(archive, name,
+                                                  namelen, error) &&
+        gvir_sandbox_builder_initrd_archive_pad(archive, error);
+
+    g_free(header);
+    return ret;
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_archive_add_data(GVirSandboxBuilderInitrdArchive *archive,
+                                                             const gchar *name,
+                                                             guint32 mode,
+                                                             const void *data,
+                                                             gsize len,
+                                                             GError **error)
+{
+    return gvir_sandbox_builder_initrd_archive_header(archive, name,
+                                                      S_IFREG | mode,
+                                                      len, error) &&
+        gvir_sandbox_builder_initrd_archive_write(archive, data, len, error) &&
+        gvir_sandbox_builder_initrd_archive_pad(archive, error);
+}
+
+
+/* Streams a host file straight into the archive, with no copy on disk */
+static gboolean gvir_sandbox_builder_initrd_archive_add_file(GVirSandboxBuilderInitrdArchive *archive,
+                                                             const gchar *name,
+                                                             guint32 mode,
+                                                             GFile *file,
+                                                             GError **error)
+{
+    GFileInputStream *is;
+    GFileInfo *info = NULL;
+    goffset size;
+    gssize len;
+    gboolean ret = FALSE;
+
+    if (!(is = g_file_read(file, NULL, error)))
+        return FALSE;
+
+    if (!(info = g_file_input_stream_query_info(is,
+                                                G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                                NULL, error)))
+        goto cleanup;
+    size = g_file_info_get_size(info);
+
+    if (!gvir_sandbox_builder_initrd_archive_header(archive, name,
+                                                    S_IFREG | mode,
+                                                    size, error))
+        goto cleanup;
+
+    if ((len = g_output_stream_splice(archive->os, G_INPUT_STREAM(is),
+                                      G_OUTPUT_STREAM_SPLICE_NONE,
+                                      NULL, error)) < 0)
+        goto cleanup;
+
+    /* The header is already out, so the size can't change now */
+    if (len != size) {
+        gchar *path = g_file_get_path(file);
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, 0,
+                    _("File %s changed size while being archived"), path);
+        g_free(path);
+        goto cleanup;
+    }
+    archive->offset += len;
+
+    if (!gvir_sandbox_builder_initrd_archive_pad(archive, error))
+        goto cleanup;
+
+    ret = TRUE;
+ cleanup:
+    if (info)
+        g_object_unref(info);
+    g_object_unref(is);
+    return ret;
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_archive_finish(GVirSandboxBuilderInitrdArchive *archive,
+                                                           GError **error)
+{
+    return gvir_sandbox_builder_initrd_archive_header(archive,
+                                                      GVIR_SANDBOX_BUILDER_INITRD_NEWC_TRAILER,
+                                                      0, 0, error);
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_wait_codec(GPid pid,
+                                                       const gchar *codec,
+                                                       GError **error)
+{
+    int status;
+    gboolean ret = FALSE;
+
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno == EINTR)
+            continue;
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
+                    _("Unable to wait for %s codec: %s"),
+                    codec, strerror(errno));
+        goto cleanup;
+    }
+
+    if (WIFSIGNALED(status)) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, 0,
+                    _("The %s codec was killed by signal %d"),
+                    codec, WTERMSIG(status));
+        goto cleanup;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, 0,
+                    _("The %s codec failed with status %d"),
+                    codec, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        goto cleanup;
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_spawn_close_pid(pid);
+    return ret;
+}
+
+
+static GBytes *gvir_sandbox_builder_initrd_decompress_gzip(GFile *file,
+                                                           GError **error)
+{
+    GFileInputStream *is;
+    GZlibDecompressor *decompressor;
+    GInputStream *cis;
+    GOutputStream *mos;
+    GBytes *data = NULL;
+
+    if (!(is = g_file_read(file, NULL, error)))
+        return NULL;
+
+    decompressor = g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+    cis = g_converter_input_stream_new(G_INPUT_STREAM(is),
+                                       G_CONVERTER(decompressor));
+    mos = g_memory_output_stream_new_resizable();
+
+    if (g_output_stream_splice(mos, cis,
+                               G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+                               G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                               NULL, error) >= 0)
+        data = g_memory_output_stream_steal_as_bytes(G_MEMORY_OUTPUT_STREAM(mos));
+
+    g_object_unref(mos);
+    g_object_unref(cis);
+    g_object_unref(decompressor);
+    g_object_unref(is);
+    return data;
+}
+
+
+#if WITH_LZMA
+static GBytes *gvir_sandbox_builder_initrd_decompress_xz(GFile *file,
+                                                         GError **error)
+{
+    lzma_stream st = LZMA_STREAM_INIT;
+    GByteArray *out = NULL;
+    gchar *in = NULL;
+    gsize inlen;
+    gsize used = 0;
+    lzma_ret rv;
+    GBytes *data = NULL;
+
+    if (!g_file_load_contents(file, NULL, &in, &inlen, NULL, error))
+        return NULL;
+
+    if ((rv = lzma_stream_decoder(&st, UINT64_MAX, LZMA_CONCATENATED)) != LZMA_OK)
+        goto cleanup;
+
+    out = g_byte_array_sized_new((inlen * 4) + 4096);
+    g_byte_array_set_size(out, (inlen * 4) + 4096);
+
+    st.next_in = (const guint8 *)in;
+    st.avail_in = inlen;
+    do {
+        if (used == out->len)
+            g_byte_array_set_size(out, out->len * 2);
+        st.next_out = out->data + used;
+        st.avail_out = out->len - used;
+        rv = lzma_code(&st, LZMA_FINISH);
+        used = out->len - st.avail_out;
+    } while (rv == LZMA_OK);
+
+    if (rv == LZMA_STREAM_END) {
+        g_byte_array_set_size(out, used);
+        data = g_byte_array_free_to_bytes(out);
+        out = NULL;
+    }
+
+ cleanup:
+    if (!data) {
+        gchar *path = g_file_get_path(file);
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, 0,
+                    _("Unable to decompress %s: lzma error %d"), path, rv);
+        g_free(path);
+    }
+    lzma_end(&st);
+    if (out)
+        g_byte_array_unref(out);
+    g_free(in);
+    return data;
+}
+#endif /* WITH_LZMA */
+
+
+static GBytes *gvir_sandbox_builder_initrd_decompress_zstd(GFile *file,
+                                                           GError **error)
+{
+    gchar *path = g_file_get_path(file);
+    const gchar *argv[] = { ZSTD_PATH, "-d", "-q", "-c", "--", path, NULL };
+    GPid pid;
+    gint outfd;
+    GInputStream *is = NULL;
+    GOutputStream *mos = NULL;
+    GBytes *data = NULL;
+    gboolean ok;
+
+    if (!g_spawn_async_with_pipes(NULL, (gchar **)argv, NULL,
+                                  G_SPAWN_DO_NOT_REAP_CHILD,
+                                  NULL, NULL, &pid,
+                                  NULL, &outfd, NULL, error))
+        goto cleanup;
+
+    is = g_unix_input_stream_new(outfd, TRUE);
+    mos = g_memory_output_stream_new_resizable();
+    ok = g_output_stream_splice(mos, is,
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                NULL, error) >= 0;
+    if (!ok)
+        g_input_stream_close(is, NULL, NULL);
+
+    if (!gvir_sandbox_builder_initrd_wait_codec(pid, "zstd", ok ? error : NULL))
+        ok = FALSE;
+
+    if (ok)
+        data = g_memory_output_stream_steal_as_bytes(G_MEMORY_OUTPUT_STREAM(mos));
+
+ cleanup:
+    if (mos)
+        g_object_unref(mos);
+    if (is)
+        g_object_unref(is);
+    g_free(path);
+    return data;
+}
+
+
+/*
+ * Decompresses a module on the host, once, so that the guest
+ * can load it without having to do so itself during boot. The
+ * result ends up in the initrd cache along with the rest.
+ * Returns NULL without setting @error if @name is not in a
+ * format that can be handled here, leaving it to the guest.
+ */
+static GBytes *gvir_sandbox_builder_initrd_decompress_module(GFile *file,
+                                                             const gchar *name,
+                                                             GError **error)
+{
+    if (g_str_has_suffix(name, ".ko.gz"))
+        return gvir_sandbox_builder_initrd_decompress_gzip(file, error);
+#if WITH_LZMA
+    if (g_str_has_suffix(name, ".ko.xz"))
+        return gvir_sandbox_builder_initrd_decompress_xz(file, error);
+#endif /* WITH_LZMA */
+    if (g_str_has_suffix(name, ".ko.zst") &&
+        g_file_test(ZSTD_PATH, G_FILE_TEST_IS_EXECUTABLE))
+        return gvir_sandbox_builder_initrd_decompress_zstd(file, error);
+    return NULL;
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_populate(GVirSandboxBuilderInitrdArchive *archive,
+                                                     GVirSandboxConfigInitrd *config,
+                                                     GError **error)
 {
     gboolean ret = FALSE;
     GList *modnames = NULL;
     GList *modfiles = NULL;
     GList *tmp;
-    GFile *modlist = NULL;
-    gchar *modlistpath = NULL;
-    GOutputStream *modlistos = NULL;
+    GFile *init = g_file_new_for_path(gvir_sandbox_config_initrd_get_init(config));
+    GString *modlist = g_string_new("");
+    GError *err = NULL;
 
-    if (!gvir_sandbox_builder_initrd_copy_file(
-                                               gvir_sandbox_config_initrd_get_init(config),
-                                               tmpdir, "init", error))
-        return FALSE;
+    if (!gvir_sandbox_builder_initrd_archive_add_file(archive, "init", 0755,
+                                                      init, error))
+        goto cleanup;
 
     modnames = gvir_sandbox_config_initrd_get_modules(config);
-    modfiles = gvir_sandbox_builder_initrd_find_modules(modnames, config, error);
-    if (*error)
+    modfiles = gvir_sandbox_builder_initrd_find_modules(modnames, config, &err);
+    if (err) {
+        g_propagate_error(error, err);
         goto cleanup;
+    }
 
+    /* Already in load order */
     tmp = modfiles;
     while (tmp) {
-        const gchar *basename = g_file_get_basename(tmp->data);
-        gchar *tgt = g_strdup_printf("%s/%s", tmpdir, basename);
-        GFile *file = g_file_new_for_path(tgt);
-        g_free(tgt);
+        gchar *basename = g_file_get_basename(tmp->data);
+        GError *e = NULL;
+        GBytes *data = gvir_sandbox_builder_initrd_decompress_module(tmp->data,
+                                                                     basename,
+                                                                     &e);
+        gboolean ok;
+
+        if (data) {
+            /* Drop the compression suffix, so the guest loads it as is */
+            strstr(basename, ".ko")[3] = '\0';
+            ok = gvir_sandbox_builder_initrd_archive_add_data(archive, basename, 0644,
+                                                              g_bytes_get_data(data, NULL),
+                                                              g_bytes_get_size(data),
+                                                              error);
+            g_bytes_unref(data);
+        } else if (e) {
+            g_propagate_error(error, e);
+            ok = FALSE;
+        } else {
+            ok = gvir_sandbox_builder_initrd_archive_add_file(archive, basename,
+                                                              0644, tmp->data,
+                                                              error);
+        }
 
-        if (!g_file_copy(tmp->data, file, 0, NULL, NULL, NULL, error)) {
-            g_object_unref(file);
-            goto cleanup;
+        if (ok) {
+            g_string_append(modlist, basename);
+            g_string_append_c(modlist, '\n');
         }
-        g_object_unref(file);
+        g_free(basename);
+        if (!ok)
+            goto cleanup;
 
         tmp = tmp->next;
     }
 
-
-    modlistpath = g_strdup_printf("%s/modules", tmpdir);
-    modlist = g_file_new_for_path(modlistpath);
-    if (!(modlistos = G_OUTPUT_STREAM(g_file_create(modlist, G_FILE_CREATE_NONE, NULL, error))))
+    if (!gvir_sandbox_builder_initrd_archive_add_data(archive, "modules", 0644,
+                                                      modlist->str, modlist->len,
+                                                      error))
         goto cleanup;
 
-    tmp = modnames;
-    while (tmp) {
-        GList *files = modfiles;
-        while (files) {
-            const gchar *basename = g_file_get_basename(files->data);
-            if (g_str_has_prefix(basename, tmp->data)) {
-                if (!g_output_stream_write_all(modlistos,
-                                               basename, strlen(basename),
-                                               NULL, NULL, error))
-                    goto cleanup;
-                if (!g_output_stream_write_all(modlistos,
-                                               "\n", 1,
-                                               NULL, NULL, error))
-                    goto cleanup;
-                break;
-            }
-            files = files->next;
-        }
-        tmp = tmp->next;
-    }
-
-    if (!g_output_stream_close(modlistos, NULL, error))
+    if (!gvir_sandbox_builder_initrd_archive_finish(archive, error))
         goto cleanup;
 
     ret = TRUE;
@@ -426,104 +1028,489 @@ static gboolean gvir_sandbox_builder_initrd_populate_tmpdir(const gchar *tmpdir,
     g_list_foreach(modfiles, (GFunc)g_object_unref, NULL);
     g_list_free(modfiles);
     g_list_free(modnames);
-    g_free(modlistpath);
-    if (modlist)
-        g_object_unref(modlist);
-    if (modlistos)
-        g_object_unref(modlistos);
+    g_string_free(modlist, TRUE);
+    g_object_unref(init);
     return ret;
 }
 
 
-static gboolean gvir_sandbox_builder_initrd_create_initrd(const gchar *tmpdir,
-                                                          const gchar *outputfile,
-                                                          GError **error)
+static void gvir_sandbox_builder_initrd_compressor_setup(gpointer opaque)
 {
-    gboolean ret = FALSE;
-    gchar *src = g_shell_quote(tmpdir);
-    gchar *tgt = g_shell_quote(outputfile);
-
-    gchar *cmd = g_strdup_printf(
-                                 "/bin/sh -c \"(cd %s && ( find | cpio --quiet -o -H newc | gzip -9 ) ) > %s\"",
-                                 src, tgt);
+    /* Runs in the child, so the compressor writes to the output file */
+    dup2(GPOINTER_TO_INT(opaque), STDOUT_FILENO);
+}
 
-    if (!g_spawn_command_line_sync(cmd, NULL, NULL, NULL, error))
-        goto cleanup;
 
-    ret = TRUE;
- cleanup:
-    g_free(src);
-    g_free(tgt);
-    g_free(cmd);
+/*
+ * Starts an external compressor writing to @outfd, for the codecs
+ * that GIO has no converter for, returning the pipe to feed it
+ */
+static gboolean gvir_sandbox_builder_initrd_spawn_compressor(const gchar *codec,
+                                                             gint level,
+                                                             int outfd,
+                                                             GPid *pid,
+                                                             gint *infd,
+                                                             GError **error)
+{
+    const gchar *argv[6];
+    gchar *levelStr = NULL;
+    gsize n = 0;
+    gboolean ret;
+
+    if (g_str_equal(codec, "lz4")) {
+        /* The kernel only understands the legacy lz4 framing */
+        argv[n++] = LZ4_PATH;
+        argv[n++] = "-l";
+    } else {
+        argv[n++] = ZSTD_PATH;
+    }
+    argv[n++] = "-q";
+    argv[n++] = "-c";
+    if (level >= 0)
+        argv[n++] = levelStr = g_strdup_printf("-%d", level);
+    argv[n] = NULL;
+
+    ret = g_spawn_async_with_pipes(NULL, (gchar **)argv, NULL,
+                                   G_SPAWN_DO_NOT_REAP_CHILD,
+                                   gvir_sandbox_builder_initrd_compressor_setup,
+                                   GINT_TO_POINTER(outfd),
+                                   pid, infd, NULL, NULL, error);
+    g_free(levelStr);
     return ret;
 }
 
 
-static gboolean gvir_sandbox_builder_initrd_remove_tmpdir(const gchar *tmpdir,
-                                                          GError **error)
+/*
+ * A compressor that dies early would have our next write raise
+ * SIGPIPE, killing the whole application. Block it in this thread
+ * instead, so that the write fails with EPIPE, and the exit status
+ * of the compressor then says what went wrong.
+ */
+static gboolean gvir_sandbox_builder_initrd_block_sigpipe(sigset_t *oldmask)
+{
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &mask, oldmask);
+
+    /* If it was pending already, it isn't ours to consume */
+    sigpending(&mask);
+    return !sigismember(&mask, SIGPIPE);
+}
+
+
+static void gvir_sandbox_builder_initrd_restore_sigpipe(const sigset_t *oldmask,
+                                                        gboolean consume)
+{
+    sigset_t mask;
+    struct timespec zero = { 0, 0 };
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGPIPE);
+    if (consume && !sigismember(oldmask, SIGPIPE)) {
+        while (sigtimedwait(&mask, NULL, &zero) < 0 && errno == EINTR)
+            ;
+    }
+    pthread_sigmask(SIG_SETMASK, oldmask, NULL);
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_build(GVirSandboxConfigInitrd *config,
+                                                  const gchar *outputfile,
+                                                  GError **error)
 {
-    GFile *dir = g_file_new_for_path(tmpdir);
-    GFileEnumerator *children = g_file_enumerate_children(dir,
-                                                          "standard::name",
-                                                          G_FILE_QUERY_INFO_NONE,
-                                                          NULL,
-                                                          error);
-    GFileInfo *childinfo;
     gboolean ret = FALSE;
-    if (!children)
+    const gchar *codec = gvir_sandbox_config_initrd_get_compression(config);
+    gint level = gvir_sandbox_config_initrd_get_compression_level(config);
+    GZlibCompressor *compressor = NULL;
+    GOutputStream *os = NULL;
+    GVirSandboxBuilderInitrdArchive archive = { NULL, 1, 0 };
+    GPid pid = 0;
+    gint infd;
+    int fd = -1;
+    mode_t mask;
+    sigset_t sigmask;
+    gboolean sigblocked = FALSE;
+    gboolean sigconsume = FALSE;
+
+    if (!codec)
+        codec = "gzip";
+
+    mask = umask(0077);
+
+    /* The output may be a link into the initrd cache from an
+     * earlier run, which must never be written through */
+    if (unlink(outputfile) < 0 && errno != ENOENT) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
+                    _("Unable to remove %s: %s"),
+                    outputfile, strerror(errno));
         goto cleanup;
+    }
 
-    while ((childinfo = g_file_enumerator_next_file(children, NULL, error)) != NULL) {
-        GFile *file = g_file_get_child(dir, g_file_info_get_name(childinfo));
-        g_file_delete(file, NULL, error && !*error ? error : NULL);
-        g_object_unref(childinfo);
+    if ((fd = open(outputfile, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600)) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
+                    _("Unable to create %s: %s"),
+                    outputfile, strerror(errno));
+        goto cleanup;
     }
 
-    if (error && *error)
+    if (g_str_equal(codec, "none")) {
+        os = g_unix_output_stream_new(fd, TRUE);
+        fd = -1;
+    } else if (g_str_equal(codec, "gzip")) {
+        GOutputStream *fos = g_unix_output_stream_new(fd, TRUE);
+        fd = -1;
+        compressor = g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP, level);
+        os = g_converter_output_stream_new(fos, G_CONVERTER(compressor));
+        g_object_unref(fos);
+    } else if (g_str_equal(codec, "lz4") ||
+               g_str_equal(codec, "zstd")) {
+        if (!gvir_sandbox_builder_initrd_spawn_compressor(codec, level, fd,
+                                                          &pid, &infd, error))
+            goto cleanup;
+        os = g_unix_output_stream_new(infd, TRUE);
+        sigconsume = gvir_sandbox_builder_initrd_block_sigpipe(&sigmask);
+        sigblocked = TRUE;
+    } else {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, 0,
+                    _("Unknown initrd compression '%s'"), codec);
         goto cleanup;
+    }
+
+    /* Headers and padding are tiny, so batch them up before
+     * they reach the compressor */
+    archive.os = g_buffered_output_stream_new_sized(os, 64 * 1024);
+
+    if (!gvir_sandbox_builder_initrd_populate(&archive, config, error) ||
+        !g_output_stream_close(archive.os, NULL, error)) {
+        /* A broken pipe is best explained by the compressor */
+        if (pid && error && *error &&
+            g_error_matches(*error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE)) {
+            GError *e = NULL;
+            GPid child = pid;
+            pid = 0;
+            if (!gvir_sandbox_builder_initrd_wait_codec(child, codec, &e)) {
+                g_clear_error(error);
+                g_propagate_error(error, e);
+            }
+        }
+        goto cleanup;
+    }
+
+    if (pid) {
+        GPid child = pid;
+        pid = 0;
+        if (!gvir_sandbox_builder_initrd_wait_codec(child, codec, error))
+            goto cleanup;
+    }
 
     ret = TRUE;
  cleanup:
-    g_file_delete(dir, NULL, error && !*error ? error : NULL);
-    g_object_unref(dir);
+    /* Drops the compressor's input, if still open, so it exits */
+    if (archive.os)
+        g_object_unref(archive.os);
+    if (os)
+        g_object_unref(os);
+    if (compressor)
+        g_object_unref(compressor);
+    if (fd >= 0)
+        close(fd);
+    if (pid)
+        gvir_sandbox_builder_initrd_wait_codec(pid, codec, NULL);
+    if (sigblocked)
+        gvir_sandbox_builder_initrd_restore_sigpipe(&sigmask, sigconsume);
+
+    if (!ret)
+        unlink(outputfile);
+
+    umask(mask);
 
-    g_object_unref(children);
     return ret;
 }
 
-gboolean gvir_sandbox_builder_initrd_construct(GVirSandboxBuilderInitrd *builder G_GNUC_UNUSED,
-                                               GVirSandboxConfigInitrd *config,
-                                               gchar *outputfile,
-                                               GError **error)
+
+/* Bump this whenever the layout of the ramdisk changes */
+#define GVIR_SANDBOX_BUILDER_INITRD_CACHE_FORMAT 4
+#define GVIR_SANDBOX_BUILDER_INITRD_CACHE_ENTRIES 8
+#define GVIR_SANDBOX_BUILDER_INITRD_CACHE_STALE (60 * 60)
+
+typedef struct _GVirSandboxBuilderInitrdCacheEntry GVirSandboxBuilderInitrdCacheEntry;
+struct _GVirSandboxBuilderInitrdCacheEntry {
+    gchar *path;
+    time_t mtime;
+};
+
+
+static void gvir_sandbox_builder_initrd_checksum_string(GChecksum *sum,
+                                                        const gchar *str)
+{
+    /* Keep a NUL separator so that adjacent fields can't run together */
+    if (str)
+        g_checksum_update(sum, (const guchar *)str, strlen(str) + 1);
+    else
+        g_checksum_update(sum, (const guchar *)"", 1);
+}
+
+
+static void gvir_sandbox_builder_initrd_checksum_file(GChecksum *sum,
+                                                      const gchar *path)
 {
-    gchar *tmpdir = NULL;
+    struct stat sb;
+    gchar *id;
+
+    /* Hashing the file identity is far cheaper than hashing
+     * its content, and changes whenever it is replaced */
+    if (stat(path, &sb) < 0)
+        memset(&sb, 0, sizeof(sb));
+
+    id = g_strdup_printf("%s:%llu:%llu:%lld:%lld.%09ld",
+                         path,
+                         (unsigned long long)sb.st_dev,
+                         (unsigned long long)sb.st_ino,
+                         (long long)sb.st_size,
+                         (long long)sb.st_mtim.tv_sec,
+                         (long)sb.st_mtim.tv_nsec);
+    gvir_sandbox_builder_initrd_checksum_string(sum, id);
+    g_free(id);
+}
+
+
+static gchar *gvir_sandbox_builder_initrd_cache_key(GVirSandboxConfigInitrd *config)
+{
+    GChecksum *sum = g_checksum_new(G_CHECKSUM_SHA256);
+    const gchar *kmoddir = gvir_sandbox_config_initrd_get_kmoddir(config);
+    GList *modnames = gvir_sandbox_config_initrd_get_modules(config);
+    GList *tmp;
+    gchar *key;
+    gchar *level;
+
+    gvir_sandbox_builder_initrd_checksum_string(sum,
+        G_STRINGIFY(GVIR_SANDBOX_BUILDER_INITRD_CACHE_FORMAT));
+    gvir_sandbox_builder_initrd_checksum_string(sum,
+        gvir_sandbox_config_initrd_get_compression(config));
+    level = g_strdup_printf("%d", gvir_sandbox_config_initrd_get_compression_level(config));
+    gvir_sandbox_builder_initrd_checksum_string(sum, level);
+    g_free(level);
+    gvir_sandbox_builder_initrd_checksum_string(sum,
+        gvir_sandbox_config_initrd_get_kver(config));
+    gvir_sandbox_builder_initrd_checksum_string(sum, kmoddir);
+    gvir_sandbox_builder_initrd_checksum_file(sum,
+        gvir_sandbox_config_initrd_get_init(config));
+
+    /* depmod rewrites modules.dep whenever the module tree changes */
+    if (kmoddir) {
+        gchar *parent = g_path_get_dirname(kmoddir);
+        gchar *moddep = g_build_filename(parent, "modules.dep", NULL);
+        gvir_sandbox_builder_initrd_checksum_file(sum, kmoddir);
+        gvir_sandbox_builder_initrd_checksum_file(sum, moddep);
+        g_free(moddep);
+        g_free(parent);
+    }
+
+    for (tmp = modnames ; tmp ; tmp = tmp->next)
+        gvir_sandbox_builder_initrd_checksum_string(sum, tmp->data);
+
+    key = g_strdup(g_checksum_get_string(sum));
+
+    g_list_free(modnames);
+    g_checksum_free(sum);
+    return key;
+}
+
+
+static gint gvir_sandbox_builder_initrd_cache_entry_cmp(gconstpointer a,
+                                                        gconstpointer b)
+{
+    const GVirSandboxBuilderInitrdCacheEntry *ea = a;
+    const GVirSandboxBuilderInitrdCacheEntry *eb = b;
+
+    /* Most recently used first */
+    if (ea->mtime > eb->mtime)
+        return -1;
+    if (ea->mtime < eb->mtime)
+        return 1;
+    return 0;
+}
+
+
+/*
+ * Trims the cache back to its size limit, dropping the least
+ * recently used entries, along with temporary files left by
+ * builders that died. Sandboxes hold their own hard link to
+ * the ramdisk they booted, so removing an entry never pulls
+ * it from under them.
+ */
+static void gvir_sandbox_builder_initrd_cache_evict(const gchar *cachedir)
+{
+    GDir *dir = g_dir_open(cachedir, 0, NULL);
+    GList *entries = NULL, *tmp;
+    const gchar *name;
+    time_t now = time(NULL);
+    guint n = 0;
+
+    if (!dir)
+        return;
+
+    while ((name = g_dir_read_name(dir))) {
+        GVirSandboxBuilderInitrdCacheEntry *entry;
+        gchar *path = g_build_filename(cachedir, name, NULL);
+        struct stat sb;
+
+        if (lstat(path, &sb) < 0 || !S_ISREG(sb.st_mode)) {
+            g_free(path);
+            continue;
+        }
+
+        if (g_str_has_suffix(name, ".tmp")) {
+            if (sb.st_mtime + GVIR_SANDBOX_BUILDER_INITRD_CACHE_STALE < now)
+                unlink(path);
+            g_free(path);
+            continue;
+        }
+
+        if (!g_str_has_suffix(name, ".img")) {
+            g_free(path);
+            continue;
+        }
+
+        entry = g_new0(GVirSandboxBuilderInitrdCacheEntry, 1);
+        entry->path = path;
+        entry->mtime = sb.st_mtime;
+        entries = g_list_prepend(entries, entry);
+    }
+    g_dir_close(dir);
+
+    entries = g_list_sort(entries, gvir_sandbox_builder_initrd_cache_entry_cmp);
+    for (tmp = entries ; tmp ; tmp = tmp->next) {
+        GVirSandboxBuilderInitrdCacheEntry *entry = tmp->data;
+        if (n++ >= GVIR_SANDBOX_BUILDER_INITRD_CACHE_ENTRIES)
+            unlink(entry->path);
+        g_free(entry->path);
+        g_free(entry);
+    }
+    g_list_free(entries);
+}
+
+
+/*
+ * Makes @outputfile refer to the cached ramdisk @entry. Returns
+ * FALSE without setting @error if the entry does not exist.
+ */
+static gboolean gvir_sandbox_builder_initrd_cache_fetch(const gchar *entry,
+                                                        const gchar *outputfile,
+                                                        GError **error)
+{
+    if (unlink(outputfile) < 0 && errno != ENOENT) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
+                    _("Unable to remove %s: %s"),
+                    outputfile, strerror(errno));
+        return FALSE;
+    }
+
+    if (link(entry, outputfile) < 0) {
+        GFile *src, *tgt;
+        gboolean ret;
+
+        if (errno == ENOENT)
+            return FALSE;
+
+        /* Cache on another filesystem, so fall back to a copy */
+        src = g_file_new_for_path(entry);
+        tgt = g_file_new_for_path(outputfile);
+        ret = g_file_copy(src, tgt, G_FILE_COPY_OVERWRITE,
+                          NULL, NULL, NULL, error);
+        g_object_unref(src);
+        g_object_unref(tgt);
+        if (!ret)
+            return FALSE;
+    }
+
+    /* Mark the entry as recently used, for eviction */
+    utime(entry, NULL);
+    return TRUE;
+}
+
+
+static gboolean gvir_sandbox_builder_initrd_construct_cached(const gchar *cachedir,
+                                                             GVirSandboxConfigInitrd *config,
+                                                             const gchar *outputfile,
+                                                             GError **error)
+{
+    gchar *key = gvir_sandbox_builder_initrd_cache_key(config);
+    gchar *entry = g_strdup_printf("%s/%s.img", cachedir, key);
+    gchar *tmpfile = NULL;
     gboolean ret = FALSE;
-    GFile *tgt = g_file_new_for_path(outputfile);
-    mode_t mask;
+    GError *err = NULL;
 
-    mask = umask(0077);
+    if (g_mkdir_with_parents(cachedir, 0700) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
+                    _("Unable to create cache directory %s: %s"),
+                    cachedir, strerror(errno));
+        goto cleanup;
+    }
 
-    if (!(tmpdir = gvir_sandbox_builder_initrd_create_tempdir(error)))
+    if (gvir_sandbox_builder_initrd_cache_fetch(entry, outputfile, &err)) {
+        ret = TRUE;
         goto cleanup;
+    }
+    if (err) {
+        g_propagate_error(error, err);
+        goto cleanup;
+    }
 
-    if (!gvir_sandbox_builder_initrd_populate_tmpdir(tmpdir, config, error))
+    /* Build under a private name and then publish it atomically,
+     * so concurrent builders never see a partial ramdisk. If two
+     * race to build the same one, the last rename wins and both
+     * copies are identical anyway. */
+    tmpfile = g_strdup_printf("%s/%s.%d.%08x.tmp", cachedir, key,
+                              (int)getpid(), g_random_int());
+    if (!gvir_sandbox_builder_initrd_build(config, tmpfile, error))
         goto cleanup;
 
-    if (!gvir_sandbox_builder_initrd_create_initrd(tmpdir, outputfile, error))
+    if (rename(tmpfile, entry) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_INITRD_ERROR, errno,
+                    _("Unable to rename %s to %s: %s"),
+                    tmpfile, entry, strerror(errno));
+        unlink(tmpfile);
         goto cleanup;
+    }
+
+    gvir_sandbox_builder_initrd_cache_evict(cachedir);
+
+    /* Eviction by another builder can have raced with us */
+    if (!gvir_sandbox_builder_initrd_cache_fetch(entry, outputfile, &err)) {
+        if (err) {
+            g_propagate_error(error, err);
+            goto cleanup;
+        }
+        if (!gvir_sandbox_builder_initrd_build(config, outputfile, error))
+            goto cleanup;
+    }
 
     ret = TRUE;
  cleanup:
-    if (tmpdir &&
-        !gvir_sandbox_builder_initrd_remove_tmpdir(tmpdir, ret ? error : NULL))
-        ret = FALSE;
+    g_free(tmpfile);
+    g_free(entry);
+    g_free(key);
+    return ret;
+}
 
-    if (!ret && tgt)
-        g_file_delete(tgt, NULL, NULL);
 
-    umask(mask);
+gboolean gvir_sandbox_builder_initrd_construct(GVirSandboxBuilderInitrd *builder,
+                                               GVirSandboxConfigInitrd *config,
+                                               gchar *outputfile,
+                                               GError **error)
+{
+    GVirSandboxBuilderInitrdPrivate *priv = builder->priv;
 
-    return ret;
+    if (priv->cachedir)
+        return gvir_sandbox_builder_initrd_construct_cached(priv->cachedir,
+                                                            config,
+                                                            outputfile,
+                                                            error);
+
+    return gvir_sandbox_builder_initrd_build(config, outputfile, error);
 }
 
 /*
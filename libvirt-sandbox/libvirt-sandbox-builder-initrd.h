@@ -60,6 +60,10 @@ GType gvir_sandbox_builder_initrd_get_type(void);
 
 GVirSandboxBuilderInitrd *gvir_sandbox_builder_initrd_new(void);
 
+void gvir_sandbox_builder_initrd_set_cachedir(GVirSandboxBuilderInitrd *builder,
+                                              const gchar *cachedir);
+const gchar *gvir_sandbox_builder_initrd_get_cachedir(GVirSandboxBuilderInitrd *builder);
+
 gboolean gvir_sandbox_builder_initrd_construct(GVirSandboxBuilderInitrd *builder,
                                                GVirSandboxConfigInitrd *config,
                                                gchar *outputfile,
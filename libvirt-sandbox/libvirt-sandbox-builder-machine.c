@@ -23,7 +23,12 @@
 #include <config.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <sys/utsname.h>
+#include <time.h>
+#include <utime.h>
 
 #include <glib/gi18n.h>
 
@@ -145,6 +150,88 @@ static gchar *gvir_sandbox_builder_machine_get_kernpath(GVirSandboxConfig *confi
 }
 
 
+/*
+ * Checks the kernel build config installed alongside the kernel
+ * to see whether it can unpack an initrd compressed with @codec.
+ * If there is no such config, assume the user knows best.
+ */
+static gboolean gvir_sandbox_builder_machine_check_compression(GVirSandboxConfig *config,
+                                                               const gchar *codec,
+                                                               GError **error)
+{
+    gchar *kver = gvir_sandbox_builder_machine_get_kernrelease(config);
+    gchar *kernpath = gvir_sandbox_builder_machine_get_kernpath(config);
+    gchar *kerndir = g_path_get_dirname(kernpath);
+    gchar *configname = g_strdup_printf("config-%s", kver);
+    gchar *configpath = g_build_filename(kerndir, configname, NULL);
+    gchar *option = NULL;
+    gchar *contents = NULL;
+    gboolean ret = FALSE;
+
+    if (g_str_equal(codec, "none") ||
+        !g_file_get_contents(configpath, &contents, NULL, NULL)) {
+        ret = TRUE;
+        goto cleanup;
+    }
+
+    option = g_strdup_printf("\nCONFIG_RD_%s=y\n", codec);
+    g_ascii_strup(option, -1);
+    if (!strstr(contents, option)) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                    _("Kernel %s cannot unpack a %s compressed initrd"),
+                    kver, codec);
+        goto cleanup;
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_free(contents);
+    g_free(option);
+    g_free(configpath);
+    g_free(configname);
+    g_free(kerndir);
+    g_free(kernpath);
+    g_free(kver);
+    return ret;
+}
+
+
+/* Compression modules must be loaded ahead of zram, since the
+ * guest has no modprobe to load them on demand. Dependencies are
+ * listed too, for module trees without a modules.dep */
+static void gvir_sandbox_builder_machine_add_zram_modules(GVirSandboxConfig *config,
+                                                          GVirSandboxConfigInitrd *initrd)
+{
+    const gchar *algorithm = gvir_sandbox_config_get_zram_algorithm(config);
+
+    if (!algorithm ||
+        g_str_equal(algorithm, "lzo") ||
+        g_str_equal(algorithm, "lzo-rle")) {
+        gvir_sandbox_config_initrd_add_module(initrd, "lzo_compress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lzo_decompress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lzo.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lzo-rle.ko");
+    } else if (g_str_equal(algorithm, "lz4")) {
+        gvir_sandbox_config_initrd_add_module(initrd, "lz4_compress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lz4_decompress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lz4.ko");
+    } else if (g_str_equal(algorithm, "lz4hc")) {
+        gvir_sandbox_config_initrd_add_module(initrd, "lz4hc_compress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lz4_decompress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "lz4hc.ko");
+    } else if (g_str_equal(algorithm, "zstd")) {
+        gvir_sandbox_config_initrd_add_module(initrd, "xxhash.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "zstd_common.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "zstd_compress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "zstd_decompress.ko");
+        gvir_sandbox_config_initrd_add_module(initrd, "zstd.ko");
+    }
+
+    gvir_sandbox_config_initrd_add_module(initrd, "zsmalloc.ko");
+    gvir_sandbox_config_initrd_add_module(initrd, "zram.ko");
+}
+
+
 static gchar *gvir_sandbox_builder_machine_mkinitrd(GVirSandboxConfig *config,
                                                     const char *statedir,
                                                     GError **error)
@@ -154,9 +241,20 @@ static gchar *gvir_sandbox_builder_machine_mkinitrd(GVirSandboxConfig *config,
     gchar *targetfile = g_strdup_printf("%s/initrd.img", statedir);
     gchar *kver = gvir_sandbox_builder_machine_get_kernrelease(config);
     const gchar *kmodpath = gvir_sandbox_config_get_kmodpath(config);
+    gchar *cachedir;
     if (!kmodpath)
         kmodpath = "/lib/modules";
 
+    /* The ramdisk only changes when the kernel, its modules or
+     * our init do, so share one between all launches */
+    if (getuid())
+        cachedir = g_build_filename(g_get_user_cache_dir(),
+                                    "libvirt-sandbox", "initrd", NULL);
+    else
+        cachedir = g_build_filename(CACHEDIR, "initrd", NULL);
+    gvir_sandbox_builder_initrd_set_cachedir(builder, cachedir);
+    g_free(cachedir);
+
     gvir_sandbox_config_initrd_set_kver(initrd, kver);
     gchar *kmoddir = g_strdup_printf("%s/%s/kernel",
                                      kmodpath, kver);
@@ -164,6 +262,18 @@ static gchar *gvir_sandbox_builder_machine_mkinitrd(GVirSandboxConfig *config,
 
     gvir_sandbox_config_initrd_set_init(initrd, LIBEXECDIR "/libvirt-sandbox-init-qemu");
 
+    if (gvir_sandbox_config_get_initrd_compression(config)) {
+        const gchar *codec = gvir_sandbox_config_get_initrd_compression(config);
+        if (!gvir_sandbox_builder_machine_check_compression(config, codec, error))
+            goto cleanup;
+        gvir_sandbox_config_initrd_set_compression(initrd, codec);
+        gvir_sandbox_config_initrd_set_compression_level(initrd,
+            gvir_sandbox_config_get_initrd_compression_level(config));
+    }
+
+    /* With a modules.dep, dependencies would be pulled in anyway,
+     * but the name search used without one can't find them, so
+     * they are all listed, in load order */
     gvir_sandbox_config_initrd_add_module(initrd, "fscache.ko");
     gvir_sandbox_config_initrd_add_module(initrd, "virtio.ko");
     gvir_sandbox_config_initrd_add_module(initrd, "virtio_ring.ko");
@@ -175,15 +285,19 @@ static gchar *gvir_sandbox_builder_machine_mkinitrd(GVirSandboxConfig *config,
         gvir_sandbox_config_initrd_add_module(initrd, "virtio_net.ko");
     if (gvir_sandbox_config_has_mounts_with_type(config,
                                                  GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_IMAGE) ||
-        gvir_sandbox_config_has_disks(config))
+        gvir_sandbox_config_has_disks(config) ||
+        gvir_sandbox_config_has_volumes(config))
         gvir_sandbox_config_initrd_add_module(initrd, "virtio_blk.ko");
     gvir_sandbox_config_initrd_add_module(initrd, "virtio_console.ko");
-#if 0
-    gvir_sandbox_config_initrd_add_module(initrd, "virtio_balloon.ko");
-#endif
+    gvir_sandbox_config_initrd_add_module(initrd, "virtio_rng.ko");
+    if (gvir_sandbox_config_get_balloon(config))
+        gvir_sandbox_config_initrd_add_module(initrd, "virtio_balloon.ko");
     /* For dhclient to work */
     gvir_sandbox_config_initrd_add_module(initrd, "af_packet.ko");
 
+    if (gvir_sandbox_config_get_zram_size(config))
+        gvir_sandbox_builder_machine_add_zram_modules(config, initrd);
+
     /* In case ext4 is built as a module, include it and its deps
      * for the root mount */
     gvir_sandbox_config_initrd_add_module(initrd, "fscrypto.ko");
@@ -208,34 +322,351 @@ static gchar *gvir_sandbox_builder_machine_mkinitrd(GVirSandboxConfig *config,
 }
 
 
-static gchar *gvir_sandbox_builder_machine_copykern(GVirSandboxConfig *config,
+/* From xen/include/public/elfnote.h */
+#define XEN_ELFNOTE_PHYS32_ENTRY 18
+
+static gboolean gvir_sandbox_builder_machine_is_x86(GVirSandboxConfig *config)
+{
+    const gchar *arch = gvir_sandbox_config_get_arch(config);
+
+    return g_str_equal(arch, "x86_64") ||
+        (arch[0] == 'i' && g_str_has_suffix(arch, "86"));
+}
+
+
+/*
+ * QEMU can boot an uncompressed vmlinux through its PVH entry
+ * point, which skips the bzImage decompressor and the real mode
+ * setup code. Look for one built alongside the kernel, either
+ * next to the image or in its modules directory.
+ */
+static gchar *gvir_sandbox_builder_machine_find_vmlinux(GVirSandboxConfig *config)
+{
+    const gchar *kmodpath = gvir_sandbox_config_get_kmodpath(config);
+    gchar *kver = gvir_sandbox_builder_machine_get_kernrelease(config);
+    gchar *kernpath = gvir_sandbox_builder_machine_get_kernpath(config);
+    gchar *kerndir = g_path_get_dirname(kernpath);
+    gchar *name = g_strdup_printf("vmlinux-%s", kver);
+    gchar *candidates[5];
+    gchar *ret = NULL;
+    gsize i;
+
+    if (!kmodpath)
+        kmodpath = "/lib/modules";
+
+    candidates[0] = g_strdup(kernpath);
+    candidates[1] = g_build_filename(kerndir, name, NULL);
+    candidates[2] = g_build_filename(kmodpath, kver, "vmlinux", NULL);
+    candidates[3] = g_build_filename(kmodpath, kver, "build", "vmlinux", NULL);
+    candidates[4] = NULL;
+
+    /* PVH boot is specific to x86 */
+    if (!gvir_sandbox_builder_machine_is_x86(config))
+        goto cleanup;
+
+    for (i = 0 ; candidates[i] ; i++) {
+        if (access(candidates[i], R_OK) == 0 &&
+            gvir_sandbox_builder_elf_has_note(candidates[i], "Xen",
+                                              XEN_ELFNOTE_PHYS32_ENTRY)) {
+            ret = g_strdup(candidates[i]);
+            break;
+        }
+    }
+
+ cleanup:
+    for (i = 0 ; candidates[i] ; i++)
+        g_free(candidates[i]);
+    g_free(name);
+    g_free(kerndir);
+    g_free(kernpath);
+    g_free(kver);
+    return ret;
+}
+
+
+typedef struct _GVirSandboxBuilderMachineEntry GVirSandboxBuilderMachineEntry;
+struct _GVirSandboxBuilderMachineEntry {
+    gchar *path;
+    time_t mtime;
+};
+
+
+static gint gvir_sandbox_builder_machine_entry_cmp(gconstpointer a,
+                                                   gconstpointer b)
+{
+    const GVirSandboxBuilderMachineEntry *ea = a;
+    const GVirSandboxBuilderMachineEntry *eb = b;
+
+    /* Most recently used first */
+    if (ea->mtime > eb->mtime)
+        return -1;
+    if (ea->mtime < eb->mtime)
+        return 1;
+    return 0;
+}
+
+
+#define KERNEL_CACHE_ENTRIES 4
+
+/* Whether the hypervisor runs as a different, privileged, user */
+static gboolean gvir_sandbox_builder_machine_is_privileged(GVirSandboxBuilder *builder)
+{
+    GVirConnection *connection = gvir_sandbox_builder_get_connection(builder);
+    gboolean ret = g_str_equal(gvir_connection_get_uri(connection),
+                               "qemu:///system");
+
+    g_object_unref(connection);
+    return ret;
+}
+
+
+static void gvir_sandbox_builder_machine_evict_kernels(const gchar *cachedir)
+{
+    GDir *dir = g_dir_open(cachedir, 0, NULL);
+    GList *entries = NULL, *tmp;
+    const gchar *name;
+    guint n = 0;
+
+    if (!dir)
+        return;
+
+    while ((name = g_dir_read_name(dir))) {
+        GVirSandboxBuilderMachineEntry *entry;
+        gchar *path = g_build_filename(cachedir, name, NULL);
+        struct stat sb;
+
+        if (lstat(path, &sb) < 0 || !S_ISREG(sb.st_mode) ||
+            !g_str_has_suffix(name, ".kernel")) {
+            g_free(path);
+            continue;
+        }
+
+        entry = g_new0(GVirSandboxBuilderMachineEntry, 1);
+        entry->path = path;
+        entry->mtime = sb.st_mtime;
+        entries = g_list_prepend(entries, entry);
+    }
+    g_dir_close(dir);
+
+    entries = g_list_sort(entries, gvir_sandbox_builder_machine_entry_cmp);
+    for (tmp = entries ; tmp ; tmp = tmp->next) {
+        GVirSandboxBuilderMachineEntry *entry = tmp->data;
+        if (n++ >= KERNEL_CACHE_ENTRIES)
+            unlink(entry->path);
+        g_free(entry->path);
+        g_free(entry);
+    }
+    g_list_free(entries);
+}
+
+
+/*
+ * Makes a private copy of the kernel @source in the kernel cache,
+ * unless one already exists there, and returns its path. The
+ * copy is named after the identity of @source, so it is redone
+ * whenever the kernel is updated.
+ */
+static gchar *gvir_sandbox_builder_machine_cache_kernel(const gchar *source,
+                                                        GError **error)
+{
+    gchar *cachedir = g_build_filename(CACHEDIR, "kernel", NULL);
+    gchar *entry = NULL;
+    gchar *tmpfile = NULL;
+    gchar *key = NULL;
+    GFile *sfile = NULL;
+    GFile *tfile = NULL;
+    gboolean ret = FALSE;
+    struct stat sb;
+
+    if (stat(source, &sb) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                    _("Unable to access kernel %s: %s"),
+                    source, strerror(errno));
+        goto cleanup;
+    }
+
+    if (g_mkdir_with_parents(cachedir, 0700) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                    _("Unable to create cache directory %s: %s"),
+                    cachedir, strerror(errno));
+        goto cleanup;
+    }
+
+    key = g_compute_checksum_for_string(G_CHECKSUM_SHA256, source, -1);
+    entry = g_strdup_printf("%s/%s-%llu-%llu-%llu.kernel", cachedir, key,
+                            (unsigned long long)sb.st_dev,
+                            (unsigned long long)sb.st_ino,
+                            (unsigned long long)sb.st_mtime);
+
+    if (access(entry, R_OK) < 0) {
+        /* Publish atomically, for the benefit of concurrent launches */
+        tmpfile = g_strdup_printf("%s.%d.tmp", entry, (int)getpid());
+        sfile = g_file_new_for_path(source);
+        tfile = g_file_new_for_path(tmpfile);
+        if (!g_file_copy(sfile, tfile, G_FILE_COPY_OVERWRITE,
+                         NULL, NULL, NULL, error))
+            goto cleanup;
+
+        if (rename(tmpfile, entry) < 0) {
+            g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                        _("Unable to rename %s to %s: %s"),
+                        tmpfile, entry, strerror(errno));
+            unlink(tmpfile);
+            goto cleanup;
+        }
+    }
+
+    /* Mark the entry as recently used, for eviction */
+    utime(entry, NULL);
+    gvir_sandbox_builder_machine_evict_kernels(cachedir);
+
+    ret = TRUE;
+ cleanup:
+    if (sfile)
+        g_object_unref(sfile);
+    if (tfile)
+        g_object_unref(tfile);
+    if (!ret) {
+        g_free(entry);
+        entry = NULL;
+    }
+    g_free(tmpfile);
+    g_free(key);
+    g_free(cachedir);
+    return entry;
+}
+
+
+static gchar *gvir_sandbox_builder_machine_copykern(GVirSandboxBuilder *builder,
+                                                    GVirSandboxConfig *config,
                                                     const char *statedir,
                                                     GError **error)
 {
-    gchar *target = g_strdup_printf("%s/vmlinuz", statedir);
-    gchar *source = gvir_sandbox_builder_machine_get_kernpath(config);
+    gchar *target = NULL;
+    gchar *source;
+    gchar *cached = NULL;
     gboolean ret = FALSE;
-    GFile *tfile = g_file_new_for_path(target);
-    GFile *sfile = g_file_new_for_path(source);
+    GFile *tfile = NULL;
+    GFile *sfile = NULL;
+
+    if (!(source = gvir_sandbox_builder_machine_find_vmlinux(config)))
+        source = gvir_sandbox_builder_machine_get_kernpath(config);
+
+    /* An unprivileged hypervisor runs as us, so it can use the
+     * kernel where it is. A privileged one would relabel it, so
+     * it gets a private copy instead, which is kept in a cache
+     * since an uncompressed kernel is large. */
+    if (!gvir_sandbox_builder_machine_is_privileged(builder)) {
+        if (access(source, R_OK) == 0) {
+            target = source;
+            source = NULL;
+            ret = TRUE;
+            goto cleanup;
+        }
+    } else {
+        if (!(cached = gvir_sandbox_builder_machine_cache_kernel(source, error)))
+            goto cleanup;
+    }
+
+    target = g_strdup_printf("%s/vmlinuz", statedir);
+
+    /* A hard link keeps the kernel alive if the cache evicts it */
+    if (cached) {
+        if (unlink(target) < 0 && errno != ENOENT) {
+            g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                        _("Unable to remove %s: %s"),
+                        target, strerror(errno));
+            goto cleanup;
+        }
+        if (link(cached, target) == 0) {
+            ret = TRUE;
+            goto cleanup;
+        }
+        /* Cache on another filesystem, so fall back to a copy */
+        g_free(source);
+        source = cached;
+        cached = NULL;
+    }
+
+    tfile = g_file_new_for_path(target);
+    sfile = g_file_new_for_path(source);
 
-    if (!g_file_copy(sfile, tfile, G_FILE_COPY_NONE,
+    if (!g_file_copy(sfile, tfile, G_FILE_COPY_OVERWRITE,
                      NULL, NULL, NULL, error))
         goto cleanup;
 
     ret = TRUE;
  cleanup:
     g_free(source);
+    g_free(cached);
     if (!ret) {
         g_free(target);
         target = NULL;
     }
-    g_object_unref(sfile);
-    g_object_unref(tfile);
+    if (sfile)
+        g_object_unref(sfile);
+    if (tfile)
+        g_object_unref(tfile);
     return target;
 }
 
 
-static gchar *gvir_sandbox_builder_machine_cmdline(GVirSandboxConfig *config G_GNUC_UNUSED)
+static gboolean gvir_sandbox_builder_machine_use_readahead(GVirSandboxConfig *config)
+{
+    /* Trace paths are relative to the root directory, which a
+     * custom root mount would replace */
+    return gvir_sandbox_config_get_readahead(config) &&
+        !gvir_sandbox_config_has_root_mount(config);
+}
+
+
+/* Slots 0 to 2 of the root bus hold the host bridge, the ISA
+ * bridge and its functions, and the reserved video slot */
+#define PCI_ROOT_BUS_SLOTS 29
+
+/*
+ * Counts the PCI devices that construct_devices will add, erring
+ * on the high side. Once they overflow the root bus, libvirt puts
+ * the rest behind a pci-bridge.
+ */
+static gsize gvir_sandbox_builder_machine_count_objects(GList *objects)
+{
+    gsize n = g_list_length(objects);
+
+    g_list_foreach(objects, (GFunc)g_object_unref, NULL);
+    g_list_free(objects);
+    return n;
+}
+
+
+static gsize gvir_sandbox_builder_machine_count_pci(GVirSandboxConfig *config)
+{
+    GList *mounts = gvir_sandbox_config_get_mounts(config);
+    GList *tmp;
+    gsize n;
+
+    /* Root, config and library filesystems, balloon, rng and
+     * the virtio-serial controller */
+    n = 6;
+    if (gvir_sandbox_builder_machine_use_readahead(config))
+        n++;
+    n += gvir_sandbox_builder_machine_count_objects(gvir_sandbox_config_get_disks(config));
+    n += gvir_sandbox_builder_machine_count_objects(gvir_sandbox_config_get_volumes(config));
+    n += gvir_sandbox_builder_machine_count_objects(gvir_sandbox_config_get_networks(config));
+
+    for (tmp = mounts ; tmp ; tmp = tmp->next) {
+        if (GVIR_SANDBOX_IS_CONFIG_MOUNT_HOST_BIND(tmp->data) ||
+            GVIR_SANDBOX_IS_CONFIG_MOUNT_HOST_IMAGE(tmp->data))
+            n++;
+    }
+
+    g_list_foreach(mounts, (GFunc)g_object_unref, NULL);
+    g_list_free(mounts);
+    return n;
+}
+
+
+static gchar *gvir_sandbox_builder_machine_cmdline(GVirSandboxConfig *config)
 {
     GString *str = g_string_new("");
     gchar *ret;
@@ -269,13 +700,200 @@ static gchar *gvir_sandbox_builder_machine_cmdline(GVirSandboxConfig *config G_G
      * service based sandboxes */
     g_string_append(str, " selinux=0");
 
+    if (gvir_sandbox_config_get_fastboot(config) &&
+        gvir_sandbox_builder_machine_is_x86(config)) {
+        /* Don't scan for buses behind bridges, unless our devices
+         * overflow the root bus and need one */
+        if (gvir_sandbox_builder_machine_count_pci(config) <= PCI_ROOT_BUS_SLOTS)
+            g_string_append(str, " pci=lastbus=0");
+        /* Only probe the serial ports we actually add */
+        g_string_append_printf(str, " 8250.nr_uarts=%d",
+                               gvir_sandbox_config_get_shell(config) ? 2 : 1);
+        /* There is nothing behind the PS/2 controller */
+        g_string_append(str, " i8042.noaux i8042.nomux i8042.nopnp i8042.dumbkbd");
+        /* The TSC is stable under KVM, so skip calibrating it */
+        g_string_append(str, " tsc=reliable no_timer_check");
+    }
+
+    if (gvir_sandbox_config_get_fastboot(config)) {
+        g_string_append(str, " cryptomgr.notests");
+        g_string_append(str, " rcupdate.rcu_expedited=1");
+        g_string_append(str, " random.trust_cpu=on");
+        g_string_append(str, " nowatchdog");
+    }
+
     ret = str->str;
     g_string_free(str, FALSE);
     return ret;
 }
 
 
-static gboolean gvir_sandbox_builder_machine_write_mount_cfg(GVirSandboxConfig *config,
+#define READAHEAD_THREADS 4
+#define READAHEAD_MAX_FILES 4096
+#define READAHEAD_MAX_SIZE (16 * 1024 * 1024)
+#define READAHEAD_MAX_TRACES 16
+#define READAHEAD_STALE (30 * 24 * 60 * 60)
+
+/*
+ * Traces are kept per command, since the same sandbox name is
+ * commonly reused to launch unrelated programs.
+ */
+static gchar *gvir_sandbox_builder_machine_get_readahead_dir(GVirSandboxConfig *config,
+                                                             const gchar *statedir)
+{
+    GChecksum *sum = g_checksum_new(G_CHECKSUM_SHA256);
+    gchar **command = gvir_sandbox_config_get_command(config);
+    gchar *dir;
+    gsize i;
+
+    g_checksum_update(sum, (const guchar *)gvir_sandbox_config_get_root(config), -1);
+    for (i = 0 ; command && command[i] ; i++) {
+        g_checksum_update(sum, (const guchar *)"", 1);
+        g_checksum_update(sum, (const guchar *)command[i], -1);
+    }
+
+    dir = g_build_filename(statedir, "readahead", g_checksum_get_string(sum), NULL);
+
+    g_strfreev(command);
+    g_checksum_free(sum);
+    return dir;
+}
+
+
+static void gvir_sandbox_builder_machine_readahead_file(gpointer data,
+                                                        gpointer opaque G_GNUC_UNUSED)
+{
+    gchar *path = data;
+    struct stat sb;
+    int fd;
+
+    /* The trace is written by the guest, so only follow it to
+     * plain files */
+    if (lstat(path, &sb) < 0 ||
+        !S_ISREG(sb.st_mode))
+        goto cleanup;
+
+    if ((fd = open(path, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC)) < 0)
+        goto cleanup;
+
+    posix_fadvise(fd, 0, MIN(sb.st_size, READAHEAD_MAX_SIZE),
+                  POSIX_FADV_WILLNEED);
+    close(fd);
+
+ cleanup:
+    g_free(path);
+}
+
+
+/*
+ * The guest root is served over 9p from the host page cache, so
+ * reading the traced files ahead on the host, while the guest is
+ * still booting, saves a synchronous round trip to disk for each
+ * of them later on.
+ */
+static void gvir_sandbox_builder_machine_replay_readahead(GVirSandboxConfig *config,
+                                                          const gchar *tracedir)
+{
+    gchar *tracefile = g_build_filename(tracedir, "trace", NULL);
+    gchar *data = NULL;
+    gchar **paths = NULL;
+    GThreadPool *pool;
+    gsize i;
+
+    if (!g_file_get_contents(tracefile, &data, NULL, NULL))
+        goto cleanup;
+
+    if (!(pool = g_thread_pool_new(gvir_sandbox_builder_machine_readahead_file,
+                                   NULL, READAHEAD_THREADS, FALSE, NULL)))
+        goto cleanup;
+
+    paths = g_strsplit(data, "\n", READAHEAD_MAX_FILES + 1);
+    for (i = 0 ; paths[i] && i < READAHEAD_MAX_FILES ; i++) {
+        if (paths[i][0] != '/' ||
+            strstr(paths[i], "/../") ||
+            g_str_has_suffix(paths[i], "/.."))
+            continue;
+
+        g_thread_pool_push(pool,
+                           g_build_filename(gvir_sandbox_config_get_root(config),
+                                            paths[i], NULL),
+                           NULL);
+    }
+
+    /* Returns immediately, the queued files are still processed */
+    g_thread_pool_free(pool, FALSE, FALSE);
+
+ cleanup:
+    g_strfreev(paths);
+    g_free(data);
+    g_free(tracefile);
+}
+
+
+/*
+ * Every distinct command gets its own trace, so drop the traces
+ * of commands that have not been launched for a while, and all
+ * but the most recently launched ones.
+ */
+static void gvir_sandbox_builder_machine_evict_readahead(const gchar *statedir)
+{
+    gchar *tracesdir = g_build_filename(statedir, "readahead", NULL);
+    GList *traces = NULL, *tmp;
+    time_t now = time(NULL);
+    const gchar *name;
+    GDir *dir;
+    guint n = 0;
+
+    if (!(dir = g_dir_open(tracesdir, 0, NULL)))
+        goto cleanup;
+
+    while ((name = g_dir_read_name(dir))) {
+        GVirSandboxBuilderMachineEntry *trace;
+        gchar *path = g_build_filename(tracesdir, name, NULL);
+        struct stat sb;
+
+        if (lstat(path, &sb) < 0 || !S_ISDIR(sb.st_mode)) {
+            g_free(path);
+            continue;
+        }
+
+        trace = g_new0(GVirSandboxBuilderMachineEntry, 1);
+        trace->path = path;
+        trace->mtime = sb.st_mtime;
+        traces = g_list_prepend(traces, trace);
+    }
+    g_dir_close(dir);
+
+    traces = g_list_sort(traces, gvir_sandbox_builder_machine_entry_cmp);
+    for (tmp = traces ; tmp ; tmp = tmp->next) {
+        GVirSandboxBuilderMachineEntry *trace = tmp->data;
+
+        if (n++ >= READAHEAD_MAX_TRACES ||
+            trace->mtime + READAHEAD_STALE < now) {
+            GDir *files = g_dir_open(trace->path, 0, NULL);
+
+            if (files) {
+                while ((name = g_dir_read_name(files))) {
+                    gchar *file = g_build_filename(trace->path, name, NULL);
+                    unlink(file);
+                    g_free(file);
+                }
+                g_dir_close(files);
+            }
+            rmdir(trace->path);
+        }
+        g_free(trace->path);
+        g_free(trace);
+    }
+    g_list_free(traces);
+
+ cleanup:
+    g_free(tracesdir);
+}
+
+
+static gboolean gvir_sandbox_builder_machine_write_mount_cfg(GVirSandboxBuilder *builder,
+                                                             GVirSandboxConfig *config,
                                                              const gchar *statedir,
                                                              GError **error)
 {
@@ -290,6 +908,7 @@ static gboolean gvir_sandbox_builder_machine_write_mount_cfg(GVirSandboxConfig *
     gboolean ret = FALSE;
     GList *mounts = gvir_sandbox_config_get_mounts(config);
     GList *disks = gvir_sandbox_config_get_disks(config);
+    GList *volumes = gvir_sandbox_config_get_volumes(config);
     GList *tmp = NULL;
     size_t nHostBind = 0;
     guint nVirtioDev = g_list_length(disks);
@@ -297,6 +916,33 @@ static gboolean gvir_sandbox_builder_machine_write_mount_cfg(GVirSandboxConfig *
     if (!fos)
         goto cleanup;
 
+    /* Raw volumes sit right after the disks, the rest follow them */
+    for (tmp = volumes ; tmp ; tmp = tmp->next) {
+        if (!gvir_sandbox_config_volume_get_target(GVIR_SANDBOX_CONFIG_VOLUME(tmp->data)))
+            nVirtioDev++;
+    }
+
+    for (tmp = volumes ; tmp ; tmp = tmp->next) {
+        GVirSandboxConfigVolume *vconfig = GVIR_SANDBOX_CONFIG_VOLUME(tmp->data);
+        const gchar *target = gvir_sandbox_config_volume_get_target(vconfig);
+        gchar *line;
+
+        if (!target)
+            continue;
+
+        /* Input volumes are attached read-only */
+        line = g_strdup_printf("/dev/vd%c\t%s\text4\t%s\n",
+                               (char)('a' + nVirtioDev++), target,
+                               gvir_sandbox_config_volume_get_output(vconfig) ? "" : "ro");
+        if (!g_output_stream_write_all(G_OUTPUT_STREAM(fos),
+                                       line, strlen(line),
+                                       NULL, NULL, error)) {
+            g_free(line);
+            goto cleanup;
+        }
+        g_free(line);
+    }
+
     tmp = mounts;
     while (tmp) {
         GVirSandboxConfigMount *mconfig = GVIR_SANDBOX_CONFIG_MOUNT(tmp->data);
@@ -346,6 +992,24 @@ static gboolean gvir_sandbox_builder_machine_write_mount_cfg(GVirSandboxConfig *
         tmp = tmp->next;
     }
 
+    if (gvir_sandbox_builder_machine_use_readahead(config)) {
+        const gchar *line = "sandbox:readahead\t" SANDBOXCONFIGDIR "/readahead\t9p\t"
+            "trans=virtio,version=9p2000.u\n";
+        if (!g_output_stream_write_all(G_OUTPUT_STREAM(fos),
+                                       line, strlen(line),
+                                       NULL, NULL, error))
+            goto cleanup;
+    }
+
+    if (gvir_sandbox_builder_get_libsdir(builder)) {
+        const gchar *line = "sandbox:libs\t" SANDBOXCONFIGDIR "/.libs\t9p\t"
+            "trans=virtio,version=9p2000.u\n";
+        if (!g_output_stream_write_all(G_OUTPUT_STREAM(fos),
+                                       line, strlen(line),
+                                       NULL, NULL, error))
+            goto cleanup;
+    }
+
     if (!g_output_stream_close(G_OUTPUT_STREAM(fos), NULL, error))
         goto cleanup;
 
@@ -359,6 +1023,8 @@ static gboolean gvir_sandbox_builder_machine_write_mount_cfg(GVirSandboxConfig *
     g_list_foreach(mounts, (GFunc)g_object_unref, NULL);
     g_list_free(mounts);
     g_list_free(disks);
+    g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(volumes);
     if (fos)
         g_object_unref(fos);
     if (!ret)
@@ -375,15 +1041,17 @@ static gboolean gvir_sandbox_builder_machine_construct_domain(GVirSandboxBuilder
                                                               GVirConfigDomain *domain,
                                                               GError **error)
 {
-    if (!gvir_sandbox_builder_machine_write_mount_cfg(config,
-                                                      statedir,
-                                                      error))
-        return FALSE;
-
+    /* The parent stages the libraries, which decides the mounts */
     if (!GVIR_SANDBOX_BUILDER_CLASS(gvir_sandbox_builder_machine_parent_class)->
         construct_domain(builder, config, statedir, domain, error))
         return FALSE;
 
+    if (!gvir_sandbox_builder_machine_write_mount_cfg(builder,
+                                                      config,
+                                                      statedir,
+                                                      error))
+        return FALSE;
+
     return TRUE;
 }
 
@@ -393,10 +1061,37 @@ static gboolean gvir_sandbox_builder_machine_construct_basic(GVirSandboxBuilder
                                                              GVirConfigDomain *domain,
                                                              GError **error)
 {
+    guint64 hugepages = gvir_sandbox_config_get_hugepages(config);
+    guint64 memory = gvir_sandbox_config_get_memory(config);
+    gchar *backing;
+
     if (!GVIR_SANDBOX_BUILDER_CLASS(gvir_sandbox_builder_machine_parent_class)->
         construct_basic(builder, config, statedir, domain, error))
         return FALSE;
 
+    if (gvir_sandbox_config_get_balloon(config) &&
+        gvir_sandbox_config_get_max_memory(config) > memory)
+        memory = gvir_sandbox_config_get_max_memory(config);
+    /* QEMU can't back a partial huge page */
+    if (hugepages && memory % hugepages) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                    _("Memory size %llu KiB is not a multiple of the %llu KiB huge pages"),
+                    (unsigned long long)memory / 1024,
+                    (unsigned long long)hugepages / 1024);
+        return FALSE;
+    }
+
+    /* Without a balloon QEMU ignores currentMemory, and the guest
+     * would get the whole max size from the start */
+    if (gvir_sandbox_config_get_balloon(config) &&
+        gvir_sandbox_config_get_max_memory(config) >
+        gvir_sandbox_config_get_memory(config)) {
+        gvir_config_domain_set_memory(domain,
+                                      gvir_sandbox_config_get_max_memory(config) / 1024);
+        gvir_config_domain_set_current_memory(domain,
+                                              gvir_sandbox_config_get_memory(config) / 1024);
+    }
+
     if (access("/dev/kvm", W_OK) == 0)
         gvir_config_domain_set_virt_type(domain,
                                          GVIR_CONFIG_DOMAIN_VIRT_KVM);
@@ -414,6 +1109,29 @@ static gboolean gvir_sandbox_builder_machine_construct_basic(GVirSandboxBuilder
                                      GVIR_CONFIG_DOMAIN_LIFECYCLE_ON_CRASH,
                                      GVIR_CONFIG_DOMAIN_LIFECYCLE_DESTROY);
 
+    if (gvir_sandbox_config_get_cpu_sockets(config)) {
+        GVirConfigDomainCpu *cpu = gvir_config_domain_cpu_new();
+        GVirConfigCapabilitiesCpuTopology *topology =
+            gvir_config_capabilities_cpu_topology_new();
+
+        gvir_config_capabilities_cpu_topology_set_sockets(topology,
+                                                          gvir_sandbox_config_get_cpu_sockets(config));
+        gvir_config_capabilities_cpu_topology_set_cores(topology,
+                                                        gvir_sandbox_config_get_cpu_cores(config));
+        gvir_config_capabilities_cpu_topology_set_threads(topology,
+                                                          gvir_sandbox_config_get_cpu_threads(config));
+        gvir_config_capabilities_cpu_set_topology(GVIR_CONFIG_CAPABILITIES_CPU(cpu),
+                                                  topology);
+        gvir_config_domain_set_cpu(domain, cpu);
+        g_object_unref(topology);
+        g_object_unref(cpu);
+    }
+
+    if ((backing = gvir_sandbox_builder_xml_memory_backing(config))) {
+        gvir_sandbox_builder_add_xml(builder, "domain", backing);
+        g_free(backing);
+    }
+
     return TRUE;
 }
 
@@ -440,7 +1158,8 @@ static gboolean gvir_sandbox_builder_machine_construct_os(GVirSandboxBuilder *bu
                                                          error)))
         return FALSE;
 
-    if (!(kernel = gvir_sandbox_builder_machine_copykern(config,
+    if (!(kernel = gvir_sandbox_builder_machine_copykern(builder,
+                                                         config,
                                                          statedir,
                                                          error))) {
         g_free(initrd);
@@ -506,15 +1225,17 @@ static gboolean gvir_sandbox_builder_machine_construct_devices(GVirSandboxBuilde
 {
     GVirConfigDomainFilesys *fs;
     GVirConfigDomainDisk *disk;
-    GVirConfigDomainDiskDriver *diskDriver;
-    GVirConfigDomainInterface *iface;
     GVirConfigDomainMemballoon *ball;
+    gchar *balloon;
     GVirConfigDomainConsole *con;
     GVirConfigDomainSerial *ser;
     GVirConfigDomainChardevSourcePty *src;
     GList *tmp = NULL, *mounts = NULL, *networks = NULL, *disks = NULL;
+    GList *volumes = NULL;
     size_t nHostBind = 0;
     size_t nVirtioDev = 0;
+    guint nIOThreads = 0;
+    size_t i;
     gchar *configdir = g_strdup_printf("%s/config", statedir);
     gboolean ret = FALSE;
 
@@ -548,6 +1269,49 @@ static gboolean gvir_sandbox_builder_machine_construct_devices(GVirSandboxBuilde
                                   GVIR_CONFIG_DOMAIN_DEVICE(fs));
     g_object_unref(fs);
 
+    if (gvir_sandbox_builder_get_libsdir(builder)) {
+        fs = gvir_config_domain_filesys_new();
+        gvir_config_domain_filesys_set_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_MOUNT);
+        gvir_config_domain_filesys_set_access_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_ACCESS_SQUASH);
+        gvir_config_domain_filesys_set_source(fs, gvir_sandbox_builder_get_libsdir(builder));
+        gvir_config_domain_filesys_set_target(fs, "sandbox:libs");
+        gvir_config_domain_filesys_set_readonly(fs, TRUE);
+
+        gvir_config_domain_add_device(domain,
+                                      GVIR_CONFIG_DOMAIN_DEVICE(fs));
+        g_object_unref(fs);
+    }
+
+
+    if (gvir_sandbox_builder_machine_use_readahead(config)) {
+        gchar *tracedir = gvir_sandbox_builder_machine_get_readahead_dir(config, statedir);
+        gchar *mountdir = g_build_filename(configdir, "readahead", NULL);
+
+        g_mkdir_with_parents(tracedir, 0700);
+        g_mkdir_with_parents(mountdir, 0755);
+
+        /* Mark the trace as used, so eviction keeps it */
+        utime(tracedir, NULL);
+        gvir_sandbox_builder_machine_evict_readahead(statedir);
+
+        gvir_sandbox_builder_machine_replay_readahead(config, tracedir);
+
+        fs = gvir_config_domain_filesys_new();
+        gvir_config_domain_filesys_set_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_MOUNT);
+        if (getuid() == 0)
+            gvir_config_domain_filesys_set_access_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_ACCESS_PASSTHROUGH);
+        else
+            gvir_config_domain_filesys_set_access_type(fs, GVIR_CONFIG_DOMAIN_FILESYS_ACCESS_SQUASH);
+        gvir_config_domain_filesys_set_source(fs, tracedir);
+        gvir_config_domain_filesys_set_target(fs, "sandbox:readahead");
+
+        gvir_config_domain_add_device(domain,
+                                      GVIR_CONFIG_DOMAIN_DEVICE(fs));
+        g_object_unref(fs);
+        g_free(mountdir);
+        g_free(tracedir);
+    }
+
 
     tmp = disks = gvir_sandbox_config_get_disks(config);
     while (tmp) {
@@ -556,21 +1320,23 @@ static gboolean gvir_sandbox_builder_machine_construct_devices(GVirSandboxBuilde
         if (GVIR_SANDBOX_IS_CONFIG_DISK(dconfig)) {
             gchar *device = g_strdup_printf("vd%c", (char)('a' + nVirtioDev++));
 
-            disk = gvir_config_domain_disk_new();
-            diskDriver = gvir_config_domain_disk_driver_new();
-            gvir_config_domain_disk_set_type(disk,
-                                             gvir_sandbox_config_disk_get_disk_type(dconfig));
-            gvir_config_domain_disk_driver_set_format(diskDriver,
-                                                      gvir_sandbox_config_disk_get_format(dconfig));
-            gvir_config_domain_disk_set_source(disk, gvir_sandbox_config_disk_get_source(dconfig));
-            gvir_config_domain_disk_set_target_bus(disk,
-                                                   GVIR_CONFIG_DOMAIN_DISK_BUS_VIRTIO);
-            gvir_config_domain_disk_set_target_dev(disk,
-                                                   device);
-            gvir_config_domain_disk_set_driver(disk, diskDriver);
-            gvir_config_domain_add_device(domain, GVIR_CONFIG_DOMAIN_DEVICE(disk));
-            g_object_unref(disk);
+            disk = gvir_sandbox_builder_xml_disk(config, dconfig,
+                                                 gvir_sandbox_config_disk_get_disk_type(dconfig),
+                                                 gvir_sandbox_config_disk_get_source(dconfig),
+                                                 gvir_sandbox_config_disk_get_format(dconfig),
+                                                 device, FALSE, NULL,
+                                                 (gvir_sandbox_config_disk_get_iothread(dconfig) ||
+                                                  gvir_sandbox_config_get_disk_iothread(config)) ?
+                                                 ++nIOThreads : 0, error);
             g_free(device);
+            if (!disk) {
+                g_list_foreach(disks, (GFunc)g_object_unref, NULL);
+                g_list_free(disks);
+                goto cleanup;
+            }
+            gvir_config_domain_add_device(domain,
+                                          GVIR_CONFIG_DOMAIN_DEVICE(disk));
+            g_object_unref(disk);
         }
         tmp = tmp->next;
     }
@@ -578,6 +1344,39 @@ static gboolean gvir_sandbox_builder_machine_construct_devices(GVirSandboxBuilde
     g_list_foreach(disks, (GFunc)g_object_unref, NULL);
     g_list_free(disks);
 
+    /* Raw volumes first, matching the order in disks.cfg */
+    volumes = gvir_sandbox_config_get_volumes(config);
+    for (i = 0 ; i < 2 ; i++) {
+        for (tmp = volumes ; tmp ; tmp = tmp->next) {
+            GVirSandboxConfigVolume *vconfig = GVIR_SANDBOX_CONFIG_VOLUME(tmp->data);
+            gboolean raw = gvir_sandbox_config_volume_get_target(vconfig) == NULL;
+            gchar *device;
+            gchar *source;
+
+            if (raw != (i == 0))
+                continue;
+
+            device = g_strdup_printf("vd%c", (char)('a' + nVirtioDev++));
+            source = gvir_sandbox_builder_get_volume_path(vconfig, statedir);
+
+            disk = gvir_sandbox_builder_xml_volume(config, vconfig, source, device,
+                                                   gvir_sandbox_config_get_disk_iothread(config) ?
+                                                   ++nIOThreads : 0, error);
+            g_free(source);
+            g_free(device);
+            if (!disk) {
+                g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+                g_list_free(volumes);
+                goto cleanup;
+            }
+            gvir_config_domain_add_device(domain,
+                                          GVIR_CONFIG_DOMAIN_DEVICE(disk));
+            g_object_unref(disk);
+        }
+    }
+    g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(volumes);
+
     tmp = mounts = gvir_sandbox_config_get_mounts(config);
     while (tmp) {
         GVirSandboxConfigMount *mconfig = GVIR_SANDBOX_CONFIG_MOUNT(tmp->data);
@@ -605,62 +1404,58 @@ static gboolean gvir_sandbox_builder_machine_construct_devices(GVirSandboxBuilde
         } else if (GVIR_SANDBOX_IS_CONFIG_MOUNT_HOST_IMAGE(mconfig)) {
             GVirSandboxConfigMountFile *mfile = GVIR_SANDBOX_CONFIG_MOUNT_FILE(mconfig);
             GVirSandboxConfigMountHostImage *mimage = GVIR_SANDBOX_CONFIG_MOUNT_HOST_IMAGE(mconfig);
-            GVirConfigDomainDiskFormat format;
             gchar *target = g_strdup_printf("vd%c", (char)('a' + nVirtioDev++));
 
-            disk = gvir_config_domain_disk_new();
-            gvir_config_domain_disk_set_type(disk, GVIR_CONFIG_DOMAIN_DISK_FILE);
-            gvir_config_domain_disk_set_source(disk,
-                                               gvir_sandbox_config_mount_file_get_source(mfile));
-            gvir_config_domain_disk_set_target_dev(disk, target);
-
-            diskDriver = gvir_config_domain_disk_driver_new();
-            format = gvir_sandbox_config_mount_host_image_get_format(mimage);
-            gvir_config_domain_disk_driver_set_format(diskDriver, format);
-            gvir_config_domain_disk_set_driver(disk, diskDriver);
-
+            disk = gvir_sandbox_builder_xml_disk(config, NULL,
+                                                 GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                                 gvir_sandbox_config_mount_file_get_source(mfile),
+                                                 gvir_sandbox_config_mount_host_image_get_format(mimage),
+                                                 target, FALSE, NULL,
+                                                 gvir_sandbox_config_get_disk_iothread(config) ?
+                                                 ++nIOThreads : 0, error);
+            g_free(target);
+            if (!disk) {
+                g_list_foreach(mounts, (GFunc)g_object_unref, NULL);
+                g_list_free(mounts);
+                goto cleanup;
+            }
             gvir_config_domain_add_device(domain,
                                           GVIR_CONFIG_DOMAIN_DEVICE(disk));
-            g_object_unref(diskDriver);
             g_object_unref(disk);
-            g_free(target);
         }
         tmp = tmp->next;
     }
     g_list_foreach(mounts, (GFunc)g_object_unref, NULL);
     g_list_free(mounts);
 
+    if (nIOThreads) {
+        gchar *iothreads = g_strdup_printf("<iothreads>%u</iothreads>", nIOThreads);
+        gvir_sandbox_builder_add_xml(builder, "domain", iothreads);
+        g_free(iothreads);
+    }
+
+    /* libvirt-gconfig can't set the interface driver, which
+     * carries the vhost, multiqueue and ring size settings */
     tmp = networks = gvir_sandbox_config_get_networks(config);
     while (tmp) {
-        const gchar *source, *mac;
         GVirSandboxConfigNetwork *network = GVIR_SANDBOX_CONFIG_NETWORK(tmp->data);
-        GVirSandboxConfigNetworkFilterref *filterref;
-
-        source = gvir_sandbox_config_network_get_source(network);
-        if (source) {
-            iface = GVIR_CONFIG_DOMAIN_INTERFACE(gvir_config_domain_interface_network_new());
-            gvir_config_domain_interface_network_set_source(
-                                                            GVIR_CONFIG_DOMAIN_INTERFACE_NETWORK(iface), source);
-        } else {
-            iface = GVIR_CONFIG_DOMAIN_INTERFACE(gvir_config_domain_interface_user_new());
-        }
-
-        mac = gvir_sandbox_config_network_get_mac(network);
-        if (mac)
-            gvir_config_domain_interface_set_mac(iface, mac);
-
-        gvir_config_domain_interface_set_model(iface,
-                                               "virtio");
-
-        filterref = gvir_sandbox_config_network_get_filterref(network);
-        if (filterref) {
-            gvir_sandbox_builder_set_filterref(builder, iface, filterref);
+        const gchar *backend = gvir_sandbox_config_network_get_backend(network);
+        gchar *ifacexml;
+
+        if (backend &&
+            gvir_sandbox_config_network_get_source(network)) {
+            g_set_error(error, GVIR_SANDBOX_BUILDER_MACHINE_ERROR, 0,
+                        _("Network backend %s cannot be used with a source network"),
+                        backend);
+            g_list_foreach(networks, (GFunc)g_object_unref, NULL);
+            g_list_free(networks);
+            goto cleanup;
         }
 
-        gvir_config_domain_add_device(domain,
-                                      GVIR_CONFIG_DOMAIN_DEVICE(iface));
+        ifacexml = gvir_sandbox_builder_xml_interface(config, network);
 
-        g_object_unref(iface);
+        gvir_sandbox_builder_add_xml(builder, "devices", ifacexml);
+        g_free(ifacexml);
 
         tmp = tmp->next;
     }
@@ -668,12 +1463,38 @@ static gboolean gvir_sandbox_builder_machine_construct_devices(GVirSandboxBuilde
     g_list_free(networks);
 
 
-    ball = gvir_config_domain_memballoon_new();
-    gvir_config_domain_memballoon_set_model(ball,
-                                            GVIR_CONFIG_DOMAIN_MEMBALLOON_MODEL_NONE);
-    gvir_config_domain_add_device(domain,
-                                  GVIR_CONFIG_DOMAIN_DEVICE(ball));
-    g_object_unref(ball);
+    /* libvirt-gconfig can't set the balloon's autodeflate and
+     * freePageReporting attributes */
+    if ((balloon = gvir_sandbox_builder_xml_memballoon(config))) {
+        gvir_sandbox_builder_add_xml(builder, "devices", balloon);
+        g_free(balloon);
+    } else {
+        ball = gvir_config_domain_memballoon_new();
+        gvir_config_domain_memballoon_set_model(ball,
+                                                GVIR_CONFIG_DOMAIN_MEMBALLOON_MODEL_NONE);
+        gvir_config_domain_add_device(domain,
+                                      GVIR_CONFIG_DOMAIN_DEVICE(ball));
+        g_object_unref(ball);
+    }
+
+
+    /* So nothing blocking in getrandom() early on stalls the boot,
+     * or the sandboxed app, waiting for the guest to gather entropy.
+     * libvirt-gconfig has no object for this device. */
+    if (gvir_sandbox_config_get_rng_rate(config)) {
+        gchar *rng = g_strdup_printf("<rng model='virtio'>"
+                                     "<rate period='1000' bytes='%u'/>"
+                                     "<backend model='random'>/dev/urandom</backend>"
+                                     "</rng>",
+                                     gvir_sandbox_config_get_rng_rate(config));
+        gvir_sandbox_builder_add_xml(builder, "devices", rng);
+        g_free(rng);
+    } else {
+        gvir_sandbox_builder_add_xml(builder, "devices",
+                                     "<rng model='virtio'>"
+                                     "<backend model='random'>/dev/urandom</backend>"
+                                     "</rng>");
+    }
 
 
     /* The first serial is for stdio of the sandboxed app */
@@ -756,12 +1577,18 @@ static gboolean gvir_sandbox_builder_machine_clean_post_stop(GVirSandboxBuilder
                                                              GError **error)
 {
     gchar *mntfile = g_strdup_printf("%s/config/mounts.cfg", statedir);
+    gchar *mountdir = g_strdup_printf("%s/config/readahead", statedir);
     gboolean ret = TRUE;
 
     if (unlink(mntfile) < 0 &&
         errno != ENOENT)
         ret = FALSE;
 
+    if (rmdir(mountdir) < 0 &&
+        errno != ENOENT)
+        ret = FALSE;
+
+    g_free(mountdir);
     g_free(mntfile);
     return ret;
 }
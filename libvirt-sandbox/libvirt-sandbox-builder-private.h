@@ -33,6 +33,46 @@ void gvir_sandbox_builder_set_filterref(GVirSandboxBuilder *builder,
                                         GVirConfigDomainInterface *iface,
                                         GVirSandboxConfigNetworkFilterref *filterref);
 
+gboolean gvir_sandbox_builder_elf_resolve(const gchar *program,
+                                          gchar **interp,
+                                          GList **libs,
+                                          GError **error);
+void gvir_sandbox_builder_elf_clear(void);
+
+gboolean gvir_sandbox_builder_elf_has_note(const gchar *path,
+                                           const gchar *owner,
+                                           guint32 type);
+
+void gvir_sandbox_builder_add_xml(GVirSandboxBuilder *builder,
+                                  const gchar *parent,
+                                  const gchar *xml);
+
+const gchar *gvir_sandbox_builder_get_libsdir(GVirSandboxBuilder *builder);
+
+gchar *gvir_sandbox_builder_xml_memory_backing(GVirSandboxConfig *config);
+gchar *gvir_sandbox_builder_xml_memballoon(GVirSandboxConfig *config);
+GVirConfigDomainDisk *gvir_sandbox_builder_xml_disk(GVirSandboxConfig *config,
+                                                    GVirSandboxConfigDisk *disk,
+                                                    GVirConfigDomainDiskType type,
+                                                    const gchar *source,
+                                                    GVirConfigDomainDiskFormat format,
+                                                    const gchar *target,
+                                                    gboolean readonly,
+                                                    const gchar *cache,
+                                                    guint iothread,
+                                                    GError **error);
+GVirConfigDomainDisk *gvir_sandbox_builder_xml_volume(GVirSandboxConfig *config,
+                                                      GVirSandboxConfigVolume *volume,
+                                                      const gchar *source,
+                                                      const gchar *target,
+                                                      guint iothread,
+                                                      GError **error);
+gchar *gvir_sandbox_builder_xml_interface(GVirSandboxConfig *config,
+                                          GVirSandboxConfigNetwork *network);
+
+gchar *gvir_sandbox_builder_get_volume_path(GVirSandboxConfigVolume *volume,
+                                            const gchar *statedir);
+
 G_END_DECLS
 
 #endif /* __LIBVIRT_SANDBOX_BUILDER_PRIVATE_H__ */
@@ -0,0 +1,373 @@
+/*
+ * libvirt-sandbox-builder-xml.c: domain XML libvirt-gconfig can't fully describe
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include "libvirt-sandbox/libvirt-sandbox.h"
+#include "libvirt-sandbox/libvirt-sandbox-builder-private.h"
+
+/*
+ * These only depend on the sandbox config, so that the XML they
+ * generate can be checked without constructing a whole domain.
+ */
+
+
+/**
+ * gvir_sandbox_builder_xml_memory_backing: (skip)
+ * @config: (transfer none): the sandbox config
+ *
+ * Formats the memoryBacking element for the memory backing mode
+ * of @config.
+ *
+ * Returns: (transfer full): the XML fragment, or NULL if the
+ * default memory backing is used
+ */
+gchar *gvir_sandbox_builder_xml_memory_backing(GVirSandboxConfig *config)
+{
+    guint64 hugepages = gvir_sandbox_config_get_hugepages(config);
+    GString *str;
+
+    if (!hugepages &&
+        gvir_sandbox_config_get_mergeable_memory(config) &&
+        !gvir_sandbox_config_get_memory_locked(config) &&
+        !gvir_sandbox_config_get_memfd(config) &&
+        !gvir_sandbox_config_get_prealloc(config))
+        return NULL;
+
+    str = g_string_new("<memoryBacking>");
+    if (hugepages)
+        g_string_append_printf(str,
+                               "<hugepages><page size='%llu' unit='KiB'/></hugepages>",
+                               (unsigned long long)hugepages / 1024);
+    if (!gvir_sandbox_config_get_mergeable_memory(config))
+        g_string_append(str, "<nosharepages/>");
+    if (gvir_sandbox_config_get_memory_locked(config))
+        g_string_append(str, "<locked/>");
+    if (gvir_sandbox_config_get_memfd(config))
+        g_string_append(str,
+                        "<source type='memfd'/>"
+                        "<access mode='shared'/>");
+    if (gvir_sandbox_config_get_prealloc(config))
+        g_string_append(str, "<allocation mode='immediate'/>");
+    g_string_append(str, "</memoryBacking>");
+
+    return g_string_free(str, FALSE);
+}
+
+
+/**
+ * gvir_sandbox_builder_xml_memballoon: (skip)
+ * @config: (transfer none): the sandbox config
+ *
+ * Formats the memballoon device of @config, which reports free
+ * pages to the host and deflates when the guest runs out of memory.
+ *
+ * Returns: (transfer full): the XML fragment, or NULL if the
+ * sandbox has no balloon
+ */
+gchar *gvir_sandbox_builder_xml_memballoon(GVirSandboxConfig *config)
+{
+    if (!gvir_sandbox_config_get_balloon(config))
+        return NULL;
+
+    return g_strdup("<memballoon model='virtio' autodeflate='on' "
+                    "freePageReporting='on'/>");
+}
+
+
+/* Whether libvirt-gconfig knows @nick, and if so its @value */
+static gboolean gvir_sandbox_builder_xml_enum_value(GType type,
+                                                    const gchar *nick,
+                                                    gint *value)
+{
+    GEnumClass *klass = g_type_class_ref(type);
+    GEnumValue *val = g_enum_get_value_by_nick(klass, nick);
+
+    if (val)
+        *value = val->value;
+
+    /* The class of a static enum type is never actually freed */
+    g_type_class_unref(klass);
+    return val != NULL;
+}
+
+
+/**
+ * gvir_sandbox_builder_xml_disk: (skip)
+ * @config: (transfer none): the sandbox config
+ * @disk: (transfer none)(allow-none): the custom disk, if any
+ * @type: the disk source type
+ * @source: the disk source
+ * @format: the disk image format
+ * @target: the guest device name
+ * @readonly: whether the guest may only read the disk
+ * @cache: (allow-none): the cache mode to use if none is configured
+ * @iothread: the I/O thread to run the disk in, or 0
+ * @error: (out): the error location
+ *
+ * Builds a virtio disk, with the tuning of @disk if it has any, or
+ * else the disk tuning of @config. As QEMU refuses native AIO through
+ * the host page cache, the native I/O mode switches the cache mode
+ * to none, and zero detection only unmaps when discards do.
+ *
+ * Returns: (transfer full): the disk, or NULL on error
+ */
+GVirConfigDomainDisk *gvir_sandbox_builder_xml_disk(GVirSandboxConfig *config,
+                                                    GVirSandboxConfigDisk *disk,
+                                                    GVirConfigDomainDiskType type,
+                                                    const gchar *source,
+                                                    GVirConfigDomainDiskFormat format,
+                                                    const gchar *target,
+                                                    gboolean readonly,
+                                                    const gchar *cache,
+                                                    guint iothread,
+                                                    GError **error)
+{
+    const gchar *io = gvir_sandbox_config_get_disk_io(config);
+    const gchar *discard = gvir_sandbox_config_get_disk_discard(config);
+    const gchar *detectZeroes = gvir_sandbox_config_get_disk_detect_zeroes(config);
+    guint queues = gvir_sandbox_config_get_disk_queues(config);
+    GVirConfigDomainDisk *ret = NULL;
+    GVirConfigDomainDiskDriver *driver;
+    GString *str;
+    gchar *tmp;
+    gint value;
+
+    if (gvir_sandbox_config_get_disk_cache(config))
+        cache = gvir_sandbox_config_get_disk_cache(config);
+    if (disk) {
+        if (gvir_sandbox_config_disk_get_cache(disk))
+            cache = gvir_sandbox_config_disk_get_cache(disk);
+        if (gvir_sandbox_config_disk_get_io(disk))
+            io = gvir_sandbox_config_disk_get_io(disk);
+        if (gvir_sandbox_config_disk_get_discard(disk))
+            discard = gvir_sandbox_config_disk_get_discard(disk);
+        if (gvir_sandbox_config_disk_get_detect_zeroes(disk))
+            detectZeroes = gvir_sandbox_config_disk_get_detect_zeroes(disk);
+        if (gvir_sandbox_config_disk_get_queues(disk))
+            queues = gvir_sandbox_config_disk_get_queues(disk);
+    }
+
+    if (g_strcmp0(io, "native") == 0 &&
+        g_strcmp0(cache, "none") != 0 &&
+        g_strcmp0(cache, "directsync") != 0)
+        cache = "none";
+    if (g_strcmp0(detectZeroes, "unmap") == 0 &&
+        g_strcmp0(discard, "unmap") != 0)
+        detectZeroes = "on";
+
+    /* libvirt-gconfig has no setters for these driver attributes,
+     * nor does it know the io_uring I/O mode */
+    str = g_string_new("<driver");
+    if (io &&
+        !gvir_sandbox_builder_xml_enum_value(GVIR_CONFIG_TYPE_DOMAIN_DISK_DRIVER_IO_POLICY,
+                                             io, &value)) {
+        tmp = g_markup_printf_escaped(" io='%s'", io);
+        g_string_append(str, tmp);
+        g_free(tmp);
+    }
+    if (detectZeroes) {
+        tmp = g_markup_printf_escaped(" detect_zeroes='%s'", detectZeroes);
+        g_string_append(str, tmp);
+        g_free(tmp);
+    }
+    if (iothread)
+        g_string_append_printf(str, " iothread='%u'", iothread);
+    if (queues)
+        g_string_append_printf(str, " queues='%u'", queues);
+    g_string_append(str, "/>");
+
+    if (!(driver = gvir_config_domain_disk_driver_new_from_xml(str->str, error)))
+        goto cleanup;
+
+    gvir_config_domain_disk_driver_set_format(driver, format);
+    if (cache &&
+        gvir_sandbox_builder_xml_enum_value(GVIR_CONFIG_TYPE_DOMAIN_DISK_CACHE_TYPE,
+                                            cache, &value))
+        gvir_config_domain_disk_driver_set_cache(driver, value);
+    if (io &&
+        gvir_sandbox_builder_xml_enum_value(GVIR_CONFIG_TYPE_DOMAIN_DISK_DRIVER_IO_POLICY,
+                                            io, &value))
+        gvir_config_domain_disk_driver_set_io_policy(driver, value);
+    if (discard &&
+        gvir_sandbox_builder_xml_enum_value(GVIR_CONFIG_TYPE_DOMAIN_DISK_DRIVER_DISCARD,
+                                            discard, &value))
+        gvir_config_domain_disk_driver_set_discard(driver, value);
+
+    ret = gvir_config_domain_disk_new();
+    gvir_config_domain_disk_set_type(ret, type);
+    gvir_config_domain_disk_set_guest_device_type(ret,
+                                                  GVIR_CONFIG_DOMAIN_DISK_GUEST_DEVICE_DISK);
+    gvir_config_domain_disk_set_driver(ret, driver);
+    gvir_config_domain_disk_set_source(ret, source);
+    gvir_config_domain_disk_set_target_dev(ret, target);
+    gvir_config_domain_disk_set_target_bus(ret, GVIR_CONFIG_DOMAIN_DISK_BUS_VIRTIO);
+    if (readonly)
+        gvir_config_domain_disk_set_readonly(ret, TRUE);
+    g_object_unref(driver);
+
+ cleanup:
+    g_string_free(str, TRUE);
+    return ret;
+}
+
+
+/**
+ * gvir_sandbox_builder_xml_volume: (skip)
+ * @config: (transfer none): the sandbox config
+ * @volume: (transfer none): the data volume
+ * @source: the host file backing @volume
+ * @target: the guest device name
+ * @iothread: the I/O thread to run the disk in, or 0
+ * @error: (out): the error location
+ *
+ * Builds the virtio disk of a data volume. Input volumes are
+ * read-only. Every other volume is a scratch image in the state
+ * dir, which is thrown away should the host crash, so there is
+ * no point in the guest flushing it.
+ *
+ * Returns: (transfer full): the disk, or NULL on error
+ */
+GVirConfigDomainDisk *gvir_sandbox_builder_xml_volume(GVirSandboxConfig *config,
+                                                      GVirSandboxConfigVolume *volume,
+                                                      const gchar *source,
+                                                      const gchar *target,
+                                                      guint iothread,
+                                                      GError **error)
+{
+    gboolean readonly = !gvir_sandbox_config_volume_get_output(volume);
+
+    return gvir_sandbox_builder_xml_disk(config, NULL,
+                                         GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                         source,
+                                         GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW,
+                                         target, readonly,
+                                         readonly ? NULL : "unsafe",
+                                         iothread, error);
+}
+
+
+/**
+ * gvir_sandbox_builder_xml_interface: (skip)
+ * @config: (transfer none): the sandbox config
+ * @network: (transfer none): the network interface config
+ *
+ * Formats a virtio interface for @network. A vhost interface
+ * connected to a virtual network gets one queue pair per vCPU,
+ * unless @network has an explicit queue count. An interface
+ * without a source network uses the passt backend if requested,
+ * or else QEMU's built in slirp stack.
+ *
+ * Returns: (transfer full): the XML fragment
+ */
+gchar *gvir_sandbox_builder_xml_interface(GVirSandboxConfig *config,
+                                          GVirSandboxConfigNetwork *network)
+{
+    const gchar *source = gvir_sandbox_config_network_get_source(network);
+    const gchar *mac = gvir_sandbox_config_network_get_mac(network);
+    GVirSandboxConfigNetworkFilterref *filterref;
+    gboolean vhost = FALSE;
+    guint queues = 0;
+    guint rxQueueSize = gvir_sandbox_config_network_get_rx_queue_size(network);
+    guint txQueueSize = gvir_sandbox_config_network_get_tx_queue_size(network);
+    GString *str;
+    gchar *tmp;
+
+    /* vhost and multiqueue both need a tap device, which
+     * user mode interfaces don't have */
+    if (source && gvir_sandbox_config_network_get_vhost(network)) {
+        vhost = TRUE;
+        queues = gvir_sandbox_config_network_get_queues(network);
+        if (!queues)
+            queues = gvir_sandbox_config_get_vcpus(config);
+        if (queues == 1)
+            queues = 0;
+    }
+
+    str = g_string_new("");
+    if (source) {
+        tmp = g_markup_printf_escaped("<interface type='network'>"
+                                      "<source network='%s'/>", source);
+        g_string_append(str, tmp);
+        g_free(tmp);
+    } else {
+        g_string_append(str, "<interface type='user'>");
+        if (g_strcmp0(gvir_sandbox_config_network_get_backend(network), "passt") == 0)
+            g_string_append(str, "<backend type='passt'/>");
+    }
+    if (mac) {
+        tmp = g_markup_printf_escaped("<mac address='%s'/>", mac);
+        g_string_append(str, tmp);
+        g_free(tmp);
+    }
+    g_string_append(str, "<model type='virtio'/>");
+
+    if (vhost || rxQueueSize || txQueueSize) {
+        g_string_append(str, "<driver");
+        if (vhost)
+            g_string_append(str, " name='vhost'");
+        if (queues)
+            g_string_append_printf(str, " queues='%u'", queues);
+        if (rxQueueSize)
+            g_string_append_printf(str, " rx_queue_size='%u'", rxQueueSize);
+        if (txQueueSize)
+            g_string_append_printf(str, " tx_queue_size='%u'", txQueueSize);
+        g_string_append(str, "/>");
+    }
+
+    filterref = gvir_sandbox_config_network_get_filterref(network);
+    if (filterref) {
+        GList *params, *iter;
+
+        tmp = g_markup_printf_escaped("<filterref filter='%s'>",
+                                      gvir_sandbox_config_network_filterref_get_name(filterref));
+        g_string_append(str, tmp);
+        g_free(tmp);
+
+        iter = params = gvir_sandbox_config_network_filterref_get_parameters(filterref);
+        while (iter) {
+            GVirSandboxConfigNetworkFilterrefParameter *param = iter->data;
+
+            tmp = g_markup_printf_escaped("<parameter name='%s' value='%s'/>",
+                                          gvir_sandbox_config_network_filterref_parameter_get_name(param),
+                                          gvir_sandbox_config_network_filterref_parameter_get_value(param));
+            g_string_append(str, tmp);
+            g_free(tmp);
+
+            iter = iter->next;
+        }
+        g_list_foreach(params, (GFunc)g_object_unref, NULL);
+        g_list_free(params);
+
+        g_string_append(str, "</filterref>");
+    }
+    g_string_append(str, "</interface>");
+
+    return g_string_free(str, FALSE);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
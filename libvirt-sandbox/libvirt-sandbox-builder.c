@@ -23,6 +23,14 @@
 #include <config.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <utime.h>
+#include <glib/gi18n.h>
 
 #include "libvirt-sandbox/libvirt-sandbox.h"
 #include "libvirt-sandbox/libvirt-sandbox-builder-private.h"
@@ -45,6 +53,8 @@
 struct _GVirSandboxBuilderPrivate
 {
     GVirConnection *connection;
+    gchar *libsdir;
+    GHashTable *xml;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE(GVirSandboxBuilder, gvir_sandbox_builder, G_TYPE_OBJECT);
@@ -158,6 +168,8 @@ static void gvir_sandbox_builder_finalize(GObject *object)
 
     if (priv->connection)
         g_object_unref(priv->connection);
+    g_free(priv->libsdir);
+    g_hash_table_unref(priv->xml);
 
     G_OBJECT_CLASS(gvir_sandbox_builder_parent_class)->finalize(object);
 }
@@ -196,9 +208,17 @@ static void gvir_sandbox_builder_class_init(GVirSandboxBuilderClass *klass)
 }
 
 
+static void gvir_sandbox_builder_free_xml(GString *xml)
+{
+    g_string_free(xml, TRUE);
+}
+
+
 static void gvir_sandbox_builder_init(GVirSandboxBuilder *ctxt)
 {
     ctxt->priv = GVIR_SANDBOX_BUILDER_GET_PRIVATE(ctxt);
+    ctxt->priv->xml = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify)gvir_sandbox_builder_free_xml);
 }
 
 
@@ -276,20 +296,48 @@ static gboolean gvir_sandbox_builder_copy_file(const char *path,
     return result;
 }
 
-static gboolean gvir_sandbox_builder_copy_program(const char *program,
-                                                  const char *dest,
+static gboolean gvir_sandbox_builder_list_program(const char *program,
+                                                  GHashTable *files,
                                                   GError **error)
 {
     gchar *out = NULL;
     gchar *line, *tmp;
     const gchar *argv[] = {LDD_PATH, program, NULL};
     gboolean result = FALSE;
+    gchar *name = g_path_get_basename(program);
+    gchar *interp = NULL;
+    GList *libs = NULL, *lib;
+
+    if (g_hash_table_contains(files, name))
+        g_free(name);
+    else
+        g_hash_table_insert(files, name, g_strdup(program));
+
+#ifdef WITH_STATIC_INIT
+    /* The init helpers are self-contained, so there are no
+     * libraries, nor a dynamic loader, to stage alongside them */
+    result = TRUE;
+    goto cleanup;
+#endif
 
-    if (!gvir_sandbox_builder_copy_file(program, dest, NULL, error))
+    /* Read the dependencies straight from the ELF headers where
+     * possible, only asking ldd if that cannot resolve them all */
+    if (gvir_sandbox_builder_elf_resolve(program, &interp, &libs, NULL)) {
+        if (interp && !g_hash_table_contains(files, "ld.so"))
+            g_hash_table_insert(files, g_strdup("ld.so"), g_strdup(interp));
+
+        for (lib = libs; lib; lib = lib->next) {
+            name = g_path_get_basename(lib->data);
+            if (g_hash_table_contains(files, name))
+                g_free(name);
+            else
+                g_hash_table_insert(files, name, g_strdup(lib->data));
+        }
+        result = TRUE;
         goto cleanup;
+    }
 
-
-    /* Get all the dependencies to be hard linked */
+    /* Get all the dependencies to be staged */
     if (!g_spawn_sync(NULL, (gchar **)argv, NULL, 0,
                       NULL, NULL, &out, NULL, NULL, error))
         goto cleanup;
@@ -305,7 +353,6 @@ static gboolean gvir_sandbox_builder_copy_program(const char *program,
         end = strstr(line, " (");
 
         if (start && end) {
-            const gchar *newname = NULL;
             *end = '\0';
 
             /* There are countless different naming schemes for
@@ -322,11 +369,15 @@ static gboolean gvir_sandbox_builder_copy_program(const char *program,
              */
             if (!strstr(line, " => ") &&
                 strstr(start, "/ld")) {
-                newname = "ld.so";
+                name = g_strdup("ld.so");
+            } else {
+                name = g_path_get_basename(start);
             }
 
-            if (!gvir_sandbox_builder_copy_file(start, dest, newname, error))
-                goto cleanup;
+            if (g_hash_table_contains(files, name))
+                g_free(name);
+            else
+                g_hash_table_insert(files, name, g_strdup(start));
         }
 
         line = tmp + 1;
@@ -334,41 +385,638 @@ static gboolean gvir_sandbox_builder_copy_program(const char *program,
     result = TRUE;
 
  cleanup:
+    g_list_free_full(libs, g_free);
+    g_free(interp);
     g_free(out);
 
     return result;
 }
 
+
+static gchar *gvir_sandbox_builder_checksum_file(const gchar *path,
+                                                 GError **error)
+{
+    GFile *file = g_file_new_for_path(path);
+    GFileInputStream *is = NULL;
+    GChecksum *checksum = NULL;
+    guchar buf[65536];
+    gssize got;
+    gchar *ret = NULL;
+
+    if (!(is = g_file_read(file, NULL, error)))
+        goto cleanup;
+
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    while ((got = g_input_stream_read(G_INPUT_STREAM(is), buf, sizeof(buf),
+                                      NULL, error)) > 0)
+        g_checksum_update(checksum, buf, got);
+
+    if (got == 0)
+        ret = g_strdup(g_checksum_get_string(checksum));
+
+ cleanup:
+    if (checksum)
+        g_checksum_free(checksum);
+    if (is)
+        g_object_unref(is);
+    g_object_unref(file);
+    return ret;
+}
+
+
+/*
+ * Adds @path to the blobs in @storedir, named by the SHA-256 of
+ * its contents, and returns that name. The index maps the file's
+ * identity (path, inode, size and mtime) onto its blob, so that
+ * files which have not changed are not hashed again every launch.
+ */
+static gchar *gvir_sandbox_builder_store_file(const gchar *storedir,
+                                              const gchar *path,
+                                              GError **error)
+{
+    struct stat sb;
+    gchar *indexdir = g_build_filename(storedir, "index", NULL);
+    gchar *blobdir = g_build_filename(storedir, "blobs", NULL);
+    gchar *pathsum = NULL;
+    gchar *indexname = NULL;
+    gchar *indexfile = NULL;
+    gchar *target = NULL;
+    gchar *blob = NULL;
+    gchar *tmpblob = NULL;
+    gchar *sum = NULL;
+    GFile *srcFile = NULL;
+    GFile *tmpFile = NULL;
+    GDir *dir;
+    const gchar *ent;
+
+    if (stat(path, &sb) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to access %s: %s"), path, strerror(errno));
+        goto cleanup;
+    }
+
+    pathsum = g_compute_checksum_for_string(G_CHECKSUM_SHA256, path, -1);
+    indexname = g_strdup_printf("%.16s-%llx-%llx-%llx-%llx", pathsum,
+                                (unsigned long long)sb.st_dev,
+                                (unsigned long long)sb.st_ino,
+                                (unsigned long long)sb.st_size,
+                                (unsigned long long)sb.st_mtime);
+    indexfile = g_build_filename(indexdir, indexname, NULL);
+
+    if ((target = g_file_read_link(indexfile, NULL))) {
+        blob = g_build_filename(indexdir, target, NULL);
+        if (g_file_test(blob, G_FILE_TEST_EXISTS)) {
+            sum = g_path_get_basename(target);
+            goto cleanup;
+        }
+        g_free(blob);
+        g_free(target);
+        blob = target = NULL;
+    }
+
+    if (!(sum = gvir_sandbox_builder_checksum_file(path, error)))
+        goto cleanup;
+
+    blob = g_build_filename(blobdir, sum, NULL);
+    if (!g_file_test(blob, G_FILE_TEST_EXISTS)) {
+        tmpblob = g_strdup_printf("%s.%d.tmp", blob, getpid());
+        srcFile = g_file_new_for_path(path);
+        tmpFile = g_file_new_for_path(tmpblob);
+
+        if (!g_file_copy(srcFile, tmpFile, G_FILE_COPY_OVERWRITE,
+                         NULL, NULL, NULL, error))
+            goto error;
+
+        /* Shared by every sandbox, so nobody gets to modify it */
+        if (chmod(tmpblob, sb.st_mode & 0555) < 0 ||
+            rename(tmpblob, blob) < 0) {
+            g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                        _("Unable to store %s: %s"), path, strerror(errno));
+            goto error;
+        }
+    }
+
+    /* Drop the entries for previous versions of this file */
+    if ((dir = g_dir_open(indexdir, 0, NULL))) {
+        while ((ent = g_dir_read_name(dir))) {
+            if (strncmp(ent, indexname, 17) == 0) {
+                gchar *stale = g_build_filename(indexdir, ent, NULL);
+                unlink(stale);
+                g_free(stale);
+            }
+        }
+        g_dir_close(dir);
+    }
+
+    /* Not fatal, it only means hashing the file again next time */
+    target = g_strdup_printf("../blobs/%s", sum);
+    if (symlink(target, indexfile) < 0)
+        unlink(indexfile);
+    goto cleanup;
+
+ error:
+    unlink(tmpblob);
+    g_free(sum);
+    sum = NULL;
+ cleanup:
+    if (tmpFile)
+        g_object_unref(tmpFile);
+    if (srcFile)
+        g_object_unref(srcFile);
+    g_free(tmpblob);
+    g_free(blob);
+    g_free(target);
+    g_free(indexfile);
+    g_free(indexname);
+    g_free(pathsum);
+    g_free(blobdir);
+    g_free(indexdir);
+    return sum;
+}
+
+
+static void gvir_sandbox_builder_remove_set(const gchar *setdir,
+                                            GList *names)
+{
+    GList *tmp = names;
+    while (tmp) {
+        gchar *path = g_build_filename(setdir, tmp->data, NULL);
+        unlink(path);
+        g_free(path);
+        tmp = tmp->next;
+    }
+    rmdir(setdir);
+}
+
+
+#define GVIR_SANDBOX_BUILDER_LIBS_SETS 8
+#define GVIR_SANDBOX_BUILDER_LIBS_STALE (60 * 60)
+
+typedef struct _GVirSandboxBuilderLibsSet GVirSandboxBuilderLibsSet;
+struct _GVirSandboxBuilderLibsSet {
+    gchar *path;
+    time_t mtime;
+};
+
+
+static gint gvir_sandbox_builder_libs_set_cmp(gconstpointer a,
+                                              gconstpointer b)
+{
+    const GVirSandboxBuilderLibsSet *sa = a;
+    const GVirSandboxBuilderLibsSet *sb = b;
+
+    /* Most recently used first */
+    if (sa->mtime > sb->mtime)
+        return -1;
+    if (sa->mtime < sb->mtime)
+        return 1;
+    return 0;
+}
+
+
+static void gvir_sandbox_builder_remove_dir(const gchar *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const gchar *name;
+
+    if (dir) {
+        while ((name = g_dir_read_name(dir))) {
+            gchar *file = g_build_filename(path, name, NULL);
+            unlink(file);
+            g_free(file);
+        }
+        g_dir_close(dir);
+    }
+    rmdir(path);
+}
+
+
+/*
+ * Records that the sandbox in @statedir mounts the set @setname,
+ * with a link named after both pointing at the mount point of the
+ * set. That only goes away when the sandbox is cleaned up after
+ * it stops, so the link dangles from then on.
+ */
+static gboolean gvir_sandbox_builder_add_set_user(const gchar *storedir,
+                                                  const gchar *setname,
+                                                  const gchar *statedir,
+                                                  GError **error)
+{
+    gchar *usersdir = g_build_filename(storedir, "users", NULL);
+    gchar *statesum = g_compute_checksum_for_string(G_CHECKSUM_SHA256, statedir, -1);
+    gchar *suffix = g_strdup_printf(".%s", statesum);
+    gchar *user = g_strdup_printf("%s%s", setname, suffix);
+    gchar *path = g_build_filename(usersdir, user, NULL);
+    gchar *libsdir = g_build_filename(statedir, "config", ".libs", NULL);
+    const gchar *name;
+    GDir *dir;
+    gboolean ret = FALSE;
+
+    if (g_mkdir_with_parents(usersdir, 0755) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to create %s: %s"), usersdir, strerror(errno));
+        goto cleanup;
+    }
+
+    /* A set used by a previous launch from the same state dir */
+    if ((dir = g_dir_open(usersdir, 0, NULL))) {
+        while ((name = g_dir_read_name(dir))) {
+            if (g_str_has_suffix(name, suffix)) {
+                gchar *old = g_build_filename(usersdir, name, NULL);
+                unlink(old);
+                g_free(old);
+            }
+        }
+        g_dir_close(dir);
+    }
+
+    if (symlink(libsdir, path) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to link %s to %s: %s"),
+                    path, libsdir, strerror(errno));
+        goto cleanup;
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_free(libsdir);
+    g_free(path);
+    g_free(user);
+    g_free(suffix);
+    g_free(statesum);
+    g_free(usersdir);
+    return ret;
+}
+
+
+/*
+ * Trims the library store back to its most recently used sets,
+ * then drops the blobs no remaining set links to, and the index
+ * entries of dropped blobs. Sets that sandboxes which have not
+ * been cleaned up yet still mount are never dropped, and sets
+ * that were used recently are kept whatever their number, as a
+ * sandbox may be about to mount them. So are new blobs, which a
+ * concurrent launch may be about to link into a set.
+ */
+static void gvir_sandbox_builder_evict_store(const gchar *storedir)
+{
+    gchar *setsdir = g_build_filename(storedir, "sets", NULL);
+    gchar *blobdir = g_build_filename(storedir, "blobs", NULL);
+    gchar *indexdir = g_build_filename(storedir, "index", NULL);
+    gchar *usersdir = g_build_filename(storedir, "users", NULL);
+    GHashTable *inuse = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                              g_free, NULL);
+    GList *sets = NULL, *tmp;
+    time_t now = time(NULL);
+    const gchar *name;
+    GDir *dir;
+    guint n = 0;
+
+    if ((dir = g_dir_open(usersdir, 0, NULL))) {
+        while ((name = g_dir_read_name(dir))) {
+            gchar *path = g_build_filename(usersdir, name, NULL);
+            const gchar *dot = strchr(name, '.');
+
+            /* Dangles once the sandbox was cleaned up */
+            if (!g_file_test(path, G_FILE_TEST_EXISTS))
+                unlink(path);
+            else if (dot)
+                g_hash_table_add(inuse, g_strndup(name, dot - name));
+            g_free(path);
+        }
+        g_dir_close(dir);
+    }
+
+    if ((dir = g_dir_open(setsdir, 0, NULL))) {
+        while ((name = g_dir_read_name(dir))) {
+            GVirSandboxBuilderLibsSet *set;
+            gchar *path = g_build_filename(setsdir, name, NULL);
+            struct stat sb;
+
+            if (lstat(path, &sb) < 0 || !S_ISDIR(sb.st_mode)) {
+                g_free(path);
+                continue;
+            }
+
+            /* Left behind by a builder that died while staging */
+            if (strchr(name, '.')) {
+                if (sb.st_mtime + GVIR_SANDBOX_BUILDER_LIBS_STALE < now)
+                    gvir_sandbox_builder_remove_dir(path);
+                g_free(path);
+                continue;
+            }
+
+            if (g_hash_table_contains(inuse, name)) {
+                g_free(path);
+                continue;
+            }
+
+            set = g_new0(GVirSandboxBuilderLibsSet, 1);
+            set->path = path;
+            set->mtime = sb.st_mtime;
+            sets = g_list_prepend(sets, set);
+        }
+        g_dir_close(dir);
+    }
+
+    sets = g_list_sort(sets, gvir_sandbox_builder_libs_set_cmp);
+    for (tmp = sets ; tmp ; tmp = tmp->next) {
+        GVirSandboxBuilderLibsSet *set = tmp->data;
+        if (n++ >= GVIR_SANDBOX_BUILDER_LIBS_SETS &&
+            set->mtime + GVIR_SANDBOX_BUILDER_LIBS_STALE < now)
+            gvir_sandbox_builder_remove_dir(set->path);
+        g_free(set->path);
+        g_free(set);
+    }
+    g_list_free(sets);
+
+    /* Linking a blob into a set changes its ctime, so this
+     * also spares blobs that were just linked or unlinked */
+    if ((dir = g_dir_open(blobdir, 0, NULL))) {
+        while ((name = g_dir_read_name(dir))) {
+            gchar *path = g_build_filename(blobdir, name, NULL);
+            struct stat sb;
+
+            if (lstat(path, &sb) == 0 && S_ISREG(sb.st_mode) &&
+                sb.st_nlink == 1 &&
+                sb.st_ctime + GVIR_SANDBOX_BUILDER_LIBS_STALE < now)
+                unlink(path);
+            g_free(path);
+        }
+        g_dir_close(dir);
+    }
+
+    if ((dir = g_dir_open(indexdir, 0, NULL))) {
+        while ((name = g_dir_read_name(dir))) {
+            gchar *path = g_build_filename(indexdir, name, NULL);
+            if (!g_file_test(path, G_FILE_TEST_EXISTS))
+                unlink(path);
+            g_free(path);
+        }
+        g_dir_close(dir);
+    }
+
+    g_hash_table_unref(inuse);
+    g_free(usersdir);
+    g_free(indexdir);
+    g_free(blobdir);
+    g_free(setsdir);
+}
+
+
+/*
+ * Stages @files, mapping names to host paths, in the shared
+ * library store and returns the directory holding them. Files are
+ * stored once by content, and each distinct set of them gets a
+ * directory of hardlinks that every sandbox using that set shares
+ * through a read-only mount, rather than taking a copy of its own.
+ * The set is recorded as used by the sandbox in @statedir.
+ */
+static gchar *gvir_sandbox_builder_store_files(GHashTable *files,
+                                               const gchar *statedir,
+                                               GError **error)
+{
+    gchar *storedir;
+    gchar *blobdir, *indexdir, *setsdir;
+    gchar *setdir = NULL;
+    gchar *tmpdir = NULL;
+    GList *names = g_list_sort(g_hash_table_get_keys(files),
+                               (GCompareFunc)strcmp);
+    GList *sums = NULL;
+    GList *tmp, *sumtmp;
+    GChecksum *setsum = g_checksum_new(G_CHECKSUM_SHA256);
+    gboolean ok = FALSE;
+
+    if (getuid())
+        storedir = g_build_filename(g_get_user_cache_dir(),
+                                    "libvirt-sandbox", "libs", NULL);
+    else
+        storedir = g_build_filename(CACHEDIR, "libs", NULL);
+    blobdir = g_build_filename(storedir, "blobs", NULL);
+    indexdir = g_build_filename(storedir, "index", NULL);
+    setsdir = g_build_filename(storedir, "sets", NULL);
+
+    if (g_mkdir_with_parents(blobdir, 0755) < 0 ||
+        g_mkdir_with_parents(indexdir, 0755) < 0 ||
+        g_mkdir_with_parents(setsdir, 0755) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to create %s: %s"), storedir, strerror(errno));
+        goto cleanup;
+    }
+    tmp = names;
+    while (tmp) {
+        gchar *sum = gvir_sandbox_builder_store_file(storedir,
+                                                     g_hash_table_lookup(files, tmp->data),
+                                                     error);
+        if (!sum)
+            goto cleanup;
+
+        g_checksum_update(setsum, tmp->data, strlen(tmp->data));
+        g_checksum_update(setsum, (const guchar *)"\t", 1);
+        g_checksum_update(setsum, (const guchar *)sum, strlen(sum));
+        g_checksum_update(setsum, (const guchar *)"\n", 1);
+        sums = g_list_append(sums, sum);
+
+        tmp = tmp->next;
+    }
+
+    setdir = g_build_filename(setsdir, g_checksum_get_string(setsum), NULL);
+    if (g_file_test(setdir, G_FILE_TEST_IS_DIR)) {
+        /* Mark the set as recently used, for eviction */
+        utime(setdir, NULL);
+        ok = TRUE;
+        goto cleanup;
+    }
+
+    tmpdir = g_strdup_printf("%s.XXXXXX", setdir);
+    if (!g_mkdtemp_full(tmpdir, 0755)) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to create %s: %s"), tmpdir, strerror(errno));
+        g_free(tmpdir);
+        tmpdir = NULL;
+        goto cleanup;
+    }
+
+    tmp = names;
+    sumtmp = sums;
+    while (tmp) {
+        gchar *blob = g_build_filename(blobdir, sumtmp->data, NULL);
+        gchar *dst = g_build_filename(tmpdir, tmp->data, NULL);
+        int rv = link(blob, dst);
+        if (rv < 0)
+            g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                        _("Unable to link %s to %s: %s"),
+                        blob, dst, strerror(errno));
+        g_free(dst);
+        g_free(blob);
+        if (rv < 0)
+            goto cleanup;
+
+        tmp = tmp->next;
+        sumtmp = sumtmp->next;
+    }
+
+    /* Another launch may have published the same set meanwhile */
+    if (rename(tmpdir, setdir) < 0 &&
+        errno != EEXIST && errno != ENOTEMPTY) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to rename %s to %s: %s"),
+                    tmpdir, setdir, strerror(errno));
+        goto cleanup;
+    }
+    ok = TRUE;
+
+ cleanup:
+    if (tmpdir && g_file_test(tmpdir, G_FILE_TEST_IS_DIR))
+        gvir_sandbox_builder_remove_set(tmpdir, names);
+    if (ok &&
+        !gvir_sandbox_builder_add_set_user(storedir,
+                                           g_checksum_get_string(setsum),
+                                           statedir, error))
+        ok = FALSE;
+    if (ok) {
+        gvir_sandbox_builder_evict_store(storedir);
+    } else {
+        g_free(setdir);
+        setdir = NULL;
+    }
+    g_checksum_free(setsum);
+    g_list_free_full(sums, g_free);
+    g_list_free(names);
+    g_free(tmpdir);
+    g_free(setsdir);
+    g_free(indexdir);
+    g_free(blobdir);
+    g_free(storedir);
+    return setdir;
+}
+
+
 static gboolean gvir_sandbox_builder_copy_init(GVirSandboxBuilder *builder,
                                                GVirSandboxConfig *config,
                                                const gchar *statedir,
                                                GError **error)
 {
+    GVirSandboxBuilderPrivate *priv = builder->priv;
     gchar *libsdir;
     GVirSandboxBuilderClass *klass = GVIR_SANDBOX_BUILDER_GET_CLASS(builder);
     GList *tocopy = NULL, *tmp = NULL;
+    GHashTable *files = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                              g_free, g_free);
+    GHashTableIter iter;
+    gpointer name, path;
     gboolean result = FALSE;
+    GError *e = NULL;
 
+    /* The shared library store gets mounted over this, if usable */
     libsdir = g_build_filename(statedir, "config", ".libs", NULL);
     g_mkdir_with_parents(libsdir, 0755);
 
     tmp = tocopy = klass->get_files_to_copy(builder, config);
     while (tmp) {
-        if (!gvir_sandbox_builder_copy_program(tmp->data, libsdir, error))
+        if (!gvir_sandbox_builder_list_program(tmp->data, files, error))
             goto cleanup;
 
         tmp = tmp->next;
     }
+
+    g_free(priv->libsdir);
+    if ((priv->libsdir = gvir_sandbox_builder_store_files(files, statedir, &e))) {
+        result = TRUE;
+        goto cleanup;
+    }
+    g_debug("Unable to use the shared library store: %s", e ? e->message : "");
+    g_clear_error(&e);
+
+    /* Otherwise fall back to a private copy for this sandbox */
+    g_hash_table_iter_init(&iter, files);
+    while (g_hash_table_iter_next(&iter, &name, &path)) {
+        if (!gvir_sandbox_builder_copy_file(path, libsdir, name, error))
+            goto cleanup;
+    }
     result = TRUE;
 
  cleanup:
+    gvir_sandbox_builder_elf_clear();
     g_free(libsdir);
+    g_hash_table_unref(files);
     g_list_free_full(tocopy, g_free);
 
     return result;
 }
 
 
+/**
+ * gvir_sandbox_builder_add_xml: (skip)
+ * @builder: (transfer none): the sandbox builder
+ * @parent: the element to add to, either "domain" or "devices"
+ * @xml: the XML fragment to add
+ *
+ * Queues up an XML fragment to add to the domain being constructed,
+ * for configuration that libvirt-gconfig has no objects for. The
+ * fragments are added once construction is otherwise complete.
+ */
+void gvir_sandbox_builder_add_xml(GVirSandboxBuilder *builder,
+                                  const gchar *parent,
+                                  const gchar *xml)
+{
+    GVirSandboxBuilderPrivate *priv = builder->priv;
+    GString *str;
+
+    if (!(str = g_hash_table_lookup(priv->xml, parent))) {
+        str = g_string_new("");
+        g_hash_table_insert(priv->xml, g_strdup(parent), str);
+    }
+    g_string_append(str, xml);
+}
+
+
+static gboolean gvir_sandbox_builder_apply_xml(GVirSandboxBuilder *builder,
+                                               GVirConfigDomain **domain,
+                                               GError **error)
+{
+    GVirSandboxBuilderPrivate *priv = builder->priv;
+    GVirConfigDomain *newdomain;
+    GHashTableIter iter;
+    gpointer parent, str;
+    gchar *xml;
+
+    if (!g_hash_table_size(priv->xml))
+        return TRUE;
+
+    xml = gvir_config_object_to_xml(GVIR_CONFIG_OBJECT(*domain));
+
+    g_hash_table_iter_init(&iter, priv->xml);
+    while (g_hash_table_iter_next(&iter, &parent, &str)) {
+        gchar *end = g_strdup_printf("</%s>", (gchar *)parent);
+        gchar *at = g_strrstr(xml, end);
+        gchar *tmp;
+
+        if (at) {
+            tmp = g_strdup_printf("%.*s%s%s", (int)(at - xml), xml,
+                                  ((GString *)str)->str, at);
+        } else {
+            at = g_strrstr(xml, "</domain>");
+            tmp = g_strdup_printf("%.*s<%s>%s</%s>%s", (int)(at - xml), xml,
+                                  (gchar *)parent, ((GString *)str)->str,
+                                  (gchar *)parent, at);
+        }
+        g_free(end);
+        g_free(xml);
+        xml = tmp;
+    }
+
+    newdomain = gvir_config_domain_new_from_xml(xml, error);
+    g_free(xml);
+    if (!newdomain)
+        return FALSE;
+
+    g_object_unref(*domain);
+    *domain = newdomain;
+    return TRUE;
+}
+
+
 static gboolean gvir_sandbox_builder_construct_domain(GVirSandboxBuilder *builder,
                                                       GVirSandboxConfig *config,
                                                       const gchar *statedir,
@@ -412,8 +1060,14 @@ static gboolean gvir_sandbox_builder_construct_basic(GVirSandboxBuilder *builder
     gvir_config_domain_set_uuid(domain,
                                 gvir_sandbox_config_get_uuid(config));
 #endif
-    /* XXX configurable */
-    gvir_config_domain_set_memory(domain, 1024*512);
+
+    gvir_config_domain_set_memory(domain,
+                                  gvir_sandbox_config_get_memory(config) / 1024);
+
+    if (gvir_sandbox_config_get_vcpus(config))
+        gvir_config_domain_set_vcpus(domain,
+                                     gvir_sandbox_config_get_vcpus(config));
+
     return TRUE;
 }
 
@@ -444,6 +1098,7 @@ static gboolean gvir_sandbox_builder_construct_disk_cfg(GVirSandboxBuilder *buil
 {
     GVirSandboxBuilderClass *klass = GVIR_SANDBOX_BUILDER_GET_CLASS(builder);
     guint nVirtioDev = 0;
+    GList *volumes = gvir_sandbox_config_get_volumes(config);
     gchar *dskfile = g_strdup_printf("%s/config/disks.cfg", statedir);
     GFile *file = g_file_new_for_path(dskfile);
     GFileOutputStream *fos = g_file_replace(file,
@@ -485,6 +1140,31 @@ static gboolean gvir_sandbox_builder_construct_disk_cfg(GVirSandboxBuilder *buil
         tmp = tmp->next;
     }
 
+    /* Raw data volumes follow straight on from the disks, while
+     * those holding a filesystem are left to the subclasses */
+    tmp = volumes;
+    while (tmp) {
+        GVirSandboxConfigVolume *vconfig = GVIR_SANDBOX_CONFIG_VOLUME(tmp->data);
+        const gchar *prefix = klass->get_disk_prefix(builder, config, NULL);
+        gchar *line;
+
+        tmp = tmp->next;
+        if (gvir_sandbox_config_volume_get_target(vconfig))
+            continue;
+
+        line = g_strdup_printf("%s\t/dev/%s%c\n",
+                               gvir_sandbox_config_volume_get_tag(vconfig),
+                               prefix, (char)('a' + (nVirtioDev)++));
+
+        if (!g_output_stream_write_all(G_OUTPUT_STREAM(fos),
+                                       line, strlen(line),
+                                       NULL, NULL, error)) {
+            g_free(line);
+            goto cleanup;
+        }
+        g_free(line);
+    }
+
     if (!g_output_stream_close(G_OUTPUT_STREAM(fos), NULL, error))
         goto cleanup;
 
@@ -492,6 +1172,8 @@ static gboolean gvir_sandbox_builder_construct_disk_cfg(GVirSandboxBuilder *buil
  cleanup:
     g_list_foreach(disks, (GFunc)g_object_unref, NULL);
     g_list_free(disks);
+    g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(volumes);
     if (fos)
         g_object_unref(fos);
     if (!ret)
@@ -502,12 +1184,271 @@ static gboolean gvir_sandbox_builder_construct_disk_cfg(GVirSandboxBuilder *buil
 
 }
 
+/**
+ * gvir_sandbox_builder_get_libsdir: (skip)
+ * @builder: (transfer none): the sandbox builder
+ *
+ * Retrieves the shared directory holding the init helpers and
+ * their libraries, to be mounted read-only over the .libs
+ * directory of the sandbox being constructed. If it is NULL,
+ * they were copied into that directory instead.
+ *
+ * Returns: (transfer none): the directory or NULL
+ */
+const gchar *gvir_sandbox_builder_get_libsdir(GVirSandboxBuilder *builder)
+{
+    return builder->priv->libsdir;
+}
+
+
+/**
+ * gvir_sandbox_builder_get_volume_path: (skip)
+ * @volume: (transfer none): the data volume
+ * @statedir: the sandbox state directory
+ *
+ * Returns: (transfer full): the host file backing @volume
+ */
+gchar *gvir_sandbox_builder_get_volume_path(GVirSandboxConfigVolume *volume,
+                                            const gchar *statedir)
+{
+    gchar *name;
+    gchar *path;
+
+    /* Raw input is handed over in place, it is never written */
+    if (!gvir_sandbox_config_volume_get_output(volume) &&
+        !gvir_sandbox_config_volume_get_target(volume))
+        return g_strdup(gvir_sandbox_config_volume_get_source(volume));
+
+    name = g_strdup_printf("%s.img", gvir_sandbox_config_volume_get_tag(volume));
+    path = g_build_filename(statedir, "volumes", name, NULL);
+    g_free(name);
+    return path;
+}
+
+
+/* Adds up the space a copy of @path needs, in whole 4k blocks */
+static gboolean gvir_sandbox_builder_measure_tree(const gchar *path,
+                                                  guint64 *bytes,
+                                                  guint64 *inodes,
+                                                  GError **error)
+{
+    struct stat sb;
+    GDir *dir;
+    const gchar *name;
+    gboolean ret = TRUE;
+
+    if (lstat(path, &sb) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to access %s: %s"), path, g_strerror(errno));
+        return FALSE;
+    }
+
+    *inodes += 1;
+    *bytes += ((guint64)sb.st_size + 4095) & ~4095ull;
+
+    if (!S_ISDIR(sb.st_mode))
+        return TRUE;
+
+    if (!(dir = g_dir_open(path, 0, error)))
+        return FALSE;
+
+    while (ret && (name = g_dir_read_name(dir))) {
+        gchar *child = g_build_filename(path, name, NULL);
+        ret = gvir_sandbox_builder_measure_tree(child, bytes, inodes, error);
+        g_free(child);
+    }
+
+    g_dir_close(dir);
+    return ret;
+}
+
+
+static gboolean gvir_sandbox_builder_format_volume(const gchar *path,
+                                                   const gchar *source,
+                                                   guint64 inodes,
+                                                   GError **error)
+{
+    const gchar *argv[12];
+    gsize n = 0;
+    gchar *inodeStr = NULL;
+    gchar *errout = NULL;
+    gint status;
+    gboolean ret = FALSE;
+
+    argv[n++] = MKFS_EXT4_PATH;
+    argv[n++] = "-q";
+    argv[n++] = "-F";
+    argv[n++] = "-m";
+    argv[n++] = "0";
+    if (source) {
+        inodeStr = g_strdup_printf("%" G_GUINT64_FORMAT,
+                                   inodes + inodes / 10 + 64);
+        argv[n++] = "-N";
+        argv[n++] = inodeStr;
+        argv[n++] = "-d";
+        argv[n++] = source;
+    }
+    argv[n++] = path;
+    argv[n] = NULL;
+
+    if (!g_spawn_sync(NULL, (gchar **)argv, NULL,
+                      G_SPAWN_STDOUT_TO_DEV_NULL,
+                      NULL, NULL, NULL, &errout, &status, error))
+        goto cleanup;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to create filesystem on %s: %s"),
+                    path, errout ? g_strstrip(errout) : "");
+        goto cleanup;
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_free(errout);
+    g_free(inodeStr);
+    return ret;
+}
+
+
+/*
+ * Creates the backing file of every data volume that needs one.
+ * They are sparse, so only what the app actually writes, or what
+ * mkfs copies in, takes up space on the host.
+ */
+static gboolean gvir_sandbox_builder_construct_volumes(GVirSandboxConfig *config,
+                                                       const gchar *statedir,
+                                                       GError **error)
+{
+    GList *volumes = gvir_sandbox_config_get_volumes(config);
+    GList *tmp;
+    gchar *voldir = g_build_filename(statedir, "volumes", NULL);
+    gboolean ret = FALSE;
+
+    if (volumes && g_mkdir_with_parents(voldir, 0700) < 0) {
+        g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                    _("Unable to create %s: %s"), voldir, g_strerror(errno));
+        goto cleanup;
+    }
+
+    for (tmp = volumes ; tmp ; tmp = tmp->next) {
+        GVirSandboxConfigVolume *vconfig = GVIR_SANDBOX_CONFIG_VOLUME(tmp->data);
+        gboolean output = gvir_sandbox_config_volume_get_output(vconfig);
+        const gchar *source = gvir_sandbox_config_volume_get_source(vconfig);
+        const gchar *target = gvir_sandbox_config_volume_get_target(vconfig);
+        guint64 size = gvir_sandbox_config_volume_get_size(vconfig);
+        guint64 bytes = 0, inodes = 0;
+        gchar *path;
+        int fd;
+
+        if (!output && !target)
+            continue;
+
+        if (!output) {
+            if (!gvir_sandbox_builder_measure_tree(source, &bytes, &inodes, error))
+                goto cleanup;
+            /* Leave room for the filesystem metadata */
+            if (!size)
+                size = (bytes + bytes / 10 + inodes * 256 +
+                        (64 * 1024 * 1024) + 0xfffff) & ~0xfffffull;
+        }
+
+        path = gvir_sandbox_builder_get_volume_path(vconfig, statedir);
+        if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)) < 0 ||
+            ftruncate(fd, size) < 0) {
+            g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                        _("Unable to create volume %s: %s"), path, g_strerror(errno));
+            if (fd >= 0)
+                close(fd);
+            g_free(path);
+            goto cleanup;
+        }
+        close(fd);
+
+        if (target &&
+            !gvir_sandbox_builder_format_volume(path, output ? NULL : source,
+                                                inodes, error)) {
+            g_free(path);
+            goto cleanup;
+        }
+        g_free(path);
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(volumes);
+    g_free(voldir);
+    return ret;
+}
+
+
+/*
+ * Hands the output volumes back to the host, at the path
+ * they were configured with, and discards the input copies.
+ */
+static gboolean gvir_sandbox_builder_finish_volumes(GVirSandboxConfig *config,
+                                                    const gchar *statedir,
+                                                    GError **error)
+{
+    GList *volumes = gvir_sandbox_config_get_volumes(config);
+    GList *tmp;
+    gchar *voldir = g_build_filename(statedir, "volumes", NULL);
+    gboolean ret = TRUE;
+
+    for (tmp = volumes ; tmp ; tmp = tmp->next) {
+        GVirSandboxConfigVolume *vconfig = GVIR_SANDBOX_CONFIG_VOLUME(tmp->data);
+        const gchar *source = gvir_sandbox_config_volume_get_source(vconfig);
+        gchar *path;
+
+        if (!gvir_sandbox_config_volume_get_output(vconfig) &&
+            !gvir_sandbox_config_volume_get_target(vconfig))
+            continue;
+
+        path = gvir_sandbox_builder_get_volume_path(vconfig, statedir);
+        if (!gvir_sandbox_config_volume_get_output(vconfig)) {
+            if (unlink(path) < 0 && errno != ENOENT)
+                ret = FALSE;
+        } else if (rename(path, source) < 0) {
+            /* A copy loses the holes, so only do it when we must */
+            if (errno == EXDEV) {
+                GFile *src = g_file_new_for_path(path);
+                GFile *dst = g_file_new_for_path(source);
+                if (!g_file_move(src, dst, G_FILE_COPY_OVERWRITE,
+                                 NULL, NULL, NULL, ret ? error : NULL))
+                    ret = FALSE;
+                g_object_unref(src);
+                g_object_unref(dst);
+            } else if (errno != ENOENT) {
+                if (ret)
+                    g_set_error(error, GVIR_SANDBOX_BUILDER_ERROR, 0,
+                                _("Unable to move volume %s to %s: %s"),
+                                path, source, g_strerror(errno));
+                ret = FALSE;
+            }
+        }
+        g_free(path);
+    }
+
+    if (volumes && rmdir(voldir) < 0 && errno != ENOENT)
+        ret = FALSE;
+
+    g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(volumes);
+    g_free(voldir);
+    return ret;
+}
+
+
 static gboolean gvir_sandbox_builder_construct_devices(GVirSandboxBuilder *builder,
                                                        GVirSandboxConfig *config,
                                                        const gchar *statedir,
                                                        GVirConfigDomain *domain,
                                                        GError **error)
 {
+    if (!gvir_sandbox_builder_construct_volumes(config, statedir, error))
+        return FALSE;
+
     return gvir_sandbox_builder_construct_disk_cfg(builder, config, statedir,error);
 }
 
@@ -663,7 +1604,10 @@ GVirConfigDomain *gvir_sandbox_builder_construct(GVirSandboxBuilder *builder,
     GVirConfigDomain *domain = gvir_config_domain_new();
     GVirSandboxBuilderClass *klass = GVIR_SANDBOX_BUILDER_GET_CLASS(builder);
 
-    if (!(klass->construct_domain(builder, config, statedir, domain, error))) {
+    g_hash_table_remove_all(builder->priv->xml);
+
+    if (!(klass->construct_domain(builder, config, statedir, domain, error)) ||
+        !gvir_sandbox_builder_apply_xml(builder, &domain, error)) {
         g_object_unref(domain);
         return NULL;
     }
@@ -721,6 +1665,10 @@ gboolean gvir_sandbox_builder_clean_post_stop(GVirSandboxBuilder *builder,
 
     ret = klass->clean_post_stop(builder, config, statedir, error);
 
+    if (!gvir_sandbox_builder_finish_volumes(config, statedir,
+                                             ret ? error : NULL))
+        ret = FALSE;
+
     if (unlink(dskfile) < 0 &&
         errno != ENOENT)
         ret = FALSE;
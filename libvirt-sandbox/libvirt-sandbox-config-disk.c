@@ -45,6 +45,12 @@ struct _GVirSandboxConfigDiskPrivate
     gchar *tag;
     gchar *source;
     GVirConfigDomainDiskFormat format;
+    gchar *cache;
+    gchar *io;
+    gchar *discard;
+    gchar *detectZeroes;
+    gboolean iothread;
+    guint queues;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxConfigDisk, gvir_sandbox_config_disk, G_TYPE_OBJECT);
@@ -55,7 +61,13 @@ enum {
     PROP_TYPE,
     PROP_TAG,
     PROP_SOURCE,
-    PROP_FORMAT
+    PROP_FORMAT,
+    PROP_CACHE,
+    PROP_IO,
+    PROP_DISCARD,
+    PROP_DETECT_ZEROES,
+    PROP_IOTHREAD,
+    PROP_QUEUES
 };
 
 enum {
@@ -85,6 +97,24 @@ static void gvir_sandbox_config_disk_get_property(GObject *object,
     case PROP_FORMAT:
         g_value_set_enum(value, priv->format);
         break;
+    case PROP_CACHE:
+        g_value_set_string(value, priv->cache);
+        break;
+    case PROP_IO:
+        g_value_set_string(value, priv->io);
+        break;
+    case PROP_DISCARD:
+        g_value_set_string(value, priv->discard);
+        break;
+    case PROP_DETECT_ZEROES:
+        g_value_set_string(value, priv->detectZeroes);
+        break;
+    case PROP_IOTHREAD:
+        g_value_set_boolean(value, priv->iothread);
+        break;
+    case PROP_QUEUES:
+        g_value_set_uint(value, priv->queues);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -114,6 +144,28 @@ static void gvir_sandbox_config_disk_set_property(GObject *object,
     case PROP_FORMAT:
         priv->format = g_value_get_enum(value);
         break;
+    case PROP_CACHE:
+        g_free(priv->cache);
+        priv->cache = g_value_dup_string(value);
+        break;
+    case PROP_IO:
+        g_free(priv->io);
+        priv->io = g_value_dup_string(value);
+        break;
+    case PROP_DISCARD:
+        g_free(priv->discard);
+        priv->discard = g_value_dup_string(value);
+        break;
+    case PROP_DETECT_ZEROES:
+        g_free(priv->detectZeroes);
+        priv->detectZeroes = g_value_dup_string(value);
+        break;
+    case PROP_IOTHREAD:
+        priv->iothread = g_value_get_boolean(value);
+        break;
+    case PROP_QUEUES:
+        priv->queues = g_value_get_uint(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -127,6 +179,10 @@ static void gvir_sandbox_config_disk_finalize(GObject *object)
 
     g_free(priv->tag);
     g_free(priv->source);
+    g_free(priv->cache);
+    g_free(priv->io);
+    g_free(priv->discard);
+    g_free(priv->detectZeroes);
 
     G_OBJECT_CLASS(gvir_sandbox_config_disk_parent_class)->finalize(object);
 }
@@ -194,6 +250,84 @@ static void gvir_sandbox_config_disk_class_init(GVirSandboxConfigDiskClass *klas
                                                       G_PARAM_STATIC_NAME |
                                                       G_PARAM_STATIC_NICK |
                                                       G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_CACHE,
+                                    g_param_spec_string("cache",
+                                                        "Cache",
+                                                        "The disk cache mode",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_IO,
+                                    g_param_spec_string("io",
+                                                        "IO",
+                                                        "The disk I/O mode",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_DISCARD,
+                                    g_param_spec_string("discard",
+                                                        "Discard",
+                                                        "The disk discard mode",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_DETECT_ZEROES,
+                                    g_param_spec_string("detect-zeroes",
+                                                        "Detect zeroes",
+                                                        "The disk zero write detection mode",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_IOTHREAD,
+                                    g_param_spec_boolean("iothread",
+                                                         "IO thread",
+                                                         "Whether the disk has a dedicated I/O thread",
+                                                         FALSE,
+                                                         G_PARAM_READABLE |
+                                                         G_PARAM_WRITABLE |
+                                                         G_PARAM_CONSTRUCT_ONLY |
+                                                         G_PARAM_STATIC_NAME |
+                                                         G_PARAM_STATIC_NICK |
+                                                         G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_QUEUES,
+                                    g_param_spec_uint("queues",
+                                                      "Queues",
+                                                      "The number of disk queues",
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READABLE |
+                                                      G_PARAM_WRITABLE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_NAME |
+                                                      G_PARAM_STATIC_NICK |
+                                                      G_PARAM_STATIC_BLURB));
 }
 
 
@@ -261,6 +395,100 @@ const gchar *gvir_sandbox_config_disk_get_source(GVirSandboxConfigDisk *config)
     return priv->source;
 }
 
+
+/**
+ * gvir_sandbox_config_disk_get_cache:
+ * @config: (transfer none): the sandbox disk config
+ *
+ * Retrieves the cache mode of the custom disk, one of none,
+ * writethrough, writeback, directsync or unsafe
+ *
+ * Returns: (transfer none): the cache mode, or NULL for the default
+ */
+const gchar *gvir_sandbox_config_disk_get_cache(GVirSandboxConfigDisk *config)
+{
+    GVirSandboxConfigDiskPrivate *priv = config->priv;
+    return priv->cache;
+}
+
+
+/**
+ * gvir_sandbox_config_disk_get_io:
+ * @config: (transfer none): the sandbox disk config
+ *
+ * Retrieves the I/O mode of the custom disk, one of native,
+ * threads or io_uring
+ *
+ * Returns: (transfer none): the I/O mode, or NULL for the default
+ */
+const gchar *gvir_sandbox_config_disk_get_io(GVirSandboxConfigDisk *config)
+{
+    GVirSandboxConfigDiskPrivate *priv = config->priv;
+    return priv->io;
+}
+
+
+/**
+ * gvir_sandbox_config_disk_get_discard:
+ * @config: (transfer none): the sandbox disk config
+ *
+ * Retrieves the discard mode of the custom disk, either unmap
+ * or ignore
+ *
+ * Returns: (transfer none): the discard mode, or NULL for the default
+ */
+const gchar *gvir_sandbox_config_disk_get_discard(GVirSandboxConfigDisk *config)
+{
+    GVirSandboxConfigDiskPrivate *priv = config->priv;
+    return priv->discard;
+}
+
+
+/**
+ * gvir_sandbox_config_disk_get_detect_zeroes:
+ * @config: (transfer none): the sandbox disk config
+ *
+ * Retrieves the zero write detection mode of the custom disk,
+ * one of off, on or unmap
+ *
+ * Returns: (transfer none): the detection mode, or NULL for the default
+ */
+const gchar *gvir_sandbox_config_disk_get_detect_zeroes(GVirSandboxConfigDisk *config)
+{
+    GVirSandboxConfigDiskPrivate *priv = config->priv;
+    return priv->detectZeroes;
+}
+
+
+/**
+ * gvir_sandbox_config_disk_get_iothread:
+ * @config: (transfer none): the sandbox disk config
+ *
+ * Retrieves whether the custom disk has a dedicated I/O thread
+ *
+ * Returns: the I/O thread flag
+ */
+gboolean gvir_sandbox_config_disk_get_iothread(GVirSandboxConfigDisk *config)
+{
+    GVirSandboxConfigDiskPrivate *priv = config->priv;
+    return priv->iothread;
+}
+
+
+/**
+ * gvir_sandbox_config_disk_get_queues:
+ * @config: (transfer none): the sandbox disk config
+ *
+ * Retrieves the number of queues of the custom disk
+ *
+ * Returns: the queue count, or 0 for the default
+ */
+guint gvir_sandbox_config_disk_get_queues(GVirSandboxConfigDisk *config)
+{
+    GVirSandboxConfigDiskPrivate *priv = config->priv;
+    return priv->queues;
+}
+
 /*
  * Local variables:
  *  c-indent-level: 4
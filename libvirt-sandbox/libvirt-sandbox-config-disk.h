@@ -68,6 +68,18 @@ GVirConfigDomainDiskType gvir_sandbox_config_disk_get_disk_type(GVirSandboxConfi
 
 GVirConfigDomainDiskFormat gvir_sandbox_config_disk_get_format(GVirSandboxConfigDisk *config);
 
+const gchar *gvir_sandbox_config_disk_get_cache(GVirSandboxConfigDisk *config);
+
+const gchar *gvir_sandbox_config_disk_get_io(GVirSandboxConfigDisk *config);
+
+const gchar *gvir_sandbox_config_disk_get_discard(GVirSandboxConfigDisk *config);
+
+const gchar *gvir_sandbox_config_disk_get_detect_zeroes(GVirSandboxConfigDisk *config);
+
+gboolean gvir_sandbox_config_disk_get_iothread(GVirSandboxConfigDisk *config);
+
+guint gvir_sandbox_config_disk_get_queues(GVirSandboxConfigDisk *config);
+
 G_END_DECLS
 
 #endif /* __LIBVIRT_SANDBOX_CONFIG_DISK_H__ */
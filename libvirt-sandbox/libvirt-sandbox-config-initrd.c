@@ -46,6 +46,8 @@ struct _GVirSandboxConfigInitrdPrivate
     gchar *init;
     gchar *kmoddir;
     GList *modules;
+    gchar *compression;
+    gint compressionLevel;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxConfigInitrd, gvir_sandbox_config_initrd, G_TYPE_OBJECT);
@@ -56,6 +58,8 @@ enum {
     PROP_KVER,
     PROP_KMODDIR,
     PROP_INIT,
+    PROP_COMPRESSION,
+    PROP_COMPRESSION_LEVEL,
 };
 
 enum {
@@ -86,6 +90,14 @@ static void gvir_sandbox_config_initrd_get_property(GObject *object,
         g_value_set_string(value, priv->init);
         break;
 
+    case PROP_COMPRESSION:
+        g_value_set_string(value, priv->compression);
+        break;
+
+    case PROP_COMPRESSION_LEVEL:
+        g_value_set_int(value, priv->compressionLevel);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -116,6 +128,15 @@ static void gvir_sandbox_config_initrd_set_property(GObject *object,
         priv->init = g_value_dup_string(value);
         break;
 
+    case PROP_COMPRESSION:
+        g_free(priv->compression);
+        priv->compression = g_value_dup_string(value);
+        break;
+
+    case PROP_COMPRESSION_LEVEL:
+        priv->compressionLevel = g_value_get_int(value);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -128,6 +149,7 @@ static void gvir_sandbox_config_initrd_finalize(GObject *object)
     GVirSandboxConfigInitrdPrivate *priv = config->priv;
 
     g_free(priv->init);
+    g_free(priv->compression);
 
     G_OBJECT_CLASS(gvir_sandbox_config_initrd_parent_class)->finalize(object);
 }
@@ -174,6 +196,30 @@ static void gvir_sandbox_config_initrd_class_init(GVirSandboxConfigInitrdClass *
                                                         G_PARAM_STATIC_NAME |
                                                         G_PARAM_STATIC_NICK |
                                                         G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_COMPRESSION,
+                                    g_param_spec_string("compression",
+                                                        "Compression",
+                                                        "The ramdisk compression codec",
+                                                        "gzip",
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_COMPRESSION_LEVEL,
+                                    g_param_spec_int("compression-level",
+                                                     "Compression level",
+                                                     "The ramdisk compression level",
+                                                     -1,
+                                                     G_MAXINT,
+                                                     -1,
+                                                     G_PARAM_READABLE |
+                                                     G_PARAM_WRITABLE |
+                                                     G_PARAM_STATIC_NAME |
+                                                     G_PARAM_STATIC_NICK |
+                                                     G_PARAM_STATIC_BLURB));
 }
 
 
@@ -182,6 +228,8 @@ static void gvir_sandbox_config_initrd_init(GVirSandboxConfigInitrd *config)
     GVirSandboxConfigInitrdPrivate *priv = config->priv;
     priv = config->priv = GVIR_SANDBOX_CONFIG_INITRD_GET_PRIVATE(config);
     priv->init = g_strdup(LIBEXECDIR "/libvirt-sandbox-init-qemu");
+    priv->compression = g_strdup("gzip");
+    priv->compressionLevel = -1;
 }
 
 
@@ -318,6 +366,71 @@ GList *gvir_sandbox_config_initrd_get_modules(GVirSandboxConfigInitrd *config)
     return g_list_copy(priv->modules);
 }
 
+
+/**
+ * gvir_sandbox_config_initrd_set_compression:
+ * @config: (transfer none): the sandbox initrd config
+ * @codec: (transfer none): the compression codec
+ *
+ * Sets the codec used to compress the initrd, one of "gzip",
+ * "lz4", "zstd" or "none". The kernel must be able to decompress
+ * whichever is chosen. An uncompressed initrd is the quickest to
+ * build and boot when it does not have to be copied far. This
+ * defaults to "gzip"
+ */
+void gvir_sandbox_config_initrd_set_compression(GVirSandboxConfigInitrd *config,
+                                                const gchar *codec)
+{
+    GVirSandboxConfigInitrdPrivate *priv = config->priv;
+    g_free(priv->compression);
+    priv->compression = g_strdup(codec);
+}
+
+/**
+ * gvir_sandbox_config_initrd_get_compression:
+ * @config: (transfer none): the sandbox initrd config
+ *
+ * Retrieves the initrd compression codec
+ *
+ * Returns: (transfer none): the compression codec
+ */
+const gchar *gvir_sandbox_config_initrd_get_compression(GVirSandboxConfigInitrd *config)
+{
+    GVirSandboxConfigInitrdPrivate *priv = config->priv;
+    return priv->compression;
+}
+
+
+/**
+ * gvir_sandbox_config_initrd_set_compression_level:
+ * @config: (transfer none): the sandbox initrd config
+ * @level: the compression level, or -1
+ *
+ * Sets the level passed to the compression codec, whose meaning
+ * and range depend on the codec. This defaults to -1, which picks
+ * the codec's own default
+ */
+void gvir_sandbox_config_initrd_set_compression_level(GVirSandboxConfigInitrd *config,
+                                                      gint level)
+{
+    GVirSandboxConfigInitrdPrivate *priv = config->priv;
+    priv->compressionLevel = level;
+}
+
+/**
+ * gvir_sandbox_config_initrd_get_compression_level:
+ * @config: (transfer none): the sandbox initrd config
+ *
+ * Retrieves the initrd compression level
+ *
+ * Returns: the compression level, or -1 for the codec default
+ */
+gint gvir_sandbox_config_initrd_get_compression_level(GVirSandboxConfigInitrd *config)
+{
+    GVirSandboxConfigInitrdPrivate *priv = config->priv;
+    return priv->compressionLevel;
+}
+
 /*
  * Local variables:
  *  c-indent-level: 4
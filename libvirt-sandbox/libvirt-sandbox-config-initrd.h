@@ -74,6 +74,14 @@ const gchar *gvir_sandbox_config_initrd_get_init(GVirSandboxConfigInitrd *config
 void gvir_sandbox_config_initrd_add_module(GVirSandboxConfigInitrd *config, const gchar *modname);
 GList *gvir_sandbox_config_initrd_get_modules(GVirSandboxConfigInitrd *config);
 
+void gvir_sandbox_config_initrd_set_compression(GVirSandboxConfigInitrd *config,
+                                                const gchar *codec);
+const gchar *gvir_sandbox_config_initrd_get_compression(GVirSandboxConfigInitrd *config);
+
+void gvir_sandbox_config_initrd_set_compression_level(GVirSandboxConfigInitrd *config,
+                                                      gint level);
+gint gvir_sandbox_config_initrd_get_compression_level(GVirSandboxConfigInitrd *config);
+
 G_END_DECLS
 
 #endif /* __LIBVIRT_SANDBOX_CONFIG_INITRD_H__ */
@@ -45,6 +45,11 @@ struct _GVirSandboxConfigNetworkPrivate
     gboolean dhcp;
     gchar *source;
     gchar *mac;
+    gchar *backend;
+    gboolean vhost;
+    guint queues;
+    guint rxQueueSize;
+    guint txQueueSize;
     GList *routes;
     GList *addrs;
     GVirSandboxConfigNetworkFilterref *filterref;
@@ -58,6 +63,11 @@ enum {
     PROP_DHCP,
     PROP_SOURCE,
     PROP_MAC,
+    PROP_BACKEND,
+    PROP_VHOST,
+    PROP_QUEUES,
+    PROP_RX_QUEUE_SIZE,
+    PROP_TX_QUEUE_SIZE,
 };
 
 enum {
@@ -88,6 +98,26 @@ static void gvir_sandbox_config_network_get_property(GObject *object,
         g_value_set_string(value, priv->mac);
         break;
 
+    case PROP_BACKEND:
+        g_value_set_string(value, priv->backend);
+        break;
+
+    case PROP_VHOST:
+        g_value_set_boolean(value, priv->vhost);
+        break;
+
+    case PROP_QUEUES:
+        g_value_set_uint(value, priv->queues);
+        break;
+
+    case PROP_RX_QUEUE_SIZE:
+        g_value_set_uint(value, priv->rxQueueSize);
+        break;
+
+    case PROP_TX_QUEUE_SIZE:
+        g_value_set_uint(value, priv->txQueueSize);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -117,6 +147,27 @@ static void gvir_sandbox_config_network_set_property(GObject *object,
         priv->mac = g_value_dup_string(value);
         break;
 
+    case PROP_BACKEND:
+        g_free(priv->backend);
+        priv->backend = g_value_dup_string(value);
+        break;
+
+    case PROP_VHOST:
+        priv->vhost = g_value_get_boolean(value);
+        break;
+
+    case PROP_QUEUES:
+        priv->queues = g_value_get_uint(value);
+        break;
+
+    case PROP_RX_QUEUE_SIZE:
+        priv->rxQueueSize = g_value_get_uint(value);
+        break;
+
+    case PROP_TX_QUEUE_SIZE:
+        priv->txQueueSize = g_value_get_uint(value);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -130,6 +181,7 @@ static void gvir_sandbox_config_network_finalize(GObject *object)
 
     g_free(priv->source);
     g_free(priv->mac);
+    g_free(priv->backend);
     g_list_foreach(priv->addrs, (GFunc)g_object_unref, NULL);
     g_list_free(priv->addrs);
     g_list_foreach(priv->routes, (GFunc)g_object_unref, NULL);
@@ -183,6 +235,72 @@ static void gvir_sandbox_config_network_class_init(GVirSandboxConfigNetworkClass
                                                         G_PARAM_STATIC_NAME |
                                                         G_PARAM_STATIC_NICK |
                                                         G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_BACKEND,
+                                    g_param_spec_string("backend",
+                                                        "Backend",
+                                                        "User mode network backend",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_VHOST,
+                                    g_param_spec_boolean("vhost",
+                                                         "Vhost",
+                                                         "Use the host kernel datapath",
+                                                         FALSE,
+                                                         G_PARAM_READABLE |
+                                                         G_PARAM_WRITABLE |
+                                                         G_PARAM_STATIC_NAME |
+                                                         G_PARAM_STATIC_NICK |
+                                                         G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_QUEUES,
+                                    g_param_spec_uint("queues",
+                                                      "Queues",
+                                                      "Number of queue pairs",
+                                                      0,
+                                                      G_MAXUINT,
+                                                      0,
+                                                      G_PARAM_READABLE |
+                                                      G_PARAM_WRITABLE |
+                                                      G_PARAM_STATIC_NAME |
+                                                      G_PARAM_STATIC_NICK |
+                                                      G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_RX_QUEUE_SIZE,
+                                    g_param_spec_uint("rx-queue-size",
+                                                      "RX queue size",
+                                                      "Receive ring size",
+                                                      0,
+                                                      G_MAXUINT,
+                                                      0,
+                                                      G_PARAM_READABLE |
+                                                      G_PARAM_WRITABLE |
+                                                      G_PARAM_STATIC_NAME |
+                                                      G_PARAM_STATIC_NICK |
+                                                      G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_TX_QUEUE_SIZE,
+                                    g_param_spec_uint("tx-queue-size",
+                                                      "TX queue size",
+                                                      "Transmit ring size",
+                                                      0,
+                                                      G_MAXUINT,
+                                                      0,
+                                                      G_PARAM_READABLE |
+                                                      G_PARAM_WRITABLE |
+                                                      G_PARAM_STATIC_NAME |
+                                                      G_PARAM_STATIC_NICK |
+                                                      G_PARAM_STATIC_BLURB));
 }
 
 
@@ -229,6 +347,7 @@ void gvir_sandbox_config_network_set_mac(GVirSandboxConfigNetwork *config,
                                          const gchar *mac)
 {
     GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    g_return_if_fail(mac == NULL || gvir_sandbox_util_is_mac_address(mac));
     g_free(priv->mac);
     priv->mac = g_strdup(mac);
 }
@@ -256,6 +375,174 @@ gboolean gvir_sandbox_config_network_get_dhcp(GVirSandboxConfigNetwork *config)
 }
 
 
+/**
+ * gvir_sandbox_config_network_set_backend:
+ * @config: (transfer none): the sandbox network configuration
+ * @backend: (allow-none): the user mode backend
+ *
+ * Set the backend of an interface which has no source network.
+ * With "passt", the guest traffic goes through a passt process,
+ * which forwards it with ordinary host sockets and is much faster
+ * than the default "slirp" stack built into QEMU. Only "slirp",
+ * which is the same as NULL, can be used with container based
+ * sandboxes.
+ */
+void gvir_sandbox_config_network_set_backend(GVirSandboxConfigNetwork *config,
+                                             const gchar *backend)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    g_return_if_fail(backend == NULL || gvir_sandbox_util_is_network_backend(backend));
+    g_free(priv->backend);
+    /* slirp is what QEMU uses anyway, so keep the default */
+    if (backend && g_str_equal(backend, "slirp"))
+        backend = NULL;
+    priv->backend = g_strdup(backend);
+}
+
+
+/**
+ * gvir_sandbox_config_network_get_backend:
+ * @config: (transfer none): the sandbox network configuration
+ *
+ * Retrieves the user mode backend of the interface
+ *
+ * Returns: (transfer none): the backend, or NULL for the default
+ */
+const gchar *gvir_sandbox_config_network_get_backend(GVirSandboxConfigNetwork *config)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    return priv->backend;
+}
+
+
+/**
+ * gvir_sandbox_config_network_set_vhost:
+ * @config: (transfer none): the sandbox network configuration
+ * @vhost: true to use vhost
+ *
+ * Move the packet datapath of a virtual machine interface
+ * into the host kernel, instead of the QEMU process. This
+ * is ignored for user mode interfaces and for containers.
+ */
+void gvir_sandbox_config_network_set_vhost(GVirSandboxConfigNetwork *config,
+                                           gboolean vhost)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    priv->vhost = vhost;
+}
+
+
+/**
+ * gvir_sandbox_config_network_get_vhost:
+ * @config: (transfer none): the sandbox network configuration
+ *
+ * Retrieves whether the interface uses vhost
+ *
+ * Returns: true if vhost is used
+ */
+gboolean gvir_sandbox_config_network_get_vhost(GVirSandboxConfigNetwork *config)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    return priv->vhost;
+}
+
+
+/**
+ * gvir_sandbox_config_network_set_queues:
+ * @config: (transfer none): the sandbox network configuration
+ * @queues: the number of queue pairs, or 0
+ *
+ * Set the number of transmit/receive queue pairs of a vhost
+ * interface. With 0, the interface gets one queue pair per
+ * sandbox vCPU, so that each vCPU can handle its own traffic.
+ */
+void gvir_sandbox_config_network_set_queues(GVirSandboxConfigNetwork *config,
+                                            guint queues)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    priv->queues = queues;
+}
+
+
+/**
+ * gvir_sandbox_config_network_get_queues:
+ * @config: (transfer none): the sandbox network configuration
+ *
+ * Retrieves the number of queue pairs of the interface
+ *
+ * Returns: the number of queue pairs, or 0 to match the vCPUs
+ */
+guint gvir_sandbox_config_network_get_queues(GVirSandboxConfigNetwork *config)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    return priv->queues;
+}
+
+
+/**
+ * gvir_sandbox_config_network_set_rx_queue_size:
+ * @config: (transfer none): the sandbox network configuration
+ * @size: the number of receive ring entries, or 0
+ *
+ * Set the size of each receive ring of the interface. It must
+ * be a power of two between 256 and 1024, or 0 for the
+ * hypervisor default.
+ */
+void gvir_sandbox_config_network_set_rx_queue_size(GVirSandboxConfigNetwork *config,
+                                                   guint size)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    priv->rxQueueSize = size;
+}
+
+
+/**
+ * gvir_sandbox_config_network_get_rx_queue_size:
+ * @config: (transfer none): the sandbox network configuration
+ *
+ * Retrieves the size of each receive ring of the interface
+ *
+ * Returns: the number of ring entries, or 0 for the default
+ */
+guint gvir_sandbox_config_network_get_rx_queue_size(GVirSandboxConfigNetwork *config)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    return priv->rxQueueSize;
+}
+
+
+/**
+ * gvir_sandbox_config_network_set_tx_queue_size:
+ * @config: (transfer none): the sandbox network configuration
+ * @size: the number of transmit ring entries, or 0
+ *
+ * Set the size of each transmit ring of the interface. It must
+ * be a power of two between 256 and 1024, or 0 for the
+ * hypervisor default.
+ */
+void gvir_sandbox_config_network_set_tx_queue_size(GVirSandboxConfigNetwork *config,
+                                                   guint size)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    priv->txQueueSize = size;
+}
+
+
+/**
+ * gvir_sandbox_config_network_get_tx_queue_size:
+ * @config: (transfer none): the sandbox network configuration
+ *
+ * Retrieves the size of each transmit ring of the interface
+ *
+ * Returns: the number of ring entries, or 0 for the default
+ */
+guint gvir_sandbox_config_network_get_tx_queue_size(GVirSandboxConfigNetwork *config)
+{
+    GVirSandboxConfigNetworkPrivate *priv = config->priv;
+    return priv->txQueueSize;
+}
+
+
 /**
  * gvir_sandbox_config_network_add_address:
  * @config: (transfer none): the sandbox network configuration
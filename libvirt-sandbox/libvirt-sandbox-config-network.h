@@ -74,6 +74,26 @@ void gvir_sandbox_config_network_set_dhcp(GVirSandboxConfigNetwork *config,
                                           gboolean dhcp);
 gboolean gvir_sandbox_config_network_get_dhcp(GVirSandboxConfigNetwork *config);
 
+void gvir_sandbox_config_network_set_backend(GVirSandboxConfigNetwork *config,
+                                             const gchar *backend);
+const gchar *gvir_sandbox_config_network_get_backend(GVirSandboxConfigNetwork *config);
+
+void gvir_sandbox_config_network_set_vhost(GVirSandboxConfigNetwork *config,
+                                           gboolean vhost);
+gboolean gvir_sandbox_config_network_get_vhost(GVirSandboxConfigNetwork *config);
+
+void gvir_sandbox_config_network_set_queues(GVirSandboxConfigNetwork *config,
+                                            guint queues);
+guint gvir_sandbox_config_network_get_queues(GVirSandboxConfigNetwork *config);
+
+void gvir_sandbox_config_network_set_rx_queue_size(GVirSandboxConfigNetwork *config,
+                                                   guint size);
+guint gvir_sandbox_config_network_get_rx_queue_size(GVirSandboxConfigNetwork *config);
+
+void gvir_sandbox_config_network_set_tx_queue_size(GVirSandboxConfigNetwork *config,
+                                                   guint size);
+guint gvir_sandbox_config_network_get_tx_queue_size(GVirSandboxConfigNetwork *config);
+
 void gvir_sandbox_config_network_add_address(GVirSandboxConfigNetwork *config,
                                              GVirSandboxConfigNetworkAddress *addr);
 GList *gvir_sandbox_config_network_get_addresses(GVirSandboxConfigNetwork *config);
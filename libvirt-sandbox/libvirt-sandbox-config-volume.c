@@ -0,0 +1,317 @@
+/*
+ * libvirt-sandbox-config-volume.c: libvirt sandbox data volume configuration
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "libvirt-sandbox/libvirt-sandbox-config-all.h"
+
+/**
+ * SECTION: libvirt-sandbox-config-volume
+ * @short_description: Data volume configuration details
+ * @include: libvirt-sandbox/libvirt-sandbox.h
+ * @see_also: #GVirSandboxConfig
+ *
+ * Provides an object to store information about a data volume in the sandbox
+ *
+ * A data volume is a scratch block device created for a single run
+ * of the sandbox, for moving bulk data in or out without going through
+ * the console or a 9p share. An input volume is filled from the host
+ * before the sandbox starts, while an output volume starts out empty
+ * and is moved to its host path once the sandbox has stopped. If a
+ * target is set, the volume holds an ext4 filesystem mounted at that
+ * path, otherwise the application sees the bare block device as
+ * /dev/disk/by-tag/TAG.
+ */
+
+#define GVIR_SANDBOX_CONFIG_VOLUME_GET_PRIVATE(obj)                     \
+    (G_TYPE_INSTANCE_GET_PRIVATE((obj), GVIR_SANDBOX_TYPE_CONFIG_VOLUME, GVirSandboxConfigVolumePrivate))
+
+
+struct _GVirSandboxConfigVolumePrivate
+{
+    gchar *tag;
+    gchar *source;
+    gchar *target;
+    gboolean output;
+    guint64 size;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxConfigVolume, gvir_sandbox_config_volume, G_TYPE_OBJECT);
+
+
+enum {
+    PROP_0,
+    PROP_TAG,
+    PROP_SOURCE,
+    PROP_TARGET,
+    PROP_OUTPUT,
+    PROP_SIZE
+};
+
+enum {
+    LAST_SIGNAL
+};
+
+
+
+static void gvir_sandbox_config_volume_get_property(GObject *object,
+                                                    guint prop_id,
+                                                    GValue *value,
+                                                    GParamSpec *pspec)
+{
+    GVirSandboxConfigVolume *config = GVIR_SANDBOX_CONFIG_VOLUME(object);
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+
+    switch (prop_id) {
+    case PROP_TAG:
+        g_value_set_string(value, priv->tag);
+        break;
+    case PROP_SOURCE:
+        g_value_set_string(value, priv->source);
+        break;
+    case PROP_TARGET:
+        g_value_set_string(value, priv->target);
+        break;
+    case PROP_OUTPUT:
+        g_value_set_boolean(value, priv->output);
+        break;
+    case PROP_SIZE:
+        g_value_set_uint64(value, priv->size);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+
+static void gvir_sandbox_config_volume_set_property(GObject *object,
+                                                    guint prop_id,
+                                                    const GValue *value,
+                                                    GParamSpec *pspec)
+{
+    GVirSandboxConfigVolume *config = GVIR_SANDBOX_CONFIG_VOLUME(object);
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+
+    switch (prop_id) {
+    case PROP_TAG:
+        g_free(priv->tag);
+        priv->tag = g_value_dup_string(value);
+        break;
+    case PROP_SOURCE:
+        g_free(priv->source);
+        priv->source = g_value_dup_string(value);
+        break;
+    case PROP_TARGET:
+        g_free(priv->target);
+        priv->target = g_value_dup_string(value);
+        break;
+    case PROP_OUTPUT:
+        priv->output = g_value_get_boolean(value);
+        break;
+    case PROP_SIZE:
+        priv->size = g_value_get_uint64(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+
+static void gvir_sandbox_config_volume_finalize(GObject *object)
+{
+    GVirSandboxConfigVolume *config = GVIR_SANDBOX_CONFIG_VOLUME(object);
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+
+    g_free(priv->tag);
+    g_free(priv->source);
+    g_free(priv->target);
+
+    G_OBJECT_CLASS(gvir_sandbox_config_volume_parent_class)->finalize(object);
+}
+
+
+static void gvir_sandbox_config_volume_class_init(GVirSandboxConfigVolumeClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = gvir_sandbox_config_volume_finalize;
+    object_class->get_property = gvir_sandbox_config_volume_get_property;
+    object_class->set_property = gvir_sandbox_config_volume_set_property;
+
+    g_object_class_install_property(object_class,
+                                    PROP_TAG,
+                                    g_param_spec_string("tag",
+                                                        "Tag",
+                                                        "The sandbox tag property",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_SOURCE,
+                                    g_param_spec_string("source",
+                                                        "Source",
+                                                        "The host file, or directory, of the volume data",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_TARGET,
+                                    g_param_spec_string("target",
+                                                        "Target",
+                                                        "The guest mount point of the volume",
+                                                        NULL,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_OUTPUT,
+                                    g_param_spec_boolean("output",
+                                                         "Output",
+                                                         "Whether the volume returns data to the host",
+                                                         FALSE,
+                                                         G_PARAM_READABLE |
+                                                         G_PARAM_WRITABLE |
+                                                         G_PARAM_CONSTRUCT_ONLY |
+                                                         G_PARAM_STATIC_NAME |
+                                                         G_PARAM_STATIC_NICK |
+                                                         G_PARAM_STATIC_BLURB));
+
+    g_object_class_install_property(object_class,
+                                    PROP_SIZE,
+                                    g_param_spec_uint64("size",
+                                                        "Size",
+                                                        "The volume size in bytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+}
+
+
+static void gvir_sandbox_config_volume_init(GVirSandboxConfigVolume *config)
+{
+    config->priv = GVIR_SANDBOX_CONFIG_VOLUME_GET_PRIVATE(config);
+}
+
+
+/**
+ * gvir_sandbox_config_volume_get_tag:
+ * @config: (transfer none): the sandbox volume config
+ *
+ * Retrieves the tag property for the data volume
+ *
+ * Returns: (transfer none): the tag property
+ */
+const gchar *gvir_sandbox_config_volume_get_tag(GVirSandboxConfigVolume *config)
+{
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+    return priv->tag;
+}
+
+
+/**
+ * gvir_sandbox_config_volume_get_source:
+ * @config: (transfer none): the sandbox volume config
+ *
+ * Retrieves the host path of the data volume. For an input
+ * volume this is the file or directory it is filled from, for
+ * an output volume the file its contents are moved to.
+ *
+ * Returns: (transfer none): the source property
+ */
+const gchar *gvir_sandbox_config_volume_get_source(GVirSandboxConfigVolume *config)
+{
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+    return priv->source;
+}
+
+
+/**
+ * gvir_sandbox_config_volume_get_target:
+ * @config: (transfer none): the sandbox volume config
+ *
+ * Retrieves the guest mount point of the data volume, if
+ * it holds a filesystem rather than raw data
+ *
+ * Returns: (transfer none)(allow-none): the target property
+ */
+const gchar *gvir_sandbox_config_volume_get_target(GVirSandboxConfigVolume *config)
+{
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+    return priv->target;
+}
+
+
+/**
+ * gvir_sandbox_config_volume_get_output:
+ * @config: (transfer none): the sandbox volume config
+ *
+ * Retrieves whether the data volume is returned to the host
+ *
+ * Returns: TRUE for an output volume, FALSE for an input volume
+ */
+gboolean gvir_sandbox_config_volume_get_output(GVirSandboxConfigVolume *config)
+{
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+    return priv->output;
+}
+
+
+/**
+ * gvir_sandbox_config_volume_get_size:
+ * @config: (transfer none): the sandbox volume config
+ *
+ * Retrieves the size of the data volume, which is 0 for an
+ * input volume sized to fit its source
+ *
+ * Returns: the size in bytes
+ */
+guint64 gvir_sandbox_config_volume_get_size(GVirSandboxConfigVolume *config)
+{
+    GVirSandboxConfigVolumePrivate *priv = config->priv;
+    return priv->size;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
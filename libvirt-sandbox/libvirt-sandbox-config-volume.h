@@ -0,0 +1,82 @@
+/*
+ * libvirt-sandbox-config-volume.h: libvirt sandbox data volume configuration
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#if !defined(__LIBVIRT_SANDBOX_H__) && !defined(LIBVIRT_SANDBOX_BUILD)
+#error "Only <libvirt-sandbox/libvirt-sandbox.h> can be included directly."
+#endif
+
+#ifndef __LIBVIRT_SANDBOX_CONFIG_VOLUME_H__
+#define __LIBVIRT_SANDBOX_CONFIG_VOLUME_H__
+
+G_BEGIN_DECLS
+
+#define GVIR_SANDBOX_TYPE_CONFIG_VOLUME            (gvir_sandbox_config_volume_get_type ())
+#define GVIR_SANDBOX_CONFIG_VOLUME(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GVIR_SANDBOX_TYPE_CONFIG_VOLUME, GVirSandboxConfigVolume))
+#define GVIR_SANDBOX_CONFIG_VOLUME_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GVIR_SANDBOX_TYPE_CONFIG_VOLUME, GVirSandboxConfigVolumeClass))
+#define GVIR_SANDBOX_IS_CONFIG_VOLUME(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GVIR_SANDBOX_TYPE_CONFIG_VOLUME))
+#define GVIR_SANDBOX_IS_CONFIG_VOLUME_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GVIR_SANDBOX_TYPE_CONFIG_VOLUME))
+#define GVIR_SANDBOX_CONFIG_VOLUME_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GVIR_SANDBOX_TYPE_CONFIG_VOLUME, GVirSandboxConfigVolumeClass))
+
+#define GVIR_SANDBOX_TYPE_CONFIG_VOLUME_HANDLE      (gvir_sandbox_config_volume_handle_get_type ())
+
+typedef struct _GVirSandboxConfigVolume GVirSandboxConfigVolume;
+typedef struct _GVirSandboxConfigVolumePrivate GVirSandboxConfigVolumePrivate;
+typedef struct _GVirSandboxConfigVolumeClass GVirSandboxConfigVolumeClass;
+
+struct _GVirSandboxConfigVolume
+{
+    GObject parent;
+
+    GVirSandboxConfigVolumePrivate *priv;
+
+    /* Do not add fields to this struct */
+};
+
+struct _GVirSandboxConfigVolumeClass
+{
+    GObjectClass parent_class;
+
+    gpointer padding[LIBVIRT_SANDBOX_CLASS_PADDING];
+};
+
+GType gvir_sandbox_config_volume_get_type(void);
+
+const gchar *gvir_sandbox_config_volume_get_tag(GVirSandboxConfigVolume *config);
+
+const gchar *gvir_sandbox_config_volume_get_source(GVirSandboxConfigVolume *config);
+
+const gchar *gvir_sandbox_config_volume_get_target(GVirSandboxConfigVolume *config);
+
+gboolean gvir_sandbox_config_volume_get_output(GVirSandboxConfigVolume *config);
+
+guint64 gvir_sandbox_config_volume_get_size(GVirSandboxConfigVolume *config);
+
+G_END_DECLS
+
+#endif /* __LIBVIRT_SANDBOX_CONFIG_VOLUME_H__ */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
@@ -45,6 +45,15 @@
 #define GVIR_SANDBOX_CONFIG_GET_PRIVATE(obj)                            \
     (G_TYPE_INSTANCE_GET_PRIVATE((obj), GVIR_SANDBOX_TYPE_CONFIG, GVirSandboxConfigPrivate))
 
+struct GVirSandboxConfigDiskTuning {
+    gchar *cache;
+    gchar *io;
+    gchar *discard;
+    gchar *detectZeroes;
+    gboolean iothread;
+    guint queues;
+};
+
 struct _GVirSandboxConfigPrivate
 {
     gchar *name;
@@ -64,6 +73,7 @@ struct _GVirSandboxConfigPrivate
     GList *networks;
     GList *mounts;
     GList *disks;
+    GList *volumes;
     GHashTable* envs;
 
     gchar *secLabel;
@@ -71,6 +81,38 @@ struct _GVirSandboxConfigPrivate
 
     gboolean debug;
     gboolean verbose;
+
+    guint telemetryInterval;
+
+    gboolean readahead;
+    gboolean fastboot;
+
+    guint rngRate;
+
+    guint vcpus;
+    guint cpuSockets;
+    guint cpuCores;
+    guint cpuThreads;
+    guint64 memory;
+    guint64 maxMemory;
+
+    guint64 hugepageSize;
+    gboolean memfd;
+    gboolean prealloc;
+    gboolean memLocked;
+    gboolean mergeable;
+    gboolean balloon;
+
+    struct GVirSandboxConfigDiskTuning diskTuning;
+
+    gchar *tuningProfile;
+    GHashTable *tuningParams;
+
+    guint64 zramSize;
+    gchar *zramAlgorithm;
+
+    gchar *initrdCompression;
+    gint initrdCompressionLevel;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE(GVirSandboxConfig, gvir_sandbox_config, G_TYPE_OBJECT);
@@ -281,10 +323,21 @@ static void gvir_sandbox_config_finalize(GObject *object)
     g_list_free(priv->networks);
 
     g_hash_table_destroy(priv->envs);
+    g_hash_table_destroy(priv->tuningParams);
+    g_free(priv->tuningProfile);
+    g_free(priv->zramAlgorithm);
+    g_free(priv->initrdCompression);
+    g_free(priv->diskTuning.cache);
+    g_free(priv->diskTuning.io);
+    g_free(priv->diskTuning.discard);
+    g_free(priv->diskTuning.detectZeroes);
 
     g_list_foreach(priv->disks, (GFunc)g_object_unref, NULL);
     g_list_free(priv->disks);
 
+    g_list_foreach(priv->volumes, (GFunc)g_object_unref, NULL);
+    g_list_free(priv->volumes);
+
 
     g_free(priv->name);
     g_free(priv->uuid);
@@ -488,10 +541,15 @@ static void gvir_sandbox_config_init(GVirSandboxConfig *config)
     priv->secDynamic = TRUE;
 
     priv->envs = g_hash_table_new(g_str_hash, g_str_equal);
+    priv->tuningParams = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                               g_free, g_free);
     priv->uid = geteuid();
     priv->gid = getegid();
     priv->username = g_strdup(g_get_user_name());
     priv->homedir = g_strdup(g_get_home_dir());
+    priv->initrdCompressionLevel = -1;
+    priv->memory = 512 * 1024 * 1024;
+    priv->mergeable = TRUE;
 }
 
 
@@ -908,6 +966,42 @@ gboolean gvir_sandbox_config_add_network_strv(GVirSandboxConfig *config,
 }
 
 
+static gboolean gvir_sandbox_config_parse_count(const gchar *str,
+                                                guint *count,
+                                                GError **error)
+{
+    gchar *end = NULL;
+    guint64 val;
+
+    val = g_ascii_strtoull(str, &end, 10);
+    if (end == str || *end != '\0' || val == 0 || val > G_MAXUINT) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Invalid count '%s'"), str);
+        return FALSE;
+    }
+    *count = val;
+    return TRUE;
+}
+
+
+static gboolean gvir_sandbox_config_parse_queue_size(const gchar *str,
+                                                     guint *size,
+                                                     GError **error)
+{
+    if (!gvir_sandbox_config_parse_count(str, size, error))
+        return FALSE;
+
+    /* The limits that QEMU puts on virtio-net rings */
+    if (*size < 256 || *size > 1024 || (*size & (*size - 1))) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Queue size '%s' is not a power of two between 256 and 1024"),
+                    str);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
 /**
  * gvir_sandbox_config_add_network_opts:
  * @config: (transfer none): the sandbox config
@@ -923,6 +1017,8 @@ gboolean gvir_sandbox_config_add_network_strv(GVirSandboxConfig *config,
  *  route=192.168.122.255/24%192.168.1.1
  *  filter=clean-traffic
  *  filter.ip=192.168.122.1
+ *  vhost,queues=4,rx_queue_size=1024,tx_queue_size=1024
+ *  dhcp,backend=passt
  */
 gboolean gvir_sandbox_config_add_network_opts(GVirSandboxConfig *config,
                                               const gchar *network,
@@ -959,8 +1055,53 @@ gboolean gvir_sandbox_config_add_network_opts(GVirSandboxConfig *config,
             gvir_sandbox_config_network_set_source(net,
                                                    param + strlen("source="));
         } else if (g_str_has_prefix(param, "mac=")) {
+            if (!gvir_sandbox_util_is_mac_address(param + strlen("mac="))) {
+                g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                            _("Invalid MAC address '%s'"), param + strlen("mac="));
+                g_object_unref(net);
+                goto cleanup;
+            }
             gvir_sandbox_config_network_set_mac(net,
                                                 param + strlen("mac="));
+        } else if (g_str_has_prefix(param, "backend=")) {
+            const gchar *backend = param + strlen("backend=");
+
+            if (!gvir_sandbox_util_is_network_backend(backend)) {
+                g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                            _("Unknown network backend '%s'"), backend);
+                g_object_unref(net);
+                goto cleanup;
+            }
+            gvir_sandbox_config_network_set_backend(net, backend);
+        } else if (g_str_equal(param, "vhost")) {
+            gvir_sandbox_config_network_set_vhost(net, TRUE);
+        } else if (g_str_has_prefix(param, "queues=")) {
+            guint queues;
+
+            if (!gvir_sandbox_config_parse_count(param + strlen("queues="),
+                                                 &queues, error)) {
+                g_object_unref(net);
+                goto cleanup;
+            }
+            gvir_sandbox_config_network_set_queues(net, queues);
+        } else if (g_str_has_prefix(param, "rx_queue_size=")) {
+            guint size;
+
+            if (!gvir_sandbox_config_parse_queue_size(param + strlen("rx_queue_size="),
+                                                      &size, error)) {
+                g_object_unref(net);
+                goto cleanup;
+            }
+            gvir_sandbox_config_network_set_rx_queue_size(net, size);
+        } else if (g_str_has_prefix(param, "tx_queue_size=")) {
+            guint size;
+
+            if (!gvir_sandbox_config_parse_queue_size(param + strlen("tx_queue_size="),
+                                                      &size, error)) {
+                g_object_unref(net);
+                goto cleanup;
+            }
+            gvir_sandbox_config_network_set_tx_queue_size(net, size);
         } else if (g_str_has_prefix(param, "filter.")) {
             GVirSandboxConfigNetworkFilterrefParameter *filter_param;
             gchar *tail = g_strdup(param + strlen("filter."));
@@ -1133,6 +1274,14 @@ gboolean gvir_sandbox_config_add_network_opts(GVirSandboxConfig *config,
         goto cleanup;
     }
 
+    if (gvir_sandbox_config_network_get_backend(net) &&
+        gvir_sandbox_config_network_get_source(net)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Cannot use a user mode backend with a source network"));
+        g_object_unref(net);
+        goto cleanup;
+    }
+
     gvir_sandbox_config_add_network(config, net);
     g_object_unref(net);
 
@@ -1281,6 +1430,145 @@ GList *gvir_sandbox_config_get_disks(GVirSandboxConfig *config)
 }
 
 
+static const gchar *gvir_sandbox_config_disk_caches[] = {
+    "none", "writethrough", "writeback", "directsync", "unsafe", NULL,
+};
+static const gchar *gvir_sandbox_config_disk_ios[] = {
+    "native", "threads", "io_uring", NULL,
+};
+static const gchar *gvir_sandbox_config_disk_discards[] = {
+    "unmap", "ignore", NULL,
+};
+static const gchar *gvir_sandbox_config_disk_detect_zeroes[] = {
+    "off", "on", "unmap", NULL,
+};
+
+static gboolean gvir_sandbox_config_is_disk_mode(const gchar *const *modes,
+                                                 const gchar *value)
+{
+    gsize i;
+
+    if (!value)
+        return TRUE;
+    for (i = 0 ; modes[i] ; i++) {
+        if (g_str_equal(modes[i], value))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean gvir_sandbox_config_parse_disk_mode(const gchar *opt,
+                                                    const gchar *const *modes,
+                                                    gchar **mode,
+                                                    GError **error)
+{
+    const gchar *value = strchr(opt, '=') + 1;
+    gsize i;
+
+    for (i = 0 ; modes[i] ; i++) {
+        if (g_str_equal(modes[i], value)) {
+            g_free(*mode);
+            *mode = g_strdup(value);
+            return TRUE;
+        }
+    }
+
+    g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                _("Unknown disk option value '%s'"), opt);
+    return FALSE;
+}
+
+/*
+ * Parses a single disk tuning option into @tuning, returning 1
+ * if @opt was one, 0 if it was not, and -1 on error
+ */
+static gint gvir_sandbox_config_parse_disk_tuning(struct GVirSandboxConfigDiskTuning *tuning,
+                                                  const gchar *opt,
+                                                  GError **error)
+{
+    gchar *end = NULL;
+    guint64 queues;
+
+    if (g_str_has_prefix(opt, "cache=")) {
+        if (!gvir_sandbox_config_parse_disk_mode(opt, gvir_sandbox_config_disk_caches,
+                                                 &tuning->cache, error))
+            return -1;
+    } else if (g_str_has_prefix(opt, "io=")) {
+        if (!gvir_sandbox_config_parse_disk_mode(opt, gvir_sandbox_config_disk_ios,
+                                                 &tuning->io, error))
+            return -1;
+    } else if (g_str_has_prefix(opt, "discard=")) {
+        if (!gvir_sandbox_config_parse_disk_mode(opt, gvir_sandbox_config_disk_discards,
+                                                 &tuning->discard, error))
+            return -1;
+    } else if (g_str_has_prefix(opt, "detect-zeroes=")) {
+        if (!gvir_sandbox_config_parse_disk_mode(opt, gvir_sandbox_config_disk_detect_zeroes,
+                                                 &tuning->detectZeroes, error))
+            return -1;
+    } else if (g_str_equal(opt, "iothread")) {
+        tuning->iothread = TRUE;
+    } else if (g_str_has_prefix(opt, "queues=")) {
+        queues = g_ascii_strtoull(opt + strlen("queues="), &end, 10);
+        if (end == opt + strlen("queues=") || *end != '\0' ||
+            queues == 0 || queues > 256) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Invalid disk queue count in '%s'"), opt);
+            return -1;
+        }
+        tuning->queues = queues;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Checks the values in @tuning, which may come from a config file,
+ * and the combinations QEMU refuses to start with
+ */
+static gboolean gvir_sandbox_config_check_disk_tuning(struct GVirSandboxConfigDiskTuning *tuning,
+                                                      GError **error)
+{
+    if (!gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_caches, tuning->cache) ||
+        !gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_ios, tuning->io) ||
+        !gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_discards, tuning->discard) ||
+        !gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_detect_zeroes,
+                                          tuning->detectZeroes)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    "%s", _("Unknown disk cache, io, discard or detect-zeroes mode"));
+        return FALSE;
+    }
+
+    /* Native AIO needs the host page cache to be bypassed */
+    if (g_strcmp0(tuning->io, "native") == 0 && tuning->cache &&
+        !g_str_equal(tuning->cache, "none") &&
+        !g_str_equal(tuning->cache, "directsync")) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Disk I/O mode native needs cache mode none or directsync, not %s"),
+                    tuning->cache);
+        return FALSE;
+    }
+
+    if (g_strcmp0(tuning->detectZeroes, "unmap") == 0 &&
+        g_strcmp0(tuning->discard, "unmap") != 0) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    "%s", _("Disk detect-zeroes mode unmap needs discard mode unmap"));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void gvir_sandbox_config_clear_disk_tuning(struct GVirSandboxConfigDiskTuning *tuning)
+{
+    g_free(tuning->cache);
+    g_free(tuning->io);
+    g_free(tuning->discard);
+    g_free(tuning->detectZeroes);
+    memset(tuning, 0, sizeof(*tuning));
+}
+
+
 /**
  * gvir_sandbox_config_add_disk_strv:
  * @config: (transfer none): the sandbox config
@@ -1313,11 +1601,14 @@ gboolean gvir_sandbox_config_add_disk_strv(GVirSandboxConfig *config,
  * @config: (transfer none): the sandbox config
  * @disk: (transfer none): the disk config
  *
- * Parses @disk in the format TYPE:TAG=SOURCE,format=FORMAT
- * creating #GVirSandboxConfigDisk instances for each element. For
- * example
+ * Parses @disk in the format TYPE:TAG=SOURCE,format=FORMAT[,TUNING...]
+ * creating #GVirSandboxConfigDisk instances for each element. The
+ * tuning options are those accepted by
+ * gvir_sandbox_config_set_disk_tuning_opts(), and override them for
+ * this disk. For example
  *
  * - file:cache=/var/lib/sandbox/demo/tmp.qcow2,format=qcow2
+ * - file:scratch=/var/lib/sandbox/demo/scratch.img,cache=unsafe,io=io_uring
  */
 
 gboolean gvir_sandbox_config_add_disk_opts(GVirSandboxConfig *config,
@@ -1329,7 +1620,12 @@ gboolean gvir_sandbox_config_add_disk_opts(GVirSandboxConfig *config,
     gchar *tag = NULL;
     gchar *source = NULL;
     GVirSandboxConfigDisk *diskConfig;
+    struct GVirSandboxConfigDiskTuning tuning = { 0 };
+    gchar **opts = NULL;
+    gboolean hasFormat = FALSE;
+    gboolean ret = FALSE;
     gchar *tmp;
+    gsize i;
     gint type;
     gint format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
     GEnumClass *enum_class = g_type_class_ref(GVIR_CONFIG_TYPE_DOMAIN_DISK_TYPE);
@@ -1374,32 +1670,63 @@ gboolean gvir_sandbox_config_add_disk_opts(GVirSandboxConfig *config,
 
     if ((tmp = strchr(source, ',')) != NULL) {
         *tmp = '\0';
-        formatStr = tmp + 1;
+        opts = g_strsplit(tmp + 1, ",", 0);
+    }
 
-        if ((strncmp(formatStr, "format=", 7) != 0) ||
-                (format = gvir_sandbox_util_disk_format_from_str(formatStr + 7, error)) < 0){
+    for (i = 0 ; opts && opts[i] ; i++) {
+        gint handled;
+
+        if (g_str_has_prefix(opts[i], "format=")) {
+            formatStr = opts[i] + strlen("format=");
+            if ((format = gvir_sandbox_util_disk_format_from_str(formatStr, NULL)) < 0) {
                 g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                            _("Unknown disk image format: '%s'"), formatStr + 7);
-                return FALSE;
+                            _("Unknown disk image format: '%s'"), formatStr);
+                goto cleanup;
+            }
+            hasFormat = TRUE;
+            continue;
+        }
+
+        if ((handled = gvir_sandbox_config_parse_disk_tuning(&tuning, opts[i], error)) < 0)
+            goto cleanup;
+        if (handled == 0) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown disk option '%s'"), opts[i]);
+            goto cleanup;
         }
-    } else if ((format = gvir_sandbox_util_guess_image_format(source, error)) < 0) {
-        format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
     }
 
+    if (!gvir_sandbox_config_check_disk_tuning(&tuning, error))
+        goto cleanup;
+
+    if (!hasFormat &&
+        (format = gvir_sandbox_util_guess_image_format(source, NULL)) < 0)
+        format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
+
 
     diskConfig = GVIR_SANDBOX_CONFIG_DISK(g_object_new(GVIR_SANDBOX_TYPE_CONFIG_DISK,
                                                 "type", type,
                                                 "tag", tag,
                                                 "source", source,
                                                 "format", format,
+                                                "cache", tuning.cache,
+                                                "io", tuning.io,
+                                                "discard", tuning.discard,
+                                                "detect-zeroes", tuning.detectZeroes,
+                                                "iothread", tuning.iothread,
+                                                "queues", tuning.queues,
                                                 NULL));
 
     gvir_sandbox_config_add_disk(config, diskConfig);
 
     g_object_unref(diskConfig);
-    g_free(typeStr);
 
-    return TRUE;
+    ret = TRUE;
+ cleanup:
+    gvir_sandbox_config_clear_disk_tuning(&tuning);
+    g_strfreev(opts);
+    g_free(typeStr);
+    return ret;
 }
 
 
@@ -1411,574 +1738,2227 @@ gboolean gvir_sandbox_config_has_disks(GVirSandboxConfig *config)
 
 
 /**
- * gvir_sandbox_config_add_mount:
+ * gvir_sandbox_config_set_disk_cache:
  * @config: (transfer none): the sandbox config
- * @mnt: (transfer none): the mount configuration
+ * @cache: (allow-none): the cache mode, or NULL for the default
  *
- * Adds a new custom mount to the sandbox, to override part of the
- * host filesystem
+ * Set the cache mode of the disks of machine based sandboxes, one
+ * of none, writethrough, writeback, directsync or unsafe. Disks may
+ * override it individually.
  */
-void gvir_sandbox_config_add_mount(GVirSandboxConfig *config,
-                                   GVirSandboxConfigMount *mnt)
+void gvir_sandbox_config_set_disk_cache(GVirSandboxConfig *config,
+                                        const gchar *cache)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-
-    g_object_ref(mnt);
-    priv->mounts = g_list_append(priv->mounts, mnt);
+    g_return_if_fail(gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_caches, cache));
+    g_free(priv->diskTuning.cache);
+    priv->diskTuning.cache = g_strdup(cache);
 }
 
-
 /**
- * gvir_sandbox_config_get_mounts:
+ * gvir_sandbox_config_get_disk_cache:
  * @config: (transfer none): the sandbox config
  *
- * Retrieves the list of custom mounts in the sandbox
+ * Retrieves the default cache mode of the sandbox disks
  *
- * Returns: (transfer full) (element-type GVirSandboxConfigMount): the list of mounts
+ * Returns: (transfer none): the cache mode, or NULL for the default
  */
-GList *gvir_sandbox_config_get_mounts(GVirSandboxConfig *config)
+const gchar *gvir_sandbox_config_get_disk_cache(GVirSandboxConfig *config)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    g_list_foreach(priv->mounts, (GFunc)g_object_ref, NULL);
-    return g_list_copy(priv->mounts);
+    return priv->diskTuning.cache;
 }
 
 
 /**
- * gvir_sandbox_config_get_mounts_with_type:
+ * gvir_sandbox_config_set_disk_io:
  * @config: (transfer none): the sandbox config
+ * @io: (allow-none): the I/O mode, or NULL for the default
  *
- * Retrieves the list of custom mounts in the sandbox
+ * Set the I/O mode of the disks of machine based sandboxes, one
+ * of native, threads or io_uring. Disks may override it
+ * individually.
+ */
+void gvir_sandbox_config_set_disk_io(GVirSandboxConfig *config,
+                                     const gchar *io)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_return_if_fail(gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_ios, io));
+    g_free(priv->diskTuning.io);
+    priv->diskTuning.io = g_strdup(io);
+}
+
+/**
+ * gvir_sandbox_config_get_disk_io:
+ * @config: (transfer none): the sandbox config
  *
- * Returns: (transfer full) (element-type GVirSandboxConfigMount): the list of mounts
+ * Retrieves the default I/O mode of the sandbox disks
+ *
+ * Returns: (transfer none): the I/O mode, or NULL for the default
  */
-GList *gvir_sandbox_config_get_mounts_with_type(GVirSandboxConfig *config,
-                                                GType type)
+const gchar *gvir_sandbox_config_get_disk_io(GVirSandboxConfig *config)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    GList *ret = NULL;
-    GList *tmp = priv->mounts;
-    while (tmp) {
-        GObject *mnt = tmp->data;
-        if (G_OBJECT_TYPE(mnt) == type) {
-            ret = g_list_append(ret, g_object_ref(mnt));
-        }
-        tmp = tmp->next;
-    }
-    return ret;
+    return priv->diskTuning.io;
 }
 
 
 /**
- * gvir_sandbox_config_find_mount:
+ * gvir_sandbox_config_set_disk_discard:
  * @config: (transfer none): the sandbox config
- * @target: the guest target path
+ * @discard: (allow-none): the discard mode, or NULL for the default
  *
- * Finds the #GVirSandboxConfigMount object corresponding to a guest
- * path of @target.
- *
- * Returns: (transfer full)(allow-none): a mount object or NULL
+ * Set the discard mode of the disks of machine based sandboxes,
+ * either unmap or ignore. Disks may override it individually.
  */
-GVirSandboxConfigMount *gvir_sandbox_config_find_mount(GVirSandboxConfig *config,
-                                                       const gchar *target)
+void gvir_sandbox_config_set_disk_discard(GVirSandboxConfig *config,
+                                          const gchar *discard)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    GList *tmp = priv->mounts;
+    g_return_if_fail(gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_discards, discard));
+    g_free(priv->diskTuning.discard);
+    priv->diskTuning.discard = g_strdup(discard);
+}
 
-    while (tmp) {
-        GVirSandboxConfigMount *mnt = GVIR_SANDBOX_CONFIG_MOUNT(tmp->data);
-        if (g_str_equal(gvir_sandbox_config_mount_get_target(mnt), target)) {
-            return g_object_ref(mnt);
-        }
-        tmp = tmp->next;
-    }
-    return NULL;
+/**
+ * gvir_sandbox_config_get_disk_discard:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the default discard mode of the sandbox disks
+ *
+ * Returns: (transfer none): the discard mode, or NULL for the default
+ */
+const gchar *gvir_sandbox_config_get_disk_discard(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->diskTuning.discard;
 }
 
 
 /**
- * gvir_sandbox_config_add_mount_strv:
+ * gvir_sandbox_config_set_disk_detect_zeroes:
  * @config: (transfer none): the sandbox config
- * @mounts: (transfer none)(array zero-terminated=1): the list of mounts
+ * @detectZeroes: (allow-none): the detection mode, or NULL for the default
  *
- * Parses @mounts whose elements are in the format TYPE:TARGET=SOURCE
- * creating #GVirSandboxConfigMount instances for each element. For
- * example
+ * Set the zero write detection mode of the disks of machine based
+ * sandboxes, one of off, on or unmap, where unmap needs the discard
+ * mode to be unmap too. Disks may override it individually.
+ */
+void gvir_sandbox_config_set_disk_detect_zeroes(GVirSandboxConfig *config,
+                                                const gchar *detectZeroes)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_return_if_fail(gvir_sandbox_config_is_disk_mode(gvir_sandbox_config_disk_detect_zeroes, detectZeroes));
+    g_free(priv->diskTuning.detectZeroes);
+    priv->diskTuning.detectZeroes = g_strdup(detectZeroes);
+}
+
+/**
+ * gvir_sandbox_config_get_disk_detect_zeroes:
+ * @config: (transfer none): the sandbox config
  *
- * - host-bind:/tmp=/var/lib/sandbox/demo/tmp
- * - host-image:/=/var/lib/sandbox/demo.img
- * - guest-bind:/home=/tmp/home
+ * Retrieves the default zero write detection mode of the sandbox disks
+ *
+ * Returns: (transfer none): the detection mode, or NULL for the default
  */
-gboolean gvir_sandbox_config_add_mount_strv(GVirSandboxConfig *config,
-                                            gchar **mounts,
-                                            GError **error)
+const gchar *gvir_sandbox_config_get_disk_detect_zeroes(GVirSandboxConfig *config)
 {
-    gsize i = 0;
-    while (mounts && mounts[i]) {
-        if (!gvir_sandbox_config_add_mount_opts(config,
-                                                mounts[i],
-                                                error))
-            return FALSE;
-        i++;
-    }
-    return TRUE;
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->diskTuning.detectZeroes;
 }
 
 
 /**
- * gvir_sandbox_config_add_mount_opts:
+ * gvir_sandbox_config_set_disk_iothread:
  * @config: (transfer none): the sandbox config
- * @mount: (transfer none): the mount config
+ * @iothread: true to give each disk its own I/O thread
  *
- * Parses @mount whose elements are in the format TYPE:TARGET=SOURCE
- * creating #GVirSandboxConfigMount instances for each element. For
- * example
+ * Give each disk of machine based sandboxes a dedicated I/O thread,
+ * rather than processing their requests in the main QEMU thread.
+ */
+void gvir_sandbox_config_set_disk_iothread(GVirSandboxConfig *config,
+                                           gboolean iothread)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->diskTuning.iothread = iothread;
+}
+
+/**
+ * gvir_sandbox_config_get_disk_iothread:
+ * @config: (transfer none): the sandbox config
  *
- * - host-bind:/tmp=/var/lib/sandbox/demo/tmp
- * - host-image:/=/var/lib/sandbox/demo.img
- * - host-image:/=/var/lib/sandbox/demo.qcow2,format=qcow2
- * - guest-bind:/home=/tmp/home
- * - ram:/tmp=500M
+ * Retrieves whether each sandbox disk has a dedicated I/O thread
+ *
+ * Returns: the I/O thread flag
  */
-gboolean gvir_sandbox_config_add_mount_opts(GVirSandboxConfig *config,
-                                            const char *mount,
-                                            GError **error)
+gboolean gvir_sandbox_config_get_disk_iothread(GVirSandboxConfig *config)
 {
-    gchar *target = NULL;
-    const gchar *source = NULL;
-    GVirSandboxConfigMount *mnt;
-    gchar *tmp;
-    GType type;
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->diskTuning.iothread;
+}
 
-    tmp = strchr(mount, ':');
-    if (!tmp) {
+
+/**
+ * gvir_sandbox_config_set_disk_queues:
+ * @config: (transfer none): the sandbox config
+ * @queues: the number of queues, or 0 for the default
+ *
+ * Set the number of virtqueues of the disks of machine based
+ * sandboxes. Disks may override it individually.
+ */
+void gvir_sandbox_config_set_disk_queues(GVirSandboxConfig *config,
+                                         guint queues)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->diskTuning.queues = queues;
+}
+
+/**
+ * gvir_sandbox_config_get_disk_queues:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the default number of queues of the sandbox disks
+ *
+ * Returns: the queue count, or 0 for the default
+ */
+guint gvir_sandbox_config_get_disk_queues(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->diskTuning.queues;
+}
+
+
+/**
+ * gvir_sandbox_config_set_disk_tuning_opts:
+ * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the disk tuning options
+ * @error: (out): the error location
+ *
+ * Parses @optstr as a comma separated list of the options
+ * cache=CACHE, io=IO, discard=DISCARD, detect-zeroes=MODE,
+ * iothread and queues=N, setting the tuning of all disks
+ *
+ * --disk-tuning cache=none,io=io_uring,iothread,queues=4
+ */
+gboolean gvir_sandbox_config_set_disk_tuning_opts(GVirSandboxConfig *config,
+                                                  const gchar *optstr,
+                                                  GError **error)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    gchar **opts = g_strsplit(optstr, ",", 0);
+    gboolean ret = FALSE;
+    gsize i;
+
+    for (i = 0 ; opts[i] ; i++) {
+        gint handled;
+
+        if ((handled = gvir_sandbox_config_parse_disk_tuning(&priv->diskTuning,
+                                                             opts[i], error)) < 0)
+            goto cleanup;
+        if (handled == 0) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown disk tuning option '%s'"), opts[i]);
+            goto cleanup;
+        }
+    }
+
+    if (!gvir_sandbox_config_check_disk_tuning(&priv->diskTuning, error))
+        goto cleanup;
+
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    return ret;
+}
+
+
+/* Parses a byte count with an optional K, M or G suffix */
+static gboolean gvir_sandbox_config_parse_size(const gchar *str,
+                                               guint64 *size,
+                                               GError **error)
+{
+    gchar *end = NULL;
+
+    *size = g_ascii_strtoull(str, &end, 10);
+    if (end == str) {
         g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                    _("No mount type prefix on %s"), mount);
+                    _("Missing size in '%s'"), str);
         return FALSE;
     }
-    if (strncmp(mount, "host-bind", (tmp - mount)) == 0) {
-        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_BIND;
-    } else if (strncmp(mount, "host-image", (tmp - mount)) == 0) {
-        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_IMAGE;
-    } else if (strncmp(mount, "guest-bind", (tmp - mount)) == 0) {
-        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_GUEST_BIND;
-    } else if (strncmp(mount, "ram", (tmp - mount)) == 0) {
-        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_RAM;
-    } else {
+    if (g_str_equal(end, "KiB") || g_str_equal(end, "K")) {
+        *size *= 1024;
+    } else if (g_str_equal(end, "MiB") || g_str_equal(end, "M")) {
+        *size *= 1024 * 1024;
+    } else if (g_str_equal(end, "GiB") || g_str_equal(end, "G")) {
+        *size *= 1024 * 1024 * 1024;
+    } else if (!g_str_equal(end, "")) {
         g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                    _("Unknown mount type prefix on %s"), mount);
+                    _("Unknown size suffix '%s'"), end);
         return FALSE;
     }
+    return TRUE;
+}
 
-    target = g_strdup(tmp + 1);
 
-    if ((tmp = strchr(target, '=')) != NULL) {
-        *tmp = '\0';
-        source = tmp + 1;
+/**
+ * gvir_sandbox_config_add_volume:
+ * @config: (transfer none): the sandbox config
+ * @vol: (transfer none): the data volume configuration
+ *
+ * Adds a new data volume to the sandbox
+ *
+ */
+void gvir_sandbox_config_add_volume(GVirSandboxConfig *config,
+                                    GVirSandboxConfigVolume *vol)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+
+    g_object_ref(vol);
+
+    priv->volumes = g_list_append(priv->volumes, vol);
+}
+
+/**
+ * gvir_sandbox_config_get_volumes:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the list of data volumes in the sandbox
+ *
+ * Returns: (transfer full) (element-type GVirSandboxConfigVolume): the list of volumes
+ */
+GList *gvir_sandbox_config_get_volumes(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_list_foreach(priv->volumes, (GFunc)g_object_ref, NULL);
+    return g_list_copy(priv->volumes);
+}
+
+
+/**
+ * gvir_sandbox_config_add_volume_strv:
+ * @config: (transfer none): the sandbox config
+ * @volumes: (transfer none)(array zero-terminated=1): the list of volumes
+ *
+ * Parses @volumes whose elements are in the format described by
+ * gvir_sandbox_config_add_volume_opts(), creating
+ * #GVirSandboxConfigVolume instances for each element.
+ */
+gboolean gvir_sandbox_config_add_volume_strv(GVirSandboxConfig *config,
+                                             gchar **volumes,
+                                             GError **error)
+{
+    gsize i = 0;
+    while (volumes && volumes[i]) {
+        if (!gvir_sandbox_config_add_volume_opts(config,
+                                                 volumes[i],
+                                                 error))
+            return FALSE;
+        i++;
     }
+    return TRUE;
+}
 
-    if (!tmp) {
+
+/* The tag names the volume's scratch image in the state dir */
+static gboolean gvir_sandbox_config_check_volume_tag(const gchar *tag,
+                                                     GError **error)
+{
+    if (!tag[0] || strchr(tag, '/') || strstr(tag, "..")) {
         g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                    _("Missing mount source string on %s"), mount);
+                    _("Invalid volume tag '%s'"), tag);
         return FALSE;
     }
+    return TRUE;
+}
 
-    if (type == GVIR_SANDBOX_TYPE_CONFIG_MOUNT_RAM) {
-        gint size;
-        gchar *end;
-        size = strtol(source, &end, 10);
-
-        if (end) {
-            if (g_str_equal(end, "KiB") || g_str_equal(end, "K"))
-                size *= 1024;
-            else if (g_str_equal(end, "MiB") || g_str_equal(end, "M"))
-                size *= 1024 * 1024;
-            else if (g_str_equal(end, "GiB") || g_str_equal(end, "G"))
-                size *= 1024 * 1024 * 1024;
-        }
-        mnt = GVIR_SANDBOX_CONFIG_MOUNT(gvir_sandbox_config_mount_ram_new(target,
-                                                                          size));
-    } else if (type == GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_IMAGE) {
-        const gchar *formatStr = NULL;
-        gint format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
 
-        if ((tmp = strchr(source, ',')) != NULL) {
-            GEnumClass *enum_class = g_type_class_ref(GVIR_CONFIG_TYPE_DOMAIN_DISK_FORMAT);
-            GEnumValue *enum_value = NULL;
+/**
+ * gvir_sandbox_config_add_volume_opts:
+ * @config: (transfer none): the sandbox config
+ * @volume: (transfer none): the volume config
+ *
+ * Parses @volume in the format in:TAG=SOURCE[,target=PATH][,size=SIZE]
+ * or out:TAG=DEST,size=SIZE[,target=PATH], creating a
+ * #GVirSandboxConfigVolume instance. An input volume without a
+ * target passes the SOURCE file through as a raw block device,
+ * with a target SOURCE is a directory copied into a new filesystem.
+ * For example
+ *
+ * - in:dataset=/srv/data/train.bin
+ * - in:refs=/srv/refs,target=/refs
+ * - out:results=/srv/out/results.img,size=20G,target=/results
+ */
+gboolean gvir_sandbox_config_add_volume_opts(GVirSandboxConfig *config,
+                                             const char *volume,
+                                             GError **error)
+{
+    GVirSandboxConfigVolume *volConfig;
+    gchar **opts = NULL;
+    gchar *modeStr = NULL;
+    gchar *tag, *source, *tmp;
+    const gchar *target = NULL;
+    gboolean output;
+    guint64 size = 0;
+    gboolean ret = FALSE;
+    gsize i;
 
-            *tmp = '\0';
-            formatStr = tmp + 1;
+    modeStr = g_strdup(volume);
 
-            if ((strncmp(formatStr, "format=", 7) == 0)) {
-                if (!(enum_value = g_enum_get_value_by_nick(enum_class, formatStr + 7))) {
-                    g_type_class_unref(enum_class);
-                    g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                                _("Unknown disk image format: '%s'"), formatStr + 7);
-                    return FALSE;
-                }
-                g_type_class_unref(enum_class);
-                format = enum_value->value;
-            }
-        } else if ((format = gvir_sandbox_util_guess_image_format(source, error)) < 0) {
-            format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
-        }
+    if (!(tmp = strchr(modeStr, ':'))) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("No volume direction prefix on %s"), volume);
+        goto cleanup;
+    }
+    *tmp = '\0';
+    tag = tmp + 1;
 
-        mnt = GVIR_SANDBOX_CONFIG_MOUNT(g_object_new(type,
-                                                     "target", target,
-                                                     "source", source,
-                                                     "format", format,
-                                                     NULL));
+    if (g_str_equal(modeStr, "in")) {
+        output = FALSE;
+    } else if (g_str_equal(modeStr, "out")) {
+        output = TRUE;
     } else {
-        mnt = GVIR_SANDBOX_CONFIG_MOUNT(g_object_new(type,
-                                                     "target", target,
-                                                     "source", source,
-                                                     NULL));
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Unknown volume direction prefix on %s"), volume);
+        goto cleanup;
     }
-    gvir_sandbox_config_add_mount(config, mnt);
-    g_object_unref(mnt);
-    g_free(target);
 
-    return TRUE;
-}
+    if (!(tmp = strchr(tag, '=')) || tmp == tag) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Missing volume source string on %s"), volume);
+        goto cleanup;
+    }
+    *tmp = '\0';
 
+    if (!gvir_sandbox_config_check_volume_tag(tag, error))
+        goto cleanup;
 
-gboolean gvir_sandbox_config_has_mounts(GVirSandboxConfig *config)
-{
-    GVirSandboxConfigPrivate *priv = config->priv;
-    return priv->mounts != NULL;
-}
+    opts = g_strsplit(tmp + 1, ",", 0);
+    source = opts[0];
+    if (!source || !source[0]) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Missing volume source string on %s"), volume);
+        goto cleanup;
+    }
 
-gboolean gvir_sandbox_config_has_mounts_with_type(GVirSandboxConfig *config,
-                                                  GType type)
-{
-    GList *tmp = config->priv->mounts;
-    while (tmp) {
-        GObject *obj = tmp->data;
-        if (G_OBJECT_TYPE(obj) == type)
-            return TRUE;
-        tmp = tmp->next;
+    for (i = 1 ; opts[i] ; i++) {
+        if (g_str_has_prefix(opts[i], "target=")) {
+            target = opts[i] + strlen("target=");
+        } else if (g_str_has_prefix(opts[i], "size=")) {
+            if (!gvir_sandbox_config_parse_size(opts[i] + strlen("size="),
+                                                &size, error))
+                goto cleanup;
+        } else {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown volume option '%s'"), opts[i]);
+            goto cleanup;
+        }
     }
-    return FALSE;
-}
 
+    if (output && !size) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Output volume %s needs a size"), tag);
+        goto cleanup;
+    }
+    if (!output && !target && size) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Raw input volume %s takes its size from the source"), tag);
+        goto cleanup;
+    }
 
-gboolean gvir_sandbox_config_has_root_mount(GVirSandboxConfig *config)
-{
-    GList *tmp = NULL, *mounts = NULL;
-    gboolean hasRoot = FALSE;
+    volConfig = GVIR_SANDBOX_CONFIG_VOLUME(g_object_new(GVIR_SANDBOX_TYPE_CONFIG_VOLUME,
+                                                        "tag", tag,
+                                                        "source", source,
+                                                        "target", target,
+                                                        "output", output,
+                                                        "size", size,
+                                                        NULL));
 
-    tmp = mounts = gvir_sandbox_config_get_mounts(config);
-    while (tmp && !hasRoot) {
-        const gchar *target;
-        GVirSandboxConfigMount *mount = GVIR_SANDBOX_CONFIG_MOUNT(tmp->data);
-        target = gvir_sandbox_config_mount_get_target(mount);
-        if (g_str_equal(target, "/"))
-            hasRoot = TRUE;
-        tmp = tmp->next;
-    }
-    g_list_foreach(mounts, (GFunc)g_object_unref, NULL);
-    g_list_free(mounts);
+    gvir_sandbox_config_add_volume(config, volConfig);
+    g_object_unref(volConfig);
 
-    return hasRoot;
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    g_free(modeStr);
+    return ret;
 }
 
 
+/**
+ * gvir_sandbox_config_has_volumes:
+ * @config: (transfer none): the sandbox config
+ *
+ * Determine if the sandbox has any data volumes
+ *
+ * Returns: TRUE if there is at least one data volume
+ */
+gboolean gvir_sandbox_config_has_volumes(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->volumes != NULL;
+}
 
 
 /**
- * gvir_sandbox_config_add_host_include_strv:
+ * gvir_sandbox_config_add_mount:
  * @config: (transfer none): the sandbox config
- * @includes: (transfer none)(array zero-terminated=1): the list of includes
+ * @mnt: (transfer none): the mount configuration
  *
- * Parses @includes whose elements are in the format
- * GUEST-TARGET=ROOT-PATH. If ROOT_PATH is omitted,
- * then it is assumed to be the same as GUEST-TARGET
+ * Adds a new custom mount to the sandbox, to override part of the
+ * host filesystem
  */
-gboolean gvir_sandbox_config_add_host_include_strv(GVirSandboxConfig *config,
-                                                   gchar **includes,
-                                                   GError **error)
+void gvir_sandbox_config_add_mount(GVirSandboxConfig *config,
+                                   GVirSandboxConfigMount *mnt)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    gsize i = 0;
 
-    while (includes && includes[i]) {
-        const gchar *host;
-        gchar *guest;
-        const gchar *relguest;
-        GVirSandboxConfigMount *mnt = NULL;
-        GList *mnts = NULL;
-        gchar *tmp;
+    g_object_ref(mnt);
+    priv->mounts = g_list_append(priv->mounts, mnt);
+}
+
+
+/**
+ * gvir_sandbox_config_get_mounts:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the list of custom mounts in the sandbox
+ *
+ * Returns: (transfer full) (element-type GVirSandboxConfigMount): the list of mounts
+ */
+GList *gvir_sandbox_config_get_mounts(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_list_foreach(priv->mounts, (GFunc)g_object_ref, NULL);
+    return g_list_copy(priv->mounts);
+}
+
+
+/**
+ * gvir_sandbox_config_get_mounts_with_type:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the list of custom mounts in the sandbox
+ *
+ * Returns: (transfer full) (element-type GVirSandboxConfigMount): the list of mounts
+ */
+GList *gvir_sandbox_config_get_mounts_with_type(GVirSandboxConfig *config,
+                                                GType type)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    GList *ret = NULL;
+    GList *tmp = priv->mounts;
+    while (tmp) {
+        GObject *mnt = tmp->data;
+        if (G_OBJECT_TYPE(mnt) == type) {
+            ret = g_list_append(ret, g_object_ref(mnt));
+        }
+        tmp = tmp->next;
+    }
+    return ret;
+}
+
+
+/**
+ * gvir_sandbox_config_find_mount:
+ * @config: (transfer none): the sandbox config
+ * @target: the guest target path
+ *
+ * Finds the #GVirSandboxConfigMount object corresponding to a guest
+ * path of @target.
+ *
+ * Returns: (transfer full)(allow-none): a mount object or NULL
+ */
+GVirSandboxConfigMount *gvir_sandbox_config_find_mount(GVirSandboxConfig *config,
+                                                       const gchar *target)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    GList *tmp = priv->mounts;
+
+    while (tmp) {
+        GVirSandboxConfigMount *mnt = GVIR_SANDBOX_CONFIG_MOUNT(tmp->data);
+        if (g_str_equal(gvir_sandbox_config_mount_get_target(mnt), target)) {
+            return g_object_ref(mnt);
+        }
+        tmp = tmp->next;
+    }
+    return NULL;
+}
+
+
+/**
+ * gvir_sandbox_config_add_mount_strv:
+ * @config: (transfer none): the sandbox config
+ * @mounts: (transfer none)(array zero-terminated=1): the list of mounts
+ *
+ * Parses @mounts whose elements are in the format TYPE:TARGET=SOURCE
+ * creating #GVirSandboxConfigMount instances for each element. For
+ * example
+ *
+ * - host-bind:/tmp=/var/lib/sandbox/demo/tmp
+ * - host-image:/=/var/lib/sandbox/demo.img
+ * - guest-bind:/home=/tmp/home
+ */
+gboolean gvir_sandbox_config_add_mount_strv(GVirSandboxConfig *config,
+                                            gchar **mounts,
+                                            GError **error)
+{
+    gsize i = 0;
+    while (mounts && mounts[i]) {
+        if (!gvir_sandbox_config_add_mount_opts(config,
+                                                mounts[i],
+                                                error))
+            return FALSE;
+        i++;
+    }
+    return TRUE;
+}
+
+
+/**
+ * gvir_sandbox_config_add_mount_opts:
+ * @config: (transfer none): the sandbox config
+ * @mount: (transfer none): the mount config
+ *
+ * Parses @mount whose elements are in the format TYPE:TARGET=SOURCE
+ * creating #GVirSandboxConfigMount instances for each element. For
+ * example
+ *
+ * - host-bind:/tmp=/var/lib/sandbox/demo/tmp
+ * - host-image:/=/var/lib/sandbox/demo.img
+ * - host-image:/=/var/lib/sandbox/demo.qcow2,format=qcow2
+ * - guest-bind:/home=/tmp/home
+ * - ram:/tmp=500M
+ */
+gboolean gvir_sandbox_config_add_mount_opts(GVirSandboxConfig *config,
+                                            const char *mount,
+                                            GError **error)
+{
+    gchar *target = NULL;
+    const gchar *source = NULL;
+    GVirSandboxConfigMount *mnt;
+    gchar *tmp;
+    GType type;
+
+    tmp = strchr(mount, ':');
+    if (!tmp) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("No mount type prefix on %s"), mount);
+        return FALSE;
+    }
+    if (strncmp(mount, "host-bind", (tmp - mount)) == 0) {
+        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_BIND;
+    } else if (strncmp(mount, "host-image", (tmp - mount)) == 0) {
+        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_IMAGE;
+    } else if (strncmp(mount, "guest-bind", (tmp - mount)) == 0) {
+        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_GUEST_BIND;
+    } else if (strncmp(mount, "ram", (tmp - mount)) == 0) {
+        type = GVIR_SANDBOX_TYPE_CONFIG_MOUNT_RAM;
+    } else {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Unknown mount type prefix on %s"), mount);
+        return FALSE;
+    }
+
+    target = g_strdup(tmp + 1);
+
+    if ((tmp = strchr(target, '=')) != NULL) {
+        *tmp = '\0';
+        source = tmp + 1;
+    }
+
+    if (!tmp) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Missing mount source string on %s"), mount);
+        return FALSE;
+    }
+
+    if (type == GVIR_SANDBOX_TYPE_CONFIG_MOUNT_RAM) {
+        gint size;
+        gchar *end;
+        size = strtol(source, &end, 10);
+
+        if (end) {
+            if (g_str_equal(end, "KiB") || g_str_equal(end, "K"))
+                size *= 1024;
+            else if (g_str_equal(end, "MiB") || g_str_equal(end, "M"))
+                size *= 1024 * 1024;
+            else if (g_str_equal(end, "GiB") || g_str_equal(end, "G"))
+                size *= 1024 * 1024 * 1024;
+        }
+        mnt = GVIR_SANDBOX_CONFIG_MOUNT(gvir_sandbox_config_mount_ram_new(target,
+                                                                          size));
+    } else if (type == GVIR_SANDBOX_TYPE_CONFIG_MOUNT_HOST_IMAGE) {
+        const gchar *formatStr = NULL;
+        gint format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
+
+        if ((tmp = strchr(source, ',')) != NULL) {
+            GEnumClass *enum_class = g_type_class_ref(GVIR_CONFIG_TYPE_DOMAIN_DISK_FORMAT);
+            GEnumValue *enum_value = NULL;
+
+            *tmp = '\0';
+            formatStr = tmp + 1;
+
+            if ((strncmp(formatStr, "format=", 7) == 0)) {
+                if (!(enum_value = g_enum_get_value_by_nick(enum_class, formatStr + 7))) {
+                    g_type_class_unref(enum_class);
+                    g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                                _("Unknown disk image format: '%s'"), formatStr + 7);
+                    return FALSE;
+                }
+                g_type_class_unref(enum_class);
+                format = enum_value->value;
+            }
+        } else if ((format = gvir_sandbox_util_guess_image_format(source, error)) < 0) {
+            format = GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW;
+        }
+
+        mnt = GVIR_SANDBOX_CONFIG_MOUNT(g_object_new(type,
+                                                     "target", target,
+                                                     "source", source,
+                                                     "format", format,
+                                                     NULL));
+    } else {
+        mnt = GVIR_SANDBOX_CONFIG_MOUNT(g_object_new(type,
+                                                     "target", target,
+                                                     "source", source,
+                                                     NULL));
+    }
+    gvir_sandbox_config_add_mount(config, mnt);
+    g_object_unref(mnt);
+    g_free(target);
+
+    return TRUE;
+}
+
+
+gboolean gvir_sandbox_config_has_mounts(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->mounts != NULL;
+}
+
+gboolean gvir_sandbox_config_has_mounts_with_type(GVirSandboxConfig *config,
+                                                  GType type)
+{
+    GList *tmp = config->priv->mounts;
+    while (tmp) {
+        GObject *obj = tmp->data;
+        if (G_OBJECT_TYPE(obj) == type)
+            return TRUE;
+        tmp = tmp->next;
+    }
+    return FALSE;
+}
+
+
+gboolean gvir_sandbox_config_has_root_mount(GVirSandboxConfig *config)
+{
+    GList *tmp = NULL, *mounts = NULL;
+    gboolean hasRoot = FALSE;
+
+    tmp = mounts = gvir_sandbox_config_get_mounts(config);
+    while (tmp && !hasRoot) {
+        const gchar *target;
+        GVirSandboxConfigMount *mount = GVIR_SANDBOX_CONFIG_MOUNT(tmp->data);
+        target = gvir_sandbox_config_mount_get_target(mount);
+        if (g_str_equal(target, "/"))
+            hasRoot = TRUE;
+        tmp = tmp->next;
+    }
+    g_list_foreach(mounts, (GFunc)g_object_unref, NULL);
+    g_list_free(mounts);
+
+    return hasRoot;
+}
+
+
+
+
+/**
+ * gvir_sandbox_config_add_host_include_strv:
+ * @config: (transfer none): the sandbox config
+ * @includes: (transfer none)(array zero-terminated=1): the list of includes
+ *
+ * Parses @includes whose elements are in the format
+ * GUEST-TARGET=ROOT-PATH. If ROOT_PATH is omitted,
+ * then it is assumed to be the same as GUEST-TARGET
+ */
+gboolean gvir_sandbox_config_add_host_include_strv(GVirSandboxConfig *config,
+                                                   gchar **includes,
+                                                   GError **error)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    gsize i = 0;
+
+    while (includes && includes[i]) {
+        const gchar *host;
+        gchar *guest;
+        const gchar *relguest;
+        GVirSandboxConfigMount *mnt = NULL;
+        GList *mnts = NULL;
+        gchar *tmp;
+
+        guest = g_strdup(includes[i]);
+        if ((tmp = strchr(guest, '=')) != NULL) {
+            *tmp = '\0';
+            host = tmp + 1;
+        } else {
+            host = guest;
+        }
+
+        mnts = priv->mounts;
+        while (mnts) {
+            mnt = GVIR_SANDBOX_CONFIG_MOUNT(mnts->data);
+            const gchar *target = gvir_sandbox_config_mount_get_target(mnt);
+            if (g_str_has_prefix(guest, target)) {
+                relguest = guest + strlen(target);
+                break;
+            }
+            mnt = NULL;
+            mnts = mnts->next;
+        }
+        if (!mnt) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("No mount with a prefix under %s"), guest);
+            g_free(guest);
+            return FALSE;
+        }
+
+        gvir_sandbox_config_mount_add_include(GVIR_SANDBOX_CONFIG_MOUNT(mnt), host, relguest);
+        g_free(guest);
+
+        i++;
+    }
+
+    return TRUE;
+}
+
+
+gboolean gvir_sandbox_config_add_host_include_file(GVirSandboxConfig *config,
+                                                   gchar *includefile,
+                                                   GError **error)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    GFile *file = g_file_new_for_path(includefile);
+    GFileInputStream *is = NULL;
+    GDataInputStream *dis = NULL;
+    gboolean ret = FALSE;
+    gchar *line = NULL;
+
+    if (!(is = g_file_read(file, NULL, error)))
+        goto cleanup;
+
+    dis = g_data_input_stream_new(G_INPUT_STREAM(is));
+
+    while ((line = g_data_input_stream_read_line(dis,
+                                                 NULL,
+                                                 NULL,
+                                                 error))) {
+        const gchar *host;
+        gchar *guest;
+        const gchar *relguest;
+        GVirSandboxConfigMount *mnt = NULL;
+        GList *mnts = NULL;
+        gchar *tmp;
+
+        guest = g_strdup(line);
+        if ((tmp = strchr(guest, '=')) != NULL) {
+            *tmp = '\0';
+            host = tmp + 1;
+        } else {
+            host = guest;
+        }
+
+        mnts = priv->mounts;
+        while (mnts) {
+            mnt = GVIR_SANDBOX_CONFIG_MOUNT(mnts->data);
+            const gchar *target = gvir_sandbox_config_mount_get_target(mnt);
+            if (g_str_has_prefix(guest, target)) {
+                relguest = guest + strlen(target);
+                break;
+            } else {
+                relguest = guest;
+            }
+            mnt = NULL;
+            mnts = mnts->next;
+        }
+        if (!mnt) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("No mount with a prefix under %s"), guest);
+            g_free(guest);
+            return FALSE;
+        }
+
+        gvir_sandbox_config_mount_add_include(GVIR_SANDBOX_CONFIG_MOUNT(mnt), host, relguest);
+        g_free(guest);
+        g_free(line);
+    }
+
+    if (error && *error)
+        goto cleanup;
+
+    ret = TRUE;
+ cleanup:
+    if (dis)
+        g_object_unref(dis);
+    g_object_unref(file);
+    return ret;
+}
+
+/**
+ * gvir_sandbox_config_set_security_label:
+ * @config: (transfer none): the sandbox config
+ * @label: (transfer none): the host directory
+ *
+ * Set the sandbox security label. By default a dynamic security label
+ * is chosen. A static security label must be specified if any
+ * custom mounts are added
+ */
+void gvir_sandbox_config_set_security_label(GVirSandboxConfig *config, const gchar *label)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_free(priv->secLabel);
+    priv->secLabel = g_strdup(label);
+}
+
+/**
+ * gvir_sandbox_config_get_security_label:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieve the sandbox security label
+ *
+ * Returns: (transfer none): the security label
+ */
+const gchar *gvir_sandbox_config_get_security_label(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->secLabel;
+}
+
+
+/**
+ * gvir_sandbox_config_set_security_dynamic:
+ * @config: (transfer none): the sandbox config
+ * @dynamic: the security mode
+ *
+ * Set the SELinux security dynamic for the sandbox. The default
+ * dynamic is "svirt_sandbox_t"
+ */
+void gvir_sandbox_config_set_security_dynamic(GVirSandboxConfig *config, gboolean dynamic)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->secDynamic = dynamic;
+}
+
+/**
+ * gvir_sandbox_config_get_security_dynamic:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieve the sandbox security mode
+ *
+ * Returns: the security mode
+ */
+gboolean gvir_sandbox_config_get_security_dynamic(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->secDynamic;
+}
+
+
+gboolean gvir_sandbox_config_set_security_opts(GVirSandboxConfig *config,
+                                               const gchar *optstr,
+                                               GError **error)
+{
+    gboolean ret = FALSE;
+    gchar *tmp = g_strdup(optstr);
+    gchar *offset = strchr(tmp, ',');
+    if (offset) {
+        *offset = '\0';
+        offset++;
+    }
+
+    if (g_str_equal(tmp, "dynamic")) {
+        gvir_sandbox_config_set_security_dynamic(config, TRUE);
+    } else if (g_str_equal(tmp, "static")) {
+        gvir_sandbox_config_set_security_dynamic(config, FALSE);
+    } else if (g_str_equal(tmp, "inherit")) {
+        gvir_sandbox_config_set_security_dynamic(config, FALSE);
+        char *scon;
+        if (getcon(&scon) < 0) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unable to get SELinux context of user: %s"),
+                        strerror(errno));
+            return FALSE;
+        }
+        gvir_sandbox_config_set_security_label(config, scon);
+        freecon(scon);
+
+    } else {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Unknown security option '%s'"), tmp);
+        goto cleanup;
+    }
+
+    if (offset) {
+        if (strncmp(offset, "label=", 6) == 0) {
+            gvir_sandbox_config_set_security_label(config, offset+6);
+        } else {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown security option '%s'"), offset);
+            goto cleanup;
+        }
+    }
+
+    ret = TRUE;
+
+ cleanup:
+    g_free(tmp);
+    return ret;
+}
+
+/**
+ * gvir_sandbox_config_set_debug:
+ * @config: (transfer none): the sandbox config
+ * @debug: true if the container init should print debugging messages
+ *
+ * Set whether the container init should print debugging messages.
+ */
+void gvir_sandbox_config_set_debug(GVirSandboxConfig *config, gboolean debug)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->debug = debug;
+}
+
+/**
+ * gvir_sandbox_config_get_debug:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the sandbox debug flag
+ *
+ * Returns: the debug flag
+ */
+gboolean gvir_sandbox_config_get_debug(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->debug;
+}
+
+/**
+ * gvir_sandbox_config_set_verbose:
+ * @config: (transfer none): the sandbox config
+ * @verbose: true if the container init should be verbose
+ *
+ * Set whether the container init should be verbose.
+ */
+void gvir_sandbox_config_set_verbose(GVirSandboxConfig *config, gboolean verbose)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->verbose = verbose;
+}
+
+/**
+ * gvir_sandbox_config_get_verbose:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the sandbox verbose flag
+ *
+ * Returns: the verbose flag
+ */
+gboolean gvir_sandbox_config_get_verbose(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->verbose;
+}
+
+/**
+ * gvir_sandbox_config_set_telemetry_interval:
+ * @config: (transfer none): the sandbox config
+ * @interval: the sampling interval in milliseconds, or 0 to disable
+ *
+ * Set how often the sandbox init should sample pressure, memory and
+ * CPU statistics inside the guest and report them to the host. The
+ * default of 0 disables telemetry entirely.
+ */
+void gvir_sandbox_config_set_telemetry_interval(GVirSandboxConfig *config,
+                                                guint interval)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->telemetryInterval = interval;
+}
+
+/**
+ * gvir_sandbox_config_get_telemetry_interval:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the telemetry sampling interval
+ *
+ * Returns: the interval in milliseconds, or 0 if disabled
+ */
+guint gvir_sandbox_config_get_telemetry_interval(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->telemetryInterval;
+}
+
+/**
+ * gvir_sandbox_config_set_readahead:
+ * @config: (transfer none): the sandbox config
+ * @readahead: true to record and replay startup file accesses
+ *
+ * Set whether the sandbox init should record the files accessed
+ * while the sandbox starts up, so that on later launches of the
+ * same command the host can read them ahead in parallel. The trace
+ * is kept in the sandbox state directory. This only has an effect
+ * for machine based sandboxes, whose root filesystem is accessed
+ * over 9p.
+ */
+void gvir_sandbox_config_set_readahead(GVirSandboxConfig *config,
+                                       gboolean readahead)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->readahead = readahead;
+}
+
+/**
+ * gvir_sandbox_config_get_readahead:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the sandbox readahead flag
+ *
+ * Returns: the readahead flag
+ */
+gboolean gvir_sandbox_config_get_readahead(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->readahead;
+}
+
+/**
+ * gvir_sandbox_config_set_fastboot:
+ * @config: (transfer none): the sandbox config
+ * @fastboot: true to skip probing hardware the sandbox never has
+ *
+ * Set whether machine based sandboxes should boot their kernel with
+ * a command line that skips probing for legacy hardware, buses and
+ * serial ports the sandbox does not have, as well as boot time self
+ * tests and clock checks, to cut down kernel initialization time.
+ * This has no effect for container based sandboxes.
+ */
+void gvir_sandbox_config_set_fastboot(GVirSandboxConfig *config,
+                                      gboolean fastboot)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->fastboot = fastboot;
+}
+
+/**
+ * gvir_sandbox_config_get_fastboot:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the sandbox fastboot flag
+ *
+ * Returns: the fastboot flag
+ */
+gboolean gvir_sandbox_config_get_fastboot(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->fastboot;
+}
+
+/**
+ * gvir_sandbox_config_set_rng_rate:
+ * @config: (transfer none): the sandbox config
+ * @rate: the entropy rate in bytes per second, or 0 for no limit
+ *
+ * Set the rate at which machine based sandboxes may draw entropy
+ * from the host's /dev/urandom, through their virtio RNG device.
+ * The default of 0 does not limit it.
+ */
+void gvir_sandbox_config_set_rng_rate(GVirSandboxConfig *config,
+                                      guint rate)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->rngRate = rate;
+}
+
+/**
+ * gvir_sandbox_config_get_rng_rate:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the entropy rate limit of the virtio RNG device
+ *
+ * Returns: the rate in bytes per second, or 0 if unlimited
+ */
+guint gvir_sandbox_config_get_rng_rate(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->rngRate;
+}
+
+
+/**
+ * gvir_sandbox_config_set_vcpus:
+ * @config: (transfer none): the sandbox config
+ * @vcpus: the number of virtual CPUs, or 0 for the default
+ *
+ * Set the number of virtual CPUs given to the sandbox. Machine
+ * based sandboxes default to a single CPU, while container based
+ * sandboxes are not limited unless a count is set, in which case
+ * their CPU time is capped to the equivalent of @vcpus CPUs.
+ */
+void gvir_sandbox_config_set_vcpus(GVirSandboxConfig *config,
+                                   guint vcpus)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->vcpus = vcpus;
+}
+
+/**
+ * gvir_sandbox_config_get_vcpus:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the number of virtual CPUs of the sandbox
+ *
+ * Returns: the CPU count, or 0 if using the default
+ */
+guint gvir_sandbox_config_get_vcpus(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->vcpus;
+}
+
+
+/**
+ * gvir_sandbox_config_set_cpu_topology:
+ * @config: (transfer none): the sandbox config
+ * @sockets: the number of CPU sockets
+ * @cores: the number of cores per socket
+ * @threads: the number of threads per core
+ *
+ * Set the CPU topology presented to machine based sandboxes. The
+ * product of @sockets, @cores and @threads should match the vCPU
+ * count. Passing zero for all three removes the topology, letting
+ * the hypervisor pick one.
+ */
+void gvir_sandbox_config_set_cpu_topology(GVirSandboxConfig *config,
+                                          guint sockets,
+                                          guint cores,
+                                          guint threads)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->cpuSockets = sockets;
+    priv->cpuCores = cores;
+    priv->cpuThreads = threads;
+}
+
+/**
+ * gvir_sandbox_config_get_cpu_sockets:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the number of CPU sockets in the topology
+ *
+ * Returns: the socket count, or 0 if no topology is set
+ */
+guint gvir_sandbox_config_get_cpu_sockets(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->cpuSockets;
+}
+
+/**
+ * gvir_sandbox_config_get_cpu_cores:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the number of cores per socket in the topology
+ *
+ * Returns: the core count, or 0 if no topology is set
+ */
+guint gvir_sandbox_config_get_cpu_cores(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->cpuCores;
+}
+
+/**
+ * gvir_sandbox_config_get_cpu_threads:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the number of threads per core in the topology
+ *
+ * Returns: the thread count, or 0 if no topology is set
+ */
+guint gvir_sandbox_config_get_cpu_threads(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->cpuThreads;
+}
+
+
+/**
+ * gvir_sandbox_config_set_vcpus_opts:
+ * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the vCPU options
+ * @error: (out): the error location
+ *
+ * Parses @optstr in the format
+ * VCPUS[,sockets=SOCKETS,cores=CORES,threads=THREADS]. When a
+ * topology is given, any of its elements left out default to one,
+ * and their product must equal the vCPU count
+ *
+ * --vcpus 4,sockets=1,cores=2,threads=2
+ */
+gboolean gvir_sandbox_config_set_vcpus_opts(GVirSandboxConfig *config,
+                                            const gchar *optstr,
+                                            GError **error)
+{
+    gchar **opts = g_strsplit(optstr, ",", 0);
+    gboolean ret = FALSE;
+    guint vcpus = 0;
+    guint sockets = 0, cores = 0, threads = 0;
+    gboolean topology = FALSE;
+    gsize i;
+
+    if (!opts[0]) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Missing vCPU count in '%s'"), optstr);
+        goto cleanup;
+    }
+    if (!gvir_sandbox_config_parse_count(opts[0], &vcpus, error))
+        goto cleanup;
+
+    for (i = 1 ; opts[i] ; i++) {
+        if (g_str_has_prefix(opts[i], "sockets=")) {
+            if (!gvir_sandbox_config_parse_count(opts[i] + strlen("sockets="),
+                                                 &sockets, error))
+                goto cleanup;
+        } else if (g_str_has_prefix(opts[i], "cores=")) {
+            if (!gvir_sandbox_config_parse_count(opts[i] + strlen("cores="),
+                                                 &cores, error))
+                goto cleanup;
+        } else if (g_str_has_prefix(opts[i], "threads=")) {
+            if (!gvir_sandbox_config_parse_count(opts[i] + strlen("threads="),
+                                                 &threads, error))
+                goto cleanup;
+        } else {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown vCPU option '%s'"), opts[i]);
+            goto cleanup;
+        }
+        topology = TRUE;
+    }
+
+    if (topology) {
+        if (!sockets)
+            sockets = 1;
+        if (!cores)
+            cores = 1;
+        if (!threads)
+            threads = 1;
+        if ((guint64)sockets * cores * threads != vcpus) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("CPU topology %u*%u*%u does not match %u vCPUs"),
+                        sockets, cores, threads, vcpus);
+            goto cleanup;
+        }
+    }
+
+    gvir_sandbox_config_set_vcpus(config, vcpus);
+    gvir_sandbox_config_set_cpu_topology(config, sockets, cores, threads);
+
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    return ret;
+}
+
+
+/**
+ * gvir_sandbox_config_set_memory:
+ * @config: (transfer none): the sandbox config
+ * @memory: the memory size in bytes
+ *
+ * Set the amount of memory given to the sandbox, which defaults
+ * to 512 MiB. For container based sandboxes this is the memory
+ * limit applied to their cgroup.
+ */
+void gvir_sandbox_config_set_memory(GVirSandboxConfig *config,
+                                    guint64 memory)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->memory = memory;
+}
+
+/**
+ * gvir_sandbox_config_get_memory:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the amount of memory given to the sandbox
+ *
+ * Returns: the memory size in bytes
+ */
+guint64 gvir_sandbox_config_get_memory(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->memory;
+}
+
+
+/**
+ * gvir_sandbox_config_set_max_memory:
+ * @config: (transfer none): the sandbox config
+ * @memory: the maximum memory size in bytes, or 0
+ *
+ * Set the maximum amount of memory a machine based sandbox may
+ * grow to, when it is larger than the memory set with
+ * gvir_sandbox_config_set_memory(). The guest can only grow
+ * through its memory balloon, so this is ignored unless
+ * gvir_sandbox_config_set_balloon() is enabled. The default of 0
+ * makes the maximum the same as the initial memory size.
+ */
+void gvir_sandbox_config_set_max_memory(GVirSandboxConfig *config,
+                                        guint64 memory)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->maxMemory = memory;
+}
+
+/**
+ * gvir_sandbox_config_get_max_memory:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the maximum amount of memory of the sandbox
+ *
+ * Returns: the maximum memory size in bytes, or 0 if not set
+ */
+guint64 gvir_sandbox_config_get_max_memory(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->maxMemory;
+}
+
+
+/**
+ * gvir_sandbox_config_set_memory_opts:
+ * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the memory options
+ * @error: (out): the error location
+ *
+ * Parses @optstr in the format SIZE[,max=SIZE] where the sizes
+ * may have a K, M or G suffix
+ *
+ * --memory 1G,max=4G
+ */
+gboolean gvir_sandbox_config_set_memory_opts(GVirSandboxConfig *config,
+                                             const gchar *optstr,
+                                             GError **error)
+{
+    gchar **opts = g_strsplit(optstr, ",", 0);
+    gboolean ret = FALSE;
+    guint64 memory = 0;
+    guint64 maxMemory = 0;
+    gsize i;
+
+    if (!opts[0]) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Missing memory size in '%s'"), optstr);
+        goto cleanup;
+    }
+    if (!gvir_sandbox_config_parse_size(opts[0], &memory, error))
+        goto cleanup;
+
+    for (i = 1 ; opts[i] ; i++) {
+        if (g_str_has_prefix(opts[i], "max=")) {
+            if (!gvir_sandbox_config_parse_size(opts[i] + strlen("max="),
+                                                &maxMemory, error))
+                goto cleanup;
+        } else {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown memory option '%s'"), opts[i]);
+            goto cleanup;
+        }
+    }
+
+    if (memory < 1024 * 1024) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Memory size '%s' is too small"), opts[0]);
+        goto cleanup;
+    }
+    if (maxMemory && maxMemory < memory) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Maximum memory is smaller than memory in '%s'"), optstr);
+        goto cleanup;
+    }
+
+    gvir_sandbox_config_set_memory(config, memory);
+    gvir_sandbox_config_set_max_memory(config, maxMemory);
+
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    return ret;
+}
+
+
+/**
+ * gvir_sandbox_config_set_balloon:
+ * @config: (transfer none): the sandbox config
+ * @balloon: true to add a memory balloon
+ *
+ * Add a virtio memory balloon to machine based sandboxes. The
+ * guest reports the pages it frees back to the host, the balloon
+ * deflates when the guest runs out of memory, and its target can
+ * be changed with gvir_sandbox_context_set_balloon_target() while
+ * the sandbox is running.
+ */
+void gvir_sandbox_config_set_balloon(GVirSandboxConfig *config,
+                                     gboolean balloon)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->balloon = balloon;
+}
+
+/**
+ * gvir_sandbox_config_get_balloon:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves whether the sandbox has a memory balloon
+ *
+ * Returns: the balloon flag
+ */
+gboolean gvir_sandbox_config_get_balloon(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->balloon;
+}
+
+
+/* Huge pages are a power of two, and a whole number of KiB */
+static gboolean gvir_sandbox_config_is_hugepage_size(guint64 size)
+{
+    return size == 0 ||
+        (size >= 1024 && (size & (size - 1)) == 0);
+}
+
+/**
+ * gvir_sandbox_config_set_hugepages:
+ * @config: (transfer none): the sandbox config
+ * @size: the huge page size in bytes, or 0 to disable
+ *
+ * Back the memory of machine based sandboxes with huge pages of
+ * @size bytes, which must have been reserved on the host. This
+ * saves the guest from most EPT faults while it warms up. The
+ * size must be a power of two of at least 1 KiB, and the memory
+ * of the sandbox a multiple of it.
+ */
+void gvir_sandbox_config_set_hugepages(GVirSandboxConfig *config,
+                                       guint64 size)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_return_if_fail(gvir_sandbox_config_is_hugepage_size(size));
+    priv->hugepageSize = size;
+}
+
+/**
+ * gvir_sandbox_config_get_hugepages:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the huge page size backing the sandbox memory
+ *
+ * Returns: the huge page size in bytes, or 0 if disabled
+ */
+guint64 gvir_sandbox_config_get_hugepages(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->hugepageSize;
+}
+
+
+/**
+ * gvir_sandbox_config_set_memfd:
+ * @config: (transfer none): the sandbox config
+ * @memfd: true to back memory with a shared memfd
+ *
+ * Back the memory of machine based sandboxes with an anonymous
+ * memfd, mapped with shared access, rather than private memory.
+ */
+void gvir_sandbox_config_set_memfd(GVirSandboxConfig *config,
+                                   gboolean memfd)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->memfd = memfd;
+}
+
+/**
+ * gvir_sandbox_config_get_memfd:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves whether the sandbox memory is backed by a memfd
+ *
+ * Returns: the memfd flag
+ */
+gboolean gvir_sandbox_config_get_memfd(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->memfd;
+}
+
+
+/**
+ * gvir_sandbox_config_set_prealloc:
+ * @config: (transfer none): the sandbox config
+ * @prealloc: true to preallocate memory
+ *
+ * Allocate all the memory of machine based sandboxes when they
+ * start, rather than on first access by the guest.
+ */
+void gvir_sandbox_config_set_prealloc(GVirSandboxConfig *config,
+                                      gboolean prealloc)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->prealloc = prealloc;
+}
+
+/**
+ * gvir_sandbox_config_get_prealloc:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves whether the sandbox memory is preallocated
+ *
+ * Returns: the preallocation flag
+ */
+gboolean gvir_sandbox_config_get_prealloc(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->prealloc;
+}
+
+
+/**
+ * gvir_sandbox_config_set_memory_locked:
+ * @config: (transfer none): the sandbox config
+ * @locked: true to lock memory
+ *
+ * Lock the memory of machine based sandboxes in host RAM, so it
+ * is never swapped out. This needs a large enough RLIMIT_MEMLOCK.
+ */
+void gvir_sandbox_config_set_memory_locked(GVirSandboxConfig *config,
+                                           gboolean locked)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->memLocked = locked;
+}
+
+/**
+ * gvir_sandbox_config_get_memory_locked:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves whether the sandbox memory is locked in host RAM
+ *
+ * Returns: the locking flag
+ */
+gboolean gvir_sandbox_config_get_memory_locked(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->memLocked;
+}
+
+
+/**
+ * gvir_sandbox_config_set_mergeable_memory:
+ * @config: (transfer none): the sandbox config
+ * @mergeable: true to let KSM merge memory
+ *
+ * Set whether the host's kernel samepage merging may share
+ * identical pages between the memory of machine based sandboxes.
+ * This is allowed by default, as it is for any other guest, and
+ * lets many near identical sandboxes fit on a host that runs KSM.
+ * Disallowing it closes the timing side channels that shared
+ * pages open up between sandboxes.
+ */
+void gvir_sandbox_config_set_mergeable_memory(GVirSandboxConfig *config,
+                                              gboolean mergeable)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    priv->mergeable = mergeable;
+}
+
+/**
+ * gvir_sandbox_config_get_mergeable_memory:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves whether the sandbox memory may be merged by KSM
+ *
+ * Returns: the mergeable flag
+ */
+gboolean gvir_sandbox_config_get_mergeable_memory(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->mergeable;
+}
+
+
+/**
+ * gvir_sandbox_config_set_memory_backing_opts:
+ * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the memory backing options
+ * @error: (out): the error location
+ *
+ * Parses @optstr as a comma separated list of the options
+ * hugepages[=SIZE], memfd, prealloc, locked, mergeable and
+ * nosharepages, where the huge page size may have a K, M or G
+ * suffix and defaults to 2M
+ *
+ * --memory-backing hugepages=1G,prealloc,locked
+ */
+gboolean gvir_sandbox_config_set_memory_backing_opts(GVirSandboxConfig *config,
+                                                     const gchar *optstr,
+                                                     GError **error)
+{
+    gchar **opts = g_strsplit(optstr, ",", 0);
+    gboolean ret = FALSE;
+    guint64 size;
+    gsize i;
+
+    for (i = 0 ; opts[i] ; i++) {
+        if (g_str_equal(opts[i], "hugepages")) {
+            gvir_sandbox_config_set_hugepages(config, 2 * 1024 * 1024);
+        } else if (g_str_has_prefix(opts[i], "hugepages=")) {
+            if (!gvir_sandbox_config_parse_size(opts[i] + strlen("hugepages="),
+                                                &size, error))
+                goto cleanup;
+            if (!size || !gvir_sandbox_config_is_hugepage_size(size)) {
+                g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                            _("Invalid huge page size in '%s'"), opts[i]);
+                goto cleanup;
+            }
+            gvir_sandbox_config_set_hugepages(config, size);
+        } else if (g_str_equal(opts[i], "memfd")) {
+            gvir_sandbox_config_set_memfd(config, TRUE);
+        } else if (g_str_equal(opts[i], "prealloc")) {
+            gvir_sandbox_config_set_prealloc(config, TRUE);
+        } else if (g_str_equal(opts[i], "locked")) {
+            gvir_sandbox_config_set_memory_locked(config, TRUE);
+        } else if (g_str_equal(opts[i], "mergeable")) {
+            gvir_sandbox_config_set_mergeable_memory(config, TRUE);
+        } else if (g_str_equal(opts[i], "nosharepages")) {
+            gvir_sandbox_config_set_mergeable_memory(config, FALSE);
+        } else {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown memory backing option '%s'"), opts[i]);
+            goto cleanup;
+        }
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    return ret;
+}
+
+
+struct GVirSandboxConfigTuningParam {
+    const gchar *key;
+    const gchar *value;
+};
+
+struct GVirSandboxConfigTuningProfile {
+    const gchar *name;
+    const struct GVirSandboxConfigTuningParam *params;
+};
+
+static const struct GVirSandboxConfigTuningParam tuningThroughput[] = {
+    { "vm.swappiness", "10" },
+    { "vm.dirty_ratio", "40" },
+    { "vm.dirty_background_ratio", "10" },
+    { "vm.overcommit_memory", "1" },
+    { "thp.enabled", "always" },
+    { "block.scheduler", "none" },
+    { "block.read_ahead_kb", "1024" },
+    { NULL, NULL },
+};
+
+static const struct GVirSandboxConfigTuningParam tuningLatency[] = {
+    { "vm.swappiness", "10" },
+    { "vm.dirty_ratio", "10" },
+    { "vm.dirty_background_ratio", "3" },
+    { "vm.stat_interval", "10" },
+    { "thp.enabled", "madvise" },
+    { "thp.defrag", "never" },
+    { "block.scheduler", "mq-deadline" },
+    { NULL, NULL },
+};
+
+static const struct GVirSandboxConfigTuningParam tuningMinimalMemory[] = {
+    { "vm.swappiness", "100" },
+    { "vm.dirty_ratio", "10" },
+    { "vm.dirty_background_ratio", "5" },
+    { "vm.vfs_cache_pressure", "200" },
+    { "vm.overcommit_memory", "0" },
+    { "thp.enabled", "never" },
+    { "block.read_ahead_kb", "32" },
+    { NULL, NULL },
+};
+
+static const struct GVirSandboxConfigTuningProfile tuningProfiles[] = {
+    { "throughput", tuningThroughput },
+    { "latency", tuningLatency },
+    { "minimal-memory", tuningMinimalMemory },
+};
+
+
+static const struct GVirSandboxConfigTuningProfile *
+gvir_sandbox_config_find_tuning_profile(const gchar *name)
+{
+    gsize i;
+
+    for (i = 0 ; i < G_N_ELEMENTS(tuningProfiles) ; i++) {
+        if (g_str_equal(tuningProfiles[i].name, name))
+            return &tuningProfiles[i];
+    }
+    return NULL;
+}
+
 
-        guest = g_strdup(includes[i]);
-        if ((tmp = strchr(guest, '=')) != NULL) {
-            *tmp = '\0';
-            host = tmp + 1;
-        } else {
-            host = guest;
-        }
+/* Keys turn into sysfs / procfs paths in the guest, so only
+ * allow plain names, separated by dots, or by slashes as sysctl(8)
+ * allows for sysctls with dots in a component */
+static gboolean gvir_sandbox_config_tuning_key_valid(const gchar *key)
+{
+    const gchar *tmp;
 
-        mnts = priv->mounts;
-        while (mnts) {
-            mnt = GVIR_SANDBOX_CONFIG_MOUNT(mnts->data);
-            const gchar *target = gvir_sandbox_config_mount_get_target(mnt);
-            if (g_str_has_prefix(guest, target)) {
-                relguest = guest + strlen(target);
-                break;
-            }
-            mnt = NULL;
-            mnts = mnts->next;
-        }
-        if (!mnt) {
-            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                        _("No mount with a prefix under %s"), guest);
-            g_free(guest);
-            return FALSE;
-        }
+    if (!key[0] || key[0] == '.' || key[0] == '/' ||
+        strstr(key, "..") || strstr(key, "//") ||
+        strstr(key, "/./") || g_str_has_suffix(key, "/."))
+        return FALSE;
 
-        gvir_sandbox_config_mount_add_include(GVIR_SANDBOX_CONFIG_MOUNT(mnt), host, relguest);
-        g_free(guest);
+    /* These name a single file in a fixed directory */
+    if ((g_str_has_prefix(key, "block.") ||
+         g_str_has_prefix(key, "thp.")) &&
+        strchr(key, '/'))
+        return FALSE;
 
-        i++;
+    for (tmp = key ; *tmp ; tmp++) {
+        if (!g_ascii_isalnum(*tmp) &&
+            *tmp != '_' && *tmp != '-' && *tmp != '.' && *tmp != '/')
+            return FALSE;
     }
-
     return TRUE;
 }
 
 
-gboolean gvir_sandbox_config_add_host_include_file(GVirSandboxConfig *config,
-                                                   gchar *includefile,
-                                                   GError **error)
+/**
+ * gvir_sandbox_config_set_tuning_profile:
+ * @config: (transfer none): the sandbox config
+ * @profile: (transfer none)(allow-none): the tuning profile name
+ *
+ * Set the performance tuning profile the sandbox init applies to
+ * the guest kernel before starting the application. The profiles
+ * are "throughput", "latency" and "minimal-memory", or NULL to
+ * leave the kernel defaults in place. Individual parameters can
+ * be overridden with gvir_sandbox_config_set_tuning_param().
+ */
+void gvir_sandbox_config_set_tuning_profile(GVirSandboxConfig *config,
+                                            const gchar *profile)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    GFile *file = g_file_new_for_path(includefile);
-    GFileInputStream *is = NULL;
-    GDataInputStream *dis = NULL;
-    gboolean ret = FALSE;
-    gchar *line = NULL;
-
-    if (!(is = g_file_read(file, NULL, error)))
-        goto cleanup;
+    g_free(priv->tuningProfile);
+    priv->tuningProfile = g_strdup(profile);
+}
 
-    dis = g_data_input_stream_new(G_INPUT_STREAM(is));
+/**
+ * gvir_sandbox_config_get_tuning_profile:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the sandbox tuning profile name
+ *
+ * Returns: (transfer none): the tuning profile, or NULL
+ */
+const gchar *gvir_sandbox_config_get_tuning_profile(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->tuningProfile;
+}
 
-    while ((line = g_data_input_stream_read_line(dis,
-                                                 NULL,
-                                                 NULL,
-                                                 error))) {
-        const gchar *host;
-        gchar *guest;
-        const gchar *relguest;
-        GVirSandboxConfigMount *mnt = NULL;
-        GList *mnts = NULL;
-        gchar *tmp;
+/**
+ * gvir_sandbox_config_set_tuning_param:
+ * @config: (transfer none): the sandbox config
+ * @key: (transfer none): the tuning parameter name
+ * @value: (transfer none): the tuning parameter value
+ *
+ * Override a single tuning parameter, whether or not a profile is
+ * set. Keys of the form "block.NAME" are written to
+ * /sys/block/vdX/queue/NAME for each virtio disk, keys of the form
+ * "thp.NAME" to /sys/kernel/mm/transparent_hugepage/NAME, and any
+ * other key is treated as a sysctl name, such as "vm.swappiness".
+ * As with sysctl(8), a sysctl name whose first separator is a slash
+ * uses slashes throughout, so that its components may contain dots,
+ * such as "net/ipv4/conf/eth0.100/forwarding".
+ */
+void gvir_sandbox_config_set_tuning_param(GVirSandboxConfig *config,
+                                          const gchar *key,
+                                          const gchar *value)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    g_hash_table_insert(priv->tuningParams, g_strdup(key), g_strdup(value));
+}
 
-        guest = g_strdup(line);
-        if ((tmp = strchr(guest, '=')) != NULL) {
-            *tmp = '\0';
-            host = tmp + 1;
-        } else {
-            host = guest;
-        }
+/**
+ * gvir_sandbox_config_get_tuning_params:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the tuning parameters explicitly overridden
+ *
+ * Returns: (transfer none) (element-type gchar gchar): the hashtable of tuning parameters
+ */
+GHashTable *gvir_sandbox_config_get_tuning_params(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->tuningParams;
+}
 
-        mnts = priv->mounts;
-        while (mnts) {
-            mnt = GVIR_SANDBOX_CONFIG_MOUNT(mnts->data);
-            const gchar *target = gvir_sandbox_config_mount_get_target(mnt);
-            if (g_str_has_prefix(guest, target)) {
-                relguest = guest + strlen(target);
-                break;
-            } else {
-                relguest = guest;
-            }
-            mnt = NULL;
-            mnts = mnts->next;
-        }
-        if (!mnt) {
-            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                        _("No mount with a prefix under %s"), guest);
-            g_free(guest);
-            return FALSE;
-        }
+/**
+ * gvir_sandbox_config_get_tuning:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the full set of tuning parameters to apply, from the
+ * tuning profile with any overrides on top
+ *
+ * Returns: (transfer full) (element-type gchar gchar): the hashtable of tuning parameters
+ */
+GHashTable *gvir_sandbox_config_get_tuning(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    GHashTable *params = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                               g_free, g_free);
+    const struct GVirSandboxConfigTuningProfile *profile = NULL;
+    GHashTableIter iter;
+    gpointer key, value;
+    gsize i;
 
-        gvir_sandbox_config_mount_add_include(GVIR_SANDBOX_CONFIG_MOUNT(mnt), host, relguest);
-        g_free(guest);
-        g_free(line);
+    if (priv->tuningProfile &&
+        (profile = gvir_sandbox_config_find_tuning_profile(priv->tuningProfile))) {
+        for (i = 0 ; profile->params[i].key ; i++)
+            g_hash_table_insert(params,
+                                g_strdup(profile->params[i].key),
+                                g_strdup(profile->params[i].value));
     }
 
-    if (error && *error)
-        goto cleanup;
+    g_hash_table_iter_init(&iter, priv->tuningParams);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+        g_hash_table_insert(params, g_strdup(key), g_strdup(value));
 
-    ret = TRUE;
- cleanup:
-    if (dis)
-        g_object_unref(dis);
-    g_object_unref(file);
-    return ret;
+    return params;
+}
+
+/* The swap header counts pages in 32 bits, and mkswap wants at
+ * least ten of them, so bound the size for pages of up to 64 KiB */
+#define GVIR_SANDBOX_CONFIG_ZRAM_MIN (1024ull * 1024)
+#define GVIR_SANDBOX_CONFIG_ZRAM_MAX (4096ull * G_MAXUINT32)
+
+static gboolean gvir_sandbox_config_check_zram_size(guint64 size,
+                                                    GError **error)
+{
+    if (size &&
+        (size < GVIR_SANDBOX_CONFIG_ZRAM_MIN ||
+         size > GVIR_SANDBOX_CONFIG_ZRAM_MAX)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Zram size %" G_GUINT64_FORMAT " must be between "
+                      "1M and 16T"), size);
+        return FALSE;
+    }
+    return TRUE;
 }
 
 /**
- * gvir_sandbox_config_set_security_label:
+ * gvir_sandbox_config_set_zram_size:
  * @config: (transfer none): the sandbox config
- * @label: (transfer none): the host directory
+ * @size: the zram swap device size in bytes
  *
- * Set the sandbox security label. By default a dynamic security label
- * is chosen. A static security label must be specified if any
- * custom mounts are added
+ * Set the size of a compressed RAM swap device to create inside
+ * the sandbox, or zero to not use one. The size is that of the
+ * uncompressed data it can hold, which is typically a few times
+ * larger than the guest memory it consumes. It must be between
+ * 1 MiB and 16 TiB. This only has an effect for machine based
+ * sandboxes.
  */
-void gvir_sandbox_config_set_security_label(GVirSandboxConfig *config, const gchar *label)
+void gvir_sandbox_config_set_zram_size(GVirSandboxConfig *config,
+                                       guint64 size)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    g_free(priv->secLabel);
-    priv->secLabel = g_strdup(label);
+    priv->zramSize = size;
 }
 
 /**
- * gvir_sandbox_config_get_security_label:
+ * gvir_sandbox_config_get_zram_size:
  * @config: (transfer none): the sandbox config
  *
- * Retrieve the sandbox security label
+ * Retrieves the sandbox zram swap device size
  *
- * Returns: (transfer none): the security label
+ * Returns: the zram size in bytes, or zero if disabled
  */
-const gchar *gvir_sandbox_config_get_security_label(GVirSandboxConfig *config)
+guint64 gvir_sandbox_config_get_zram_size(GVirSandboxConfig *config)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    return priv->secLabel;
+    return priv->zramSize;
 }
 
-
 /**
- * gvir_sandbox_config_set_security_dynamic:
+ * gvir_sandbox_config_set_zram_algorithm:
  * @config: (transfer none): the sandbox config
- * @dynamic: the security mode
+ * @algorithm: (transfer none)(allow-none): the compression algorithm
  *
- * Set the SELinux security dynamic for the sandbox. The default
- * dynamic is "svirt_sandbox_t"
+ * Set the compression algorithm of the zram swap device, one of
+ * "lzo", "lzo-rle", "lz4", "lz4hc" or "zstd", or NULL for the
+ * kernel's default.
  */
-void gvir_sandbox_config_set_security_dynamic(GVirSandboxConfig *config, gboolean dynamic)
+void gvir_sandbox_config_set_zram_algorithm(GVirSandboxConfig *config,
+                                            const gchar *algorithm)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    priv->secDynamic = dynamic;
+    g_free(priv->zramAlgorithm);
+    priv->zramAlgorithm = g_strdup(algorithm);
 }
 
 /**
- * gvir_sandbox_config_get_security_dynamic:
+ * gvir_sandbox_config_get_zram_algorithm:
  * @config: (transfer none): the sandbox config
  *
- * Retrieve the sandbox security mode
+ * Retrieves the sandbox zram compression algorithm
  *
- * Returns: the security mode
+ * Returns: (transfer none): the algorithm, or NULL for the default
  */
-gboolean gvir_sandbox_config_get_security_dynamic(GVirSandboxConfig *config)
+const gchar *gvir_sandbox_config_get_zram_algorithm(GVirSandboxConfig *config)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    return priv->secDynamic;
+    return priv->zramAlgorithm;
 }
 
-
-gboolean gvir_sandbox_config_set_security_opts(GVirSandboxConfig *config,
-                                               const gchar *optstr,
-                                               GError **error)
+/**
+ * gvir_sandbox_config_set_zram_opts:
+ * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the zram options
+ * @error: (out): the error location
+ *
+ * Parses @optstr in the format SIZE[,algorithm=ALGORITHM] where
+ * the size may have a K, M or G suffix
+ *
+ * --zram 1G,algorithm=zstd
+ */
+gboolean gvir_sandbox_config_set_zram_opts(GVirSandboxConfig *config,
+                                           const gchar *optstr,
+                                           GError **error)
 {
+    gchar **opts = g_strsplit(optstr, ",", 0);
     gboolean ret = FALSE;
-    gchar *tmp = g_strdup(optstr);
-    gchar *offset = strchr(tmp, ',');
-    if (offset) {
-        *offset = '\0';
-        offset++;
-    }
-
-    if (g_str_equal(tmp, "dynamic")) {
-        gvir_sandbox_config_set_security_dynamic(config, TRUE);
-    } else if (g_str_equal(tmp, "static")) {
-        gvir_sandbox_config_set_security_dynamic(config, FALSE);
-    } else if (g_str_equal(tmp, "inherit")) {
-        gvir_sandbox_config_set_security_dynamic(config, FALSE);
-        char *scon;
-        if (getcon(&scon) < 0) {
-            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                        _("Unable to get SELinux context of user: %s"),
-                        strerror(errno));
-            return FALSE;
-        }
-        gvir_sandbox_config_set_security_label(config, scon);
-        freecon(scon);
+    guint64 size = 0;
+    gsize i;
 
-    } else {
+    if (!opts[0]) {
         g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                    _("Unknown security option '%s'"), tmp);
+                    _("Missing zram size in '%s'"), optstr);
         goto cleanup;
     }
+    if (!gvir_sandbox_config_parse_size(opts[0], &size, error) ||
+        !gvir_sandbox_config_check_zram_size(size, error))
+        goto cleanup;
+    gvir_sandbox_config_set_zram_size(config, size);
 
-    if (offset) {
-        if (strncmp(offset, "label=", 6) == 0) {
-            gvir_sandbox_config_set_security_label(config, offset+6);
+    for (i = 1 ; opts[i] ; i++) {
+        if (g_str_has_prefix(opts[i], "algorithm=")) {
+            gvir_sandbox_config_set_zram_algorithm(config,
+                                                   opts[i] + strlen("algorithm="));
         } else {
             g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
-                        _("Unknown security option '%s'"), offset);
+                        _("Unknown zram option '%s'"), opts[i]);
             goto cleanup;
         }
     }
 
     ret = TRUE;
-
  cleanup:
-    g_free(tmp);
+    g_strfreev(opts);
     return ret;
 }
 
+static const struct {
+    const gchar *name;
+    gint minLevel;
+    gint maxLevel;
+} gvir_sandbox_config_initrd_codecs[] = {
+    { "none", -1, -1 },
+    { "gzip", 1, 9 },
+    { "lz4", 1, 12 },
+    { "zstd", 1, 19 },
+};
+
+/* Whether @codec is known, with @level in its range or -1 */
+static gboolean gvir_sandbox_config_is_initrd_compression(const gchar *codec,
+                                                          gint level)
+{
+    gsize i;
+
+    if (!codec)
+        codec = "gzip";
+
+    for (i = 0 ; i < G_N_ELEMENTS(gvir_sandbox_config_initrd_codecs) ; i++) {
+        if (g_str_equal(codec, gvir_sandbox_config_initrd_codecs[i].name))
+            return level == -1 ||
+                (level >= gvir_sandbox_config_initrd_codecs[i].minLevel &&
+                 level <= gvir_sandbox_config_initrd_codecs[i].maxLevel);
+    }
+    return FALSE;
+}
+
 /**
- * gvir_sandbox_config_set_debug:
+ * gvir_sandbox_config_set_initrd_compression:
  * @config: (transfer none): the sandbox config
- * @debug: true if the container init should print debugging messages
+ * @codec: (transfer none)(allow-none): the compression codec
+ * @level: the compression level, or -1 for the codec default
  *
- * Set whether the container init should print debugging messages.
+ * Set how the initrd of a machine based sandbox is compressed,
+ * with @codec one of "gzip", "lz4", "zstd" or "none", or NULL
+ * for the default of gzip. Faster codecs and lower levels make
+ * the initrd quicker to build and to unpack during boot, at the
+ * cost of size.
  */
-void gvir_sandbox_config_set_debug(GVirSandboxConfig *config, gboolean debug)
+void gvir_sandbox_config_set_initrd_compression(GVirSandboxConfig *config,
+                                                const gchar *codec,
+                                                gint level)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    priv->debug = debug;
+    g_return_if_fail(gvir_sandbox_config_is_initrd_compression(codec, level));
+    g_free(priv->initrdCompression);
+    priv->initrdCompression = g_strdup(codec);
+    priv->initrdCompressionLevel = level;
 }
 
 /**
- * gvir_sandbox_config_get_debug:
+ * gvir_sandbox_config_get_initrd_compression:
  * @config: (transfer none): the sandbox config
  *
- * Retrieves the sandbox debug flag
+ * Retrieves the initrd compression codec
  *
- * Returns: the debug flag
+ * Returns: (transfer none): the codec, or NULL for the default
  */
-gboolean gvir_sandbox_config_get_debug(GVirSandboxConfig *config)
+const gchar *gvir_sandbox_config_get_initrd_compression(GVirSandboxConfig *config)
 {
     GVirSandboxConfigPrivate *priv = config->priv;
-    return priv->debug;
+    return priv->initrdCompression;
 }
 
-/**
- * gvir_sandbox_config_set_verbose:
- * @config: (transfer none): the sandbox config
- * @verbose: true if the container init should be verbose
- *
- * Set whether the container init should be verbose.
- */
-void gvir_sandbox_config_set_verbose(GVirSandboxConfig *config, gboolean verbose)
-{
-    GVirSandboxConfigPrivate *priv = config->priv;
-    priv->verbose = verbose;
+/**
+ * gvir_sandbox_config_get_initrd_compression_level:
+ * @config: (transfer none): the sandbox config
+ *
+ * Retrieves the initrd compression level
+ *
+ * Returns: the level, or -1 for the codec default
+ */
+gint gvir_sandbox_config_get_initrd_compression_level(GVirSandboxConfig *config)
+{
+    GVirSandboxConfigPrivate *priv = config->priv;
+    return priv->initrdCompressionLevel;
+}
+
+/**
+ * gvir_sandbox_config_set_initrd_compression_opts:
+ * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the compression options
+ * @error: (out): the error location
+ *
+ * Parses @optstr in the format CODEC[,level=LEVEL]
+ *
+ * --initrd-compression zstd,level=3
+ */
+gboolean gvir_sandbox_config_set_initrd_compression_opts(GVirSandboxConfig *config,
+                                                         const gchar *optstr,
+                                                         GError **error)
+{
+    gchar **opts = g_strsplit(optstr, ",", 0);
+    gboolean ret = FALSE;
+    gint level = -1;
+    gsize i;
+
+    if (!opts[0] ||
+        !gvir_sandbox_config_is_initrd_compression(opts[0], -1)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Unknown initrd compression in '%s'"), optstr);
+        goto cleanup;
+    }
+
+    for (i = 1 ; opts[i] ; i++) {
+        if (g_str_has_prefix(opts[i], "level=")) {
+            gchar *end;
+            level = strtol(opts[i] + strlen("level="), &end, 10);
+            if (*end || end == opts[i] + strlen("level=") ||
+                !gvir_sandbox_config_is_initrd_compression(opts[0], level)) {
+                g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                            _("Invalid %s compression level '%s'"),
+                            opts[0], opts[i] + strlen("level="));
+                goto cleanup;
+            }
+        } else {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown initrd compression option '%s'"), opts[i]);
+            goto cleanup;
+        }
+    }
+
+    gvir_sandbox_config_set_initrd_compression(config, opts[0], level);
+
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    return ret;
 }
 
 /**
- * gvir_sandbox_config_get_verbose:
+ * gvir_sandbox_config_set_tuning_opts:
  * @config: (transfer none): the sandbox config
+ * @optstr: (transfer none): the tuning options
+ * @error: (out): the error location
  *
- * Retrieves the sandbox verbose flag
+ * Parses @optstr in the format PROFILE[,KEY=VALUE...] where the
+ * profile may be omitted to only override individual parameters
  *
- * Returns: the verbose flag
+ * --tuning throughput,vm.swappiness=0
  */
-gboolean gvir_sandbox_config_get_verbose(GVirSandboxConfig *config)
+gboolean gvir_sandbox_config_set_tuning_opts(GVirSandboxConfig *config,
+                                             const gchar *optstr,
+                                             GError **error)
 {
-    GVirSandboxConfigPrivate *priv = config->priv;
-    return priv->verbose;
+    gchar **opts = g_strsplit(optstr, ",", 0);
+    gboolean ret = FALSE;
+    gsize i;
+
+    for (i = 0 ; opts[i] ; i++) {
+        gchar *value = strchr(opts[i], '=');
+
+        if (!value) {
+            if (i != 0 ||
+                !gvir_sandbox_config_find_tuning_profile(opts[i])) {
+                g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                            _("Unknown tuning profile '%s'"), opts[i]);
+                goto cleanup;
+            }
+            gvir_sandbox_config_set_tuning_profile(config, opts[i]);
+            continue;
+        }
+
+        *value = '\0';
+        value++;
+        if (!gvir_sandbox_config_tuning_key_valid(opts[i])) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Invalid tuning parameter '%s'"), opts[i]);
+            goto cleanup;
+        }
+        gvir_sandbox_config_set_tuning_param(config, opts[i], value);
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_strfreev(opts);
+    return ret;
 }
 
 static GVirSandboxConfigMount *gvir_sandbox_config_load_config_mount(GKeyFile *file,
@@ -2147,6 +4127,7 @@ static GVirSandboxConfigDisk *gvir_sandbox_config_load_config_disk(GKeyFile *fil
     gchar *source = NULL;
     gchar *typeStr = NULL;
     gchar *formatStr = NULL;
+    struct GVirSandboxConfigDiskTuning tuning = { 0 };
     gint type, format;
     GError *e = NULL;
     GEnumClass *enum_class = g_type_class_ref(GVIR_CONFIG_TYPE_DOMAIN_DISK_TYPE);
@@ -2193,14 +4174,30 @@ static GVirSandboxConfigDisk *gvir_sandbox_config_load_config_disk(GKeyFile *fil
         goto error;
     }
 
+    tuning.cache = g_key_file_get_string(file, key, "cache", NULL);
+    tuning.io = g_key_file_get_string(file, key, "io", NULL);
+    tuning.discard = g_key_file_get_string(file, key, "discard", NULL);
+    tuning.detectZeroes = g_key_file_get_string(file, key, "detect-zeroes", NULL);
+    tuning.iothread = g_key_file_get_boolean(file, key, "iothread", NULL);
+    tuning.queues = g_key_file_get_uint64(file, key, "queues", NULL);
+    if (!gvir_sandbox_config_check_disk_tuning(&tuning, error))
+        goto cleanup;
+
     config = GVIR_SANDBOX_CONFIG_DISK(g_object_new(GVIR_SANDBOX_TYPE_CONFIG_DISK,
                                                    "type", type,
                                                    "tag", tag,
                                                    "source", source,
                                                    "format", format,
+                                                   "cache", tuning.cache,
+                                                   "io", tuning.io,
+                                                   "discard", tuning.discard,
+                                                   "detect-zeroes", tuning.detectZeroes,
+                                                   "iothread", tuning.iothread,
+                                                   "queues", tuning.queues,
                                                    NULL));
 
  cleanup:
+    gvir_sandbox_config_clear_disk_tuning(&tuning);
     g_type_class_unref(enum_class);
     g_free(tag);
     g_free(source);
@@ -2216,6 +4213,58 @@ static GVirSandboxConfigDisk *gvir_sandbox_config_load_config_disk(GKeyFile *fil
 }
 
 
+static GVirSandboxConfigVolume *gvir_sandbox_config_load_config_volume(GKeyFile *file,
+                                                                       guint i,
+                                                                       GError **error)
+{
+    GVirSandboxConfigVolume *config = NULL;
+    gchar *key = NULL;
+    gchar *tag = NULL;
+    gchar *source = NULL;
+    gchar *target = NULL;
+    gboolean output;
+    guint64 size;
+    GError *e = NULL;
+
+    key = g_strdup_printf("volume.%u", i);
+    if ((tag = g_key_file_get_string(file, key, "tag", &e)) == NULL) {
+        if (e->code == G_KEY_FILE_ERROR_GROUP_NOT_FOUND) {
+            g_error_free(e);
+            goto cleanup;
+        }
+        g_error_free(e);
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    "%s", _("Missing volume tag in config file"));
+        goto cleanup;
+    }
+    if (!gvir_sandbox_config_check_volume_tag(tag, error))
+        goto cleanup;
+    if ((source = g_key_file_get_string(file, key, "source", NULL)) == NULL) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    "%s", _("Missing volume source in config file"));
+        goto cleanup;
+    }
+    target = g_key_file_get_string(file, key, "target", NULL);
+    output = g_key_file_get_boolean(file, key, "output", NULL);
+    size = g_key_file_get_uint64(file, key, "size", NULL);
+
+    config = GVIR_SANDBOX_CONFIG_VOLUME(g_object_new(GVIR_SANDBOX_TYPE_CONFIG_VOLUME,
+                                                     "tag", tag,
+                                                     "source", source,
+                                                     "target", target,
+                                                     "output", output,
+                                                     "size", size,
+                                                     NULL));
+
+ cleanup:
+    g_free(tag);
+    g_free(source);
+    g_free(target);
+    g_free(key);
+    return config;
+}
+
+
 static GVirSandboxConfigNetwork *gvir_sandbox_config_load_config_network(GKeyFile *file,
                                                                          guint i,
                                                                          GError **error)
@@ -2248,10 +4297,37 @@ static GVirSandboxConfigNetwork *gvir_sandbox_config_load_config_network(GKeyFil
     g_free(str1);
 
     str1 = g_key_file_get_string(file, key, "mac", NULL);
+    if (str1 && !gvir_sandbox_util_is_mac_address(str1)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Invalid MAC address %s in config file"), str1);
+        g_free(str1);
+        goto error;
+    }
     if (str1)
         gvir_sandbox_config_network_set_mac(config, str1);
     g_free(str1);
 
+    str1 = g_key_file_get_string(file, key, "backend", NULL);
+    if (str1 && !gvir_sandbox_util_is_network_backend(str1)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Unknown network backend %s in config file"), str1);
+        g_free(str1);
+        goto error;
+    }
+    if (str1)
+        gvir_sandbox_config_network_set_backend(config, str1);
+    g_free(str1);
+
+    /* Missing keys read as FALSE/0, which are the defaults */
+    gvir_sandbox_config_network_set_vhost(config,
+                                          g_key_file_get_boolean(file, key, "vhost", NULL));
+    gvir_sandbox_config_network_set_queues(config,
+                                           g_key_file_get_uint64(file, key, "queues", NULL));
+    gvir_sandbox_config_network_set_rx_queue_size(config,
+                                                  g_key_file_get_uint64(file, key, "rx-queue-size", NULL));
+    gvir_sandbox_config_network_set_tx_queue_size(config,
+                                                  g_key_file_get_uint64(file, key, "tx-queue-size", NULL));
+
     g_free(key);
     key = NULL;
 
@@ -2346,8 +4422,10 @@ static gboolean gvir_sandbox_config_load_config(GVirSandboxConfig *config,
 {
     GVirSandboxConfigPrivate *priv = config->priv;
     gchar *str;
+    gchar **keys;
     gboolean b;
     guint64 u;
+    gint level;
     gsize i;
     GError *e = NULL;
     gboolean ret = FALSE;
@@ -2454,6 +4532,15 @@ static gboolean gvir_sandbox_config_load_config(GVirSandboxConfig *config,
             priv->disks = g_list_append(priv->disks, disk);
     }
 
+    for (i = 0 ; i < 1024 ; i++) {
+        GVirSandboxConfigVolume *volume;
+        if (!(volume = gvir_sandbox_config_load_config_volume(file, i, error)) &&
+            *error)
+            goto cleanup;
+        if (volume)
+            priv->volumes = g_list_append(priv->volumes, volume);
+    }
+
 
     g_free(priv->secLabel);
     if ((str = g_key_file_get_string(file, "security", "label", NULL)) != NULL)
@@ -2485,6 +4572,233 @@ static gboolean gvir_sandbox_config_load_config(GVirSandboxConfig *config,
         priv->verbose = b;
     }
 
+    u = g_key_file_get_uint64(file, "telemetry", "interval", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->telemetryInterval = u;
+    }
+
+    b = g_key_file_get_boolean(file, "core", "readahead", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->readahead = b;
+    }
+
+    b = g_key_file_get_boolean(file, "core", "fastboot", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->fastboot = b;
+    }
+
+    u = g_key_file_get_uint64(file, "rng", "rate", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->rngRate = u;
+    }
+
+    u = g_key_file_get_uint64(file, "resources", "vcpus", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->vcpus = u;
+    }
+
+    u = g_key_file_get_uint64(file, "resources", "sockets", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->cpuSockets = u;
+    }
+
+    u = g_key_file_get_uint64(file, "resources", "cores", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->cpuCores = u;
+    }
+
+    u = g_key_file_get_uint64(file, "resources", "threads", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->cpuThreads = u;
+    }
+
+    u = g_key_file_get_uint64(file, "resources", "memory", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->memory = u;
+    }
+
+    u = g_key_file_get_uint64(file, "resources", "max-memory", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->maxMemory = u;
+    }
+
+    b = g_key_file_get_boolean(file, "resources", "balloon", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->balloon = b;
+    }
+
+    u = g_key_file_get_uint64(file, "memory-backing", "hugepages", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else if (!gvir_sandbox_config_is_hugepage_size(u)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Invalid huge page size %llu in config file"),
+                    (unsigned long long)u);
+        goto cleanup;
+    } else {
+        priv->hugepageSize = u;
+    }
+
+    b = g_key_file_get_boolean(file, "memory-backing", "memfd", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->memfd = b;
+    }
+
+    b = g_key_file_get_boolean(file, "memory-backing", "prealloc", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->prealloc = b;
+    }
+
+    b = g_key_file_get_boolean(file, "memory-backing", "locked", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->memLocked = b;
+    }
+
+    b = g_key_file_get_boolean(file, "memory-backing", "mergeable", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->mergeable = b;
+    }
+
+    if ((str = g_key_file_get_string(file, "disk-tuning", "cache", NULL)) != NULL) {
+        g_free(priv->diskTuning.cache);
+        priv->diskTuning.cache = str;
+    }
+    if ((str = g_key_file_get_string(file, "disk-tuning", "io", NULL)) != NULL) {
+        g_free(priv->diskTuning.io);
+        priv->diskTuning.io = str;
+    }
+    if ((str = g_key_file_get_string(file, "disk-tuning", "discard", NULL)) != NULL) {
+        g_free(priv->diskTuning.discard);
+        priv->diskTuning.discard = str;
+    }
+    if ((str = g_key_file_get_string(file, "disk-tuning", "detect-zeroes", NULL)) != NULL) {
+        g_free(priv->diskTuning.detectZeroes);
+        priv->diskTuning.detectZeroes = str;
+    }
+
+    b = g_key_file_get_boolean(file, "disk-tuning", "iothread", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->diskTuning.iothread = b;
+    }
+
+    u = g_key_file_get_uint64(file, "disk-tuning", "queues", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->diskTuning.queues = u;
+    }
+
+    if (!gvir_sandbox_config_check_disk_tuning(&priv->diskTuning, error))
+        goto cleanup;
+
+    u = g_key_file_get_uint64(file, "zram", "size", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        if (!gvir_sandbox_config_check_zram_size(u, error))
+            goto cleanup;
+        priv->zramSize = u;
+    }
+
+    if ((str = g_key_file_get_string(file, "zram", "algorithm", NULL)) != NULL) {
+        g_free(priv->zramAlgorithm);
+        priv->zramAlgorithm = str;
+    }
+
+    if ((str = g_key_file_get_string(file, "initrd", "compression", NULL)) != NULL) {
+        g_free(priv->initrdCompression);
+        priv->initrdCompression = str;
+    }
+
+    level = g_key_file_get_integer(file, "initrd", "level", &e);
+    if (e) {
+        g_error_free(e);
+        e = NULL;
+    } else {
+        priv->initrdCompressionLevel = level;
+    }
+
+    if (!gvir_sandbox_config_is_initrd_compression(priv->initrdCompression,
+                                                   priv->initrdCompressionLevel)) {
+        g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                    _("Invalid initrd compression %s level %d in config file"),
+                    priv->initrdCompression ? priv->initrdCompression : "gzip",
+                    priv->initrdCompressionLevel);
+        goto cleanup;
+    }
+
+    if ((str = g_key_file_get_string(file, "tuning", "profile", NULL)) != NULL) {
+        if (!gvir_sandbox_config_find_tuning_profile(str)) {
+            g_set_error(error, GVIR_SANDBOX_CONFIG_ERROR, 0,
+                        _("Unknown tuning profile '%s'"), str);
+            g_free(str);
+            goto cleanup;
+        }
+        g_free(priv->tuningProfile);
+        priv->tuningProfile = str;
+    }
+
+    if ((keys = g_key_file_get_keys(file, "tuning-params", NULL, NULL)) != NULL) {
+        for (i = 0 ; keys[i] ; i++) {
+            if (!gvir_sandbox_config_tuning_key_valid(keys[i]) ||
+                !(str = g_key_file_get_string(file, "tuning-params", keys[i], NULL)))
+                continue;
+            g_hash_table_insert(priv->tuningParams, g_strdup(keys[i]), str);
+        }
+        g_strfreev(keys);
+    }
+
     ret = TRUE;
  cleanup:
     return ret;
@@ -2530,6 +4844,44 @@ static void gvir_sandbox_config_save_config_disk(GVirSandboxConfigDisk *config,
     value = g_enum_get_value(klass, format);
     g_type_class_unref(klass);
     g_key_file_set_string(file, key, "format", value->value_nick);
+
+    if (gvir_sandbox_config_disk_get_cache(config))
+        g_key_file_set_string(file, key, "cache",
+                              gvir_sandbox_config_disk_get_cache(config));
+    if (gvir_sandbox_config_disk_get_io(config))
+        g_key_file_set_string(file, key, "io",
+                              gvir_sandbox_config_disk_get_io(config));
+    if (gvir_sandbox_config_disk_get_discard(config))
+        g_key_file_set_string(file, key, "discard",
+                              gvir_sandbox_config_disk_get_discard(config));
+    if (gvir_sandbox_config_disk_get_detect_zeroes(config))
+        g_key_file_set_string(file, key, "detect-zeroes",
+                              gvir_sandbox_config_disk_get_detect_zeroes(config));
+    if (gvir_sandbox_config_disk_get_iothread(config))
+        g_key_file_set_boolean(file, key, "iothread", TRUE);
+    if (gvir_sandbox_config_disk_get_queues(config))
+        g_key_file_set_uint64(file, key, "queues",
+                              gvir_sandbox_config_disk_get_queues(config));
+    g_free(key);
+}
+
+static void gvir_sandbox_config_save_config_volume(GVirSandboxConfigVolume *config,
+                                                   GKeyFile *file,
+                                                   guint i)
+{
+    gchar *key = g_strdup_printf("volume.%u", i);
+
+    g_key_file_set_string(file, key, "tag",
+                          gvir_sandbox_config_volume_get_tag(config));
+    g_key_file_set_string(file, key, "source",
+                          gvir_sandbox_config_volume_get_source(config));
+    if (gvir_sandbox_config_volume_get_target(config))
+        g_key_file_set_string(file, key, "target",
+                              gvir_sandbox_config_volume_get_target(config));
+    g_key_file_set_boolean(file, key, "output",
+                           gvir_sandbox_config_volume_get_output(config));
+    g_key_file_set_uint64(file, key, "size",
+                          gvir_sandbox_config_volume_get_size(config));
     g_free(key);
 }
 
@@ -2670,6 +5022,14 @@ static void gvir_sandbox_config_save_config_network(GVirSandboxConfigNetwork *co
         g_key_file_set_string(file, key, "source", gvir_sandbox_config_network_get_source(config));
     if (gvir_sandbox_config_network_get_mac(config))
         g_key_file_set_string(file, key, "mac", gvir_sandbox_config_network_get_mac(config));
+    if (gvir_sandbox_config_network_get_backend(config))
+        g_key_file_set_string(file, key, "backend", gvir_sandbox_config_network_get_backend(config));
+    g_key_file_set_boolean(file, key, "vhost", gvir_sandbox_config_network_get_vhost(config));
+    g_key_file_set_uint64(file, key, "queues", gvir_sandbox_config_network_get_queues(config));
+    g_key_file_set_uint64(file, key, "rx-queue-size",
+                          gvir_sandbox_config_network_get_rx_queue_size(config));
+    g_key_file_set_uint64(file, key, "tx-queue-size",
+                          gvir_sandbox_config_network_get_tx_queue_size(config));
     g_key_file_set_uint64(file, key, "addresses", j);
     g_key_file_set_uint64(file, key, "routes", k);
     g_free(key);
@@ -2733,6 +5093,16 @@ static void gvir_sandbox_config_save_config(GVirSandboxConfig *config,
         i++;
     }
 
+    i = 0;
+    tmp = priv->volumes;
+    while (tmp) {
+        gvir_sandbox_config_save_config_volume(tmp->data,
+                                               file,
+                                               i);
+        tmp = tmp->next;
+        i++;
+    }
+
     i = 0;
     tmp = priv->networks;
     while (tmp) {
@@ -2750,6 +5120,61 @@ static void gvir_sandbox_config_save_config(GVirSandboxConfig *config,
 
     g_key_file_set_boolean(file, "core", "debug", priv->debug);
     g_key_file_set_boolean(file, "core", "verbose", priv->verbose);
+    g_key_file_set_boolean(file, "core", "readahead", priv->readahead);
+    g_key_file_set_boolean(file, "core", "fastboot", priv->fastboot);
+
+    if (priv->telemetryInterval)
+        g_key_file_set_uint64(file, "telemetry", "interval", priv->telemetryInterval);
+
+    if (priv->rngRate)
+        g_key_file_set_uint64(file, "rng", "rate", priv->rngRate);
+
+    if (priv->vcpus)
+        g_key_file_set_uint64(file, "resources", "vcpus", priv->vcpus);
+    if (priv->cpuSockets) {
+        g_key_file_set_uint64(file, "resources", "sockets", priv->cpuSockets);
+        g_key_file_set_uint64(file, "resources", "cores", priv->cpuCores);
+        g_key_file_set_uint64(file, "resources", "threads", priv->cpuThreads);
+    }
+    g_key_file_set_uint64(file, "resources", "memory", priv->memory);
+    if (priv->maxMemory)
+        g_key_file_set_uint64(file, "resources", "max-memory", priv->maxMemory);
+    g_key_file_set_boolean(file, "resources", "balloon", priv->balloon);
+
+    if (priv->hugepageSize)
+        g_key_file_set_uint64(file, "memory-backing", "hugepages", priv->hugepageSize);
+    g_key_file_set_boolean(file, "memory-backing", "memfd", priv->memfd);
+    g_key_file_set_boolean(file, "memory-backing", "prealloc", priv->prealloc);
+    g_key_file_set_boolean(file, "memory-backing", "locked", priv->memLocked);
+    g_key_file_set_boolean(file, "memory-backing", "mergeable", priv->mergeable);
+
+    if (priv->diskTuning.cache)
+        g_key_file_set_string(file, "disk-tuning", "cache", priv->diskTuning.cache);
+    if (priv->diskTuning.io)
+        g_key_file_set_string(file, "disk-tuning", "io", priv->diskTuning.io);
+    if (priv->diskTuning.discard)
+        g_key_file_set_string(file, "disk-tuning", "discard", priv->diskTuning.discard);
+    if (priv->diskTuning.detectZeroes)
+        g_key_file_set_string(file, "disk-tuning", "detect-zeroes", priv->diskTuning.detectZeroes);
+    g_key_file_set_boolean(file, "disk-tuning", "iothread", priv->diskTuning.iothread);
+    if (priv->diskTuning.queues)
+        g_key_file_set_uint64(file, "disk-tuning", "queues", priv->diskTuning.queues);
+
+    if (priv->zramSize)
+        g_key_file_set_uint64(file, "zram", "size", priv->zramSize);
+    if (priv->zramAlgorithm)
+        g_key_file_set_string(file, "zram", "algorithm", priv->zramAlgorithm);
+
+    if (priv->initrdCompression)
+        g_key_file_set_string(file, "initrd", "compression", priv->initrdCompression);
+    if (priv->initrdCompressionLevel >= 0)
+        g_key_file_set_integer(file, "initrd", "level", priv->initrdCompressionLevel);
+
+    if (priv->tuningProfile)
+        g_key_file_set_string(file, "tuning", "profile", priv->tuningProfile);
+    g_hash_table_iter_init(&iter, priv->tuningParams);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+        g_key_file_set_string(file, "tuning-params", key, value);
 }
 
 
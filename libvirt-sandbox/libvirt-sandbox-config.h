@@ -146,6 +146,39 @@ gboolean gvir_sandbox_config_add_disk_opts(GVirSandboxConfig *config,
                                            GError **error);
 gboolean gvir_sandbox_config_has_disks(GVirSandboxConfig *config);
 
+void gvir_sandbox_config_set_disk_cache(GVirSandboxConfig *config,
+                                        const gchar *cache);
+const gchar *gvir_sandbox_config_get_disk_cache(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_disk_io(GVirSandboxConfig *config,
+                                     const gchar *io);
+const gchar *gvir_sandbox_config_get_disk_io(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_disk_discard(GVirSandboxConfig *config,
+                                          const gchar *discard);
+const gchar *gvir_sandbox_config_get_disk_discard(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_disk_detect_zeroes(GVirSandboxConfig *config,
+                                                const gchar *detectZeroes);
+const gchar *gvir_sandbox_config_get_disk_detect_zeroes(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_disk_iothread(GVirSandboxConfig *config,
+                                           gboolean iothread);
+gboolean gvir_sandbox_config_get_disk_iothread(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_disk_queues(GVirSandboxConfig *config,
+                                         guint queues);
+guint gvir_sandbox_config_get_disk_queues(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_disk_tuning_opts(GVirSandboxConfig *config,
+                                                  const gchar *optstr,
+                                                  GError **error);
+
+void gvir_sandbox_config_add_volume(GVirSandboxConfig *config,
+                                    GVirSandboxConfigVolume *vol);
+GList *gvir_sandbox_config_get_volumes(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_add_volume_strv(GVirSandboxConfig *config,
+                                             gchar **volumes,
+                                             GError **error);
+gboolean gvir_sandbox_config_add_volume_opts(GVirSandboxConfig *config,
+                                             const char *volume,
+                                             GError **error);
+gboolean gvir_sandbox_config_has_volumes(GVirSandboxConfig *config);
+
 void gvir_sandbox_config_add_mount(GVirSandboxConfig *config,
                                    GVirSandboxConfigMount *mnt);
 GList *gvir_sandbox_config_get_mounts(GVirSandboxConfig *config);
@@ -186,6 +219,99 @@ gboolean gvir_sandbox_config_get_debug(GVirSandboxConfig *config);
 void gvir_sandbox_config_set_verbose(GVirSandboxConfig *config, gboolean verbose);
 gboolean gvir_sandbox_config_get_verbose(GVirSandboxConfig *config);
 
+void gvir_sandbox_config_set_telemetry_interval(GVirSandboxConfig *config,
+                                                guint interval);
+guint gvir_sandbox_config_get_telemetry_interval(GVirSandboxConfig *config);
+
+void gvir_sandbox_config_set_readahead(GVirSandboxConfig *config,
+                                       gboolean readahead);
+gboolean gvir_sandbox_config_get_readahead(GVirSandboxConfig *config);
+
+void gvir_sandbox_config_set_fastboot(GVirSandboxConfig *config,
+                                      gboolean fastboot);
+gboolean gvir_sandbox_config_get_fastboot(GVirSandboxConfig *config);
+
+void gvir_sandbox_config_set_rng_rate(GVirSandboxConfig *config,
+                                      guint rate);
+guint gvir_sandbox_config_get_rng_rate(GVirSandboxConfig *config);
+
+void gvir_sandbox_config_set_vcpus(GVirSandboxConfig *config,
+                                   guint vcpus);
+guint gvir_sandbox_config_get_vcpus(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_cpu_topology(GVirSandboxConfig *config,
+                                          guint sockets,
+                                          guint cores,
+                                          guint threads);
+guint gvir_sandbox_config_get_cpu_sockets(GVirSandboxConfig *config);
+guint gvir_sandbox_config_get_cpu_cores(GVirSandboxConfig *config);
+guint gvir_sandbox_config_get_cpu_threads(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_vcpus_opts(GVirSandboxConfig *config,
+                                            const gchar *optstr,
+                                            GError **error);
+
+void gvir_sandbox_config_set_memory(GVirSandboxConfig *config,
+                                    guint64 memory);
+guint64 gvir_sandbox_config_get_memory(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_max_memory(GVirSandboxConfig *config,
+                                        guint64 memory);
+guint64 gvir_sandbox_config_get_max_memory(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_balloon(GVirSandboxConfig *config,
+                                     gboolean balloon);
+gboolean gvir_sandbox_config_get_balloon(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_memory_opts(GVirSandboxConfig *config,
+                                             const gchar *optstr,
+                                             GError **error);
+
+void gvir_sandbox_config_set_hugepages(GVirSandboxConfig *config,
+                                       guint64 size);
+guint64 gvir_sandbox_config_get_hugepages(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_memfd(GVirSandboxConfig *config,
+                                   gboolean memfd);
+gboolean gvir_sandbox_config_get_memfd(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_prealloc(GVirSandboxConfig *config,
+                                      gboolean prealloc);
+gboolean gvir_sandbox_config_get_prealloc(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_memory_locked(GVirSandboxConfig *config,
+                                           gboolean locked);
+gboolean gvir_sandbox_config_get_memory_locked(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_mergeable_memory(GVirSandboxConfig *config,
+                                              gboolean mergeable);
+gboolean gvir_sandbox_config_get_mergeable_memory(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_memory_backing_opts(GVirSandboxConfig *config,
+                                                     const gchar *optstr,
+                                                     GError **error);
+
+void gvir_sandbox_config_set_tuning_profile(GVirSandboxConfig *config,
+                                            const gchar *profile);
+const gchar *gvir_sandbox_config_get_tuning_profile(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_tuning_param(GVirSandboxConfig *config,
+                                          const gchar *key,
+                                          const gchar *value);
+GHashTable *gvir_sandbox_config_get_tuning_params(GVirSandboxConfig *config);
+GHashTable *gvir_sandbox_config_get_tuning(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_tuning_opts(GVirSandboxConfig *config,
+                                             const gchar *optstr,
+                                             GError **error);
+
+void gvir_sandbox_config_set_zram_size(GVirSandboxConfig *config,
+                                       guint64 size);
+guint64 gvir_sandbox_config_get_zram_size(GVirSandboxConfig *config);
+void gvir_sandbox_config_set_zram_algorithm(GVirSandboxConfig *config,
+                                            const gchar *algorithm);
+const gchar *gvir_sandbox_config_get_zram_algorithm(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_zram_opts(GVirSandboxConfig *config,
+                                           const gchar *optstr,
+                                           GError **error);
+
+void gvir_sandbox_config_set_initrd_compression(GVirSandboxConfig *config,
+                                                const gchar *codec,
+                                                gint level);
+const gchar *gvir_sandbox_config_get_initrd_compression(GVirSandboxConfig *config);
+gint gvir_sandbox_config_get_initrd_compression_level(GVirSandboxConfig *config);
+gboolean gvir_sandbox_config_set_initrd_compression_opts(GVirSandboxConfig *config,
+                                                         const gchar *optstr,
+                                                         GError **error);
+
 gchar **gvir_sandbox_config_get_command(GVirSandboxConfig *config);
 
 G_END_DECLS
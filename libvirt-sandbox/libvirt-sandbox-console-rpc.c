@@ -26,6 +26,7 @@
 #include <termios.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/ioctl.h>
 
 #include <glib/gi18n.h>
 #include <libvirt-glib/libvirt-glib-error.h>
@@ -57,6 +58,17 @@ static gboolean gvir_sandbox_console_rpc_attach(GVirSandboxConsole *console,
                                                 GError **error);
 static gboolean gvir_sandbox_console_rpc_detach(GVirSandboxConsole *console,
                                                 GError **error);
+static gboolean gvir_sandbox_console_rpc_send_signal(GVirSandboxConsole *console,
+                                                     gint signum,
+                                                     GError **error);
+static gboolean gvir_sandbox_console_rpc_set_window_size(GVirSandboxConsole *console,
+                                                         guint rows,
+                                                         guint cols,
+                                                         GError **error);
+static gboolean gvir_sandbox_console_rpc_set_priority(GVirSandboxConsole *console,
+                                                      gint nice,
+                                                      guint weight,
+                                                      GError **error);
 
 typedef enum {
     /*
@@ -127,6 +139,9 @@ struct _GVirSandboxConsoleRpcPrivate
     GVirSandboxRPCPacket *rx;
     GVirSandboxRPCPacket *tx;
 
+    /* Encoded control messages, sent ahead of any further stdin */
+    GQueue *control;
+
     /* Decoded RPC message forwarded to stdout */
     gchar *localToStdout;
     gsize localToStdoutLength; /* No more than GVIR_SANDBOX_CONSOLE_MAX_QUEUED_DATA*/
@@ -139,6 +154,9 @@ struct _GVirSandboxConsoleRpcPrivate
 
     GVirSandboxConsoleRpcState state;
 
+    /* Resource usage reported along with the exit status */
+    GVirSandboxRusage *rusage;
+
     /* True if stdin has shown us EOF */
     gboolean localEOF;
 
@@ -253,6 +271,45 @@ gvir_sandbox_console_rpc_build_stdin(GVirSandboxConsoleRpc *console,
 }
 
 
+static GVirSandboxRPCPacket *
+gvir_sandbox_console_rpc_build_control(GVirSandboxConsoleRpc *console,
+                                       GVirSandboxProtocolProc proc,
+                                       xdrproc_t filter,
+                                       void *msg,
+                                       GError **error)
+{
+    GVirSandboxConsoleRpcPrivate *priv = console->priv;
+    GVirSandboxRPCPacket *pkt = gvir_sandbox_rpcpacket_new(FALSE);
+
+    g_debug("Build control %d", proc);
+    pkt->header.proc = proc;
+    pkt->header.status = GVIR_SANDBOX_PROTOCOL_STATUS_OK;
+    pkt->header.type = GVIR_SANDBOX_PROTOCOL_TYPE_MESSAGE;
+    pkt->header.serial = priv->serial++;
+
+    if (!gvir_sandbox_rpcpacket_encode_header(pkt, error))
+        goto error;
+    if (!gvir_sandbox_rpcpacket_encode_payload_msg(pkt, filter, msg, error))
+        goto error;
+
+    return pkt;
+
+ error:
+    gvir_sandbox_rpcpacket_free(pkt);
+    return NULL;
+}
+
+
+static void gvir_sandbox_console_rpc_clear_control(GVirSandboxConsoleRpc *console)
+{
+    GVirSandboxConsoleRpcPrivate *priv = console->priv;
+    GVirSandboxRPCPacket *pkt;
+
+    while ((pkt = g_queue_pop_head(priv->control)))
+        gvir_sandbox_rpcpacket_free(pkt);
+}
+
+
 static void gvir_sandbox_console_rpc_finalize(GObject *object)
 {
     GVirSandboxConsoleRpc *console = GVIR_SANDBOX_CONSOLE_RPC(object);
@@ -265,10 +322,15 @@ static void gvir_sandbox_console_rpc_finalize(GObject *object)
 
     gvir_sandbox_rpcpacket_free(priv->tx);
     gvir_sandbox_rpcpacket_free(priv->rx);
+    gvir_sandbox_console_rpc_clear_control(console);
+    g_queue_free(priv->control);
 
     g_free(priv->localToStdout);
     g_free(priv->localToStderr);
 
+    if (priv->rusage)
+        g_object_unref(priv->rusage);
+
     G_OBJECT_CLASS(gvir_sandbox_console_rpc_parent_class)->finalize(object);
 }
 
@@ -281,6 +343,9 @@ static void gvir_sandbox_console_rpc_class_init(GVirSandboxConsoleRpcClass *klas
     object_class->finalize = gvir_sandbox_console_rpc_finalize;
     console_class->attach = gvir_sandbox_console_rpc_attach;
     console_class->detach = gvir_sandbox_console_rpc_detach;
+    console_class->send_signal = gvir_sandbox_console_rpc_send_signal;
+    console_class->set_window_size = gvir_sandbox_console_rpc_set_window_size;
+    console_class->set_priority = gvir_sandbox_console_rpc_set_priority;
 
     g_signal_new("exited",
                  G_OBJECT_CLASS_TYPE(object_class),
@@ -291,12 +356,22 @@ static void gvir_sandbox_console_rpc_class_init(GVirSandboxConsoleRpcClass *klas
                  G_TYPE_NONE,
                  1,
                  G_TYPE_INT);
+    g_signal_new("telemetry",
+                 G_OBJECT_CLASS_TYPE(object_class),
+                 G_SIGNAL_RUN_FIRST,
+                 0,
+                 NULL, NULL,
+                 g_cclosure_marshal_VOID__OBJECT,
+                 G_TYPE_NONE,
+                 1,
+                 GVIR_SANDBOX_TYPE_TELEMETRY);
 }
 
 
 static void gvir_sandbox_console_rpc_init(GVirSandboxConsoleRpc *console)
 {
     console->priv = GVIR_SANDBOX_CONSOLE_RPC_GET_PRIVATE(console);
+    console->priv->control = g_queue_new();
 }
 
 
@@ -322,6 +397,24 @@ GVirSandboxConsoleRpc *gvir_sandbox_console_rpc_new(GVirConnection *connection,
 }
 
 
+/**
+ * gvir_sandbox_console_rpc_get_rusage:
+ * @console: (transfer none): the sandbox console
+ *
+ * Retrieves the resource usage of the sandboxed command, which
+ * is only known once the "exited" signal has been emitted.
+ *
+ * Returns: (transfer full)(allow-none): the resource usage or NULL
+ */
+GVirSandboxRusage *gvir_sandbox_console_rpc_get_rusage(GVirSandboxConsoleRpc *console)
+{
+    GVirSandboxConsoleRpcPrivate *priv = console->priv;
+    if (priv->rusage)
+        g_object_ref(priv->rusage);
+    return priv->rusage;
+}
+
+
 static gboolean gvir_sandbox_console_rpc_start_term(GVirSandboxConsoleRpc *console,
                                                     GUnixInputStream *localStdin,
                                                     GError **error)
@@ -443,11 +536,12 @@ static gboolean do_console_rpc_set_state(GVirSandboxConsoleRpc *console,
 
     case GVIR_SANDBOX_CONSOLE_RPC_STATE_STOPPING:
         /* Container has exited, so no point trying to send any
-         * stdin data that might be queued */
+         * stdin data or control messages that might be queued */
         if (priv->tx) {
             gvir_sandbox_rpcpacket_free(priv->tx);
             priv->tx = NULL;
         }
+        gvir_sandbox_console_rpc_clear_control(console);
         break;
 
     case GVIR_SANDBOX_CONSOLE_RPC_STATE_FINISHED:
@@ -482,6 +576,10 @@ static void do_console_rpc_update_events(GVirSandboxConsoleRpc *console)
 
     switch (priv->state) {
     case GVIR_SANDBOX_CONSOLE_RPC_STATE_RUNNING:
+        /* Control messages overtake any stdin not yet read */
+        if (!priv->tx && !g_queue_is_empty(priv->control))
+            priv->tx = g_queue_pop_head(priv->control);
+
         /* If nothing is waiting to be sent to guest, we can read
          * some more of stdin */
         if (!priv->tx && !priv->localEOF)
@@ -616,6 +714,8 @@ static gboolean do_console_rpc_dispatch_proc(GVirSandboxConsoleRpc *console,
 {
     GVirSandboxConsoleRpcPrivate *priv = console->priv;
     struct GVirSandboxProtocolMessageExit msgexit;
+    struct GVirSandboxProtocolMessageTelemetry msgtelemetry;
+    GVirSandboxTelemetry *telemetry;
     gsize want;
 
     if (!gvir_sandbox_rpcpacket_decode_header(pkt, error))
@@ -672,6 +772,27 @@ static gboolean do_console_rpc_dispatch_proc(GVirSandboxConsoleRpc *console,
                                                         error)))
             return FALSE;
 
+        if (priv->rusage)
+            g_object_unref(priv->rusage);
+        priv->rusage = GVIR_SANDBOX_RUSAGE(g_object_new(GVIR_SANDBOX_TYPE_RUSAGE,
+                                                        "user-time", (guint64)msgexit.utime,
+                                                        "system-time", (guint64)msgexit.stime,
+                                                        "max-rss", (guint64)msgexit.maxrss,
+                                                        "minor-faults", (guint64)msgexit.minflt,
+                                                        "major-faults", (guint64)msgexit.majflt,
+                                                        "input-blocks", (guint64)msgexit.inblock,
+                                                        "output-blocks", (guint64)msgexit.oublock,
+                                                        "voluntary-switches", (guint64)msgexit.nvcsw,
+                                                        "involuntary-switches", (guint64)msgexit.nivcsw,
+                                                        "has-cgroup", (gboolean)msgexit.cgroup,
+                                                        "cgroup-usage-time", (guint64)msgexit.cgroupUsage,
+                                                        "cgroup-user-time", (guint64)msgexit.cgroupUser,
+                                                        "cgroup-system-time", (guint64)msgexit.cgroupSystem,
+                                                        "cgroup-memory-peak", (guint64)msgexit.cgroupMemPeak,
+                                                        "cgroup-read-bytes", (guint64)msgexit.cgroupReadBytes,
+                                                        "cgroup-write-bytes", (guint64)msgexit.cgroupWriteBytes,
+                                                        NULL));
+
         g_signal_emit_by_name(console, "exited", msgexit.status);
 
         if (priv->localToStdoutLength == 0 &&
@@ -688,8 +809,38 @@ static gboolean do_console_rpc_dispatch_proc(GVirSandboxConsoleRpc *console,
         }
         break;
 
+    case GVIR_SANDBOX_PROTOCOL_PROC_TELEMETRY:
+        memset(&msgtelemetry, 0, sizeof(msgtelemetry));
+        if (!(gvir_sandbox_rpcpacket_decode_payload_msg(pkt,
+                                                        (xdrproc_t)xdr_GVirSandboxProtocolMessageTelemetry,
+                                                        (void*)&msgtelemetry,
+                                                        error)))
+            return FALSE;
+
+        telemetry = GVIR_SANDBOX_TELEMETRY(g_object_new(GVIR_SANDBOX_TYPE_TELEMETRY,
+                                                        "has-pressure", (gboolean)msgtelemetry.pressure,
+                                                        "cpu-some-pressure", msgtelemetry.cpuSome / 100.0,
+                                                        "memory-some-pressure", msgtelemetry.memorySome / 100.0,
+                                                        "memory-full-pressure", msgtelemetry.memoryFull / 100.0,
+                                                        "io-some-pressure", msgtelemetry.ioSome / 100.0,
+                                                        "io-full-pressure", msgtelemetry.ioFull / 100.0,
+                                                        "memory-total", (guint64)msgtelemetry.memTotal,
+                                                        "memory-available", (guint64)msgtelemetry.memAvailable,
+                                                        "cpu-user", (guint64)msgtelemetry.cpuUser,
+                                                        "cpu-system", (guint64)msgtelemetry.cpuSystem,
+                                                        "cpu-idle", (guint64)msgtelemetry.cpuIdle,
+                                                        "cpu-iowait", (guint64)msgtelemetry.cpuIOWait,
+                                                        "cpu-steal", (guint64)msgtelemetry.cpuSteal,
+                                                        NULL));
+        g_signal_emit_by_name(console, "telemetry", telemetry);
+        g_object_unref(telemetry);
+        break;
+
     case GVIR_SANDBOX_PROTOCOL_PROC_QUIT:
     case GVIR_SANDBOX_PROTOCOL_PROC_STDIN:
+    case GVIR_SANDBOX_PROTOCOL_PROC_SIGNAL:
+    case GVIR_SANDBOX_PROTOCOL_PROC_WINSIZE:
+    case GVIR_SANDBOX_PROTOCOL_PROC_PRIORITY:
     default:
         g_set_error(error, GVIR_SANDBOX_CONSOLE_RPC_ERROR, 0,
                     _("Unexpected rpc proc %u"),
@@ -1135,6 +1286,19 @@ static gboolean gvir_sandbox_console_rpc_attach(GVirSandboxConsole *console,
                                   GVIR_SANDBOX_CONSOLE_RPC_STATE_WAITING,
                                   error))
         goto cleanup;
+
+    /* The sandbox pty starts out at the kernel default of 0x0,
+     * so tell it about our own size as soon as we're running */
+    if (localStdin) {
+        struct winsize ws;
+        int fd = g_unix_input_stream_get_fd(localStdin);
+
+        if (isatty(fd) && ioctl(fd, TIOCGWINSZ, &ws) == 0 &&
+            !gvir_sandbox_console_rpc_set_window_size(console,
+                                                      ws.ws_row, ws.ws_col,
+                                                      error))
+            goto cleanup;
+    }
     do_console_rpc_update_events(GVIR_SANDBOX_CONSOLE_RPC(console));
 
     ret = TRUE;
@@ -1199,6 +1363,7 @@ static gboolean gvir_sandbox_console_rpc_detach(GVirSandboxConsole *console,
     gvir_sandbox_rpcpacket_free(priv->tx);
     gvir_sandbox_rpcpacket_free(priv->rx);
     priv->tx = priv->rx = NULL;
+    gvir_sandbox_console_rpc_clear_control(GVIR_SANDBOX_CONSOLE_RPC(console));
 
     priv->state = GVIR_SANDBOX_CONSOLE_RPC_STATE_INACTIVE;
 
@@ -1208,6 +1373,97 @@ static gboolean gvir_sandbox_console_rpc_detach(GVirSandboxConsole *console,
     return ret;
 }
 
+
+static gboolean do_console_rpc_queue_control(GVirSandboxConsoleRpc *console,
+                                             GVirSandboxProtocolProc proc,
+                                             xdrproc_t filter,
+                                             void *msg,
+                                             GError **error)
+{
+    GVirSandboxConsoleRpcPrivate *priv = console->priv;
+    GVirSandboxRPCPacket *pkt;
+
+    switch (priv->state) {
+    case GVIR_SANDBOX_CONSOLE_RPC_STATE_WAITING:
+    case GVIR_SANDBOX_CONSOLE_RPC_STATE_SYNCING:
+    case GVIR_SANDBOX_CONSOLE_RPC_STATE_RUNNING:
+        break;
+
+    case GVIR_SANDBOX_CONSOLE_RPC_STATE_STOPPING:
+    case GVIR_SANDBOX_CONSOLE_RPC_STATE_FINISHED:
+    case GVIR_SANDBOX_CONSOLE_RPC_STATE_INACTIVE:
+    default:
+        g_set_error(error, GVIR_SANDBOX_CONSOLE_RPC_ERROR, 0, "%s",
+                    _("Console is not attached to a running sandbox"));
+        return FALSE;
+    }
+
+    if (!(pkt = gvir_sandbox_console_rpc_build_control(console, proc,
+                                                       filter, msg,
+                                                       error)))
+        return FALSE;
+
+    g_queue_push_tail(priv->control, pkt);
+    do_console_rpc_update_events(console);
+
+    return TRUE;
+}
+
+
+static gboolean gvir_sandbox_console_rpc_send_signal(GVirSandboxConsole *console,
+                                                     gint signum,
+                                                     GError **error)
+{
+    struct GVirSandboxProtocolMessageSignal msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.signum = signum;
+
+    return do_console_rpc_queue_control(GVIR_SANDBOX_CONSOLE_RPC(console),
+                                        GVIR_SANDBOX_PROTOCOL_PROC_SIGNAL,
+                                        (xdrproc_t)xdr_GVirSandboxProtocolMessageSignal,
+                                        (void*)&msg,
+                                        error);
+}
+
+
+static gboolean gvir_sandbox_console_rpc_set_window_size(GVirSandboxConsole *console,
+                                                         guint rows,
+                                                         guint cols,
+                                                         GError **error)
+{
+    struct GVirSandboxProtocolMessageWinsize msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.rows = rows;
+    msg.cols = cols;
+
+    return do_console_rpc_queue_control(GVIR_SANDBOX_CONSOLE_RPC(console),
+                                        GVIR_SANDBOX_PROTOCOL_PROC_WINSIZE,
+                                        (xdrproc_t)xdr_GVirSandboxProtocolMessageWinsize,
+                                        (void*)&msg,
+                                        error);
+}
+
+
+static gboolean gvir_sandbox_console_rpc_set_priority(GVirSandboxConsole *console,
+                                                      gint nice,
+                                                      guint weight,
+                                                      GError **error)
+{
+    struct GVirSandboxProtocolMessagePriority msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.nice = nice;
+    msg.weight = weight;
+
+    return do_console_rpc_queue_control(GVIR_SANDBOX_CONSOLE_RPC(console),
+                                        GVIR_SANDBOX_PROTOCOL_PROC_PRIORITY,
+                                        (xdrproc_t)xdr_GVirSandboxProtocolMessagePriority,
+                                        (void*)&msg,
+                                        error);
+}
+
 /*
  * Local variables:
  *  c-indent-level: 4
@@ -65,6 +65,8 @@ GVirSandboxConsoleRpc *gvir_sandbox_console_rpc_new(GVirConnection *connection,
                                                     GVirDomain *domain,
                                                     const char *devname);
 
+GVirSandboxRusage *gvir_sandbox_console_rpc_get_rusage(GVirSandboxConsoleRpc *console);
+
 G_END_DECLS
 
 #endif /* __LIBVIRT_SANDBOX_CONSOLE_H__ */
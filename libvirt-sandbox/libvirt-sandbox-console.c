@@ -338,6 +338,103 @@ gboolean gvir_sandbox_console_isolate(GVirSandboxConsole *console,
 }
 
 
+/**
+ * gvir_sandbox_console_send_signal:
+ * @console: (transfer none): the sandbox console
+ * @signum: the signal number
+ * @error: (out): the error location
+ *
+ * Deliver the signal @signum to the application running in
+ * the sandbox. The request is sent out of band, so it is not
+ * held up behind any stdin data that is still queued.
+ *
+ * Returns: TRUE if the signal was queued for sending
+ */
+gboolean gvir_sandbox_console_send_signal(GVirSandboxConsole *console,
+                                          gint signum,
+                                          GError **error)
+{
+    GVirSandboxConsoleClass *klass = GVIR_SANDBOX_CONSOLE_GET_CLASS(console);
+
+    if (!klass->send_signal) {
+        g_set_error(error, GVIR_SANDBOX_CONSOLE_ERROR, 0, "%s",
+                    _("Console does not support sending signals"));
+        return FALSE;
+    }
+
+    return klass->send_signal(console, signum, error);
+}
+
+
+/**
+ * gvir_sandbox_console_set_window_size:
+ * @console: (transfer none): the sandbox console
+ * @rows: the number of terminal rows
+ * @cols: the number of terminal columns
+ * @error: (out): the error location
+ *
+ * Update the size of the sandbox application's terminal,
+ * typically after the local terminal has been resized.
+ *
+ * Returns: TRUE if the new size was queued for sending
+ */
+gboolean gvir_sandbox_console_set_window_size(GVirSandboxConsole *console,
+                                              guint rows,
+                                              guint cols,
+                                              GError **error)
+{
+    GVirSandboxConsoleClass *klass = GVIR_SANDBOX_CONSOLE_GET_CLASS(console);
+
+    if (!klass->set_window_size) {
+        g_set_error(error, GVIR_SANDBOX_CONSOLE_ERROR, 0, "%s",
+                    _("Console does not support changing the window size"));
+        return FALSE;
+    }
+
+    return klass->set_window_size(console, rows, cols, error);
+}
+
+
+/**
+ * gvir_sandbox_console_set_priority:
+ * @console: (transfer none): the sandbox console
+ * @nice: the nice value, from -20 to 19
+ * @weight: the cgroup CPU weight, from 1 to 10000, or 0 to leave it unchanged
+ * @error: (out): the error location
+ *
+ * Change the scheduling priority of every process belonging
+ * to the sandbox application.
+ *
+ * Returns: TRUE if the new priority was queued for sending
+ */
+gboolean gvir_sandbox_console_set_priority(GVirSandboxConsole *console,
+                                           gint nice,
+                                           guint weight,
+                                           GError **error)
+{
+    GVirSandboxConsoleClass *klass = GVIR_SANDBOX_CONSOLE_GET_CLASS(console);
+
+    if (nice < -20 || nice > 19) {
+        g_set_error(error, GVIR_SANDBOX_CONSOLE_ERROR, 0,
+                    _("Nice value %d is outside the range -20 to 19"), nice);
+        return FALSE;
+    }
+    if (weight > 10000) {
+        g_set_error(error, GVIR_SANDBOX_CONSOLE_ERROR, 0,
+                    _("CPU weight %u is outside the range 1 to 10000"), weight);
+        return FALSE;
+    }
+
+    if (!klass->set_priority) {
+        g_set_error(error, GVIR_SANDBOX_CONSOLE_ERROR, 0, "%s",
+                    _("Console does not support changing the priority"));
+        return FALSE;
+    }
+
+    return klass->set_priority(console, nice, weight, error);
+}
+
+
 void gvir_sandbox_console_set_escape(GVirSandboxConsole *console,
                                      gchar escape)
 {
@@ -70,8 +70,19 @@ struct _GVirSandboxConsoleClass
                        GError **error);
     gboolean (*detach)(GVirSandboxConsole *console,
                        GError **error);
-
-    gpointer padding[LIBVIRT_SANDBOX_CLASS_PADDING];
+    gboolean (*send_signal)(GVirSandboxConsole *console,
+                            gint signum,
+                            GError **error);
+    gboolean (*set_window_size)(GVirSandboxConsole *console,
+                                guint rows,
+                                guint cols,
+                                GError **error);
+    gboolean (*set_priority)(GVirSandboxConsole *console,
+                             gint nice,
+                             guint weight,
+                             GError **error);
+
+    gpointer padding[LIBVIRT_SANDBOX_CLASS_PADDING - 3];
 };
 
 
@@ -96,6 +107,18 @@ gboolean gvir_sandbox_console_detach(GVirSandboxConsole *console,
 gboolean gvir_sandbox_console_isolate(GVirSandboxConsole *console,
                                       GError **error);
 
+gboolean gvir_sandbox_console_send_signal(GVirSandboxConsole *console,
+                                          gint signum,
+                                          GError **error);
+gboolean gvir_sandbox_console_set_window_size(GVirSandboxConsole *console,
+                                              guint rows,
+                                              guint cols,
+                                              GError **error);
+gboolean gvir_sandbox_console_set_priority(GVirSandboxConsole *console,
+                                           gint nice,
+                                           guint weight,
+                                           GError **error);
+
 void gvir_sandbox_console_set_escape(GVirSandboxConsole *console,
                                      gchar escape);
 gchar gvir_sandbox_console_get_escape(GVirSandboxConsole *console);
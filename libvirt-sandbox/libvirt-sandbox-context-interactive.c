@@ -143,6 +143,27 @@ static gboolean gvir_sandbox_context_clean_post_start(GVirSandboxContext *ctxt,
 }
 
 
+/* Whether readahead traces are all that is left in @statedir */
+static gboolean gvir_sandbox_context_only_traces(const gchar *statedir)
+{
+    GDir *dir = g_dir_open(statedir, 0, NULL);
+    const gchar *name;
+    gboolean ret = TRUE;
+
+    if (!dir)
+        return FALSE;
+
+    while ((name = g_dir_read_name(dir))) {
+        if (!g_str_equal(name, "readahead")) {
+            ret = FALSE;
+            break;
+        }
+    }
+    g_dir_close(dir);
+    return ret;
+}
+
+
 static gboolean gvir_sandbox_context_clean_post_stop(GVirSandboxContext *ctxt,
                                                      GVirSandboxBuilder *builder,
                                                      GError **error)
@@ -181,9 +202,17 @@ static gboolean gvir_sandbox_context_clean_post_stop(GVirSandboxContext *ctxt,
         errno != ENOENT)
         ret = FALSE;
 
+    /* Readahead traces are kept around for the next launch */
     if (rmdir(statedir) < 0 &&
-        errno != ENOENT)
-        ret = FALSE;
+        errno != ENOENT) {
+        int err = errno;
+        if (err != ENOTEMPTY ||
+            !gvir_sandbox_context_only_traces(statedir)) {
+            g_warning("Unable to remove sandbox state directory %s: %s",
+                      statedir, g_strerror(err));
+            ret = FALSE;
+        }
+    }
 
     g_object_unref(config);
     g_free(configfile);
@@ -374,6 +403,19 @@ GVirSandboxContextInteractive *gvir_sandbox_context_interactive_new(GVirConnecti
 }
 
 
+static void gvir_sandbox_context_interactive_app_exited(GVirSandboxConsoleRpc *console,
+                                                        int status G_GNUC_UNUSED,
+                                                        gpointer opaque)
+{
+    GVirSandboxContext *ctxt = GVIR_SANDBOX_CONTEXT(opaque);
+    GVirSandboxRusage *rusage = gvir_sandbox_console_rpc_get_rusage(console);
+
+    g_object_set(ctxt, "rusage", rusage, NULL);
+    if (rusage)
+        g_object_unref(rusage);
+}
+
+
 /**
  * gvir_sandbox_context_interactive_get_app_console:
  * @ctxt: (transfer none): the sandbox context
@@ -407,6 +449,9 @@ GVirSandboxConsole *gvir_sandbox_context_interactive_get_app_console(GVirSandbox
     console = GVIR_SANDBOX_CONSOLE(gvir_sandbox_console_rpc_new(conn,
                                                                 domain,
                                                                 devname));
+    g_signal_connect_object(console, "exited",
+                            G_CALLBACK(gvir_sandbox_context_interactive_app_exited),
+                            ctxt, 0);
     g_object_unref(domain);
     return console;
 }
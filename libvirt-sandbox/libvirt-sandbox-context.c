@@ -26,6 +26,7 @@
 #include <errno.h>
 
 #include <glib/gi18n.h>
+#include <libvirt/libvirt.h>
 
 #include "libvirt-sandbox/libvirt-sandbox.h"
 
@@ -50,6 +51,7 @@ struct _GVirSandboxContextPrivate
     GVirConnection *connection;
     GVirDomain *domain;
     GVirSandboxConfig *config;
+    GVirSandboxRusage *rusage;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE(GVirSandboxContext, gvir_sandbox_context, G_TYPE_OBJECT);
@@ -61,6 +63,7 @@ enum {
     PROP_CONFIG,
     PROP_DOMAIN,
     PROP_CONNECTION,
+    PROP_RUSAGE,
 };
 
 enum {
@@ -104,6 +107,10 @@ static void gvir_sandbox_context_get_property(GObject *object,
         g_value_set_object(value, priv->connection);
         break;
 
+    case PROP_RUSAGE:
+        g_value_set_object(value, priv->rusage);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -137,6 +144,12 @@ static void gvir_sandbox_context_set_property(GObject *object,
         priv->connection = g_value_dup_object(value);
         break;
 
+    case PROP_RUSAGE:
+        if (priv->rusage)
+            g_object_unref(priv->rusage);
+        priv->rusage = g_value_dup_object(value);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
     }
@@ -155,6 +168,8 @@ static void gvir_sandbox_context_finalize(GObject *object)
         g_object_unref(priv->connection);
     if (priv->config)
         g_object_unref(priv->config);
+    if (priv->rusage)
+        g_object_unref(priv->rusage);
 
     G_OBJECT_CLASS(gvir_sandbox_context_parent_class)->finalize(object);
 }
@@ -208,6 +223,17 @@ static void gvir_sandbox_context_class_init(GVirSandboxContextClass *klass)
                                                         G_PARAM_STATIC_NAME |
                                                         G_PARAM_STATIC_NICK |
                                                         G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_RUSAGE,
+                                    g_param_spec_object("rusage",
+                                                        "Rusage",
+                                                        "The command resource usage",
+                                                        GVIR_SANDBOX_TYPE_RUSAGE,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
 }
 
 
@@ -272,6 +298,67 @@ GVirConnection *gvir_sandbox_context_get_connection(GVirSandboxContext *ctxt)
 }
 
 
+/**
+ * gvir_sandbox_context_get_rusage:
+ * @ctxt: (transfer none): the sandbox context
+ *
+ * Retrieves the resource usage of the sandboxed command. This
+ * is only available once the command has exited.
+ *
+ * Returns: (transfer full)(allow-none): the resource usage or NULL
+ */
+GVirSandboxRusage *gvir_sandbox_context_get_rusage(GVirSandboxContext *ctxt)
+{
+    GVirSandboxContextPrivate *priv = ctxt->priv;
+    if (priv->rusage)
+        g_object_ref(priv->rusage);
+    return priv->rusage;
+}
+
+
+/**
+ * gvir_sandbox_context_set_balloon_target:
+ * @ctxt: (transfer none): the sandbox context
+ * @memory: the memory size in bytes
+ * @error: (out): the error location
+ *
+ * Changes the amount of memory of the running sandbox to @memory,
+ * which may be up to its maximum memory size. Machine based
+ * sandboxes need a memory balloon for this, while for container
+ * based sandboxes it changes their memory limit.
+ *
+ * Returns: TRUE if the memory was changed, FALSE on error
+ */
+gboolean gvir_sandbox_context_set_balloon_target(GVirSandboxContext *ctxt,
+                                                 guint64 memory,
+                                                 GError **error)
+{
+    GVirSandboxContextPrivate *priv = ctxt->priv;
+    virDomainPtr handle = NULL;
+    gboolean ret = FALSE;
+
+    if (!priv->domain) {
+        g_set_error(error, GVIR_SANDBOX_CONTEXT_ERROR, 0,
+                    _("Domain is not currently running"));
+        return FALSE;
+    }
+
+    /* libvirt-gobject has no API for changing the memory size */
+    g_object_get(priv->domain, "handle", &handle, NULL);
+    if (virDomainSetMemoryFlags(handle, memory / 1024,
+                                VIR_DOMAIN_AFFECT_LIVE) < 0) {
+        gvir_set_error(error, GVIR_SANDBOX_CONTEXT_ERROR, 0,
+                       _("Unable to set balloon target"));
+        goto cleanup;
+    }
+
+    ret = TRUE;
+ cleanup:
+    virDomainFree(handle);
+    return ret;
+}
+
+
 static gboolean gvir_sandbox_context_start_default(GVirSandboxContext *ctxt, GError **error)
 {
     GVirSandboxContextPrivate *priv = ctxt->priv;
@@ -282,6 +369,11 @@ static gboolean gvir_sandbox_context_start_default(GVirSandboxContext *ctxt, GEr
         return FALSE;
     }
 
+    if (priv->rusage) {
+        g_object_unref(priv->rusage);
+        priv->rusage = NULL;
+    }
+
     return TRUE;
 }
 
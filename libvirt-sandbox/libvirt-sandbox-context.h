@@ -79,6 +79,12 @@ GVirDomain *gvir_sandbox_context_get_domain(GVirSandboxContext *ctxt,
                                             GError **error);
 GVirConnection *gvir_sandbox_context_get_connection(GVirSandboxContext *ctxt);
 
+GVirSandboxRusage *gvir_sandbox_context_get_rusage(GVirSandboxContext *ctxt);
+
+gboolean gvir_sandbox_context_set_balloon_target(GVirSandboxContext *ctxt,
+                                                 guint64 memory,
+                                                 GError **error);
+
 GVirSandboxConsole *gvir_sandbox_context_get_log_console(GVirSandboxContext *ctxt,
                                                          GError **error);
 GVirSandboxConsole *gvir_sandbox_context_get_shell_console(GVirSandboxContext *ctxt,
@@ -46,6 +46,15 @@
 #include <grp.h>
 #include <mntent.h>
 #include <sys/reboot.h>
+#include <sys/fanotify.h>
+#include <dirent.h>
+#include <sys/swap.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#include <signal.h>
 
 #include "libvirt-sandbox-rpcpacket.h"
 
@@ -53,6 +62,19 @@ static gboolean debug = FALSE;
 static gboolean verbose = FALSE;
 static int sigwrite;
 
+#define SANDBOX_CGROUP_ROOT "/sys/fs/cgroup"
+#define SANDBOX_CGROUP_APP SANDBOX_CGROUP_ROOT "/sandbox-app"
+
+static gboolean have_app_cgroup = FALSE;
+
+#define READAHEAD_DIR SANDBOXCONFIGDIR "/readahead"
+#define READAHEAD_TRACE READAHEAD_DIR "/trace"
+#define READAHEAD_WINDOW (10 * G_USEC_PER_SEC)
+#define READAHEAD_MAX_FILES 4096
+
+static GThread *readahead_thread = NULL;
+static gint readahead_quit = 0;
+
 #define ATTR_UNUSED __attribute__((__unused__))
 static void sync_data(void);
 static void umount_fs(void);
@@ -275,6 +297,71 @@ static gboolean add_route(const gchar *devname,
 }
 
 
+/* The equivalent of 'ethtool -L DEV combined N': virtio-net only
+ * uses the extra queue pairs that QEMU gave it once the guest
+ * asks for them. Failures just leave the device single queue. */
+static void setup_network_channels(GVirSandboxConfig *config,
+                                   GVirSandboxConfigNetwork *netconfig,
+                                   const gchar *devname)
+{
+    struct ethtool_drvinfo drvinfo = { .cmd = ETHTOOL_GDRVINFO };
+    struct ethtool_channels channels = { .cmd = ETHTOOL_GCHANNELS };
+    struct ifreq ifr;
+    guint queues;
+    int fd;
+
+    if (!gvir_sandbox_config_network_get_vhost(netconfig) ||
+        !gvir_sandbox_config_network_get_source(netconfig))
+        return;
+
+    queues = gvir_sandbox_config_network_get_queues(netconfig);
+    if (!queues)
+        queues = gvir_sandbox_config_get_vcpus(config);
+    if (queues <= 1)
+        return;
+
+    if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+        return;
+
+    memset(&ifr, 0, sizeof(ifr));
+    g_strlcpy(ifr.ifr_name, devname, sizeof(ifr.ifr_name));
+
+    /* Containers get a veth device, whose channels mean nothing here */
+    ifr.ifr_data = (void *)&drvinfo;
+    if (ioctl(fd, SIOCETHTOOL, &ifr) < 0 ||
+        !g_str_equal(drvinfo.driver, "virtio_net"))
+        goto cleanup;
+
+    ifr.ifr_data = (void *)&channels;
+    if (ioctl(fd, SIOCETHTOOL, &ifr) < 0)
+        goto error;
+
+    if (queues > channels.max_combined)
+        queues = channels.max_combined;
+    if (channels.combined_count == queues)
+        goto cleanup;
+
+    if (debug)
+        fprintf(stderr, "libvirt-sandbox-init-common: setting %s to %u queue pairs\n",
+                devname, queues);
+
+    channels.cmd = ETHTOOL_SCHANNELS;
+    channels.combined_count = queues;
+    if (ioctl(fd, SIOCETHTOOL, &ifr) < 0)
+        goto error;
+
+ cleanup:
+    close(fd);
+    return;
+
+ error:
+    if (debug)
+        fprintf(stderr, "libvirt-sandbox-init-common: cannot set %s channels: %s\n",
+                devname, strerror(errno));
+    close(fd);
+}
+
+
 static gboolean setup_network_device(GVirSandboxConfigNetwork *config,
                                      const gchar *devname,
                                      GError **error)
@@ -333,6 +420,7 @@ static gboolean setup_network(GVirSandboxConfig *config, GError **error)
 
         g_free(devname);
         devname = g_strdup_printf("eth%d", i++);
+        setup_network_channels(config, netconfig, devname);
         if (!setup_network_device(netconfig, devname, error))
             goto cleanup;
 
@@ -364,6 +452,423 @@ static gboolean setup_custom_env(GVirSandboxConfig *config, GError **error)
     return ret;
 }
 
+/*
+ * Try to give the application its own cgroup v2 group, so that
+ * we can report its CPU, memory & I/O accounting on exit. This
+ * is entirely best-effort, since the guest kernel may not have
+ * cgroup v2, or individual controllers, enabled.
+ */
+static void setup_app_cgroup(void)
+{
+    struct stat sb;
+    int fd;
+
+    if (stat(SANDBOX_CGROUP_ROOT "/cgroup.controllers", &sb) < 0) {
+        if (mount("cgroup2", SANDBOX_CGROUP_ROOT, "cgroup2", 0, NULL) < 0) {
+            if (debug)
+                fprintf(stderr, "libvirt-sandbox-init-common: cannot mount cgroup2: %s\n",
+                        strerror(errno));
+            return;
+        }
+    }
+
+    if (mkdir(SANDBOX_CGROUP_APP, 0755) < 0 &&
+        errno != EEXIST) {
+        if (debug)
+            fprintf(stderr, "libvirt-sandbox-init-common: cannot create %s: %s\n",
+                    SANDBOX_CGROUP_APP, strerror(errno));
+        return;
+    }
+
+    /* Enable whichever controllers exist, one at a time, since
+     * the kernel rejects the whole write if any one is missing */
+    if ((fd = open(SANDBOX_CGROUP_ROOT "/cgroup.subtree_control", O_WRONLY)) >= 0) {
+        const char *controllers[] = { "+cpu", "+memory", "+io" };
+        size_t i;
+        for (i = 0 ; i < G_N_ELEMENTS(controllers) ; i++) {
+            if (write(fd, controllers[i], strlen(controllers[i])) < 0 && debug)
+                fprintf(stderr, "libvirt-sandbox-init-common: cannot enable %s controller: %s\n",
+                        controllers[i] + 1, strerror(errno));
+        }
+        close(fd);
+    }
+
+    have_app_cgroup = TRUE;
+}
+
+static void join_app_cgroup(void)
+{
+    int fd;
+
+    if (!have_app_cgroup)
+        return;
+
+    if ((fd = open(SANDBOX_CGROUP_APP "/cgroup.procs", O_WRONLY)) < 0)
+        return;
+    if (write(fd, "0", 1) < 0 && debug)
+        fprintf(stderr, "libvirt-sandbox-init-common: cannot join app cgroup: %s\n",
+                strerror(errno));
+    close(fd);
+}
+
+static gboolean read_cgroup_keyed(const char *file,
+                                  const char *key,
+                                  uint64_t *value)
+{
+    gchar *data = NULL;
+    gchar **lines = NULL;
+    gboolean ret = FALSE;
+    size_t i, keylen = strlen(key);
+
+    if (!g_file_get_contents(file, &data, NULL, NULL))
+        return FALSE;
+
+    lines = g_strsplit(data, "\n", 0);
+    for (i = 0 ; lines[i] ; i++) {
+        if (g_str_has_prefix(lines[i], key) &&
+            lines[i][keylen] == ' ') {
+            *value = g_ascii_strtoull(lines[i] + keylen + 1, NULL, 10);
+            ret = TRUE;
+            break;
+        }
+    }
+
+    g_strfreev(lines);
+    g_free(data);
+    return ret;
+}
+
+static void collect_app_cgroup(GVirSandboxProtocolMessageExit *msg)
+{
+    gchar *data = NULL;
+    gchar **lines = NULL;
+    size_t i;
+
+    if (!have_app_cgroup)
+        return;
+
+    if (!read_cgroup_keyed(SANDBOX_CGROUP_APP "/cpu.stat", "usage_usec",
+                           &msg->cgroupUsage))
+        return;
+    read_cgroup_keyed(SANDBOX_CGROUP_APP "/cpu.stat", "user_usec",
+                      &msg->cgroupUser);
+    read_cgroup_keyed(SANDBOX_CGROUP_APP "/cpu.stat", "system_usec",
+                      &msg->cgroupSystem);
+
+    if (g_file_get_contents(SANDBOX_CGROUP_APP "/memory.peak", &data, NULL, NULL))
+        msg->cgroupMemPeak = g_ascii_strtoull(data, NULL, 10);
+    g_free(data);
+    data = NULL;
+
+    /* Each line is "MAJ:MIN rbytes=N wbytes=N rios=N ..." */
+    if (g_file_get_contents(SANDBOX_CGROUP_APP "/io.stat", &data, NULL, NULL)) {
+        lines = g_strsplit_set(data, " \n", 0);
+        for (i = 0 ; lines[i] ; i++) {
+            if (g_str_has_prefix(lines[i], "rbytes="))
+                msg->cgroupReadBytes += g_ascii_strtoull(lines[i] + 7, NULL, 10);
+            else if (g_str_has_prefix(lines[i], "wbytes="))
+                msg->cgroupWriteBytes += g_ascii_strtoull(lines[i] + 7, NULL, 10);
+        }
+        g_strfreev(lines);
+    }
+    g_free(data);
+
+    msg->cgroup = TRUE;
+}
+
+static gboolean write_sysfs(const char *path, const char *value)
+{
+    gboolean ret = TRUE;
+    int fd;
+
+    if (debug)
+        fprintf(stderr, "libvirt-sandbox-init-common: setting %s=%s\n",
+                path, value);
+
+    if ((fd = open(path, O_WRONLY)) < 0 ||
+        write(fd, value, strlen(value)) < 0) {
+        if (debug)
+            fprintf(stderr, "libvirt-sandbox-init-common: cannot write %s: %s\n",
+                    path, strerror(errno));
+        ret = FALSE;
+    }
+    if (fd >= 0)
+        close(fd);
+    return ret;
+}
+
+#define ZRAM_DEVICE "/dev/zram0"
+#define ZRAM_SYSFS "/sys/block/zram0"
+#define ZRAM_SWAP_PRIORITY 100
+
+/* Writes a version 1 swap header, as mkswap would, so that we
+ * don't depend on mkswap existing in the sandbox root */
+static gboolean write_swap_header(const char *path, guint64 size)
+{
+    long pagesize = sysconf(_SC_PAGESIZE);
+    guint64 pages = size / pagesize;
+    guint32 *info;
+    gchar *page;
+    gboolean ret = FALSE;
+    size_t i;
+    int fd;
+
+    /* The header page itself plus at least one usable page */
+    if (pages < 2)
+        return FALSE;
+    /* Any excess beyond what the header can describe goes unused */
+    if (pages - 1 > G_MAXUINT32)
+        pages = (guint64)G_MAXUINT32 + 1;
+
+    if ((fd = open(path, O_WRONLY | O_CLOEXEC)) < 0)
+        return FALSE;
+
+    page = g_new0(gchar, pagesize);
+    info = (guint32 *)(page + 1024);
+    info[0] = 1;                          /* version */
+    info[1] = pages - 1;                  /* last_page */
+    info[2] = 0;                          /* nr_badpages */
+    for (i = 0 ; i < 4 ; i++)             /* uuid */
+        info[3 + i] = g_random_int();
+    memcpy(page + pagesize - 10, "SWAPSPACE2", 10);
+
+    if (pwrite(fd, page, pagesize, 0) == pagesize)
+        ret = TRUE;
+
+    g_free(page);
+    close(fd);
+    return ret;
+}
+
+/*
+ * Set up a compressed RAM swap device. Swap is a bonus, not a
+ * requirement, so any failure just leaves the sandbox without.
+ */
+static void setup_zram(GVirSandboxConfig *config)
+{
+    guint64 size = gvir_sandbox_config_get_zram_size(config);
+    const gchar *algorithm = gvir_sandbox_config_get_zram_algorithm(config);
+    gchar *disksize;
+    int flags;
+
+    if (!size)
+        return;
+
+    if (access(ZRAM_SYSFS, F_OK) < 0) {
+        if (debug)
+            fprintf(stderr, "libvirt-sandbox-init-common: no zram device available\n");
+        return;
+    }
+
+    if (algorithm &&
+        !write_sysfs(ZRAM_SYSFS "/comp_algorithm", algorithm))
+        g_printerr(_("Unable to use zram compression %s, using the default\n"),
+                   algorithm);
+
+    disksize = g_strdup_printf("%" G_GUINT64_FORMAT, size);
+    if (!write_sysfs(ZRAM_SYSFS "/disksize", disksize)) {
+        g_free(disksize);
+        return;
+    }
+    g_free(disksize);
+
+    if (!write_swap_header(ZRAM_DEVICE, size)) {
+        g_printerr(_("Unable to format %s as swap\n"), ZRAM_DEVICE);
+        return;
+    }
+
+    /* Discard lets zram free the memory of swapped-in pages */
+    flags = SWAP_FLAG_DISCARD | SWAP_FLAG_PREFER |
+        ((ZRAM_SWAP_PRIORITY << SWAP_FLAG_PRIO_SHIFT) & SWAP_FLAG_PRIO_MASK);
+    if (swapon(ZRAM_DEVICE, flags) < 0)
+        g_printerr(_("Unable to enable swap on %s: %s\n"),
+                   ZRAM_DEVICE, strerror(errno));
+}
+
+/*
+ * Apply the tuning profile and overrides. This is best-effort,
+ * since the kernel may lack some knobs, and container sandboxes
+ * may not be permitted to change them.
+ */
+static void setup_tuning(GVirSandboxConfig *config)
+{
+    GHashTable *params = gvir_sandbox_config_get_tuning(config);
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_iter_init(&iter, params);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        const gchar *name = key;
+        gchar *path;
+
+        if (name[0] == '/' || strstr(name, "..") || strstr(name, "//") ||
+            ((g_str_has_prefix(name, "block.") ||
+              g_str_has_prefix(name, "thp.")) && strchr(name, '/'))) {
+            g_printerr(_("Ignoring invalid tuning parameter %s\n"), name);
+            continue;
+        }
+
+        if (g_str_has_prefix(name, "block.")) {
+            DIR *dh;
+            struct dirent *de;
+
+            if (!(dh = opendir("/sys/block")))
+                continue;
+            while ((de = readdir(dh))) {
+                if (!g_str_has_prefix(de->d_name, "vd"))
+                    continue;
+                path = g_strdup_printf("/sys/block/%s/queue/%s",
+                                       de->d_name, name + strlen("block."));
+                write_sysfs(path, value);
+                g_free(path);
+            }
+            closedir(dh);
+        } else if (g_str_has_prefix(name, "thp.")) {
+            path = g_strdup_printf("/sys/kernel/mm/transparent_hugepage/%s",
+                                   name + strlen("thp."));
+            write_sysfs(path, value);
+            g_free(path);
+        } else {
+            gchar *tmp;
+
+            /* Like sysctl(8), if the first separator is a dot then
+             * dots and slashes swap, so "net.ipv4.conf.eth0/100.rp_filter"
+             * and "net/ipv4/conf/eth0.100/rp_filter" are equivalent */
+            path = g_strdup_printf("/proc/sys/%s", name);
+            tmp = path + strlen("/proc/sys/");
+            if (tmp[strcspn(tmp, "./")] == '.') {
+                for ( ; *tmp ; tmp++) {
+                    if (*tmp == '.')
+                        *tmp = '/';
+                    else if (*tmp == '/')
+                        *tmp = '.';
+                }
+            }
+            write_sysfs(path, value);
+            g_free(path);
+        }
+    }
+
+    g_hash_table_unref(params);
+}
+
+/*
+ * Record the regular files opened on the root filesystem during
+ * the startup window, in first-open order. The trace is written
+ * to a directory shared with the host, which reads the listed
+ * files ahead into its page cache, in parallel, when the same
+ * command is next launched.
+ */
+static gpointer readahead_record(gpointer opaque)
+{
+    int fd = GPOINTER_TO_INT(opaque);
+    gint64 deadline = g_get_monotonic_time() + READAHEAD_WINDOW;
+    GHashTable *seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GString *trace = g_string_new("");
+    GError *error = NULL;
+    char buf[8192] __attribute__((aligned(__alignof__(struct fanotify_event_metadata))));
+
+    while (!g_atomic_int_get(&readahead_quit) &&
+           g_get_monotonic_time() < deadline &&
+           g_hash_table_size(seen) < READAHEAD_MAX_FILES) {
+        struct pollfd fds = { .fd = fd, .events = POLLIN };
+        struct fanotify_event_metadata *ev;
+        ssize_t len;
+
+        if (poll(&fds, 1, 100) <= 0)
+            continue;
+
+        if ((len = read(fd, buf, sizeof(buf))) < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            break;
+        }
+
+        for (ev = (struct fanotify_event_metadata *)buf ;
+             FAN_EVENT_OK(ev, len) ;
+             ev = FAN_EVENT_NEXT(ev, len)) {
+            gchar proc[64];
+            char path[PATH_MAX];
+            struct stat sb;
+            ssize_t n;
+
+            if (ev->fd < 0)
+                continue;
+
+            g_snprintf(proc, sizeof(proc), "/proc/self/fd/%d", ev->fd);
+            if (fstat(ev->fd, &sb) == 0 &&
+                S_ISREG(sb.st_mode) && sb.st_size > 0 &&
+                (n = readlink(proc, path, sizeof(path) - 1)) > 0) {
+                path[n] = '\0';
+                if (path[0] == '/' &&
+                    !strchr(path, '\n') &&
+                    !g_str_has_suffix(path, " (deleted)") &&
+                    !g_hash_table_contains(seen, path)) {
+                    g_hash_table_add(seen, g_strdup(path));
+                    g_string_append_printf(trace, "%s\n", path);
+                }
+            }
+            close(ev->fd);
+        }
+    }
+    close(fd);
+
+    if (debug)
+        fprintf(stderr, "libvirt-sandbox-init-common: recorded %u files for readahead\n",
+                g_hash_table_size(seen));
+
+    if (!g_file_set_contents(READAHEAD_TRACE, trace->str, trace->len, &error)) {
+        if (debug)
+            fprintf(stderr, "libvirt-sandbox-init-common: cannot save readahead trace: %s\n",
+                    error->message);
+        g_error_free(error);
+    }
+
+    g_string_free(trace, TRUE);
+    g_hash_table_unref(seen);
+    return NULL;
+}
+
+static void readahead_start(GVirSandboxConfig *config)
+{
+    int fd;
+
+    /* The trace directory is only shared by machine sandboxes */
+    if (!gvir_sandbox_config_get_readahead(config) ||
+        access(READAHEAD_DIR, W_OK) < 0)
+        return;
+
+    if ((fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC,
+                            O_RDONLY | O_LARGEFILE | O_CLOEXEC)) < 0) {
+        if (debug)
+            fprintf(stderr, "libvirt-sandbox-init-common: cannot initialize fanotify: %s\n",
+                    strerror(errno));
+        return;
+    }
+
+    if (fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_MOUNT,
+                      FAN_OPEN, AT_FDCWD, "/") < 0) {
+        if (debug)
+            fprintf(stderr, "libvirt-sandbox-init-common: cannot watch root filesystem: %s\n",
+                    strerror(errno));
+        close(fd);
+        return;
+    }
+
+    readahead_thread = g_thread_new("readahead", readahead_record,
+                                    GINT_TO_POINTER(fd));
+}
+
+static void readahead_finish(void)
+{
+    if (!readahead_thread)
+        return;
+
+    g_atomic_int_set(&readahead_quit, 1);
+    g_thread_join(readahead_thread);
+    readahead_thread = NULL;
+}
+
 static int change_user(const gchar *user,
                        uid_t uid,
                        gid_t gid,
@@ -477,6 +982,8 @@ static gboolean run_command(GVirSandboxConfig *config,
     }
 
     if (pid == 0) {
+        join_app_cgroup();
+
         if (change_user(gvir_sandbox_config_get_username(config),
                         gvir_sandbox_config_get_userid(config),
                         gvir_sandbox_config_get_groupid(config),
@@ -611,7 +1118,10 @@ static GVirSandboxRPCPacket *gvir_sandbox_encode_stderr(const gchar *data,
 }
 
 
+#define TIMEVAL_TO_USEC(tv) (((guint64)(tv).tv_sec * 1000000ull) + (tv).tv_usec)
+
 static GVirSandboxRPCPacket *gvir_sandbox_encode_exit(int status,
+                                                      const struct rusage *usage,
                                                       unsigned int serial,
                                                       GError **error)
 {
@@ -621,6 +1131,19 @@ static GVirSandboxRPCPacket *gvir_sandbox_encode_exit(int status,
     memset(&msg, 0, sizeof(msg));
     msg.status = status;
 
+    msg.utime = TIMEVAL_TO_USEC(usage->ru_utime);
+    msg.stime = TIMEVAL_TO_USEC(usage->ru_stime);
+    msg.maxrss = usage->ru_maxrss;
+    msg.minflt = usage->ru_minflt;
+    msg.majflt = usage->ru_majflt;
+    msg.inblock = usage->ru_inblock;
+    msg.oublock = usage->ru_oublock;
+    msg.nvcsw = usage->ru_nvcsw;
+    msg.nivcsw = usage->ru_nivcsw;
+
+    /* Must be read before umount_fs() takes away the cgroup mount */
+    collect_app_cgroup(&msg);
+
     pkt->header.proc = GVIR_SANDBOX_PROTOCOL_PROC_EXIT;
     pkt->header.status = GVIR_SANDBOX_PROTOCOL_STATUS_OK;
     pkt->header.type = GVIR_SANDBOX_PROTOCOL_TYPE_MESSAGE;
@@ -649,6 +1172,102 @@ static GVirSandboxRPCPacket *gvir_sandbox_encode_exit(int status,
     return NULL;
 }
 
+static gssize read_proc_file(const char *path, char *buf, size_t len)
+{
+    int fd;
+    gssize got;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return -1;
+    got = read(fd, buf, len - 1);
+    close(fd);
+    if (got < 0)
+        return -1;
+    buf[got] = '\0';
+    return got;
+}
+
+static gboolean read_pressure(const char *path,
+                              unsigned int *some,
+                              unsigned int *full)
+{
+    char buf[256];
+    char *tmp;
+    double avg10;
+
+    if (read_proc_file(path, buf, sizeof(buf)) < 0)
+        return FALSE;
+
+    if (some && (tmp = strstr(buf, "some avg10=")) &&
+        sscanf(tmp, "some avg10=%lf", &avg10) == 1)
+        *some = avg10 * 100;
+    if (full && (tmp = strstr(buf, "full avg10=")) &&
+        sscanf(tmp, "full avg10=%lf", &avg10) == 1)
+        *full = avg10 * 100;
+
+    return TRUE;
+}
+
+static GVirSandboxRPCPacket *gvir_sandbox_encode_telemetry(unsigned int serial,
+                                                           GError **error)
+{
+    GVirSandboxRPCPacket *pkt;
+    GVirSandboxProtocolMessageTelemetry msg;
+    char buf[4096];
+    char *tmp;
+    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+
+    memset(&msg, 0, sizeof(msg));
+
+    msg.pressure = read_pressure("/proc/pressure/cpu", &msg.cpuSome, NULL);
+    if (msg.pressure) {
+        read_pressure("/proc/pressure/memory", &msg.memorySome, &msg.memoryFull);
+        read_pressure("/proc/pressure/io", &msg.ioSome, &msg.ioFull);
+    }
+
+    if (read_proc_file("/proc/meminfo", buf, sizeof(buf)) > 0) {
+        unsigned long long kb;
+        if ((tmp = strstr(buf, "MemTotal:")) &&
+            sscanf(tmp, "MemTotal: %llu", &kb) == 1)
+            msg.memTotal = kb;
+        if ((tmp = strstr(buf, "MemAvailable:")) &&
+            sscanf(tmp, "MemAvailable: %llu", &kb) == 1)
+            msg.memAvailable = kb;
+    }
+
+    /* Only the first, aggregate, line is needed */
+    if (read_proc_file("/proc/stat", buf, sizeof(buf)) > 0 &&
+        sscanf(buf, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+               &user, &nice, &system, &idle,
+               &iowait, &irq, &softirq, &steal) == 8) {
+        msg.cpuUser = user + nice;
+        msg.cpuSystem = system + irq + softirq;
+        msg.cpuIdle = idle;
+        msg.cpuIOWait = iowait;
+        msg.cpuSteal = steal;
+    }
+
+    pkt = gvir_sandbox_rpcpacket_new(FALSE);
+    pkt->header.proc = GVIR_SANDBOX_PROTOCOL_PROC_TELEMETRY;
+    pkt->header.status = GVIR_SANDBOX_PROTOCOL_STATUS_OK;
+    pkt->header.type = GVIR_SANDBOX_PROTOCOL_TYPE_MESSAGE;
+    pkt->header.serial = serial;
+
+    if (!gvir_sandbox_rpcpacket_encode_header(pkt, error))
+        goto error;
+    if (!gvir_sandbox_rpcpacket_encode_payload_msg(pkt,
+                                                   (xdrproc_t)xdr_GVirSandboxProtocolMessageTelemetry,
+                                                   (void*)&msg,
+                                                   error))
+        goto error;
+
+    return pkt;
+
+ error:
+    gvir_sandbox_rpcpacket_free(pkt);
+    return NULL;
+}
+
 /* Copied & adapted from libguestfs daemon/sync.c under LGPLv2+ */
 static void sync_data(void)
 {
@@ -835,6 +1454,185 @@ static gssize write_data(int fd, const char *buf, size_t len)
     return got;
 }
 
+/*
+ * Signals go to the foreground process group of the app's
+ * terminal, as if generated by the line discipline, otherwise
+ * just to the app itself.
+ */
+static void control_signal(pid_t child, int appout, int signum)
+{
+    pid_t target = child;
+
+    if (child <= 0)
+        return;
+
+    if (appout != -1 && isatty(appout)) {
+        pid_t pgrp = tcgetpgrp(appout);
+        if (pgrp > 0)
+            target = -pgrp;
+    }
+
+    if (debug)
+        fprintf(stderr, "Sending signal %d to %d\n", signum, target);
+    if (kill(target, signum) < 0 && debug)
+        fprintf(stderr, "Cannot send signal %d: %s\n",
+                signum, strerror(errno));
+}
+
+/* The kernel raises SIGWINCH for the foreground group itself */
+static void control_winsize(int appout, unsigned int rows, unsigned int cols)
+{
+    struct winsize ws;
+
+    if (appout == -1 || !isatty(appout))
+        return;
+
+    memset(&ws, 0, sizeof(ws));
+    ws.ws_row = rows;
+    ws.ws_col = cols;
+
+    if (ioctl(appout, TIOCSWINSZ, &ws) < 0 && debug)
+        fprintf(stderr, "Cannot set window size %ux%u: %s\n",
+                cols, rows, strerror(errno));
+}
+
+static void control_priority(pid_t child, int nice, unsigned int weight)
+{
+    gchar *data = NULL;
+    gchar **pids = NULL;
+    gsize i;
+
+    if (child <= 0)
+        return;
+
+    /* Everything the app forked lives in its cgroup, so renice
+     * the lot, falling back to just the app without cgroups */
+    if (have_app_cgroup &&
+        g_file_get_contents(SANDBOX_CGROUP_APP "/cgroup.procs", &data, NULL, NULL)) {
+        pids = g_strsplit(data, "\n", 0);
+        for (i = 0 ; pids[i] ; i++) {
+            if (!pids[i][0])
+                continue;
+            if (setpriority(PRIO_PROCESS, atoi(pids[i]), nice) < 0 && debug)
+                fprintf(stderr, "Cannot renice %s: %s\n",
+                        pids[i], strerror(errno));
+        }
+    } else if (setpriority(PRIO_PROCESS, child, nice) < 0 && debug) {
+        fprintf(stderr, "Cannot renice %d: %s\n",
+                child, strerror(errno));
+    }
+
+    if (have_app_cgroup && weight) {
+        gchar *value = g_strdup_printf("%u", weight);
+        write_sysfs(SANDBOX_CGROUP_APP "/cpu.weight", value);
+        g_free(value);
+    }
+
+    g_strfreev(pids);
+    g_free(data);
+}
+
+static gboolean process_control(GVirSandboxRPCPacket *pkt,
+                                pid_t child,
+                                int appout)
+{
+    struct GVirSandboxProtocolMessageSignal msgsignal;
+    struct GVirSandboxProtocolMessageWinsize msgwinsize;
+    struct GVirSandboxProtocolMessagePriority msgpriority;
+
+    switch (pkt->header.proc) {
+    case GVIR_SANDBOX_PROTOCOL_PROC_SIGNAL:
+        memset(&msgsignal, 0, sizeof(msgsignal));
+        if (!gvir_sandbox_rpcpacket_decode_payload_msg(pkt,
+                                                       (xdrproc_t)xdr_GVirSandboxProtocolMessageSignal,
+                                                       (void*)&msgsignal,
+                                                       NULL))
+            return FALSE;
+        control_signal(child, appout, msgsignal.signum);
+        break;
+
+    case GVIR_SANDBOX_PROTOCOL_PROC_WINSIZE:
+        memset(&msgwinsize, 0, sizeof(msgwinsize));
+        if (!gvir_sandbox_rpcpacket_decode_payload_msg(pkt,
+                                                       (xdrproc_t)xdr_GVirSandboxProtocolMessageWinsize,
+                                                       (void*)&msgwinsize,
+                                                       NULL))
+            return FALSE;
+        control_winsize(appout, msgwinsize.rows, msgwinsize.cols);
+        break;
+
+    case GVIR_SANDBOX_PROTOCOL_PROC_PRIORITY:
+        memset(&msgpriority, 0, sizeof(msgpriority));
+        if (!gvir_sandbox_rpcpacket_decode_payload_msg(pkt,
+                                                       (xdrproc_t)xdr_GVirSandboxProtocolMessagePriority,
+                                                       (void*)&msgpriority,
+                                                       NULL))
+            return FALSE;
+        control_priority(child, msgpriority.nice, msgpriority.weight);
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Start writing a STDIN packet's data to the app, or close
+ * the app's stdin if it is the empty EOF packet.
+ */
+static void take_host_stdin(GVirSandboxRPCPacket *pkt,
+                            gchar **data,
+                            gsize *length,
+                            gsize *offset,
+                            int *appin)
+{
+    *offset = 0;
+    *length = pkt->bufferLength - pkt->bufferOffset;
+    if (*length) {
+        *data = g_new0(gchar, *length);
+        memcpy(*data, pkt->buffer + pkt->bufferOffset, *length);
+        if (debug)
+            fprintf(stderr, "Processed stdin %zu\n", *length);
+    } else {
+        close(*appin);
+        *appin = -1;
+    }
+}
+
+/*
+ * The app can't take any more stdin, so throw away what is queued
+ * for it, and start reading from the host again if that was held
+ * back by a parked STDIN packet.
+ */
+static void drop_host_stdin(gchar **data,
+                            gsize *length,
+                            gsize *offset,
+                            GVirSandboxRPCPacket **pending,
+                            GVirSandboxRPCPacket **rx,
+                            int *appin,
+                            int appout,
+                            gboolean *closed)
+{
+    g_free(*data);
+    *data = NULL;
+    *length = *offset = 0;
+
+    if (*pending) {
+        gvir_sandbox_rpcpacket_free(*pending);
+        *pending = NULL;
+        *rx = gvir_sandbox_rpcpacket_new(TRUE);
+    }
+
+    /* A pseudo-tty master is still needed for the app's output */
+    if (*appin != appout) {
+        close(*appin);
+        *appin = -1;
+    }
+    *closed = TRUE;
+}
+
 typedef enum {
     GVIR_SANDBOX_CONSOLE_STATE_WAITING,
     GVIR_SANDBOX_CONSOLE_STATE_SYNCING,
@@ -852,9 +1650,12 @@ static gboolean eventloop(GVirSandboxConfig *config,
     gboolean appErrEOF = FALSE;
     gboolean appQuit = FALSE;
     int exitstatus = 0;
+    struct rusage exitusage;
     gchar *hostToStdin = NULL;
     gsize hostToStdinLength = 0;
     gsize hostToStdinOffset = 0;
+    GVirSandboxRPCPacket *hostStdinPending = NULL;
+    gboolean appInClosed = FALSE;
     unsigned int serial = 0;
     pid_t child = 0;
     int appin = -1;
@@ -862,6 +1663,10 @@ static gboolean eventloop(GVirSandboxConfig *config,
     int apperr = -1;
     gboolean ret = FALSE;
     GVirSandboxConsoleState state = GVIR_SANDBOX_CONSOLE_STATE_WAITING;
+    gint64 telemetryInterval = gvir_sandbox_config_get_telemetry_interval(config) * 1000ll;
+    gint64 nextTelemetry = 0;
+
+    memset(&exitusage, 0, sizeof(exitusage));
 
     if (debug)
         fprintf(stderr, "libvirt-sandbox-init-common: running I/O loop %d %d", appin, appout);
@@ -878,6 +1683,7 @@ static gboolean eventloop(GVirSandboxConfig *config,
         int appoutEv = 0;
         int apperrEv = 0;
         int hostEv = 0;
+        int timeout = -1;
 
         fds[nfds].fd = sigread;
         fds[nfds].events = POLLIN;
@@ -895,7 +1701,9 @@ static gboolean eventloop(GVirSandboxConfig *config,
         case GVIR_SANDBOX_CONSOLE_STATE_RUNNING:
             if (hostToStdin && appin != -1)
                 appinEv |= POLLOUT;
-            else if (rx != NULL)
+            /* Keep reading even while stdin is being written, so
+             * control messages are not stuck behind a slow app */
+            if (rx != NULL)
                 hostEv |= POLLIN;
 
             if (tx != NULL)
@@ -932,8 +1740,20 @@ static gboolean eventloop(GVirSandboxConfig *config,
             nfds++;
         }
 
+        /* Telemetry is only sent while the app is running, so
+         * it can never get in the way of the final exit message */
+        if (telemetryInterval &&
+            state == GVIR_SANDBOX_CONSOLE_STATE_RUNNING &&
+            !appQuit && !appOutEOF && !appErrEOF) {
+            gint64 now = g_get_monotonic_time();
+            if (!nextTelemetry)
+                nextTelemetry = now + telemetryInterval;
+            timeout = nextTelemetry > now ?
+                (nextTelemetry - now + 999) / 1000 : 0;
+        }
+
     repoll:
-        if (poll(fds, nfds, -1) < 0) {
+        if (poll(fds, nfds, timeout) < 0) {
             if (errno == EINTR)
                 goto repoll;
             if (debug)
@@ -950,18 +1770,25 @@ static gboolean eventloop(GVirSandboxConfig *config,
                 if (fds[i].revents) {
                     char ignore;
                     pid_t rv;
+                    int status;
+                    struct rusage usage;
                     if (read(sigread, &ignore, 1) != 1)
                         goto cleanup;
                     while (1) {
-                        rv = waitpid(-1, &exitstatus, WNOHANG);
+                        rv = wait4(-1, &status, WNOHANG, &usage);
                         if (rv == -1 || rv == 0)
                             break;
                         if (rv == child) {
+                            exitstatus = status;
+                            exitusage = usage;
                             appQuit = TRUE;
+                            /* The trace must be saved before the host
+                             * gets the exit status and may kill us */
+                            readahead_finish();
                             if (appErrEOF && appOutEOF) {
                                 if (debug)
                                     fprintf(stderr, "Encoding exit status sigchild %d\n", exitstatus);
-                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, serial++, NULL)))
+                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, &exitusage, serial++, NULL)))
                                     goto cleanup;
                             }
                         }
@@ -1067,18 +1894,32 @@ static gboolean eventloop(GVirSandboxConfig *config,
 
                                         switch (rx->header.proc) {
                                         case GVIR_SANDBOX_PROTOCOL_PROC_STDIN:
-                                            if (rx->bufferLength - rx->bufferOffset) {
-                                                hostToStdinOffset = 0;
-                                                hostToStdinLength = rx->bufferLength - rx->bufferOffset;
-                                                hostToStdin = g_new0(gchar, hostToStdinLength);
-                                                memcpy(hostToStdin,
-                                                       rx->buffer + rx->bufferOffset,
-                                                       hostToStdinLength);
+                                            if (appInClosed) {
                                                 if (debug)
-                                                    fprintf(stderr, "Processed stdin %zu\n", hostToStdinLength);
+                                                    fprintf(stderr, "Dropping stdin for closed app\n");
+                                            } else if (hostToStdin) {
+                                                /* Park it until the app has taken the
+                                                 * previous data, which stops us reading
+                                                 * any more from the host till then */
+                                                hostStdinPending = rx;
+                                                rx = NULL;
                                             } else {
-                                                close(appin);
-                                                appin = -1;
+                                                take_host_stdin(rx,
+                                                                &hostToStdin,
+                                                                &hostToStdinLength,
+                                                                &hostToStdinOffset,
+                                                                &appin);
+                                            }
+                                            break;
+
+                                        case GVIR_SANDBOX_PROTOCOL_PROC_SIGNAL:
+                                        case GVIR_SANDBOX_PROTOCOL_PROC_WINSIZE:
+                                        case GVIR_SANDBOX_PROTOCOL_PROC_PRIORITY:
+                                            if (!process_control(rx, child, appout)) {
+                                                if (debug)
+                                                    fprintf(stderr, "Cannot decode control %u\n",
+                                                            rx->header.proc);
+                                                goto cleanup;
                                             }
                                             break;
 
@@ -1089,14 +1930,17 @@ static gboolean eventloop(GVirSandboxConfig *config,
                                         case GVIR_SANDBOX_PROTOCOL_PROC_STDOUT:
                                         case GVIR_SANDBOX_PROTOCOL_PROC_STDERR:
                                         case GVIR_SANDBOX_PROTOCOL_PROC_EXIT:
+                                        case GVIR_SANDBOX_PROTOCOL_PROC_TELEMETRY:
                                         default:
                                             if (debug)
                                                 fprintf(stderr, "Unexpected proc %u\n", rx->header.proc);
                                             goto cleanup;
                                         }
                                     }
-                                    gvir_sandbox_rpcpacket_free(rx);
-                                    rx = NULL;
+                                    if (rx) {
+                                        gvir_sandbox_rpcpacket_free(rx);
+                                        rx = gvir_sandbox_rpcpacket_new(TRUE);
+                                    }
                                     break;
                                 default:
                                     if (debug)
@@ -1155,7 +1999,7 @@ static gboolean eventloop(GVirSandboxConfig *config,
                             if (appQuit) {
                                 if (debug)
                                     fprintf(stderr, "Encoding exit status appout tty %d\n", exitstatus);
-                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, serial++, NULL)))
+                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, &exitusage, serial++, NULL)))
                                     goto cleanup;
                             }
                         } else {
@@ -1179,16 +2023,28 @@ static gboolean eventloop(GVirSandboxConfig *config,
                             if (debug)
                                 fprintf(stderr, "Failed to write to app %s\n",
                                         strerror(errno));
-                            g_free(hostToStdin);
-                            hostToStdin = NULL;
-                            hostToStdinLength = hostToStdinOffset = 0;
+                            drop_host_stdin(&hostToStdin,
+                                            &hostToStdinLength,
+                                            &hostToStdinOffset,
+                                            &hostStdinPending,
+                                            &rx, &appin, appout,
+                                            &appInClosed);
                         } else {
                             hostToStdinOffset += got;
                             if (hostToStdinOffset == hostToStdinLength) {
                                 g_free(hostToStdin);
                                 hostToStdin = NULL;
                                 hostToStdinLength = hostToStdinOffset = 0;
-                                rx = gvir_sandbox_rpcpacket_new(TRUE);
+                                if (hostStdinPending) {
+                                    take_host_stdin(hostStdinPending,
+                                                    &hostToStdin,
+                                                    &hostToStdinLength,
+                                                    &hostToStdinOffset,
+                                                    &appin);
+                                    gvir_sandbox_rpcpacket_free(hostStdinPending);
+                                    hostStdinPending = NULL;
+                                    rx = gvir_sandbox_rpcpacket_new(TRUE);
+                                }
                             }
                         }
                     }
@@ -1200,7 +2056,7 @@ static gboolean eventloop(GVirSandboxConfig *config,
                     if (appQuit) {
                         if (debug)
                             fprintf(stderr, "Encoding exit status due to HUP %d\n", exitstatus);
-                        if (!(tx = gvir_sandbox_encode_exit(exitstatus, serial++, NULL)))
+                        if (!(tx = gvir_sandbox_encode_exit(exitstatus, &exitusage, serial++, NULL)))
                             goto cleanup;
                     }
                 }
@@ -1211,16 +2067,31 @@ static gboolean eventloop(GVirSandboxConfig *config,
                                      hostToStdin + hostToStdinOffset,
                                      hostToStdinLength - hostToStdinOffset);
                     if (got < 0) {
-                        g_free(hostToStdin);
-                        hostToStdin = NULL;
-                        hostToStdinLength = hostToStdinOffset = 0;
+                        if (debug)
+                            fprintf(stderr, "Failed to write to app %s\n",
+                                    strerror(errno));
+                        drop_host_stdin(&hostToStdin,
+                                        &hostToStdinLength,
+                                        &hostToStdinOffset,
+                                        &hostStdinPending,
+                                        &rx, &appin, appout,
+                                        &appInClosed);
                     } else {
                         hostToStdinOffset += got;
                         if (hostToStdinOffset == hostToStdinLength) {
                             g_free(hostToStdin);
                             hostToStdin = NULL;
                             hostToStdinLength = hostToStdinOffset = 0;
-                            rx = gvir_sandbox_rpcpacket_new(TRUE);
+                            if (hostStdinPending) {
+                                take_host_stdin(hostStdinPending,
+                                                &hostToStdin,
+                                                &hostToStdinLength,
+                                                &hostToStdinOffset,
+                                                &appin);
+                                gvir_sandbox_rpcpacket_free(hostStdinPending);
+                                hostStdinPending = NULL;
+                                rx = gvir_sandbox_rpcpacket_new(TRUE);
+                            }
                         }
                     }
                 }
@@ -1236,7 +2107,7 @@ static gboolean eventloop(GVirSandboxConfig *config,
                             if (appErrEOF && appQuit) {
                                 if (debug)
                                     fprintf(stderr, "Encoding exit status appout %d\n", exitstatus);
-                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, serial++, NULL)))
+                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, &exitusage, serial++, NULL)))
                                     goto cleanup;
                             }
                         } else {
@@ -1260,7 +2131,7 @@ static gboolean eventloop(GVirSandboxConfig *config,
                             if (appOutEOF && appQuit) {
                                 if (debug)
                                     fprintf(stderr, "Encoding exit status apperr %d\n", exitstatus);
-                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, serial++, NULL)))
+                                if (!(tx = gvir_sandbox_encode_exit(exitstatus, &exitusage, serial++, NULL)))
                                     goto cleanup;
                             }
                         } else {
@@ -1274,11 +2145,23 @@ static gboolean eventloop(GVirSandboxConfig *config,
                 }
             }
         }
+
+        if (timeout != -1) {
+            gint64 now = g_get_monotonic_time();
+            if (now >= nextTelemetry) {
+                /* Low priority: if the channel to the host is busy
+                 * with app I/O, just drop this sample */
+                if (!tx && !appQuit && !appOutEOF && !appErrEOF)
+                    tx = gvir_sandbox_encode_telemetry(serial++, NULL);
+                nextTelemetry = now + telemetryInterval;
+            }
+        }
     }
 
     ret = TRUE;
 
  cleanup:
+    gvir_sandbox_rpcpacket_free(hostStdinPending);
     if (appin != -1) {
         close(appin);
         if (appin == appout)
@@ -1445,6 +2328,8 @@ int main(int argc, char **argv) {
     debug = gvir_sandbox_config_get_debug(config);
     verbose = gvir_sandbox_config_get_verbose(config);
 
+    readahead_start(config);
+
     setenv("PATH", "/bin:/usr/bin:/usr/local/bin:/sbin/:/usr/sbin", 1);
     unsetenv("LD_LIBRARY_PATH");
 
@@ -1461,6 +2346,15 @@ int main(int argc, char **argv) {
     if (!setup_network(config, &error))
         goto error;
 
+    if (GVIR_SANDBOX_IS_CONFIG_INTERACTIVE(config))
+        setup_app_cgroup();
+
+    /* Only init-qemu asks for a power off. In a container the zram
+     * device, if any, would be the host's own */
+    if (poweroff)
+        setup_zram(config);
+    setup_tuning(config);
+
     if (GVIR_SANDBOX_IS_CONFIG_INTERACTIVE(config)) {
         if (run_interactive(config) < 0)
             goto cleanup;
@@ -1480,6 +2374,7 @@ int main(int argc, char **argv) {
     if (error)
         g_error_free(error);
 
+    readahead_finish();
     sync_data();
 
     if (poweroff) {
@@ -77,16 +77,20 @@ main(int argc, char **argv)
         args[narg++] = "1000";
     }
 
+#ifndef WITH_STATIC_INIT
     args[narg++] = SANDBOXCONFIGDIR "/.libs/ld.so";
+#endif
     args[narg++] = SANDBOXCONFIGDIR "/.libs/libvirt-sandbox-init-common";
     if (debug)
         args[narg++] = "-d";
 
+#ifndef WITH_STATIC_INIT
     if (setenv("LD_LIBRARY_PATH", SANDBOXCONFIGDIR "/.libs", 1) != 0) {
         fprintf(stderr, "libvirt-sandbox-init-lxc: %s: cannot set LD_LIBRARY_PATH: %s\n",
                 __func__, strerror(errno));
         exit(EXIT_FAILURE);
     }
+#endif
 
     if (debug)
         fprintf(stderr, "Running interactive\n");
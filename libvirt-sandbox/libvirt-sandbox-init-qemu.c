@@ -32,6 +32,7 @@
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
@@ -190,6 +191,12 @@ mount_entry(const char *source,
 {
     int flags = 0;
 
+    /* The kernel only takes "ro" as a mount flag */
+    if (strncmp(opts, "ro", 2) == 0 && (opts[2] == '\0' || opts[2] == ',')) {
+        flags |= MS_RDONLY;
+        opts += opts[2] ? 3 : 2;
+    }
+
     if (STREQ(type, "")) {
         struct stat st;
         type = NULL;
@@ -437,17 +444,21 @@ main(int argc ATTR_UNUSED, char **argv ATTR_UNUSED)
         args[narg++] = "1000";
     }
 
+#ifndef WITH_STATIC_INIT
     args[narg++] = SANDBOXCONFIGDIR "/.libs/ld.so";
+#endif
     args[narg++] = SANDBOXCONFIGDIR "/.libs/libvirt-sandbox-init-common";
     args[narg++] = "--poweroff";
     if (debug)
         args[narg++] = "-d";
 
+#ifndef WITH_STATIC_INIT
     if (setenv("LD_LIBRARY_PATH", SANDBOXCONFIGDIR "/.libs", 1) < 0) {
         fprintf(stderr, "libvirt-sandbox-init-qemu: %s: cannot set LD_LIBRARY_PATH: %s\n",
                 __func__, strerror(errno));
         exit_poweroff();
     }
+#endif
 
 
     if (debug)
@@ -463,15 +474,33 @@ extern long init_module(const void *mem, unsigned long len, const char *args);
 
 #define READ_SIZE (1024 * 16)
 
+/*
+ * Grows @data to twice its @capacity. Only needed when a size
+ * hint turns out wrong, since buffers are normally sized up front.
+ */
+static char *grow(char *data, size_t *capacity)
+{
+    char *tmp;
+
+    *capacity *= 2;
+    if (!(tmp = realloc(data, *capacity))) {
+        fprintf(stderr, "libvirt-sandbox-init-qemu: %s: out of memory\n",
+                __func__);
+        exit_poweroff();
+    }
+    return tmp;
+}
+
 static char *readall(const char *filename, size_t *len)
 {
-    char *data = NULL, *tmp;
+    char *data = NULL;
     int fd;
     size_t capacity;
     size_t offset;
     ssize_t got;
+    struct stat sb;
 
-    *len = capacity = offset = 0;
+    *len = offset = 0;
 
     if ((fd = open(filename, O_RDONLY)) < 0) {
         fprintf(stderr, "libvirt-sandbox-init-qemu: %s: cannot open %s\n",
@@ -479,16 +508,21 @@ static char *readall(const char *filename, size_t *len)
         exit_poweroff();
     }
 
+    /* One more byte than the file, so EOF is seen without growing */
+    if (fstat(fd, &sb) == 0 && sb.st_size > 0)
+        capacity = sb.st_size + 1;
+    else
+        capacity = READ_SIZE;
+
+    if (!(data = malloc(capacity))) {
+        fprintf(stderr, "libvirt-sandbox-init-qemu: %s: out of memory\n",
+                __func__);
+        exit_poweroff();
+    }
+
     for (;;) {
-        if ((capacity - offset) < 1024) {
-            if (!(tmp = realloc(data, capacity + 2048))) {
-                fprintf(stderr, "libvirt-sandbox-init-qemu: %s: out of memory\n",
-                        __func__);
-                exit_poweroff();
-            }
-            data = tmp;
-            capacity += 2048;
-        }
+        if (offset == capacity)
+            data = grow(data, &capacity);
 
         if ((got = read(fd, data + offset, capacity - offset)) < 0) {
             fprintf(stderr, "libvirt-sandbox-init-qemu: %s: error reading %s: %s\n",
@@ -515,6 +549,32 @@ has_suffix(const char *filename, const char *ext)
 }
 
 #if WITH_LZMA
+/* Reads the uncompressed size from the index at the end of the
+ * stream, or returns 0 if it can't be found */
+static uint64_t
+xz_uncompressed_size(const unsigned char *buf, size_t len)
+{
+    lzma_stream_flags flags;
+    lzma_index *idx = NULL;
+    uint64_t memlimit = UINT64_MAX;
+    uint64_t size;
+    size_t pos;
+
+    if (len < LZMA_STREAM_HEADER_SIZE * 2 ||
+        lzma_stream_footer_decode(&flags, buf + len - LZMA_STREAM_HEADER_SIZE) != LZMA_OK ||
+        flags.backward_size > len - (LZMA_STREAM_HEADER_SIZE * 2))
+        return 0;
+
+    pos = len - LZMA_STREAM_HEADER_SIZE - flags.backward_size;
+    if (lzma_index_buffer_decode(&idx, &memlimit, NULL, buf, &pos,
+                                 len - LZMA_STREAM_HEADER_SIZE) != LZMA_OK)
+        return 0;
+
+    size = lzma_index_uncompressed_size(idx);
+    lzma_index_end(idx, NULL);
+    return size;
+}
+
 static char *
 load_module_file_lzma(const char *filename, size_t *len)
 {
@@ -522,6 +582,8 @@ load_module_file_lzma(const char *filename, size_t *len)
     char *xzdata;
     size_t xzlen;
     char *data;
+    size_t capacity;
+    uint64_t hint;
     lzma_ret ret;
 
     *len = 0;
@@ -540,33 +602,33 @@ load_module_file_lzma(const char *filename, size_t *len)
     st.next_in = (unsigned char *)xzdata;
     st.avail_in = xzlen;
 
-    *len = 32 * 1024;
-    if (!(data = malloc(*len))) {
+    /* Size the output from the stream index, so it is decoded
+     * straight into a single allocation */
+    hint = xz_uncompressed_size((unsigned char *)xzdata, xzlen);
+    capacity = hint && hint < SIZE_MAX ? hint + 1 : (xzlen * 4) + READ_SIZE;
+    if (!(data = malloc(capacity))) {
         fprintf(stderr, "libvirt-sandbox-init-qemu: %s: %s\n", __func__, strerror(errno));
         exit_poweroff();
     }
 
     st.next_out = (unsigned char *)data;
-    st.avail_out = *len;
+    st.avail_out = capacity;
 
     do {
-        ret = lzma_code(&st, LZMA_FINISH);
         if (st.avail_out == 0) {
-            size_t used = *len;
-            *len += (32 * 1024);
-            if (!(data = realloc(data, *len))) {
-                fprintf(stderr, "libvirt-sandbox-init-qemu: %s: %s\n", __func__, strerror(errno));
-                exit_poweroff();
-            }
+            size_t used = capacity;
+            data = grow(data, &capacity);
             st.next_out = (unsigned char *)data + used;
-            st.avail_out = *len - used;
+            st.avail_out = capacity - used;
         }
+        ret = lzma_code(&st, LZMA_FINISH);
         if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
             fprintf(stderr, "libvirt-sandbox-init-qemu: %s: %s: lzma decode failure: %d\n",
                     __func__, filename, ret);
             exit_poweroff();
         }
     } while (ret != LZMA_STREAM_END);
+    *len = capacity - st.avail_out;
     lzma_end(&st);
     free(xzdata);
     return data;
@@ -582,12 +644,32 @@ load_module_file_lzma(const char *filename, size_t *len)
 #endif /* WITH_LZMA */
 
 #if WITH_ZLIB
+/* The gzip trailer holds the uncompressed size, modulo 4GB */
+static size_t
+gz_uncompressed_size(const char *filename)
+{
+    unsigned char isize[4];
+    size_t size = 0;
+    int fd;
+
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        return 0;
+
+    if (lseek(fd, -4, SEEK_END) >= 0 &&
+        read(fd, isize, sizeof(isize)) == sizeof(isize))
+        size = isize[0] | (isize[1] << 8) | (isize[2] << 16) |
+            ((size_t)isize[3] << 24);
+
+    close(fd);
+    return size;
+}
+
 static char *
 load_module_file_zlib(const char *filename, size_t *len)
 {
     gzFile fp;
     char *data;
-    unsigned int avail;
+    size_t capacity;
     size_t total;
     int got;
 
@@ -600,35 +682,35 @@ load_module_file_zlib(const char *filename, size_t *len)
         exit_poweroff();
     }
 
-    *len = 32 * 1024;
-    if (!(data = malloc(*len))) {
+    /* One more byte than the hint, so EOF is seen without growing */
+    capacity = gz_uncompressed_size(filename) + 1;
+    if (capacity == 1)
+        capacity = READ_SIZE;
+    if (!(data = malloc(capacity))) {
         fprintf(stderr, "libvirt-sandbox-init-qemu: %s: %s\n", __func__, strerror(errno));
         exit_poweroff();
     }
 
-    avail = *len;
     total = 0;
 
-    do {
-        got = gzread(fp, data + total, avail);
+    for (;;) {
+        if (total == capacity)
+            data = grow(data, &capacity);
+
+        got = gzread(fp, data + total, capacity - total);
 
         if (got < 0) {
             fprintf(stderr, "libvirt-sandbox-init-qemu: %s: %s: gzread failure\n",
                 __func__, filename);
             exit_poweroff();
         }
+        if (got == 0)
+            break;
 
         total += got;
-        if (total >= *len) {
-            *len += (32 * 1024);
-            if (!(data = realloc(data, *len))) {
-                fprintf(stderr, "libvirt-sandbox-init-qemu: %s: %s\n", __func__, strerror(errno));
-                exit_poweroff();
-            }
-            avail = *len - total;
-        }
-    } while (got > 0);
+    }
 
+    *len = total;
     gzclose(fp);
     return data;
 }
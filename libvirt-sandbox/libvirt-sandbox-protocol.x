@@ -12,7 +12,12 @@ enum GVirSandboxProtocolProc {
      GVIR_SANDBOX_PROTOCOL_PROC_STDOUT = 2,
      GVIR_SANDBOX_PROTOCOL_PROC_STDERR = 3,
      GVIR_SANDBOX_PROTOCOL_PROC_EXIT = 4,
-     GVIR_SANDBOX_PROTOCOL_PROC_QUIT = 5
+     GVIR_SANDBOX_PROTOCOL_PROC_QUIT = 5,
+     GVIR_SANDBOX_PROTOCOL_PROC_TELEMETRY = 6,
+     /* Control messages from the host, handled ahead of stdin */
+     GVIR_SANDBOX_PROTOCOL_PROC_SIGNAL = 7,
+     GVIR_SANDBOX_PROTOCOL_PROC_WINSIZE = 8,
+     GVIR_SANDBOX_PROTOCOL_PROC_PRIORITY = 9
 };
 
 enum GVirSandboxProtocolType {
@@ -38,4 +43,60 @@ struct GVirSandboxProtocolHeader {
 
 struct GVirSandboxProtocolMessageExit {
      int status;
+
+     /* Resource usage of the command, from wait4() */
+     unsigned hyper utime;         /* microseconds */
+     unsigned hyper stime;         /* microseconds */
+     unsigned hyper maxrss;        /* kilobytes */
+     unsigned hyper minflt;
+     unsigned hyper majflt;
+     unsigned hyper inblock;
+     unsigned hyper oublock;
+     unsigned hyper nvcsw;
+     unsigned hyper nivcsw;
+
+     /* Cgroup v2 stats of the command, if the guest has them */
+     bool cgroup;
+     unsigned hyper cgroupUsage;   /* microseconds */
+     unsigned hyper cgroupUser;    /* microseconds */
+     unsigned hyper cgroupSystem;  /* microseconds */
+     unsigned hyper cgroupMemPeak; /* bytes */
+     unsigned hyper cgroupReadBytes;
+     unsigned hyper cgroupWriteBytes;
+};
+
+struct GVirSandboxProtocolMessageTelemetry {
+     /* /proc/pressure "avg10" values, in hundredths of a percent */
+     bool pressure;
+     unsigned int cpuSome;
+     unsigned int memorySome;
+     unsigned int memoryFull;
+     unsigned int ioSome;
+     unsigned int ioFull;
+
+     /* /proc/meminfo, in kilobytes */
+     unsigned hyper memTotal;
+     unsigned hyper memAvailable;
+
+     /* /proc/stat cumulative CPU times, in clock ticks */
+     unsigned hyper cpuUser;
+     unsigned hyper cpuSystem;
+     unsigned hyper cpuIdle;
+     unsigned hyper cpuIOWait;
+     unsigned hyper cpuSteal;
+};
+
+struct GVirSandboxProtocolMessageSignal {
+     int signum;
+};
+
+struct GVirSandboxProtocolMessageWinsize {
+     unsigned int rows;
+     unsigned int cols;
+};
+
+struct GVirSandboxProtocolMessagePriority {
+     int nice;
+     /* cgroup v2 cpu.weight, 1-10000, or 0 to leave unchanged */
+     unsigned int weight;
 };
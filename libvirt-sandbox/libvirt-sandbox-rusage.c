@@ -0,0 +1,707 @@
+/*
+ * libvirt-sandbox-rusage.c: libvirt sandbox command resource usage
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include "libvirt-sandbox/libvirt-sandbox.h"
+
+/**
+ * SECTION: libvirt-sandbox-rusage
+ * @short_description: Resource usage of a sandboxed command
+ * @include: libvirt-sandbox/libvirt-sandbox.h
+ * @see_also: #GVirSandboxContext
+ *
+ * Provides an object to report what a sandboxed command cost to run
+ *
+ * The GVirSandboxRusage object records the resource usage of the command
+ * run inside a sandbox, as reported by the guest when the command exits.
+ * The process level counters come from wait4(), while the cgroup counters
+ * are only present if the guest kernel has cgroup v2 support.
+ */
+
+#define GVIR_SANDBOX_RUSAGE_GET_PRIVATE(obj)                            \
+    (G_TYPE_INSTANCE_GET_PRIVATE((obj), GVIR_SANDBOX_TYPE_RUSAGE, GVirSandboxRusagePrivate))
+
+struct _GVirSandboxRusagePrivate
+{
+    guint64 user_time;
+    guint64 system_time;
+    guint64 max_rss;
+    guint64 minor_faults;
+    guint64 major_faults;
+    guint64 input_blocks;
+    guint64 output_blocks;
+    guint64 voluntary_switches;
+    guint64 involuntary_switches;
+
+    gboolean cgroup;
+    guint64 cgroup_usage_time;
+    guint64 cgroup_user_time;
+    guint64 cgroup_system_time;
+    guint64 cgroup_memory_peak;
+    guint64 cgroup_read_bytes;
+    guint64 cgroup_write_bytes;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxRusage, gvir_sandbox_rusage, G_TYPE_OBJECT);
+
+
+enum {
+    PROP_0,
+    PROP_USER_TIME,
+    PROP_SYSTEM_TIME,
+    PROP_MAX_RSS,
+    PROP_MINOR_FAULTS,
+    PROP_MAJOR_FAULTS,
+    PROP_INPUT_BLOCKS,
+    PROP_OUTPUT_BLOCKS,
+    PROP_VOLUNTARY_SWITCHES,
+    PROP_INVOLUNTARY_SWITCHES,
+    PROP_HAS_CGROUP,
+    PROP_CGROUP_USAGE_TIME,
+    PROP_CGROUP_USER_TIME,
+    PROP_CGROUP_SYSTEM_TIME,
+    PROP_CGROUP_MEMORY_PEAK,
+    PROP_CGROUP_READ_BYTES,
+    PROP_CGROUP_WRITE_BYTES,
+};
+
+enum {
+    LAST_SIGNAL
+};
+
+//static gint signals[LAST_SIGNAL];
+
+
+static void gvir_sandbox_rusage_get_property(GObject *object,
+                                             guint prop_id,
+                                             GValue *value,
+                                             GParamSpec *pspec)
+{
+    GVirSandboxRusage *rusage = GVIR_SANDBOX_RUSAGE(object);
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+
+    switch (prop_id) {
+    case PROP_USER_TIME:
+        g_value_set_uint64(value, priv->user_time);
+        break;
+
+    case PROP_SYSTEM_TIME:
+        g_value_set_uint64(value, priv->system_time);
+        break;
+
+    case PROP_MAX_RSS:
+        g_value_set_uint64(value, priv->max_rss);
+        break;
+
+    case PROP_MINOR_FAULTS:
+        g_value_set_uint64(value, priv->minor_faults);
+        break;
+
+    case PROP_MAJOR_FAULTS:
+        g_value_set_uint64(value, priv->major_faults);
+        break;
+
+    case PROP_INPUT_BLOCKS:
+        g_value_set_uint64(value, priv->input_blocks);
+        break;
+
+    case PROP_OUTPUT_BLOCKS:
+        g_value_set_uint64(value, priv->output_blocks);
+        break;
+
+    case PROP_VOLUNTARY_SWITCHES:
+        g_value_set_uint64(value, priv->voluntary_switches);
+        break;
+
+    case PROP_INVOLUNTARY_SWITCHES:
+        g_value_set_uint64(value, priv->involuntary_switches);
+        break;
+
+    case PROP_HAS_CGROUP:
+        g_value_set_boolean(value, priv->cgroup);
+        break;
+
+    case PROP_CGROUP_USAGE_TIME:
+        g_value_set_uint64(value, priv->cgroup_usage_time);
+        break;
+
+    case PROP_CGROUP_USER_TIME:
+        g_value_set_uint64(value, priv->cgroup_user_time);
+        break;
+
+    case PROP_CGROUP_SYSTEM_TIME:
+        g_value_set_uint64(value, priv->cgroup_system_time);
+        break;
+
+    case PROP_CGROUP_MEMORY_PEAK:
+        g_value_set_uint64(value, priv->cgroup_memory_peak);
+        break;
+
+    case PROP_CGROUP_READ_BYTES:
+        g_value_set_uint64(value, priv->cgroup_read_bytes);
+        break;
+
+    case PROP_CGROUP_WRITE_BYTES:
+        g_value_set_uint64(value, priv->cgroup_write_bytes);
+        break;
+
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+
+static void gvir_sandbox_rusage_set_property(GObject *object,
+                                             guint prop_id,
+                                             const GValue *value,
+                                             GParamSpec *pspec)
+{
+    GVirSandboxRusage *rusage = GVIR_SANDBOX_RUSAGE(object);
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+
+    switch (prop_id) {
+    case PROP_USER_TIME:
+        priv->user_time = g_value_get_uint64(value);
+        break;
+
+    case PROP_SYSTEM_TIME:
+        priv->system_time = g_value_get_uint64(value);
+        break;
+
+    case PROP_MAX_RSS:
+        priv->max_rss = g_value_get_uint64(value);
+        break;
+
+    case PROP_MINOR_FAULTS:
+        priv->minor_faults = g_value_get_uint64(value);
+        break;
+
+    case PROP_MAJOR_FAULTS:
+        priv->major_faults = g_value_get_uint64(value);
+        break;
+
+    case PROP_INPUT_BLOCKS:
+        priv->input_blocks = g_value_get_uint64(value);
+        break;
+
+    case PROP_OUTPUT_BLOCKS:
+        priv->output_blocks = g_value_get_uint64(value);
+        break;
+
+    case PROP_VOLUNTARY_SWITCHES:
+        priv->voluntary_switches = g_value_get_uint64(value);
+        break;
+
+    case PROP_INVOLUNTARY_SWITCHES:
+        priv->involuntary_switches = g_value_get_uint64(value);
+        break;
+
+    case PROP_HAS_CGROUP:
+        priv->cgroup = g_value_get_boolean(value);
+        break;
+
+    case PROP_CGROUP_USAGE_TIME:
+        priv->cgroup_usage_time = g_value_get_uint64(value);
+        break;
+
+    case PROP_CGROUP_USER_TIME:
+        priv->cgroup_user_time = g_value_get_uint64(value);
+        break;
+
+    case PROP_CGROUP_SYSTEM_TIME:
+        priv->cgroup_system_time = g_value_get_uint64(value);
+        break;
+
+    case PROP_CGROUP_MEMORY_PEAK:
+        priv->cgroup_memory_peak = g_value_get_uint64(value);
+        break;
+
+    case PROP_CGROUP_READ_BYTES:
+        priv->cgroup_read_bytes = g_value_get_uint64(value);
+        break;
+
+    case PROP_CGROUP_WRITE_BYTES:
+        priv->cgroup_write_bytes = g_value_get_uint64(value);
+        break;
+
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+
+static void gvir_sandbox_rusage_class_init(GVirSandboxRusageClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->get_property = gvir_sandbox_rusage_get_property;
+    object_class->set_property = gvir_sandbox_rusage_set_property;
+
+    g_object_class_install_property(object_class,
+                                    PROP_USER_TIME,
+                                    g_param_spec_uint64("user-time",
+                                                        "User time",
+                                                        "User CPU time in microseconds",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_SYSTEM_TIME,
+                                    g_param_spec_uint64("system-time",
+                                                        "System time",
+                                                        "System CPU time in microseconds",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MAX_RSS,
+                                    g_param_spec_uint64("max-rss",
+                                                        "Max RSS",
+                                                        "Maximum resident set size in kilobytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MINOR_FAULTS,
+                                    g_param_spec_uint64("minor-faults",
+                                                        "Minor faults",
+                                                        "Page faults not requiring I/O",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MAJOR_FAULTS,
+                                    g_param_spec_uint64("major-faults",
+                                                        "Major faults",
+                                                        "Page faults requiring I/O",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_INPUT_BLOCKS,
+                                    g_param_spec_uint64("input-blocks",
+                                                        "Input blocks",
+                                                        "Block input operations",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_OUTPUT_BLOCKS,
+                                    g_param_spec_uint64("output-blocks",
+                                                        "Output blocks",
+                                                        "Block output operations",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_VOLUNTARY_SWITCHES,
+                                    g_param_spec_uint64("voluntary-switches",
+                                                        "Voluntary switches",
+                                                        "Voluntary context switches",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_INVOLUNTARY_SWITCHES,
+                                    g_param_spec_uint64("involuntary-switches",
+                                                        "Involuntary switches",
+                                                        "Involuntary context switches",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_HAS_CGROUP,
+                                    g_param_spec_boolean("has-cgroup",
+                                                         "Has cgroup",
+                                                         "Whether cgroup stats are present",
+                                                         FALSE,
+                                                         G_PARAM_READABLE |
+                                                         G_PARAM_WRITABLE |
+                                                         G_PARAM_CONSTRUCT_ONLY |
+                                                         G_PARAM_STATIC_NAME |
+                                                         G_PARAM_STATIC_NICK |
+                                                         G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CGROUP_USAGE_TIME,
+                                    g_param_spec_uint64("cgroup-usage-time",
+                                                        "Cgroup usage time",
+                                                        "Cgroup total CPU time in microseconds",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CGROUP_USER_TIME,
+                                    g_param_spec_uint64("cgroup-user-time",
+                                                        "Cgroup user time",
+                                                        "Cgroup user CPU time in microseconds",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CGROUP_SYSTEM_TIME,
+                                    g_param_spec_uint64("cgroup-system-time",
+                                                        "Cgroup system time",
+                                                        "Cgroup system CPU time in microseconds",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CGROUP_MEMORY_PEAK,
+                                    g_param_spec_uint64("cgroup-memory-peak",
+                                                        "Cgroup memory peak",
+                                                        "Cgroup peak memory usage in bytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CGROUP_READ_BYTES,
+                                    g_param_spec_uint64("cgroup-read-bytes",
+                                                        "Cgroup read bytes",
+                                                        "Cgroup bytes read from block devices",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CGROUP_WRITE_BYTES,
+                                    g_param_spec_uint64("cgroup-write-bytes",
+                                                        "Cgroup write bytes",
+                                                        "Cgroup bytes written to block devices",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+}
+
+
+static void gvir_sandbox_rusage_init(GVirSandboxRusage *rusage)
+{
+    rusage->priv = GVIR_SANDBOX_RUSAGE_GET_PRIVATE(rusage);
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_user_time:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the CPU time spent by the command in user mode
+ *
+ * Returns: the user time in microseconds
+ */
+guint64 gvir_sandbox_rusage_get_user_time(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->user_time;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_system_time:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the CPU time spent by the command in kernel mode
+ *
+ * Returns: the system time in microseconds
+ */
+guint64 gvir_sandbox_rusage_get_system_time(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->system_time;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_max_rss:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the peak resident set size of the command
+ *
+ * Returns: the maximum resident set size in kilobytes
+ */
+guint64 gvir_sandbox_rusage_get_max_rss(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->max_rss;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_minor_faults:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of page faults serviced without any I/O
+ *
+ * Returns: the minor fault count
+ */
+guint64 gvir_sandbox_rusage_get_minor_faults(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->minor_faults;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_major_faults:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of page faults that required I/O
+ *
+ * Returns: the major fault count
+ */
+guint64 gvir_sandbox_rusage_get_major_faults(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->major_faults;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_input_blocks:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of times the filesystem had to perform input
+ *
+ * Returns: the block input count
+ */
+guint64 gvir_sandbox_rusage_get_input_blocks(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->input_blocks;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_output_blocks:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of times the filesystem had to perform output
+ *
+ * Returns: the block output count
+ */
+guint64 gvir_sandbox_rusage_get_output_blocks(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->output_blocks;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_voluntary_switches:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of times the command yielded the CPU voluntarily
+ *
+ * Returns: the voluntary context switch count
+ */
+guint64 gvir_sandbox_rusage_get_voluntary_switches(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->voluntary_switches;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_involuntary_switches:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of times the command was preempted
+ *
+ * Returns: the involuntary context switch count
+ */
+guint64 gvir_sandbox_rusage_get_involuntary_switches(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->involuntary_switches;
+}
+
+
+/**
+ * gvir_sandbox_rusage_has_cgroup:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Determine whether the guest was able to report cgroup v2
+ * statistics for the command. If not, all the cgroup counters
+ * will be zero.
+ *
+ * Returns: TRUE if cgroup statistics are present
+ */
+gboolean gvir_sandbox_rusage_has_cgroup(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_cgroup_usage_time:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the total CPU time consumed by the command's cgroup
+ *
+ * Returns: the CPU time in microseconds
+ */
+guint64 gvir_sandbox_rusage_get_cgroup_usage_time(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup_usage_time;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_cgroup_user_time:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the user mode CPU time consumed by the command's cgroup
+ *
+ * Returns: the user time in microseconds
+ */
+guint64 gvir_sandbox_rusage_get_cgroup_user_time(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup_user_time;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_cgroup_system_time:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the kernel mode CPU time consumed by the command's cgroup
+ *
+ * Returns: the system time in microseconds
+ */
+guint64 gvir_sandbox_rusage_get_cgroup_system_time(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup_system_time;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_cgroup_memory_peak:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the peak memory usage of the command's cgroup
+ *
+ * Returns: the peak memory usage in bytes
+ */
+guint64 gvir_sandbox_rusage_get_cgroup_memory_peak(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup_memory_peak;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_cgroup_read_bytes:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of bytes read from block devices by the command's cgroup
+ *
+ * Returns: the number of bytes read
+ */
+guint64 gvir_sandbox_rusage_get_cgroup_read_bytes(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup_read_bytes;
+}
+
+
+/**
+ * gvir_sandbox_rusage_get_cgroup_write_bytes:
+ * @rusage: (transfer none): the command resource usage
+ *
+ * Retrieves the number of bytes written to block devices by the command's cgroup
+ *
+ * Returns: the number of bytes written
+ */
+guint64 gvir_sandbox_rusage_get_cgroup_write_bytes(GVirSandboxRusage *rusage)
+{
+    GVirSandboxRusagePrivate *priv = rusage->priv;
+    return priv->cgroup_write_bytes;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
@@ -0,0 +1,87 @@
+/*
+ * libvirt-sandbox-rusage.h: libvirt sandbox command resource usage
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#if !defined(__LIBVIRT_SANDBOX_H__) && !defined(LIBVIRT_SANDBOX_BUILD)
+#error "Only <libvirt-sandbox/libvirt-sandbox.h> can be included directly."
+#endif
+
+#ifndef __LIBVIRT_SANDBOX_RUSAGE_H__
+#define __LIBVIRT_SANDBOX_RUSAGE_H__
+
+G_BEGIN_DECLS
+
+#define GVIR_SANDBOX_TYPE_RUSAGE            (gvir_sandbox_rusage_get_type ())
+#define GVIR_SANDBOX_RUSAGE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GVIR_SANDBOX_TYPE_RUSAGE, GVirSandboxRusage))
+#define GVIR_SANDBOX_RUSAGE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GVIR_SANDBOX_TYPE_RUSAGE, GVirSandboxRusageClass))
+#define GVIR_SANDBOX_IS_RUSAGE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GVIR_SANDBOX_TYPE_RUSAGE))
+#define GVIR_SANDBOX_IS_RUSAGE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GVIR_SANDBOX_TYPE_RUSAGE))
+#define GVIR_SANDBOX_RUSAGE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GVIR_SANDBOX_TYPE_RUSAGE, GVirSandboxRusageClass))
+
+typedef struct _GVirSandboxRusage GVirSandboxRusage;
+typedef struct _GVirSandboxRusagePrivate GVirSandboxRusagePrivate;
+typedef struct _GVirSandboxRusageClass GVirSandboxRusageClass;
+
+struct _GVirSandboxRusage
+{
+    GObject parent;
+
+    GVirSandboxRusagePrivate *priv;
+
+    /* Do not add fields to this struct */
+};
+
+struct _GVirSandboxRusageClass
+{
+    GObjectClass parent_class;
+
+    gpointer padding[LIBVIRT_SANDBOX_CLASS_PADDING];
+};
+
+GType gvir_sandbox_rusage_get_type(void);
+
+guint64 gvir_sandbox_rusage_get_user_time(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_system_time(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_max_rss(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_minor_faults(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_major_faults(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_input_blocks(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_output_blocks(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_voluntary_switches(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_involuntary_switches(GVirSandboxRusage *rusage);
+gboolean gvir_sandbox_rusage_has_cgroup(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_cgroup_usage_time(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_cgroup_user_time(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_cgroup_system_time(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_cgroup_memory_peak(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_cgroup_read_bytes(GVirSandboxRusage *rusage);
+guint64 gvir_sandbox_rusage_get_cgroup_write_bytes(GVirSandboxRusage *rusage);
+
+G_END_DECLS
+
+#endif /* __LIBVIRT_SANDBOX_RUSAGE_H__ */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
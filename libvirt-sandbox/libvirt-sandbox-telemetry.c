@@ -0,0 +1,603 @@
+/*
+ * libvirt-sandbox-telemetry.c: libvirt sandbox guest telemetry
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <config.h>
+
+#include "libvirt-sandbox/libvirt-sandbox.h"
+
+/**
+ * SECTION: libvirt-sandbox-telemetry
+ * @short_description: Guest resource pressure sample
+ * @include: libvirt-sandbox/libvirt-sandbox.h
+ * @see_also: #GVirSandboxConsoleRpc
+ *
+ * Provides an object to report resource pressure inside the sandbox
+ *
+ * The GVirSandboxTelemetry object holds a single sample of the guest's
+ * pressure stall information, memory and CPU statistics. Samples are
+ * periodically emitted by the "telemetry" signal of #GVirSandboxConsoleRpc
+ * when a telemetry interval has been set in the sandbox config.
+ */
+
+#define GVIR_SANDBOX_TELEMETRY_GET_PRIVATE(obj)                         \
+    (G_TYPE_INSTANCE_GET_PRIVATE((obj), GVIR_SANDBOX_TYPE_TELEMETRY, GVirSandboxTelemetryPrivate))
+
+struct _GVirSandboxTelemetryPrivate
+{
+    gboolean pressure;
+    gdouble cpu_some;
+    gdouble memory_some;
+    gdouble memory_full;
+    gdouble io_some;
+    gdouble io_full;
+    guint64 memory_total;
+    guint64 memory_available;
+    guint64 cpu_user;
+    guint64 cpu_system;
+    guint64 cpu_idle;
+    guint64 cpu_iowait;
+    guint64 cpu_steal;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(GVirSandboxTelemetry, gvir_sandbox_telemetry, G_TYPE_OBJECT);
+
+
+enum {
+    PROP_0,
+    PROP_HAS_PRESSURE,
+    PROP_CPU_SOME_PRESSURE,
+    PROP_MEMORY_SOME_PRESSURE,
+    PROP_MEMORY_FULL_PRESSURE,
+    PROP_IO_SOME_PRESSURE,
+    PROP_IO_FULL_PRESSURE,
+    PROP_MEMORY_TOTAL,
+    PROP_MEMORY_AVAILABLE,
+    PROP_CPU_USER,
+    PROP_CPU_SYSTEM,
+    PROP_CPU_IDLE,
+    PROP_CPU_IOWAIT,
+    PROP_CPU_STEAL,
+};
+
+enum {
+    LAST_SIGNAL
+};
+
+//static gint signals[LAST_SIGNAL];
+
+
+static void gvir_sandbox_telemetry_get_property(GObject *object,
+                                                guint prop_id,
+                                                GValue *value,
+                                                GParamSpec *pspec)
+{
+    GVirSandboxTelemetry *telemetry = GVIR_SANDBOX_TELEMETRY(object);
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+
+    switch (prop_id) {
+    case PROP_HAS_PRESSURE:
+        g_value_set_boolean(value, priv->pressure);
+        break;
+
+    case PROP_CPU_SOME_PRESSURE:
+        g_value_set_double(value, priv->cpu_some);
+        break;
+
+    case PROP_MEMORY_SOME_PRESSURE:
+        g_value_set_double(value, priv->memory_some);
+        break;
+
+    case PROP_MEMORY_FULL_PRESSURE:
+        g_value_set_double(value, priv->memory_full);
+        break;
+
+    case PROP_IO_SOME_PRESSURE:
+        g_value_set_double(value, priv->io_some);
+        break;
+
+    case PROP_IO_FULL_PRESSURE:
+        g_value_set_double(value, priv->io_full);
+        break;
+
+    case PROP_MEMORY_TOTAL:
+        g_value_set_uint64(value, priv->memory_total);
+        break;
+
+    case PROP_MEMORY_AVAILABLE:
+        g_value_set_uint64(value, priv->memory_available);
+        break;
+
+    case PROP_CPU_USER:
+        g_value_set_uint64(value, priv->cpu_user);
+        break;
+
+    case PROP_CPU_SYSTEM:
+        g_value_set_uint64(value, priv->cpu_system);
+        break;
+
+    case PROP_CPU_IDLE:
+        g_value_set_uint64(value, priv->cpu_idle);
+        break;
+
+    case PROP_CPU_IOWAIT:
+        g_value_set_uint64(value, priv->cpu_iowait);
+        break;
+
+    case PROP_CPU_STEAL:
+        g_value_set_uint64(value, priv->cpu_steal);
+        break;
+
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+
+static void gvir_sandbox_telemetry_set_property(GObject *object,
+                                                guint prop_id,
+                                                const GValue *value,
+                                                GParamSpec *pspec)
+{
+    GVirSandboxTelemetry *telemetry = GVIR_SANDBOX_TELEMETRY(object);
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+
+    switch (prop_id) {
+    case PROP_HAS_PRESSURE:
+        priv->pressure = g_value_get_boolean(value);
+        break;
+
+    case PROP_CPU_SOME_PRESSURE:
+        priv->cpu_some = g_value_get_double(value);
+        break;
+
+    case PROP_MEMORY_SOME_PRESSURE:
+        priv->memory_some = g_value_get_double(value);
+        break;
+
+    case PROP_MEMORY_FULL_PRESSURE:
+        priv->memory_full = g_value_get_double(value);
+        break;
+
+    case PROP_IO_SOME_PRESSURE:
+        priv->io_some = g_value_get_double(value);
+        break;
+
+    case PROP_IO_FULL_PRESSURE:
+        priv->io_full = g_value_get_double(value);
+        break;
+
+    case PROP_MEMORY_TOTAL:
+        priv->memory_total = g_value_get_uint64(value);
+        break;
+
+    case PROP_MEMORY_AVAILABLE:
+        priv->memory_available = g_value_get_uint64(value);
+        break;
+
+    case PROP_CPU_USER:
+        priv->cpu_user = g_value_get_uint64(value);
+        break;
+
+    case PROP_CPU_SYSTEM:
+        priv->cpu_system = g_value_get_uint64(value);
+        break;
+
+    case PROP_CPU_IDLE:
+        priv->cpu_idle = g_value_get_uint64(value);
+        break;
+
+    case PROP_CPU_IOWAIT:
+        priv->cpu_iowait = g_value_get_uint64(value);
+        break;
+
+    case PROP_CPU_STEAL:
+        priv->cpu_steal = g_value_get_uint64(value);
+        break;
+
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+    }
+}
+
+
+static void gvir_sandbox_telemetry_class_init(GVirSandboxTelemetryClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->get_property = gvir_sandbox_telemetry_get_property;
+    object_class->set_property = gvir_sandbox_telemetry_set_property;
+
+    g_object_class_install_property(object_class,
+                                    PROP_HAS_PRESSURE,
+                                    g_param_spec_boolean("has-pressure",
+                                                         "Has pressure",
+                                                         "Whether pressure stats are present",
+                                                         FALSE,
+                                                         G_PARAM_READABLE |
+                                                         G_PARAM_WRITABLE |
+                                                         G_PARAM_CONSTRUCT_ONLY |
+                                                         G_PARAM_STATIC_NAME |
+                                                         G_PARAM_STATIC_NICK |
+                                                         G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CPU_SOME_PRESSURE,
+                                    g_param_spec_double("cpu-some-pressure",
+                                                        "CPU some pressure",
+                                                        "Share of time some tasks stalled on CPU",
+                                                        0, 100, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MEMORY_SOME_PRESSURE,
+                                    g_param_spec_double("memory-some-pressure",
+                                                        "Memory some pressure",
+                                                        "Share of time some tasks stalled on memory",
+                                                        0, 100, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MEMORY_FULL_PRESSURE,
+                                    g_param_spec_double("memory-full-pressure",
+                                                        "Memory full pressure",
+                                                        "Share of time all tasks stalled on memory",
+                                                        0, 100, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_IO_SOME_PRESSURE,
+                                    g_param_spec_double("io-some-pressure",
+                                                        "I/O some pressure",
+                                                        "Share of time some tasks stalled on I/O",
+                                                        0, 100, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_IO_FULL_PRESSURE,
+                                    g_param_spec_double("io-full-pressure",
+                                                        "I/O full pressure",
+                                                        "Share of time all tasks stalled on I/O",
+                                                        0, 100, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MEMORY_TOTAL,
+                                    g_param_spec_uint64("memory-total",
+                                                        "Memory total",
+                                                        "Total guest memory in kilobytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_MEMORY_AVAILABLE,
+                                    g_param_spec_uint64("memory-available",
+                                                        "Memory available",
+                                                        "Available guest memory in kilobytes",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CPU_USER,
+                                    g_param_spec_uint64("cpu-user",
+                                                        "CPU user",
+                                                        "Cumulative user CPU time in clock ticks",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CPU_SYSTEM,
+                                    g_param_spec_uint64("cpu-system",
+                                                        "CPU system",
+                                                        "Cumulative system CPU time in clock ticks",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CPU_IDLE,
+                                    g_param_spec_uint64("cpu-idle",
+                                                        "CPU idle",
+                                                        "Cumulative idle CPU time in clock ticks",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CPU_IOWAIT,
+                                    g_param_spec_uint64("cpu-iowait",
+                                                        "CPU I/O wait",
+                                                        "Cumulative I/O wait CPU time in clock ticks",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+    g_object_class_install_property(object_class,
+                                    PROP_CPU_STEAL,
+                                    g_param_spec_uint64("cpu-steal",
+                                                        "CPU steal",
+                                                        "Cumulative stolen CPU time in clock ticks",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_WRITABLE |
+                                                        G_PARAM_CONSTRUCT_ONLY |
+                                                        G_PARAM_STATIC_NAME |
+                                                        G_PARAM_STATIC_NICK |
+                                                        G_PARAM_STATIC_BLURB));
+}
+
+
+static void gvir_sandbox_telemetry_init(GVirSandboxTelemetry *telemetry)
+{
+    telemetry->priv = GVIR_SANDBOX_TELEMETRY_GET_PRIVATE(telemetry);
+}
+
+
+/**
+ * gvir_sandbox_telemetry_has_pressure:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Determine whether the guest kernel reported pressure stall information.
+ * If not, all the pressure values will be zero.
+ *
+ * Returns: TRUE if pressure values are present
+ */
+gboolean gvir_sandbox_telemetry_has_pressure(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->pressure;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_cpu_some_pressure:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the percentage of time, averaged over 10 seconds, in which at
+ * least some tasks were stalled waiting for CPU
+ *
+ * Returns: the stall percentage
+ */
+gdouble gvir_sandbox_telemetry_get_cpu_some_pressure(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->cpu_some;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_memory_some_pressure:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the percentage of time, averaged over 10 seconds, in which at
+ * least some tasks were stalled waiting for memory
+ *
+ * Returns: the stall percentage
+ */
+gdouble gvir_sandbox_telemetry_get_memory_some_pressure(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->memory_some;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_memory_full_pressure:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the percentage of time, averaged over 10 seconds, in which all
+ * non-idle tasks were stalled waiting for memory
+ *
+ * Returns: the stall percentage
+ */
+gdouble gvir_sandbox_telemetry_get_memory_full_pressure(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->memory_full;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_io_some_pressure:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the percentage of time, averaged over 10 seconds, in which at
+ * least some tasks were stalled waiting for I/O
+ *
+ * Returns: the stall percentage
+ */
+gdouble gvir_sandbox_telemetry_get_io_some_pressure(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->io_some;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_io_full_pressure:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the percentage of time, averaged over 10 seconds, in which all
+ * non-idle tasks were stalled waiting for I/O
+ *
+ * Returns: the stall percentage
+ */
+gdouble gvir_sandbox_telemetry_get_io_full_pressure(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->io_full;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_memory_total:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the total usable memory in the guest
+ *
+ * Returns: the memory size in kilobytes
+ */
+guint64 gvir_sandbox_telemetry_get_memory_total(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->memory_total;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_memory_available:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the amount of guest memory available for starting new
+ * applications without swapping
+ *
+ * Returns: the memory size in kilobytes
+ */
+guint64 gvir_sandbox_telemetry_get_memory_available(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->memory_available;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_cpu_user:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the cumulative time all guest CPUs spent in user mode
+ *
+ * Returns: the time in clock ticks
+ */
+guint64 gvir_sandbox_telemetry_get_cpu_user(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->cpu_user;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_cpu_system:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the cumulative time all guest CPUs spent in kernel mode,
+ * including interrupt handling
+ *
+ * Returns: the time in clock ticks
+ */
+guint64 gvir_sandbox_telemetry_get_cpu_system(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->cpu_system;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_cpu_idle:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the cumulative time all guest CPUs spent idle
+ *
+ * Returns: the time in clock ticks
+ */
+guint64 gvir_sandbox_telemetry_get_cpu_idle(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->cpu_idle;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_cpu_iowait:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the cumulative time all guest CPUs spent idle while waiting
+ * for I/O
+ *
+ * Returns: the time in clock ticks
+ */
+guint64 gvir_sandbox_telemetry_get_cpu_iowait(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->cpu_iowait;
+}
+
+
+/**
+ * gvir_sandbox_telemetry_get_cpu_steal:
+ * @telemetry: (transfer none): the telemetry sample
+ *
+ * Retrieves the cumulative time the guest CPUs were runnable but not
+ * scheduled by the host
+ *
+ * Returns: the time in clock ticks
+ */
+guint64 gvir_sandbox_telemetry_get_cpu_steal(GVirSandboxTelemetry *telemetry)
+{
+    GVirSandboxTelemetryPrivate *priv = telemetry->priv;
+    return priv->cpu_steal;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
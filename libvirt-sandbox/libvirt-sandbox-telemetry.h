@@ -0,0 +1,84 @@
+/*
+ * libvirt-sandbox-telemetry.h: libvirt sandbox guest telemetry
+ *
+ * Copyright (C) 2026 The libvirt-sandbox authors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#if !defined(__LIBVIRT_SANDBOX_H__) && !defined(LIBVIRT_SANDBOX_BUILD)
+#error "Only <libvirt-sandbox/libvirt-sandbox.h> can be included directly."
+#endif
+
+#ifndef __LIBVIRT_SANDBOX_TELEMETRY_H__
+#define __LIBVIRT_SANDBOX_TELEMETRY_H__
+
+G_BEGIN_DECLS
+
+#define GVIR_SANDBOX_TYPE_TELEMETRY            (gvir_sandbox_telemetry_get_type ())
+#define GVIR_SANDBOX_TELEMETRY(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GVIR_SANDBOX_TYPE_TELEMETRY, GVirSandboxTelemetry))
+#define GVIR_SANDBOX_TELEMETRY_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GVIR_SANDBOX_TYPE_TELEMETRY, GVirSandboxTelemetryClass))
+#define GVIR_SANDBOX_IS_TELEMETRY(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GVIR_SANDBOX_TYPE_TELEMETRY))
+#define GVIR_SANDBOX_IS_TELEMETRY_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GVIR_SANDBOX_TYPE_TELEMETRY))
+#define GVIR_SANDBOX_TELEMETRY_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GVIR_SANDBOX_TYPE_TELEMETRY, GVirSandboxTelemetryClass))
+
+typedef struct _GVirSandboxTelemetry GVirSandboxTelemetry;
+typedef struct _GVirSandboxTelemetryPrivate GVirSandboxTelemetryPrivate;
+typedef struct _GVirSandboxTelemetryClass GVirSandboxTelemetryClass;
+
+struct _GVirSandboxTelemetry
+{
+    GObject parent;
+
+    GVirSandboxTelemetryPrivate *priv;
+
+    /* Do not add fields to this struct */
+};
+
+struct _GVirSandboxTelemetryClass
+{
+    GObjectClass parent_class;
+
+    gpointer padding[LIBVIRT_SANDBOX_CLASS_PADDING];
+};
+
+GType gvir_sandbox_telemetry_get_type(void);
+
+gboolean gvir_sandbox_telemetry_has_pressure(GVirSandboxTelemetry *telemetry);
+gdouble gvir_sandbox_telemetry_get_cpu_some_pressure(GVirSandboxTelemetry *telemetry);
+gdouble gvir_sandbox_telemetry_get_memory_some_pressure(GVirSandboxTelemetry *telemetry);
+gdouble gvir_sandbox_telemetry_get_memory_full_pressure(GVirSandboxTelemetry *telemetry);
+gdouble gvir_sandbox_telemetry_get_io_some_pressure(GVirSandboxTelemetry *telemetry);
+gdouble gvir_sandbox_telemetry_get_io_full_pressure(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_memory_total(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_memory_available(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_cpu_user(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_cpu_system(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_cpu_idle(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_cpu_iowait(GVirSandboxTelemetry *telemetry);
+guint64 gvir_sandbox_telemetry_get_cpu_steal(GVirSandboxTelemetry *telemetry);
+
+G_END_DECLS
+
+#endif /* __LIBVIRT_SANDBOX_TELEMETRY_H__ */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
@@ -71,3 +71,28 @@ gint gvir_sandbox_util_disk_format_from_str(const gchar *value,
     g_type_class_unref(enum_class);
     return ret;
 }
+
+/* Whether @mac is six colon separated pairs of hex digits */
+gboolean gvir_sandbox_util_is_mac_address(const gchar *mac)
+{
+    gsize i;
+
+    for (i = 0 ; i < 6 ; i++) {
+        if (!g_ascii_isxdigit(mac[0]) ||
+            !g_ascii_isxdigit(mac[1]))
+            return FALSE;
+        mac += 2;
+        if (*mac != (i == 5 ? '\0' : ':'))
+            return FALSE;
+        mac++;
+    }
+
+    return TRUE;
+}
+
+/* Whether @backend is a user mode network backend QEMU has */
+gboolean gvir_sandbox_util_is_network_backend(const gchar *backend)
+{
+    return g_str_equal(backend, "slirp") ||
+        g_str_equal(backend, "passt");
+}
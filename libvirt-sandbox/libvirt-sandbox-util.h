@@ -34,6 +34,10 @@ gint gvir_sandbox_util_guess_image_format(const gchar *path, GError **error);
 
 gint gvir_sandbox_util_disk_format_from_str(const gchar *value, GError **error);
 
+gboolean gvir_sandbox_util_is_mac_address(const gchar *mac);
+
+gboolean gvir_sandbox_util_is_network_backend(const gchar *backend);
+
 /**
  * LIBVIRT_SANDBOX_CLASS_PADDING: (skip)
  */
@@ -32,6 +32,7 @@
 #include <libvirt-sandbox/libvirt-sandbox-util.h>
 #include <libvirt-sandbox/libvirt-sandbox-enum-types.h>
 #include <libvirt-sandbox/libvirt-sandbox-config-disk.h>
+#include <libvirt-sandbox/libvirt-sandbox-config-volume.h>
 #include <libvirt-sandbox/libvirt-sandbox-config-mount.h>
 #include <libvirt-sandbox/libvirt-sandbox-config-mount-file.h>
 #include <libvirt-sandbox/libvirt-sandbox-config-mount-host-bind.h>
@@ -53,6 +54,8 @@
 #include <libvirt-sandbox/libvirt-sandbox-builder-initrd.h>
 #include <libvirt-sandbox/libvirt-sandbox-builder-machine.h>
 #include <libvirt-sandbox/libvirt-sandbox-builder-container.h>
+#include <libvirt-sandbox/libvirt-sandbox-rusage.h>
+#include <libvirt-sandbox/libvirt-sandbox-telemetry.h>
 #include <libvirt-sandbox/libvirt-sandbox-console.h>
 #include <libvirt-sandbox/libvirt-sandbox-console-raw.h>
 #include <libvirt-sandbox/libvirt-sandbox-console-rpc.h>
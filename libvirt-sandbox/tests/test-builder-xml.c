@@ -0,0 +1,527 @@
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libvirt-sandbox/libvirt-sandbox.h>
+#include <libvirt-sandbox/libvirt-sandbox-builder-private.h>
+
+
+static gboolean check_xml(const gchar *what,
+                          gchar *actual,
+                          const gchar *expected,
+                          GError **error)
+{
+    gboolean ret = TRUE;
+
+    if (g_strcmp0(actual, expected) != 0) {
+        g_set_error(error, 0, 0,
+                    "Different %s XML >>>%s<<< >>>%s<<<\n",
+                    what, actual ? actual : "(null)",
+                    expected ? expected : "(null)");
+        ret = FALSE;
+    }
+    g_free(actual);
+    return ret;
+}
+
+
+/* Serializes and releases @disk, so it can be checked like a fragment */
+static gchar *disk_xml(GVirConfigDomainDisk *disk)
+{
+    gchar *xml;
+
+    if (!disk)
+        return NULL;
+    xml = gvir_config_object_to_xml(GVIR_CONFIG_OBJECT(disk));
+    g_object_unref(disk);
+    return xml;
+}
+
+
+static gboolean test_memory_backing(GError **error)
+{
+    static const struct {
+        const gchar *opts;
+        const gchar *xml;
+    } tests[] = {
+        { "", NULL },
+        { "mergeable", NULL },
+        { "nosharepages",
+          "<memoryBacking>"
+          "<nosharepages/>"
+          "</memoryBacking>" },
+        { "hugepages",
+          "<memoryBacking>"
+          "<hugepages><page size='2048' unit='KiB'/></hugepages>"
+          "</memoryBacking>" },
+        { "hugepages=1G",
+          "<memoryBacking>"
+          "<hugepages><page size='1048576' unit='KiB'/></hugepages>"
+          "</memoryBacking>" },
+        { "memfd",
+          "<memoryBacking>"
+          "<source type='memfd'/><access mode='shared'/>"
+          "</memoryBacking>" },
+        { "prealloc",
+          "<memoryBacking>"
+          "<allocation mode='immediate'/>"
+          "</memoryBacking>" },
+        { "locked",
+          "<memoryBacking>"
+          "<locked/>"
+          "</memoryBacking>" },
+        { "hugepages=2M,memfd,prealloc,locked,nosharepages",
+          "<memoryBacking>"
+          "<hugepages><page size='2048' unit='KiB'/></hugepages>"
+          "<nosharepages/>"
+          "<locked/>"
+          "<source type='memfd'/><access mode='shared'/>"
+          "<allocation mode='immediate'/>"
+          "</memoryBacking>" },
+    };
+    static const gchar *invalid[] = {
+        "hugepages=512",
+        "hugepages=3M",
+        "hugepages=1536K",
+    };
+    gboolean ret = FALSE;
+    gsize i;
+
+    for (i = 0 ; i < G_N_ELEMENTS(tests) ; i++) {
+        GVirSandboxConfig *cfg =
+            GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+
+        if (!gvir_sandbox_config_set_memory_backing_opts(cfg, tests[i].opts, error) ||
+            !check_xml(tests[i].opts,
+                       gvir_sandbox_builder_xml_memory_backing(cfg),
+                       tests[i].xml, error)) {
+            g_object_unref(cfg);
+            goto cleanup;
+        }
+        g_object_unref(cfg);
+    }
+
+    for (i = 0 ; i < G_N_ELEMENTS(invalid) ; i++) {
+        GVirSandboxConfig *cfg =
+            GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+        gboolean ok = gvir_sandbox_config_set_memory_backing_opts(cfg, invalid[i], NULL);
+
+        g_object_unref(cfg);
+        if (ok) {
+            g_set_error(error, 0, 0, "Invalid memory backing '%s' was accepted\n",
+                        invalid[i]);
+            goto cleanup;
+        }
+    }
+
+    ret = TRUE;
+ cleanup:
+    return ret;
+}
+
+
+static gboolean test_memballoon(GError **error)
+{
+    GVirSandboxConfig *cfg =
+        GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+    gboolean ret = FALSE;
+
+    if (!check_xml("no balloon",
+                   gvir_sandbox_builder_xml_memballoon(cfg),
+                   NULL, error))
+        goto cleanup;
+
+    gvir_sandbox_config_set_balloon(cfg, TRUE);
+    if (!check_xml("balloon",
+                   gvir_sandbox_builder_xml_memballoon(cfg),
+                   "<memballoon model='virtio' autodeflate='on' "
+                   "freePageReporting='on'/>", error))
+        goto cleanup;
+
+    ret = TRUE;
+ cleanup:
+    g_object_unref(cfg);
+    return ret;
+}
+
+
+static gboolean test_disk(GError **error)
+{
+    GVirSandboxConfig *cfg =
+        GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+    GList *disks = NULL;
+    gboolean ret = FALSE;
+
+    if (!check_xml("default disk",
+                   disk_xml(gvir_sandbox_builder_xml_disk(cfg, NULL,
+                                                          GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                                          "/tmp/in&out.img",
+                                                          GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW,
+                                                          "vda", TRUE, NULL, 0, NULL)),
+                   "<disk type=\"file\" device=\"disk\">"
+                   "<driver type=\"raw\"/>"
+                   "<source file=\"/tmp/in&amp;out.img\"/>"
+                   "<target dev=\"vda\" bus=\"virtio\"/>"
+                   "<readonly/>"
+                   "</disk>", error))
+        goto cleanup;
+
+    if (!check_xml("scratch disk",
+                   disk_xml(gvir_sandbox_builder_xml_disk(cfg, NULL,
+                                                          GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                                          "/tmp/scratch.img",
+                                                          GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW,
+                                                          "vdb", FALSE, "unsafe", 0, NULL)),
+                   "<disk type=\"file\" device=\"disk\">"
+                   "<driver type=\"raw\" cache=\"unsafe\"/>"
+                   "<source file=\"/tmp/scratch.img\"/>"
+                   "<target dev=\"vdb\" bus=\"virtio\"/>"
+                   "</disk>", error))
+        goto cleanup;
+
+    if (!gvir_sandbox_config_set_disk_tuning_opts(cfg,
+                                                  "cache=none,io=native,discard=unmap,"
+                                                  "detect-zeroes=unmap,iothread,queues=2",
+                                                  error))
+        goto cleanup;
+
+    if (!check_xml("tuned disk",
+                   disk_xml(gvir_sandbox_builder_xml_disk(cfg, NULL,
+                                                          GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                                          "/tmp/scratch.img",
+                                                          GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW,
+                                                          "vdb", FALSE, "unsafe", 1, NULL)),
+                   "<disk type=\"file\" device=\"disk\">"
+                   "<driver detect_zeroes=\"unmap\" iothread=\"1\" queues=\"2\" "
+                   "type=\"raw\" cache=\"none\" io=\"native\" discard=\"unmap\"/>"
+                   "<source file=\"/tmp/scratch.img\"/>"
+                   "<target dev=\"vdb\" bus=\"virtio\"/>"
+                   "</disk>", error))
+        goto cleanup;
+
+    if (!gvir_sandbox_config_add_disk_opts(cfg,
+                                           "file:data=/tmp/data.qcow2,format=qcow2,"
+                                           "cache=unsafe,io=io_uring,queues=4",
+                                           error))
+        goto cleanup;
+    disks = gvir_sandbox_config_get_disks(cfg);
+
+    if (!check_xml("custom disk",
+                   disk_xml(gvir_sandbox_builder_xml_disk(cfg, disks->data,
+                                                          GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                                          "/tmp/data.qcow2",
+                                                          GVIR_CONFIG_DOMAIN_DISK_FORMAT_QCOW2,
+                                                          "vdc", FALSE, NULL, 2, NULL)),
+                   "<disk type=\"file\" device=\"disk\">"
+                   "<driver io=\"io_uring\" detect_zeroes=\"unmap\" iothread=\"2\" queues=\"4\" "
+                   "type=\"qcow2\" cache=\"unsafe\" discard=\"unmap\"/>"
+                   "<source file=\"/tmp/data.qcow2\"/>"
+                   "<target dev=\"vdc\" bus=\"virtio\"/>"
+                   "</disk>", error))
+        goto cleanup;
+
+    if (gvir_sandbox_config_add_disk_opts(cfg, "file:bad=/tmp/bad.img,cache=sometimes",
+                                          NULL)) {
+        g_set_error(error, 0, 0, "%s", "Invalid cache mode was accepted\n");
+        goto cleanup;
+    }
+
+    if (gvir_sandbox_config_add_disk_opts(cfg, "file:bad=/tmp/bad.img,cache=unsafe,io=native",
+                                          NULL)) {
+        g_set_error(error, 0, 0, "%s", "Native I/O through the page cache was accepted\n");
+        goto cleanup;
+    }
+
+    if (gvir_sandbox_config_add_disk_opts(cfg, "file:bad=/tmp/bad.img,detect-zeroes=unmap",
+                                          NULL)) {
+        g_set_error(error, 0, 0, "%s", "Unmapping zero writes without discard was accepted\n");
+        goto cleanup;
+    }
+
+    ret = TRUE;
+ cleanup:
+    g_list_foreach(disks, (GFunc)g_object_unref, NULL);
+    g_list_free(disks);
+    g_object_unref(cfg);
+    return ret;
+}
+
+
+static gboolean test_disk_native_io(GError **error)
+{
+    GVirSandboxConfig *cfg =
+        GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+    gboolean ret = FALSE;
+
+    if (gvir_sandbox_config_set_disk_tuning_opts(cfg, "cache=writeback,io=native", NULL)) {
+        g_set_error(error, 0, 0, "%s", "Native I/O through the page cache was accepted\n");
+        goto cleanup;
+    }
+    g_object_unref(cfg);
+    cfg = GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+
+    if (!gvir_sandbox_config_set_disk_tuning_opts(cfg, "io=native", error))
+        goto cleanup;
+
+    /* The unsafe default of scratch disks can't be used */
+    if (!check_xml("native scratch disk",
+                   disk_xml(gvir_sandbox_builder_xml_disk(cfg, NULL,
+                                                          GVIR_CONFIG_DOMAIN_DISK_FILE,
+                                                          "/tmp/scratch.img",
+                                                          GVIR_CONFIG_DOMAIN_DISK_FORMAT_RAW,
+                                                          "vdb", FALSE, "unsafe", 0, NULL)),
+                   "<disk type=\"file\" device=\"disk\">"
+                   "<driver type=\"raw\" cache=\"none\" io=\"native\"/>"
+                   "<source file=\"/tmp/scratch.img\"/>"
+                   "<target dev=\"vdb\" bus=\"virtio\"/>"
+                   "</disk>", error))
+        goto cleanup;
+
+    ret = TRUE;
+ cleanup:
+    g_object_unref(cfg);
+    return ret;
+}
+
+
+static gboolean test_volume(GError **error)
+{
+    static const struct {
+        const gchar *opts;
+        const gchar *xml;
+    } tests[] = {
+        { "in:data=/srv/data.bin",
+          "<disk type=\"file\" device=\"disk\">"
+          "<driver type=\"raw\"/>"
+          "<source file=\"/srv/data.bin\"/>"
+          "<target dev=\"vdb\" bus=\"virtio\"/>"
+          "<readonly/>"
+          "</disk>" },
+        { "in:refs=/srv/refs,target=/refs",
+          "<disk type=\"file\" device=\"disk\">"
+          "<driver type=\"raw\"/>"
+          "<source file=\"/srv/refs\"/>"
+          "<target dev=\"vdb\" bus=\"virtio\"/>"
+          "<readonly/>"
+          "</disk>" },
+        { "out:results=/srv/results.img,size=1G",
+          "<disk type=\"file\" device=\"disk\">"
+          "<driver type=\"raw\" cache=\"unsafe\"/>"
+          "<source file=\"/srv/results.img\"/>"
+          "<target dev=\"vdb\" bus=\"virtio\"/>"
+          "</disk>" },
+        { "out:results=/srv/results.img,size=1G,target=/results",
+          "<disk type=\"file\" device=\"disk\">"
+          "<driver type=\"raw\" cache=\"unsafe\"/>"
+          "<source file=\"/srv/results.img\"/>"
+          "<target dev=\"vdb\" bus=\"virtio\"/>"
+          "</disk>" },
+    };
+    static const gchar *invalid[] = {
+        "in:=/srv/data.bin",
+        "in:../data=/srv/data.bin",
+        "out:a/b=/srv/results.img,size=1G",
+    };
+    gboolean ret = FALSE;
+    gsize i;
+
+    for (i = 0 ; i < G_N_ELEMENTS(tests) ; i++) {
+        GVirSandboxConfig *cfg =
+            GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+        GList *volumes;
+        gboolean ok;
+
+        if (!gvir_sandbox_config_add_volume_opts(cfg, tests[i].opts, error)) {
+            g_object_unref(cfg);
+            goto cleanup;
+        }
+        volumes = gvir_sandbox_config_get_volumes(cfg);
+        /* The source stands in for the scratch image path */
+        ok = check_xml(tests[i].opts,
+                       disk_xml(gvir_sandbox_builder_xml_volume(cfg, volumes->data,
+                                                                gvir_sandbox_config_volume_get_source(volumes->data),
+                                                                "vdb", 0, NULL)),
+                       tests[i].xml, error);
+        g_list_foreach(volumes, (GFunc)g_object_unref, NULL);
+        g_list_free(volumes);
+        g_object_unref(cfg);
+        if (!ok)
+            goto cleanup;
+    }
+
+    for (i = 0 ; i < G_N_ELEMENTS(invalid) ; i++) {
+        GVirSandboxConfig *cfg =
+            GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+        gboolean ok = gvir_sandbox_config_add_volume_opts(cfg, invalid[i], NULL);
+
+        g_object_unref(cfg);
+        if (ok) {
+            g_set_error(error, 0, 0, "Invalid volume '%s' was accepted\n",
+                        invalid[i]);
+            goto cleanup;
+        }
+    }
+
+    ret = TRUE;
+ cleanup:
+    return ret;
+}
+
+
+static gboolean test_interface(GError **error)
+{
+    static const struct {
+        const gchar *opts;
+        const gchar *xml;
+    } tests[] = {
+        { "dhcp",
+          "<interface type='user'>"
+          "<model type='virtio'/>"
+          "</interface>" },
+        { "dhcp,backend=slirp",
+          "<interface type='user'>"
+          "<model type='virtio'/>"
+          "</interface>" },
+        { "dhcp,backend=passt",
+          "<interface type='user'>"
+          "<backend type='passt'/>"
+          "<model type='virtio'/>"
+          "</interface>" },
+        { "dhcp,backend=passt,mac=52:54:00:00:00:02,rx_queue_size=512",
+          "<interface type='user'>"
+          "<backend type='passt'/>"
+          "<mac address='52:54:00:00:00:02'/>"
+          "<model type='virtio'/>"
+          "<driver rx_queue_size='512'/>"
+          "</interface>" },
+        { "dhcp,vhost,rx_queue_size=1024",
+          "<interface type='user'>"
+          "<model type='virtio'/>"
+          "<driver rx_queue_size='1024'/>"
+          "</interface>" },
+        { "dhcp,source=default,mac=52:54:00:00:00:01",
+          "<interface type='network'>"
+          "<source network='default'/>"
+          "<mac address='52:54:00:00:00:01'/>"
+          "<model type='virtio'/>"
+          "</interface>" },
+        { "dhcp,source=default,vhost",
+          "<interface type='network'>"
+          "<source network='default'/>"
+          "<model type='virtio'/>"
+          "<driver name='vhost' queues='4'/>"
+          "</interface>" },
+        { "dhcp,source=default,vhost,queues=2,rx_queue_size=1024,tx_queue_size=256",
+          "<interface type='network'>"
+          "<source network='default'/>"
+          "<model type='virtio'/>"
+          "<driver name='vhost' queues='2' rx_queue_size='1024' tx_queue_size='256'/>"
+          "</interface>" },
+        { "dhcp,source=default,vhost,queues=1,filter=clean-traffic,filter.ip=10.0.0.1",
+          "<interface type='network'>"
+          "<source network='default'/>"
+          "<model type='virtio'/>"
+          "<driver name='vhost'/>"
+          "<filterref filter='clean-traffic'>"
+          "<parameter name='IP' value='10.0.0.1'/>"
+          "</filterref>"
+          "</interface>" },
+    };
+    static const gchar *invalid[] = {
+        "dhcp,queues=0",
+        "dhcp,rx_queue_size=128",
+        "dhcp,tx_queue_size=768",
+        "dhcp,backend=vde",
+        "dhcp,backend=passt,source=default",
+        "dhcp,mac=52:54'/><x a='",
+        "dhcp,mac=52:54:00:00:00",
+        "dhcp,mac=52:54:00:00:00:0g",
+    };
+    gboolean ret = FALSE;
+    gsize i;
+
+    for (i = 0 ; i < G_N_ELEMENTS(tests) ; i++) {
+        GVirSandboxConfig *cfg =
+            GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+        GList *networks;
+        gboolean ok;
+
+        gvir_sandbox_config_set_vcpus(cfg, 4);
+        if (!gvir_sandbox_config_add_network_opts(cfg, tests[i].opts, error)) {
+            g_object_unref(cfg);
+            goto cleanup;
+        }
+        networks = gvir_sandbox_config_get_networks(cfg);
+        ok = check_xml(tests[i].opts,
+                       gvir_sandbox_builder_xml_interface(cfg, networks->data),
+                       tests[i].xml, error);
+        g_list_foreach(networks, (GFunc)g_object_unref, NULL);
+        g_list_free(networks);
+        g_object_unref(cfg);
+        if (!ok)
+            goto cleanup;
+    }
+
+    for (i = 0 ; i < G_N_ELEMENTS(invalid) ; i++) {
+        GVirSandboxConfig *cfg =
+            GVIR_SANDBOX_CONFIG(gvir_sandbox_config_interactive_new("demo"));
+        gboolean ok = gvir_sandbox_config_add_network_opts(cfg, invalid[i], NULL);
+
+        g_object_unref(cfg);
+        if (ok) {
+            g_set_error(error, 0, 0, "Invalid network '%s' was accepted\n",
+                        invalid[i]);
+            goto cleanup;
+        }
+    }
+
+    ret = TRUE;
+ cleanup:
+    return ret;
+}
+
+
+int main(int argc, char **argv)
+{
+    GError *err = NULL;
+    int ret = EXIT_FAILURE;
+
+    if (!gvir_init_object_check(&argc, &argv, &err))
+        goto cleanup;
+
+    if (!test_memory_backing(&err))
+        goto cleanup;
+
+    if (!test_memballoon(&err))
+        goto cleanup;
+
+    if (!test_disk(&err))
+        goto cleanup;
+
+    if (!test_disk_native_io(&err))
+        goto cleanup;
+
+    if (!test_volume(&err))
+        goto cleanup;
+
+    if (!test_interface(&err))
+        goto cleanup;
+
+    ret = EXIT_SUCCESS;
+cleanup:
+    if (ret != EXIT_SUCCESS)
+        fprintf(stderr, "Error in test: %s", err && err->message ? err->message : "none");
+
+    exit(ret);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
@@ -70,6 +70,13 @@ int main(int argc, char **argv)
         "file:cache=/tmp/img.qcow2",
         "file:homedir=/tmp/img.qcow2,format=raw",
         "file:root=/tmp/img.img",
+        "file:scratch=/tmp/scratch.img,format=raw,cache=unsafe,io=io_uring,iothread,queues=4",
+        NULL
+    };
+    const gchar *volumes[] = {
+        "in:refdata=/tmp/ref.img",
+        "in:inputs=/tmp/inputs,target=/mnt/inputs",
+        "out:results=/tmp/results.img,size=1G,target=/mnt/results",
         NULL
     };
     const gchar *includes[] = {
@@ -81,6 +88,8 @@ int main(int argc, char **argv)
     const gchar *networks[] = {
         "address=10.0.0.1/24%10.0.0.255",
         "address=10.0.0.1/24%10.0.0.255,route=192.168.1.0/24%10.0.0.3",
+        "dhcp,source=default,vhost,queues=4,rx_queue_size=1024,tx_queue_size=512",
+        "dhcp,backend=passt",
         NULL,
     };
     const gchar *command[] = {
@@ -116,6 +125,9 @@ int main(int argc, char **argv)
     if (!gvir_sandbox_config_add_disk_strv(cfg1, (gchar**)disks, &err))
         goto cleanup;
 
+    if (!gvir_sandbox_config_add_volume_strv(cfg1, (gchar**)volumes, &err))
+        goto cleanup;
+
     if (!gvir_sandbox_config_add_host_include_strv(cfg1, (gchar**)includes, &err))
         goto cleanup;
 
@@ -125,6 +137,29 @@ int main(int argc, char **argv)
     gvir_sandbox_config_set_security_dynamic(cfg1, FALSE);
     gvir_sandbox_config_set_security_label(cfg1, "devil_u:devil_r:devil_t:s666:c0.c1023");
 
+    gvir_sandbox_config_set_telemetry_interval(cfg1, 500);
+    gvir_sandbox_config_set_readahead(cfg1, TRUE);
+    gvir_sandbox_config_set_fastboot(cfg1, TRUE);
+    gvir_sandbox_config_set_rng_rate(cfg1, 4096);
+    gvir_sandbox_config_set_vcpus(cfg1, 4);
+    gvir_sandbox_config_set_cpu_topology(cfg1, 1, 2, 2);
+    gvir_sandbox_config_set_memory(cfg1, 1024 * 1024 * 1024);
+    gvir_sandbox_config_set_max_memory(cfg1, 2048ULL * 1024 * 1024);
+    gvir_sandbox_config_set_hugepages(cfg1, 2 * 1024 * 1024);
+    gvir_sandbox_config_set_memfd(cfg1, TRUE);
+    gvir_sandbox_config_set_prealloc(cfg1, TRUE);
+    gvir_sandbox_config_set_memory_locked(cfg1, TRUE);
+    gvir_sandbox_config_set_mergeable_memory(cfg1, FALSE);
+    gvir_sandbox_config_set_balloon(cfg1, TRUE);
+    gvir_sandbox_config_set_disk_cache(cfg1, "none");
+    gvir_sandbox_config_set_disk_discard(cfg1, "unmap");
+    gvir_sandbox_config_set_disk_detect_zeroes(cfg1, "unmap");
+    gvir_sandbox_config_set_tuning_profile(cfg1, "latency");
+    gvir_sandbox_config_set_tuning_param(cfg1, "vm.swappiness", "0");
+    gvir_sandbox_config_set_zram_size(cfg1, 256 * 1024 * 1024);
+    gvir_sandbox_config_set_zram_algorithm(cfg1, "lz4");
+    gvir_sandbox_config_set_initrd_compression(cfg1, "zstd", 3);
+
     unlink("test.cfg");
 
     if (!gvir_sandbox_config_save_to_path(cfg1, "test1.cfg", &err))
@@ -0,0 +1,122 @@
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libvirt-sandbox/libvirt-sandbox.h>
+
+
+static const struct {
+    const gchar *name;
+    guint64 (*get)(GVirSandboxRusage *rusage);
+} counters[] = {
+    { "user-time", gvir_sandbox_rusage_get_user_time },
+    { "system-time", gvir_sandbox_rusage_get_system_time },
+    { "max-rss", gvir_sandbox_rusage_get_max_rss },
+    { "minor-faults", gvir_sandbox_rusage_get_minor_faults },
+    { "major-faults", gvir_sandbox_rusage_get_major_faults },
+    { "input-blocks", gvir_sandbox_rusage_get_input_blocks },
+    { "output-blocks", gvir_sandbox_rusage_get_output_blocks },
+    { "voluntary-switches", gvir_sandbox_rusage_get_voluntary_switches },
+    { "involuntary-switches", gvir_sandbox_rusage_get_involuntary_switches },
+    { "cgroup-usage-time", gvir_sandbox_rusage_get_cgroup_usage_time },
+    { "cgroup-user-time", gvir_sandbox_rusage_get_cgroup_user_time },
+    { "cgroup-system-time", gvir_sandbox_rusage_get_cgroup_system_time },
+    { "cgroup-memory-peak", gvir_sandbox_rusage_get_cgroup_memory_peak },
+    { "cgroup-read-bytes", gvir_sandbox_rusage_get_cgroup_read_bytes },
+    { "cgroup-write-bytes", gvir_sandbox_rusage_get_cgroup_write_bytes },
+};
+
+
+/* A value for each counter that no other counter shares, and
+ * which doesn't fit in 32 bits */
+static guint64 counter_value(gsize i)
+{
+    return ((guint64)(i + 1) << 32) | (i + 1);
+}
+
+
+int main(int argc, char **argv)
+{
+    GVirSandboxRusage *empty = NULL;
+    GVirSandboxRusage *full = NULL;
+    GError *err = NULL;
+    int ret = EXIT_FAILURE;
+    gsize i;
+
+    empty = GVIR_SANDBOX_RUSAGE(g_object_new(GVIR_SANDBOX_TYPE_RUSAGE, NULL));
+    /* The counters can only be set at construction */
+    full = GVIR_SANDBOX_RUSAGE(g_object_new(GVIR_SANDBOX_TYPE_RUSAGE,
+                                            "user-time", counter_value(0),
+                                            "system-time", counter_value(1),
+                                            "max-rss", counter_value(2),
+                                            "minor-faults", counter_value(3),
+                                            "major-faults", counter_value(4),
+                                            "input-blocks", counter_value(5),
+                                            "output-blocks", counter_value(6),
+                                            "voluntary-switches", counter_value(7),
+                                            "involuntary-switches", counter_value(8),
+                                            "cgroup-usage-time", counter_value(9),
+                                            "cgroup-user-time", counter_value(10),
+                                            "cgroup-system-time", counter_value(11),
+                                            "cgroup-memory-peak", counter_value(12),
+                                            "cgroup-read-bytes", counter_value(13),
+                                            "cgroup-write-bytes", counter_value(14),
+                                            "has-cgroup", TRUE,
+                                            NULL));
+
+    if (gvir_sandbox_rusage_has_cgroup(empty) ||
+        !gvir_sandbox_rusage_has_cgroup(full)) {
+        g_set_error(&err, 0, 0, "%s", "Wrong cgroup presence\n");
+        goto cleanup;
+    }
+
+    for (i = 0 ; i < G_N_ELEMENTS(counters) ; i++) {
+        guint64 prop;
+
+        if (counters[i].get(empty) != 0) {
+            g_set_error(&err, 0, 0, "Default %s is %llu, not 0\n",
+                        counters[i].name,
+                        (unsigned long long)counters[i].get(empty));
+            goto cleanup;
+        }
+
+        if (counters[i].get(full) != counter_value(i)) {
+            g_set_error(&err, 0, 0, "Accessor of %s returned %llu, not %llu\n",
+                        counters[i].name,
+                        (unsigned long long)counters[i].get(full),
+                        (unsigned long long)counter_value(i));
+            goto cleanup;
+        }
+
+        g_object_get(full, counters[i].name, &prop, NULL);
+        if (prop != counter_value(i)) {
+            g_set_error(&err, 0, 0, "Property %s is %llu, not %llu\n",
+                        counters[i].name, (unsigned long long)prop,
+                        (unsigned long long)counter_value(i));
+            goto cleanup;
+        }
+    }
+
+    ret = EXIT_SUCCESS;
+cleanup:
+    if (ret != EXIT_SUCCESS)
+        fprintf(stderr, "Error in test: %s", err && err->message ? err->message : "none");
+
+    g_clear_error(&err);
+    if (empty)
+        g_object_unref(empty);
+    if (full)
+        g_object_unref(full);
+    exit(ret);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ *  indent-tabs-mode: nil
+ *  tab-width: 8
+ * End:
+ */
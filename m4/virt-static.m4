@@ -55,3 +55,27 @@ AC_DEFUN([LIBVIRT_SANDBOX_STATIC_ZLIB], [
          [gzread(NULL, NULL, 0);])
     LIBS="$old_LIBS"
 ])
+
+# LIBVIRT_SANDBOX_STATIC_INIT
+# ---------------------------
+# Optionally link libvirt-sandbox-init-common statically, so that
+# the builders need not stage its shared libraries into the guest.
+#
+AC_DEFUN([LIBVIRT_SANDBOX_STATIC_INIT], [
+    AC_ARG_ENABLE([static-init],
+      [AS_HELP_STRING([--enable-static-init],
+        [link the guest init helpers statically @<:@default=no@:>@])])
+    m4_divert_text([DEFAULTS], [enable_static_init=no])
+
+    if test "$enable_static_init" = "yes" ; then
+        orig_pkg_config="$PKG_CONFIG"
+        PKG_CONFIG="$PKG_CONFIG --static"
+        PKG_CHECK_MODULES(STATIC_INIT, [gio-unix-2.0 >= $GLIB_REQUIRED
+                                        libvirt-gconfig-1.0 >= $LIBVIRT_GCONFIG_REQUIRED
+                                        libselinux])
+        PKG_CONFIG="$orig_pkg_config"
+        AC_DEFINE([WITH_STATIC_INIT], [1],
+                  [Whether the guest init helpers are statically linked])
+    fi
+    AM_CONDITIONAL([WITH_STATIC_INIT], [test "$enable_static_init" = "yes"])
+])